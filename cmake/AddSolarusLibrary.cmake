@@ -44,6 +44,7 @@ file(
   include/solarus/entities/Layer.h
   include/solarus/entities/NonAnimatedRegions.h
   include/solarus/entities/Npc.h
+  include/solarus/entities/ParallaxLayers.h
   include/solarus/entities/ParallaxScrollingTilePattern.h
   include/solarus/entities/Pickable.h
   include/solarus/entities/SelfScrollingTilePattern.h
@@ -103,11 +104,14 @@ file(
   include/solarus/lowlevel/Color.h
   include/solarus/lowlevel/Debug.h
   include/solarus/lowlevel/FontResource.h
+  include/solarus/lowlevel/FrameCapture.h
   include/solarus/lowlevel/Geometry.h
   include/solarus/lowlevel/Hq2xFilter.h
   include/solarus/lowlevel/Hq3xFilter.h
   include/solarus/lowlevel/Hq4xFilter.h
   include/solarus/lowlevel/InputEvent.h
+  include/solarus/lowlevel/IntrusivePtr.h
+  include/solarus/lowlevel/IntrusivePtr.inl
   include/solarus/lowlevel/ItDecoder.h
   include/solarus/lowlevel/Logger.h
   include/solarus/lowlevel/Music.h
@@ -127,21 +131,28 @@ file(
   include/solarus/lowlevel/shaders/Shader.h
   include/solarus/lowlevel/Size.h
   include/solarus/lowlevel/Size.inl
+  include/solarus/lowlevel/SoftwareBlitter.h
   include/solarus/lowlevel/Sound.h
   include/solarus/lowlevel/SpcDecoder.h
+  include/solarus/lowlevel/StartupProfile.h
   include/solarus/lowlevel/String.h
   include/solarus/lowlevel/Surface.h
   include/solarus/lowlevel/SurfacePtr.h
+  include/solarus/lowlevel/Symbol.h
+  include/solarus/lowlevel/Symbol.inl
   include/solarus/lowlevel/System.h
   include/solarus/lowlevel/TextSurface.h
   include/solarus/lowlevel/Video.h
   include/solarus/lowlevel/VideoMode.h
+  include/solarus/lowlevel/WorkerPool.h
 
   include/solarus/lua/ExportableToLua.h
   include/solarus/lua/ExportableToLuaPtr.h
   include/solarus/lua/LuaContext.h
   include/solarus/lua/LuaData.h
   include/solarus/lua/LuaException.h
+  include/solarus/lua/LuaFfi.h
+  include/solarus/lua/LuaProfiler.h
   include/solarus/lua/LuaTools.h
   include/solarus/lua/LuaTools.inl
   include/solarus/lua/ScopedLuaRef.h
@@ -152,6 +163,7 @@ file(
   include/solarus/movements/JumpMovement.h
   include/solarus/movements/Movement.h
   include/solarus/movements/PathFinding.h
+  include/solarus/movements/PathFindingGraph.h
   include/solarus/movements/PathFindingMovement.h
   include/solarus/movements/PathMovement.h
   include/solarus/movements/PixelMovement.h
@@ -196,9 +208,12 @@ file(
   include/solarus/GameCommand.h
   include/solarus/GameCommands.h
   include/solarus/Game.h
+  include/solarus/GameCheckpoint.h
+  include/solarus/LightMap.h
   include/solarus/MainLoop.h
   include/solarus/Map.h
   include/solarus/MapData.h
+  include/solarus/ParticleEmitter.h
   include/solarus/QuestProperties.h
   include/solarus/QuestResources.h
   include/solarus/ResourceProvider.h
@@ -251,6 +266,7 @@ file(
   src/entities/Jumper.cpp
   src/entities/NonAnimatedRegions.cpp
   src/entities/Npc.cpp
+  src/entities/ParallaxLayers.cpp
   src/entities/ParallaxScrollingTilePattern.cpp
   src/entities/Pickable.cpp
   src/entities/SelfScrollingTilePattern.cpp
@@ -305,6 +321,7 @@ file(
   src/lowlevel/Color.cpp
   src/lowlevel/Debug.cpp
   src/lowlevel/FontResource.cpp
+  src/lowlevel/FrameCapture.cpp
   src/lowlevel/Geometry.cpp
   src/lowlevel/Hq2xFilter.cpp
   src/lowlevel/Hq3xFilter.cpp
@@ -327,14 +344,18 @@ file(
   src/lowlevel/shaders/ShaderContext.cpp
   src/lowlevel/shaders/Shader.cpp
   src/lowlevel/Size.cpp
+  src/lowlevel/SoftwareBlitter.cpp
   src/lowlevel/Sound.cpp
   src/lowlevel/SpcDecoder.cpp
+  src/lowlevel/StartupProfile.cpp
   src/lowlevel/String.cpp
   src/lowlevel/Surface.cpp
+  src/lowlevel/Symbol.cpp
   src/lowlevel/System.cpp
   src/lowlevel/TextSurface.cpp
   src/lowlevel/Video.cpp
   src/lowlevel/VideoMode.cpp
+  src/lowlevel/WorkerPool.cpp
 
   src/lua/AudioApi.cpp
   src/lua/DrawableApi.cpp
@@ -345,14 +366,18 @@ file(
   src/lua/InputApi.cpp
   src/lua/ItemApi.cpp
   src/lua/LanguageApi.cpp
+  src/lua/LightMapApi.cpp
   src/lua/LuaContext.cpp
   src/lua/LuaData.cpp
   src/lua/LuaException.cpp
+  src/lua/LuaFfi.cpp
+  src/lua/LuaProfiler.cpp
   src/lua/LuaTools.cpp
   src/lua/MainApi.cpp
   src/lua/MapApi.cpp
   src/lua/MenuApi.cpp
   src/lua/MovementApi.cpp
+  src/lua/ParticleEmitterApi.cpp
   src/lua/ScopedLuaRef.cpp
   src/lua/SpriteApi.cpp
   src/lua/SurfaceApi.cpp
@@ -365,6 +390,7 @@ file(
   src/movements/JumpMovement.cpp
   src/movements/Movement.cpp
   src/movements/PathFinding.cpp
+  src/movements/PathFindingGraph.cpp
   src/movements/PathFindingMovement.cpp
   src/movements/PathMovement.cpp
   src/movements/PixelMovement.cpp
@@ -389,9 +415,11 @@ file(
   src/EquipmentItemUsage.cpp
   src/GameCommands.cpp
   src/Game.cpp
+  src/LightMap.cpp
   src/MainLoop.cpp
   src/Map.cpp
   src/MapData.cpp
+  src/ParticleEmitter.cpp
   src/QuestProperties.cpp
   src/QuestResources.cpp
   src/ResourceProvider.cpp
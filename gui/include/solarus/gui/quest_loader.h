@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2014-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_GUI_QUEST_LOADER_H
+#define SOLARUS_GUI_QUEST_LOADER_H
+
+#include "solarus/gui/gui_common.h"
+#include "solarus/QuestProperties.h"
+#include <QImage>
+#include <QList>
+#include <QMetaType>
+#include <QObject>
+#include <QThread>
+
+class QMutex;
+
+namespace SolarusGui {
+
+/**
+ * @brief Loads the properties, icons and logo of quests in a background thread.
+ *
+ * Opening a quest and decoding its images can be slow, especially with
+ * quest archives.
+ * Results are also kept in a cache on disk, indexed by the quest path and
+ * its modification date, so that quests don't need to be opened again
+ * the next time.
+ */
+class SOLARUS_GUI_API QuestLoader : public QObject {
+  Q_OBJECT
+
+public:
+
+  /**
+   * @brief Everything loaded from a quest.
+   */
+  struct QuestData {
+    QString path;                 /**< Path to the quest directory. */
+    bool valid = false;           /**< Whether a quest was found there. */
+    Solarus::QuestProperties
+        properties;               /**< All properties from quest.dat. */
+    QList<QImage> icons;          /**< Icon of the quest in each size available. */
+    QImage logo;                  /**< Logo of the quest, or a null image. */
+  };
+
+  explicit QuestLoader(QObject* parent = nullptr);
+  ~QuestLoader();
+
+  void request(const QString& quest_path);
+
+  static QuestData load(const QString& quest_path);
+  static QMutex& get_quest_files_mutex();
+
+signals:
+
+  void quest_loaded(const SolarusGui::QuestLoader::QuestData& quest_data);
+  void load_requested(const QString& quest_path);
+
+private:
+
+  QThread thread;                 /**< The background thread. */
+  QObject* worker;                /**< Object living in the background thread. */
+
+};
+
+}
+
+// Allow to send QuestData between threads.
+Q_DECLARE_METATYPE(SolarusGui::QuestLoader::QuestData)
+
+#endif
@@ -18,6 +18,7 @@
 #define SOLARUS_GUI_QUESTS_MODEL_H
 
 #include "solarus/gui/gui_common.h"
+#include "solarus/gui/quest_loader.h"
 #include "solarus/QuestProperties.h"
 #include <QAbstractListModel>
 #include <QIcon>
@@ -51,6 +52,7 @@ public:
       QPixmap logo;               /**< Logo of the quest (recommended: 200x140). */
       Solarus::QuestProperties
           properties;             /**< All properties from quest.dat. */
+      bool loaded = false;        /**< Whether the data above is loaded yet. */
     };
 
   QuestsModel(QObject* parent = nullptr);
@@ -65,6 +67,7 @@ public:
 
   bool has_quest(const QString& quest_path);
   bool add_quest(const QString& quest_path);
+  void add_quests(const QStringList& quest_paths);
   bool remove_quest(int index);
   QStringList get_paths() const;
 
@@ -81,10 +84,12 @@ public:
 private:
 
   void doSort(QuestSort sort, Qt::SortOrder order = Qt::AscendingOrder);
-  void load_icon(int quest_index) const;
+  void set_quest_data(QuestInfo& info, const QuestLoader::QuestData& quest_data);
+  void quest_loaded(const QuestLoader::QuestData& quest_data);
 
-  mutable std::vector<QuestInfo>
+  std::vector<QuestInfo>
       quests;                   /**< Info of each quest in the list. */
+  QuestLoader loader;           /**< Loads quest data in the background. */
 };
 
 }
@@ -42,6 +42,7 @@ public:
   QStringList get_paths() const;
   bool has_quest(const QString& path);
   bool add_quest(const QString& path);
+  void add_quests(const QStringList& paths);
   bool remove_quest(int index);
 
   Solarus::QuestProperties get_selected_quest_properties() const;
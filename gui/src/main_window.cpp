@@ -56,9 +56,7 @@ MainWindow::MainWindow(QWidget* parent) :
   // Show recent quests.
   Settings settings;
   QStringList quest_paths = settings.value("quests_paths").toStringList();
-  Q_FOREACH (const QString& path, quest_paths) {
-    ui.quests_view->add_quest(path);
-  }
+  ui.quests_view->add_quests(quest_paths);
 
   // Select the last quest played.
   QString last_quest = settings.value("last_quest").toString();
@@ -78,6 +76,8 @@ MainWindow::MainWindow(QWidget* parent) :
   // Make connections.
   connect(ui.quests_view->selectionModel(), SIGNAL(selectionChanged(QItemSelection, QItemSelection)),
           this, SLOT(selected_quest_changed()));
+  connect(ui.quests_view->model(), SIGNAL(dataChanged(QModelIndex, QModelIndex)),
+          this, SLOT(quest_data_changed(QModelIndex, QModelIndex)));
   connect(ui.play_button, SIGNAL(clicked()),
           this, SLOT(on_action_play_quest_triggered()));
   connect(ui.quests_view, SIGNAL(activated(QModelIndex)),
@@ -472,6 +472,19 @@ void MainWindow::update_run_quest() {
   ui.menu_zoom->setEnabled(playing);
 }
 
+/**
+ * @brief Slot called when quests of the list have finished loading.
+ * @param top_left First quest changed.
+ * @param bottom_right Last quest changed.
+ */
+void MainWindow::quest_data_changed(const QModelIndex& top_left, const QModelIndex& bottom_right) {
+
+  const int selected_index = ui.quests_view->get_selected_index();
+  if (selected_index >= top_left.row() && selected_index <= bottom_right.row()) {
+    selected_quest_changed();
+  }
+}
+
 /**
  * @brief Slot called when the selection changes in the quest list.
  */
@@ -0,0 +1,336 @@
+/*
+ * Copyright (C) 2014-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus Quest Editor is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus Quest Editor is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/gui/quest_loader.h"
+#include "solarus/lowlevel/QuestFiles.h"
+#include "solarus/CurrentQuest.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <QStringList>
+#include <algorithm>
+
+namespace SolarusGui {
+
+namespace {
+
+/**
+ * @brief Icon files that a quest may provide.
+ */
+const QStringList icon_file_names = {
+  "logos/icon_16.png",
+  "logos/icon_24.png",
+  "logos/icon_32.png",
+  "logos/icon_48.png",
+  "logos/icon_64.png",
+  "logos/icon_128.png",
+  "logos/icon_256.png",
+  "logos/icon_512.png",
+  "logos/icon_1024.png",
+};
+
+/**
+ * @brief Logo file that a quest may provide.
+ */
+const QString logo_file_name = "logos/logo.png";
+
+/**
+ * @brief Returns the name of the program to give to the quest file layer.
+ * @return The program name.
+ */
+const QString& get_program_name() {
+
+  static const QString program_name = [] {
+    const QStringList& arguments = QCoreApplication::arguments();
+    return arguments.isEmpty() ? QString() : arguments.first();
+  }();
+  return program_name;
+}
+
+/**
+ * @brief Returns the cache directory of a quest.
+ * @param quest_path Path of a quest.
+ * @return The directory where data of this quest are cached.
+ */
+QString get_cache_path(const QString& quest_path) {
+
+  const QByteArray& hash = QCryptographicHash::hash(
+        quest_path.toUtf8(), QCryptographicHash::Md5).toHex();
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+      "/quests/" + QString::fromLatin1(hash);
+}
+
+/**
+ * @brief Returns a string that changes when the quest is modified.
+ *
+ * It is made of the quest path and of the most recent modification date
+ * of the files and directories that contain the quest properties and images.
+ *
+ * @param quest_path Path of a quest.
+ * @return The cache key of the quest in its current state.
+ */
+QString get_cache_key(const QString& quest_path) {
+
+  const QStringList suffixes = {
+    "",
+    "/data",
+    "/data/quest.dat",
+    "/data/logos",
+    "/data.solarus",
+    "/data.solarus.zip",
+  };
+
+  qint64 last_modified = 0;
+  for (const QString& suffix : suffixes) {
+    const QFileInfo info(quest_path + suffix);
+    if (info.exists()) {
+      last_modified = std::max(last_modified, info.lastModified().toMSecsSinceEpoch());
+    }
+  }
+  return quest_path + '\n' + QString::number(last_modified);
+}
+
+/**
+ * @brief Reads a whole file.
+ * @param[in] file_name The file to read.
+ * @param[out] content Its content.
+ * @return @c false if the file could not be read.
+ */
+bool read_file(const QString& file_name, QByteArray& content) {
+
+  QFile file(file_name);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  content = file.readAll();
+  return true;
+}
+
+/**
+ * @brief Writes a whole file.
+ * @param file_name The file to write.
+ * @param content Its content.
+ * @return @c false if the file could not be written.
+ */
+bool write_file(const QString& file_name, const QByteArray& content) {
+
+  QFile file(file_name);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    return false;
+  }
+  return file.write(content) == content.size();
+}
+
+/**
+ * @brief Loads quest data from the cache.
+ * @param[in] cache_key The current cache key of the quest.
+ * @param[in,out] quest_data Where to store the data. Its path must be set.
+ * @return @c true if the cache is up to date and was loaded.
+ */
+bool load_from_cache(const QString& cache_key, QuestLoader::QuestData& quest_data) {
+
+  const QString& cache_path = get_cache_path(quest_data.path);
+
+  QByteArray content;
+  if (!read_file(cache_path + "/key", content) ||
+      QString::fromUtf8(content) != cache_key) {
+    return false;
+  }
+
+  if (!read_file(cache_path + "/quest.dat", content)) {
+    return false;
+  }
+  const std::string buffer(content.constData(), content.size());
+  if (!quest_data.properties.import_from_buffer(buffer, "quest.dat")) {
+    return false;
+  }
+
+  for (const QString& file_name : icon_file_names) {
+    QImage icon;
+    if (icon.load(cache_path + '/' + QFileInfo(file_name).fileName())) {
+      quest_data.icons << icon;
+    }
+  }
+  quest_data.logo.load(cache_path + '/' + QFileInfo(logo_file_name).fileName());
+
+  quest_data.valid = true;
+  return true;
+}
+
+/**
+ * @brief Saves quest files to the cache.
+ * @param cache_key The current cache key of the quest.
+ * @param quest_path Path of the quest.
+ * @param files Content of the files to save, indexed by their file name
+ * in the cache.
+ */
+void save_to_cache(
+    const QString& cache_key,
+    const QString& quest_path,
+    const QMap<QString, QByteArray>& files
+) {
+  const QString& cache_path = get_cache_path(quest_path);
+  QDir cache_dir(cache_path);
+  if (cache_dir.exists()) {
+    cache_dir.removeRecursively();
+  }
+  if (!QDir().mkpath(cache_path)) {
+    return;
+  }
+
+  for (auto it = files.begin(); it != files.end(); ++it) {
+    if (!write_file(cache_path + '/' + it.key(), it.value())) {
+      return;
+    }
+  }
+
+  // Write the key last so that an incomplete cache is never used.
+  write_file(cache_path + "/key", cache_key.toUtf8());
+}
+
+}
+
+/**
+ * @brief Creates a quest loader and starts its background thread.
+ * @param parent Parent object or nullptr.
+ */
+QuestLoader::QuestLoader(QObject* parent) :
+  QObject(parent),
+  thread(),
+  worker(new QObject()) {
+
+  qRegisterMetaType<QuestData>();
+  get_program_name();  // Initialize it from the GUI thread.
+
+  worker->moveToThread(&thread);
+  connect(this, &QuestLoader::load_requested, worker, [this](const QString& quest_path) {
+    emit quest_loaded(load(quest_path));
+  });
+  thread.start(QThread::LowPriority);
+}
+
+/**
+ * @brief Stops the background thread.
+ *
+ * Requests not processed yet are dropped.
+ */
+QuestLoader::~QuestLoader() {
+
+  thread.quit();
+  thread.wait();
+  delete worker;
+}
+
+/**
+ * @brief Asks to load a quest in the background.
+ *
+ * The quest_loaded() signal will be emitted when it is done.
+ *
+ * @param quest_path Path of the quest to load.
+ */
+void QuestLoader::request(const QString& quest_path) {
+
+  emit load_requested(quest_path);
+}
+
+/**
+ * @brief Loads the properties, icons and logo of a quest.
+ *
+ * They come from the cache if it is up to date,
+ * otherwise from the quest itself and the cache is updated.
+ * This function can be called from any thread.
+ *
+ * @param quest_path Path of the quest to load.
+ * @return The quest data. Check its valid field to know if a quest
+ * was found.
+ */
+QuestLoader::QuestData QuestLoader::load(const QString& quest_path) {
+
+  QuestData quest_data;
+  quest_data.path = quest_path;
+
+  const QString& cache_key = get_cache_key(quest_path);
+  if (load_from_cache(cache_key, quest_data)) {
+    return quest_data;
+  }
+
+  // Read the files from the quest.
+  QMap<QString, QByteArray> files;
+  {
+    QMutexLocker locker(&get_quest_files_mutex());
+    if (!Solarus::QuestFiles::open_quest(get_program_name().toStdString(),
+                                         quest_path.toStdString())) {
+      Solarus::QuestFiles::close_quest();
+      return quest_data;
+    }
+    quest_data.properties = Solarus::CurrentQuest::get_properties();
+
+    QStringList image_file_names = icon_file_names;
+    image_file_names << logo_file_name;
+    for (const QString& file_name : image_file_names) {
+      if (Solarus::QuestFiles::data_file_exists(file_name.toStdString())) {
+        const std::string& buffer = Solarus::QuestFiles::data_file_read(file_name.toStdString());
+        files.insert(QFileInfo(file_name).fileName(), QByteArray(buffer.data(), buffer.size()));
+      }
+    }
+    Solarus::QuestFiles::close_quest();
+  }
+  quest_data.valid = true;
+
+  // Decode images outside of the lock.
+  for (const QString& file_name : icon_file_names) {
+    const QByteArray& buffer = files.value(QFileInfo(file_name).fileName());
+    QImage icon;
+    if (!buffer.isEmpty() && icon.loadFromData(buffer)) {
+      quest_data.icons << icon;
+    }
+  }
+  const QByteArray& logo_buffer = files.value(QFileInfo(logo_file_name).fileName());
+  if (!logo_buffer.isEmpty()) {
+    quest_data.logo.loadFromData(logo_buffer);
+  }
+
+  std::string properties_buffer;
+  if (quest_data.properties.export_to_buffer(properties_buffer)) {
+    files.insert("quest.dat", QByteArray(properties_buffer.data(), properties_buffer.size()));
+    save_to_cache(cache_key, quest_path, files);
+  }
+
+  return quest_data;
+}
+
+/**
+ * @brief Returns the mutex that protects the quest file layer.
+ *
+ * Only one quest can be open at a time in the quest file layer,
+ * so any code of the GUI that opens a quest must lock this mutex.
+ *
+ * @return The quest files mutex.
+ */
+QMutex& QuestLoader::get_quest_files_mutex() {
+
+  static QMutex mutex;
+  return mutex;
+}
+
+}
@@ -15,10 +15,7 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "solarus/gui/quests_model.h"
-#include "solarus/lowlevel/QuestFiles.h"
-#include "solarus/CurrentQuest.h"
 #include "solarus/QuestProperties.h"
-#include <QApplication>
 #include <algorithm>
 
 namespace SolarusGui {
@@ -29,8 +26,11 @@ namespace SolarusGui {
  */
 QuestsModel::QuestsModel(QObject* parent) :
   QAbstractListModel(parent),
-  quests() {
+  quests(),
+  loader() {
 
+  connect(&loader, &QuestLoader::quest_loaded,
+          this, &QuestsModel::quest_loaded);
 }
 
 /**
@@ -59,7 +59,6 @@ QVariant QuestsModel::data(const QModelIndex& index, int role) const {
   switch (role) {
 
   case Qt::ItemDataRole::DisplayRole:
-    load_icon(index.row());
     return QVariant::fromValue(quests.at(index.row()));
 
   case Qt::ItemDataRole::ToolTipRole:
@@ -113,6 +112,9 @@ bool QuestsModel::has_quest(const QString& quest_path) {
 
 /**
  * @brief Adds a quest to the model.
+ *
+ * The quest is loaded immediately.
+ *
  * @param quest_path Path of the quest to add.
  * @return @c true if it was added, @c false if there is no such quest
  * or if it is already there.
@@ -123,31 +125,65 @@ bool QuestsModel::add_quest(const QString& quest_path) {
     return false;
   }
 
-  QuestInfo info;
-
-  // Open the quest to get its quest.dat file.
-  QStringList arguments = QApplication::arguments();
-  QString program_name = arguments.isEmpty() ? QString() : arguments.first();
-  if (!Solarus::QuestFiles::open_quest(program_name.toStdString(),
-                                       quest_path.toStdString())) {
-    Solarus::QuestFiles::close_quest();
+  const QuestLoader::QuestData& quest_data = QuestLoader::load(quest_path);
+  if (!quest_data.valid) {
     return false;
   }
-  info.properties = Solarus::CurrentQuest::get_properties();
-  Solarus::QuestFiles::close_quest();
-
-  const int num_quests = rowCount();
-  beginInsertRows(QModelIndex(), num_quests, num_quests);
 
+  QuestInfo info;
   info.path = quest_path;
   info.directory_name = quest_path.section('/', -1, -1, QString::SectionSkipEmpty);
-  quests.push_back(info);
+  set_quest_data(info, quest_data);
 
+  const int num_quests = rowCount();
+  beginInsertRows(QModelIndex(), num_quests, num_quests);
+  quests.push_back(info);
   endInsertRows();
 
   return true;
 }
 
+/**
+ * @brief Adds several quests to the model without waiting for them to load.
+ *
+ * Quests are shown with a default icon and logo until their data is loaded
+ * in the background.
+ * Paths that turn out not to contain a quest are removed from the model
+ * at that time.
+ *
+ * @param quest_paths Paths of the quests to add.
+ */
+void QuestsModel::add_quests(const QStringList& quest_paths) {
+
+  std::vector<QuestInfo> new_quests;
+  for (const QString& quest_path : quest_paths) {
+    if (has_quest(quest_path)) {
+      continue;
+    }
+
+    QuestInfo info;
+    info.path = quest_path;
+    info.directory_name = quest_path.section('/', -1, -1, QString::SectionSkipEmpty);
+    info.icon = get_quest_default_icon();
+    info.logo = get_quest_default_logo();
+    info.properties.set_title(info.directory_name.toStdString());
+    new_quests.push_back(info);
+  }
+
+  if (new_quests.empty()) {
+    return;
+  }
+
+  const int num_quests = rowCount();
+  beginInsertRows(QModelIndex(), num_quests, num_quests + (int) new_quests.size() - 1);
+  quests.insert(quests.end(), new_quests.begin(), new_quests.end());
+  endInsertRows();
+
+  for (const QuestInfo& info : new_quests) {
+    loader.request(info.path);
+  }
+}
+
 /**
  * @brief Removes a quest from this model.
  * @param quest_index Index of the quest to remove.
@@ -215,28 +251,7 @@ const QPixmap& QuestsModel::get_quest_logo(int quest_index) const {
     return get_quest_default_logo();
   }
 
-  QuestInfo& quest = quests[quest_index];
-  if (quest.logo.isNull()) {
-    // Lazily load the logo.
-    quest.logo = get_quest_default_logo();
-
-    QStringList arguments = QApplication::arguments();
-    QString program_name = arguments.isEmpty() ? QString() : arguments.first();
-    if (Solarus::QuestFiles::open_quest(program_name.toStdString(),
-                                        quest.path.toStdString())) {
-      std::string file_name = "logos/logo.png";
-      if (Solarus::QuestFiles::data_file_exists(file_name)) {
-        std::string buffer = Solarus::QuestFiles::data_file_read(file_name);
-        QPixmap pixmap;
-        if (pixmap.loadFromData((const uchar*) buffer.data(), (uint) buffer.size())) {
-          quests[quest_index].logo = pixmap;
-        }
-      }
-    }
-    Solarus::QuestFiles::close_quest();
-  }
-
-  return quest.logo;
+  return quests[quest_index].logo;
 }
 
 /**
@@ -251,57 +266,52 @@ const QIcon& QuestsModel::get_quest_default_icon() const {
 }
 
 /**
- * @brief Loads the icon of the given quest.
- * @param quest_index Index of a quest.
+ * @brief Fills the info of a quest from data loaded by the quest loader.
+ * @param info The quest info to fill.
+ * @param quest_data The loaded data.
  */
-void QuestsModel::load_icon(int quest_index) const {
+void QuestsModel::set_quest_data(QuestInfo& info, const QuestLoader::QuestData& quest_data) {
 
-  if (quest_index < 0 || quest_index > rowCount()) {
-    return;
+  info.properties = quest_data.properties;
+
+  info.icon = QIcon();
+  for (const QImage& image : quest_data.icons) {
+    info.icon.addPixmap(QPixmap::fromImage(image));
+  }
+  if (info.icon.isNull()) {
+    info.icon = get_quest_default_icon();
   }
 
-  QuestInfo& quest = quests[quest_index];
-  QIcon& icon = quest.icon;
-  if (!icon.isNull()) {
-    // Already loaded.
-    return;
+  if (!quest_data.logo.isNull()) {
+    info.logo = QPixmap::fromImage(quest_data.logo);
+  }
+  else {
+    info.logo = get_quest_default_logo();
   }
 
-  QStringList arguments = QApplication::arguments();
-  QString program_name = arguments.isEmpty() ? QString() : arguments.first();
-  if (!Solarus::QuestFiles::open_quest(program_name.toStdString(),
-                                       quest.path.toStdString())) {
-    Solarus::QuestFiles::close_quest();
-    icon = get_quest_default_icon();
+  info.loaded = true;
+}
+
+/**
+ * @brief Slot called when the quest loader has finished loading a quest.
+ * @param quest_data The loaded data.
+ */
+void QuestsModel::quest_loaded(const QuestLoader::QuestData& quest_data) {
+
+  const int quest_index = path_to_index(quest_data.path);
+  if (quest_index == -1) {
+    // Removed in the meantime.
     return;
   }
 
-  QStringList file_names = {
-    "logos/icon_16.png",
-    "logos/icon_24.png",
-    "logos/icon_32.png",
-    "logos/icon_48.png",
-    "logos/icon_64.png",
-    "logos/icon_128.png",
-    "logos/icon_256.png",
-    "logos/icon_512.png",
-    "logos/icon_1024.png",
-  };
-  for (const QString& file_name : file_names) {
-    if (Solarus::QuestFiles::data_file_exists(file_name.toStdString())) {
-      std::string buffer = Solarus::QuestFiles::data_file_read(file_name.toStdString());
-      QPixmap pixmap;
-      if (!pixmap.loadFromData((const uchar*) buffer.data(), (uint) buffer.size())) {
-        continue;
-      }
-      icon.addPixmap(pixmap);
-    }
+  if (!quest_data.valid) {
+    remove_quest(quest_index);
+    return;
   }
-  Solarus::QuestFiles::close_quest();
 
-  if (icon.isNull()) {
-    icon = get_quest_default_icon();
-  }
+  set_quest_data(quests[quest_index], quest_data);
+  const QModelIndex& model_index = index(quest_index);
+  emit dataChanged(model_index, model_index);
 }
 
 /**
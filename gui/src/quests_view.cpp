@@ -93,6 +93,18 @@ bool QuestsView::add_quest(const QString& path) {
   return model->add_quest(path);
 }
 
+/**
+ * @brief Adds several quests to the model of this view.
+ *
+ * They are loaded in the background.
+ *
+ * @param paths Paths of the quests to add.
+ */
+void QuestsView::add_quests(const QStringList& paths) {
+
+  model->add_quests(paths);
+}
+
 /**
  * @brief Removes a quest from the model of this view.
  * @param index Index of the quest to remove.
@@ -15,9 +15,11 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "solarus/gui/settings.h"
+#include "solarus/gui/quest_loader.h"
 #include "solarus/lowlevel/QuestFiles.h"
 #include "solarus/Settings.h"
 #include <QApplication>
+#include <QMutexLocker>
 
 namespace SolarusGui {
 
@@ -41,6 +43,9 @@ Settings::Settings(Scope scope) :
  */
 void Settings::export_to_quest(const QString& quest_path) const {
 
+  // Quests may be loading in the background.
+  QMutexLocker locker(&QuestLoader::get_quest_files_mutex());
+
   if (Solarus::QuestFiles::is_open()) {
     Solarus::QuestFiles::close_quest();
   }
@@ -18,13 +18,13 @@
 #define SOLARUS_DIALOG_BOX_SYSTEM_H
 
 #include "solarus/Common.h"
+#include "solarus/lowlevel/IntrusivePtr.h"
 #include "solarus/lowlevel/Point.h"
 #include "solarus/lowlevel/SurfacePtr.h"
 #include "solarus/lua/ScopedLuaRef.h"
 #include "solarus/Dialog.h"
 #include "solarus/GameCommand.h"
 #include <list>
-#include <memory>
 #include <string>
 
 namespace Solarus {
@@ -73,7 +73,7 @@ class DialogBoxSystem {
     bool built_in;                                  /**< Whether we are using the built-in dialog box. */
     static constexpr int nb_visible_lines = 3;      /**< Maximum number of visible lines. */
     std::list<std::string> remaining_lines;         /**< Text of each line still to be displayed. */
-    std::shared_ptr<TextSurface>
+    IntrusivePtr<TextSurface>
         line_surfaces[nb_visible_lines];            /**< Text surface of each visible line. */
     Point text_position;                            /**< Destination position of the first line. */
     bool is_question;                               /**< Whether the dialog is a question with two possible answers. */
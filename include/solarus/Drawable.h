@@ -19,6 +19,7 @@
 
 #include "solarus/Common.h"
 #include "solarus/lowlevel/BlendMode.h"
+#include "solarus/lowlevel/IntrusivePtr.h"
 #include "solarus/lowlevel/Point.h"
 #include "solarus/lowlevel/Size.h"
 #include "solarus/lowlevel/SurfacePtr.h"
@@ -53,9 +54,9 @@ class Drawable: public ExportableToLua {
     virtual Size get_size() const = 0;
 
     // dynamic effects
-    void start_movement(const std::shared_ptr<Movement>& movement);
+    void start_movement(const IntrusivePtr<Movement>& movement);
     void stop_movement();
-    const std::shared_ptr<Movement>& get_movement();
+    const IntrusivePtr<Movement>& get_movement();
     const Point& get_xy() const;
     void set_xy(const Point& xy);
 
@@ -140,7 +141,7 @@ class Drawable: public ExportableToLua {
 
     Point xy;                     /**< Current position of this object
                                    * (result of movements). */
-    std::shared_ptr<Movement>
+    IntrusivePtr<Movement>
         movement;                 /**< A movement applied or nullptr. */
     std::unique_ptr<Transition>
         transition;               /**< A transition applied or nullptr. */
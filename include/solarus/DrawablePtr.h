@@ -17,16 +17,16 @@
 #ifndef SOLARUS_DRAWABLE_PTR_H
 #define SOLARUS_DRAWABLE_PTR_H
 
-#include <memory>
+#include "solarus/lowlevel/IntrusivePtr.h"
 
 namespace Solarus {
 
 class Drawable;
 
 /**
- * \brief Alias for shared_ptr of Drawable.
+ * \brief Alias for IntrusivePtr of Drawable.
  */
-using DrawablePtr = std::shared_ptr<Drawable>;
+using DrawablePtr = IntrusivePtr<Drawable>;
 
 }
 
@@ -19,8 +19,9 @@
 
 #include "solarus/Common.h"
 #include "solarus/Ability.h"
+#include "solarus/lowlevel/IntrusivePtr.h"
+#include "solarus/lowlevel/Symbol.h"
 #include <map>
-#include <memory>
 #include <string>
 
 struct lua_State;
@@ -108,10 +109,10 @@ class SOLARUS_API Equipment {
     bool suspended;                              /**< Indicates that the game is suspended. */
 
     // items
-    std::map<std::string, std::shared_ptr<EquipmentItem>>
+    std::map<std::string, IntrusivePtr<EquipmentItem>>
         items;                                   /**< Each item (properties loaded from item scripts). */
 
-    std::string get_ability_savegame_variable(Ability ability) const;
+    const Symbol& get_ability_savegame_variable(Ability ability) const;
 
 };
 
@@ -19,6 +19,7 @@
 
 #include "solarus/Common.h"
 #include "solarus/entities/HeroPtr.h"
+#include "solarus/lowlevel/IntrusivePtr.h"
 #include "solarus/lowlevel/Point.h"
 #include "solarus/lowlevel/SurfacePtr.h"
 #include "solarus/CommandsEffects.h"
@@ -26,7 +27,9 @@
 #include "solarus/GameCommand.h"
 #include "solarus/Transition.h"
 #include "solarus/GameCommands.h"
+#include "solarus/GameCheckpoint.h"
 #include "solarus/entities/NonAnimatedRegions.h"
+#include <map>
 #include <memory>
 #include <string>
 
@@ -52,7 +55,7 @@ class SOLARUS_API Game {
   public:
 
     // creation
-    Game(MainLoop& main_loop, const std::shared_ptr<Savegame>& savegame);
+    Game(MainLoop& main_loop, const IntrusivePtr<Savegame>& savegame);
 
     // no copy operations
     Game(const Game& game) = delete;
@@ -129,11 +132,19 @@ class SOLARUS_API Game {
     // Suspend manually.
     void set_suspended_by_script(bool suspended);
 
+    // checkpoints
+    GameCheckpoint create_checkpoint();
+    bool restore_checkpoint(const GameCheckpoint& checkpoint);
+    bool has_checkpoint(const std::string& name) const;
+    void save_checkpoint(const std::string& name);
+    bool restore_checkpoint(const std::string& name);
+    void remove_checkpoint(const std::string& name);
+
 private:
 
     // main objects
     MainLoop& main_loop;       /**< the main loop object */
-    std::shared_ptr<Savegame>
+    IntrusivePtr<Savegame>
         savegame;              /**< the game data saved */
     HeroPtr hero;              /**< The hero entity.  */
 
@@ -155,9 +166,9 @@ private:
                                 * (represented on the HUD by the action icon, the objects icons, etc.) */
 
     // map
-    std::shared_ptr<Map>
+    IntrusivePtr<Map>
         current_map;           /**< the map currently displayed */
-    std::shared_ptr<Map>
+    IntrusivePtr<Map>
         next_map;              /**< the map where the hero is going to; if not nullptr, it means that the hero
                                 * is changing from current_map to next_map */
     SurfacePtr
@@ -171,6 +182,12 @@ private:
     // world (i.e. the current set of maps)
     bool crystal_state;        /**< indicates that a crystal has been enabled (i.e. the orange blocks are raised) */
 
+    // checkpoints
+    std::map<std::string, GameCheckpoint>
+        checkpoints;           /**< Checkpoints saved by name from scripts. */
+    std::unique_ptr<GameCheckpoint>
+        checkpoint_to_restore; /**< Checkpoint to apply when the next map starts, if any. */
+
     // update functions
     void update_commands_effects();
     void update_transitions();
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_GAME_CHECKPOINT_H
+#define SOLARUS_GAME_CHECKPOINT_H
+
+#include "solarus/Common.h"
+#include "solarus/lowlevel/Point.h"
+#include "solarus/lua/ScopedLuaRef.h"
+#include "solarus/MapData.h"
+#include "solarus/Savegame.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Solarus {
+
+/**
+ * \brief A point where the game can restart its current map from.
+ *
+ * A checkpoint is created with Game::create_checkpoint() and restored with
+ * Game::restore_checkpoint().
+ * Restoring is much faster than saving and loading the savegame because
+ * nothing goes through files and the game is not restarted.
+ *
+ * This is not a full copy of the state of the game.
+ * When restoring, the map of the checkpoint is started again from its data,
+ * so map and entity scripts run again.
+ * Entities whose state is stored in savegame values (treasures, enemies,
+ * doors...) get back the state they had.
+ * Then the hero gets back its position and direction, named entities
+ * get back their position, layer and enabled state, and the ones removed
+ * before the checkpoint are removed again.
+ *
+ * Hero states other than the position, movements, timers and entities
+ * created by scripts are not captured: they restart as in the initial state
+ * of the map.
+ * Scripts can capture additional state with the
+ * game:on_checkpoint_saving() and game:on_checkpoint_restored() events.
+ */
+struct GameCheckpoint {
+
+  /**
+   * \brief State of a named entity of the map.
+   */
+  struct EntityCheckpoint {
+    std::string name;           /**< Name of the entity on the map. */
+    bool removed = false;       /**< Whether the entity was removed from the map. */
+    Point xy;                   /**< Position of the entity. */
+    int layer = 0;              /**< Layer of the entity. */
+    bool enabled = true;        /**< Whether the entity is enabled. */
+  };
+
+  Savegame::SavedValues
+      saved_values;             /**< All savegame values, including the equipment. */
+  bool crystal_state = false;   /**< State of crystal blocks. */
+  std::string map_id;           /**< Id of the current map. */
+  std::shared_ptr<const MapData>
+      map_data;                 /**< Data of the current map, to avoid reading it again. */
+  Point hero_xy;                /**< Position of the hero on the map. */
+  int hero_layer = 0;           /**< Layer of the hero on the map. */
+  int hero_direction = 0;       /**< Direction of the hero's sprites (0 to 3). */
+  std::vector<EntityCheckpoint>
+      entities;                 /**< State of the named entities of the map. */
+  ScopedLuaRef script_data;     /**< Value returned by game:on_checkpoint_saving() if any. */
+};
+
+}
+
+#endif
@@ -19,6 +19,7 @@
 
 #include "solarus/Common.h"
 #include "solarus/lowlevel/InputEvent.h"
+#include "solarus/lowlevel/Symbol.h"
 #include "solarus/lua/ScopedLuaRef.h"
 #include "solarus/GameCommand.h"
 #include <map>
@@ -79,7 +80,7 @@ class GameCommands {
     // Keyboard mapping.
     void keyboard_key_pressed(InputEvent::KeyboardKey keyboard_key_pressed);
     void keyboard_key_released(InputEvent::KeyboardKey keyboard_key_released);
-    const std::string& get_keyboard_binding_savegame_variable(GameCommand command) const;
+    const Symbol& get_keyboard_binding_savegame_variable(GameCommand command) const;
     InputEvent::KeyboardKey get_saved_keyboard_binding(GameCommand command) const;
     void set_saved_keyboard_binding(GameCommand command, InputEvent::KeyboardKey key);
     GameCommand get_command_from_keyboard(InputEvent::KeyboardKey key) const;
@@ -89,7 +90,7 @@ class GameCommands {
     void joypad_button_released(int button);
     void joypad_axis_moved(int axis, int direction);
     void joypad_hat_moved(int hat, int direction);
-    const std::string& get_joypad_binding_savegame_variable(GameCommand command) const;
+    const Symbol& get_joypad_binding_savegame_variable(GameCommand command) const;
     std::string get_saved_joypad_binding(GameCommand command) const;
     void set_saved_joypad_binding(GameCommand command, const std::string& joypad_string);
     GameCommand get_command_from_joypad(const std::string& joypad_string) const;
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_LIGHT_MAP_H
+#define SOLARUS_LIGHT_MAP_H
+
+#include "solarus/Common.h"
+#include "solarus/entities/EntityPtr.h"
+#include "solarus/lowlevel/Color.h"
+#include "solarus/lowlevel/IntrusivePtr.h"
+#include "solarus/lowlevel/Point.h"
+#include "solarus/lowlevel/Size.h"
+#include "solarus/lowlevel/SurfacePtr.h"
+#include "solarus/Drawable.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace Solarus {
+
+/**
+ * \brief A drawable that darkens what is below it except around lights.
+ *
+ * The light map is computed at a reduced resolution: it is filled with an
+ * ambient color, then each light adds its shape with additive blending.
+ * The result is enlarged and multiplied onto the destination in a single
+ * pass, so dark areas become darker and lit areas keep their colors.
+ *
+ * Light shapes only depend on their radius, color and falloff: they are
+ * computed once and cached.
+ * A light is either at a fixed position or follows the center of an entity.
+ * Positions are in map coordinates: the view position tells which point of
+ * the map is at the top-left corner of the light map, usually the camera
+ * position.
+ */
+class SOLARUS_API LightMap: public Drawable {
+
+  public:
+
+    static constexpr int max_scale = 16;  /**< Maximum resolution reduction factor. */
+
+    LightMap(const Size& size, int scale);
+
+    int get_scale() const;
+    const Color& get_ambient_color() const;
+    void set_ambient_color(const Color& ambient_color);
+    const Point& get_view_position() const;
+    void set_view_position(const Point& view_position);
+
+    int add_light(const Point& xy, int radius, const Color& color, double falloff);
+    int add_light(const EntityPtr& entity, int radius, const Color& color, double falloff);
+    bool has_light(int light_id) const;
+    bool set_light_position(int light_id, const Point& xy);
+    bool remove_light(int light_id);
+    void clear_lights();
+    int get_num_lights() const;
+
+    // Drawable.
+    virtual Size get_size() const override;
+    virtual void raw_draw(
+        Surface& dst_surface,
+        const Point& dst_position
+    ) override;
+    virtual void raw_draw_region(
+        const Rectangle& region,
+        Surface& dst_surface,
+        const Point& dst_position
+    ) override;
+    virtual void draw_transition(Transition& transition) override;
+    virtual Surface& get_transition_surface() override;
+
+    virtual const std::string& get_lua_type_name() const override;
+
+  private:
+
+    /**
+     * \brief A light source.
+     */
+    struct Light {
+      int id;                             /**< Id of the light in this light map. */
+      Point xy;                           /**< Map coordinates, or offset from the entity. */
+      IntrusiveWeakPtr<Entity> entity;       /**< Entity followed if any. */
+      bool follows_entity;                /**< Whether the light is attached to an entity. */
+      int radius;                         /**< Radius in pixels. */
+      Color color;                        /**< Color at the center. */
+      double falloff;                     /**< Exponent of the intensity decrease. */
+    };
+
+    /**
+     * \brief Identifies a cached light shape: radius in light map pixels,
+     * color and falloff in hundredths.
+     */
+    using ShapeKey = std::tuple<int, uint32_t, int>;
+
+    static constexpr int max_cached_shapes = 64;  /**< Shapes kept in the cache. */
+
+    const SurfacePtr& get_shape(int radius, const Color& color, double falloff);
+    void render();
+    void draw_lights_region(
+        const Rectangle& region,
+        Surface& dst_surface,
+        const Point& dst_position
+    );
+
+    Size size;                            /**< Size of the light map in pixels. */
+    int scale;                            /**< Resolution reduction factor. */
+    Color ambient_color;                  /**< Light where there is no light source. */
+    Point view_position;                  /**< Map coordinates of the top-left corner. */
+    std::vector<Light> lights;            /**< Light sources. */
+    int next_light_id;                    /**< Id of the next light added. */
+    SurfacePtr light_surface;             /**< Lights at the reduced resolution. */
+    SurfacePtr enlarged_surface;          /**< Lights at the full resolution, only used
+                                           * when drawing on a GPU surface. */
+    std::map<ShapeKey, SurfacePtr>
+        shapes;                           /**< Cached light shapes. */
+
+};
+
+}
+
+#endif
@@ -28,8 +28,13 @@
 #include "solarus/lowlevel/Rectangle.h"
 #include "solarus/lowlevel/SurfacePtr.h"
 #include "solarus/lua/ExportableToLua.h"
+#include "solarus/movements/PathFindingGraph.h"
 #include "solarus/MapData.h"
 #include "solarus/Transition.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
 
 namespace Solarus {
 
@@ -87,6 +92,8 @@ class SOLARUS_API Map: public ExportableToLua {
     // loading
     bool is_loaded() const;
     void load(Game& game);
+    void load(Game& game, const std::shared_ptr<const MapData>& data);
+    const std::shared_ptr<const MapData>& get_data() const;
     void unload();
     Game& get_game();
     LuaContext& get_lua_context();
@@ -145,6 +152,19 @@ class SOLARUS_API Map: public ExportableToLua {
         int layer,
         const Rectangle& collision_box
     ) const;
+    bool raycast(
+        int layer,
+        const Point& source,
+        const Point& target,
+        Entity& entity_to_check,
+        Point& hit_point,
+        EntityPtr& hit_entity
+    );
+    void get_entities_on_segment(
+        const Point& source,
+        const Point& target,
+        EntityVector& result
+    );
 
     Ground get_ground(
         int layer,
@@ -159,6 +179,9 @@ class SOLARUS_API Map: public ExportableToLua {
     ) const;
     Ground get_ground_from_entity(const Entity& entity, int x, int y) const;
     Ground get_ground_from_entity(const Entity& entity, const Point& xy) const;
+    uint32_t get_ground_revision() const;
+    void notify_ground_changed();
+    PathFindingGraph& get_path_finding_graph(int layer, uint32_t ground_obstacles);
 
     // collisions with detectors (checked after a move)
     void check_collision_with_detectors(Entity& entity);
@@ -180,6 +203,13 @@ class SOLARUS_API Map: public ExportableToLua {
   private:
 
     void set_suspended(bool suspended);
+    bool is_ground_obstacle(
+        Ground ground,
+        int x,
+        int y,
+        const Entity& entity_to_check,
+        bool& found_diagonal_wall
+    ) const;
     void build_background_surface();
     void build_foreground_surface();
     void draw_background(const SurfacePtr& dst_surface);
@@ -218,6 +248,8 @@ class SOLARUS_API Map: public ExportableToLua {
         foreground_surface;       /**< A surface with black bars when the map is smaller than the screen. */
 
     // map state
+    std::shared_ptr<const MapData>
+        data;                     /**< The data this map was loaded from. */
     bool loaded;                  /**< Whether the loading phase is done. */
     bool started;                 /**< Whether this map is the current map. */
     std::string destination_name; /**< Current destination point on the map,
@@ -229,6 +261,11 @@ class SOLARUS_API Map: public ExportableToLua {
     std::unique_ptr<Entities>
         entities;                 /**< The entities on the map. */
     bool suspended;               /**< Whether the game is suspended. */
+    uint32_t ground_revision;     /**< Incremented whenever a dynamic entity may
+                                   * have changed the ground somewhere. */
+    std::map<std::pair<int, uint32_t>, std::unique_ptr<PathFindingGraph>>
+        path_finding_graphs;      /**< Graphs for long paths, created on demand
+                                   * for each layer and set of ground obstacles. */
 };
 
 /**
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_PARTICLE_EMITTER_H
+#define SOLARUS_PARTICLE_EMITTER_H
+
+#include "solarus/Common.h"
+#include "solarus/lowlevel/Size.h"
+#include "solarus/lowlevel/SurfacePtr.h"
+#include "solarus/Drawable.h"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Solarus {
+
+/**
+ * \brief A drawable that simulates and draws lots of small particles.
+ *
+ * Particles are emitted from a rectangular area centered on the origin of
+ * the emitter, move with a random initial velocity and a constant gravity
+ * and disappear after their lifetime.
+ * Each particle shows a frame of a sprite sheet: frames are the cells of
+ * a grid in the sheet, in reading order.
+ *
+ * Particles are not entities: there is no Lua, no movement and no collision
+ * for individual particles.
+ * Their state is stored as one array per field so that the simulation
+ * loops run over contiguous numbers and can be vectorized by the compiler.
+ */
+class SOLARUS_API ParticleEmitter: public Drawable {
+
+  public:
+
+    ParticleEmitter(const SurfacePtr& sheet, const Size& frame_size, int max_particles);
+
+    const SurfacePtr& get_sheet() const;
+    const Size& get_frame_size() const;
+    int get_num_frames() const;
+    uint32_t get_frame_delay() const;
+    void set_frame_delay(uint32_t frame_delay);
+
+    int get_max_particles() const;
+    int get_num_particles() const;
+
+    bool is_emitting() const;
+    void set_emitting(bool emitting);
+    double get_emission_rate() const;
+    void set_emission_rate(double emission_rate);
+    const Size& get_emission_size() const;
+    void set_emission_size(const Size& emission_size);
+
+    void get_lifetime(uint32_t& min_lifetime, uint32_t& max_lifetime) const;
+    void set_lifetime(uint32_t min_lifetime, uint32_t max_lifetime);
+    void get_speed(double& min_speed, double& max_speed) const;
+    void set_speed(double min_speed, double max_speed);
+    void get_angle(double& angle, double& spread) const;
+    void set_angle(double angle, double spread);
+    void get_gravity(double& x, double& y) const;
+    void set_gravity(double x, double y);
+
+    void emit(int count);
+    void clear();
+
+    // Drawable.
+    virtual Size get_size() const override;
+    virtual void update() override;
+    virtual void raw_draw(
+        Surface& dst_surface,
+        const Point& dst_position
+    ) override;
+    virtual void raw_draw_region(
+        const Rectangle& region,
+        Surface& dst_surface,
+        const Point& dst_position
+    ) override;
+    virtual void draw_transition(Transition& transition) override;
+    virtual Surface& get_transition_surface() override;
+
+    virtual const std::string& get_lua_type_name() const override;
+
+  private:
+
+    float get_random(float min, float max);
+    void remove_dead_particles();
+
+    // Configuration.
+    SurfacePtr sheet;                   /**< Image with the frames of particles,
+                                         * possibly shared with the caller. */
+    SurfacePtr transition_surface;      /**< Receives the opacity of transitions
+                                         * instead of the shared sheet. */
+    Size frame_size;                    /**< Size of a frame in the sheet. */
+    int num_columns;                    /**< Number of frames in a row of the sheet. */
+    int num_frames;                     /**< Total number of frames in the sheet. */
+    uint32_t frame_delay;               /**< Delay between frames in milliseconds,
+                                         * or 0 to show all frames over the lifetime. */
+    int max_particles;                  /**< Maximum number of particles alive. */
+    bool emitting;                      /**< Whether particles are continuously emitted. */
+    double emission_rate;               /**< Particles emitted per second. */
+    double emission_debt;               /**< Fraction of particle not emitted yet. */
+    Size emission_size;                 /**< Size of the emission area. */
+    uint32_t min_lifetime;              /**< Minimum lifetime of a particle in milliseconds. */
+    uint32_t max_lifetime;              /**< Maximum lifetime of a particle in milliseconds. */
+    double min_speed;                   /**< Minimum initial speed in pixels per second. */
+    double max_speed;                   /**< Maximum initial speed in pixels per second. */
+    double angle;                       /**< Mean direction of emission in radians. */
+    double spread;                      /**< Maximum deviation from the angle in radians. */
+    double gravity_x;                   /**< Horizontal acceleration in pixels per second squared. */
+    double gravity_y;                   /**< Vertical acceleration in pixels per second squared. */
+    std::minstd_rand random_engine;     /**< Random numbers of this emitter. */
+
+    // Particles, one array per field.
+    std::vector<float> xs;              /**< X coordinate of each particle. */
+    std::vector<float> ys;              /**< Y coordinate of each particle. */
+    std::vector<float> speeds_x;        /**< Horizontal speed of each particle in pixels per second. */
+    std::vector<float> speeds_y;        /**< Vertical speed of each particle in pixels per second. */
+    std::vector<float> ages;            /**< Age of each particle in milliseconds. */
+    std::vector<float> lifetimes;       /**< Lifetime of each particle in milliseconds. */
+    std::vector<int> frames;            /**< Current frame of each particle. */
+
+};
+
+}
+
+#endif
@@ -71,6 +71,12 @@ class SOLARUS_API QuestProperties : public LuaData {
     void set_min_quest_size(const Size& min_quest_size);
     Size get_max_quest_size() const;
     void set_max_quest_size(const Size& max_quest_size);
+    int get_max_sound_voices() const;
+    void set_max_sound_voices(int max_sound_voices);
+    int get_max_voices_per_sound() const;
+    void set_max_voices_per_sound(int max_voices_per_sound);
+    bool get_louder_coalesced_sounds() const;
+    void set_louder_coalesced_sounds(bool louder_coalesced_sounds);
 
   private:
 
@@ -90,6 +96,13 @@ class SOLARUS_API QuestProperties : public LuaData {
     Size normal_quest_size;            /**< Default quest size. */
     Size min_quest_size;               /**< Minimum quest size. */
     Size max_quest_size;               /**< Maximum quest size. */
+    int max_sound_voices;              /**< Maximum number of sounds playing
+                                        * at the same time (0 means no limit). */
+    int max_voices_per_sound;          /**< Maximum number of instances of the
+                                        * same sound playing at the same time
+                                        * (0 means no limit). */
+    bool louder_coalesced_sounds;      /**< Whether a sound played several times
+                                        * in the same tick becomes louder. */
 
 };
 
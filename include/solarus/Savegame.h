@@ -19,9 +19,10 @@
 
 #include "solarus/Common.h"
 #include "solarus/Equipment.h"
+#include "solarus/lowlevel/Symbol.h"
 #include "solarus/lua/ExportableToLua.h"
-#include <map>
 #include <string>
+#include <unordered_map>
 
 struct lua_State;
 
@@ -39,48 +40,65 @@ class SOLARUS_API Savegame: public ExportableToLua {
 
   public:
 
+    /**
+     * \brief A value stored in the savegame.
+     */
+    struct SavedValue {
+
+      enum {
+        VALUE_STRING,
+        VALUE_INTEGER,
+        VALUE_BOOLEAN
+      } type;
+
+      std::string string_data;
+      int int_data;  // Also used for boolean
+    };
+
+    using SavedValues = std::unordered_map<Symbol, SavedValue>;
+
     static const int SAVEGAME_VERSION;  /**< Version number of the savegame file format. */
 
     // Keys to built-in values saved.
-    static const std::string KEY_SAVEGAME_VERSION;
-    static const std::string KEY_STARTING_MAP;
-    static const std::string KEY_STARTING_POINT;
-    static const std::string KEY_KEYBOARD_ACTION;
-    static const std::string KEY_KEYBOARD_ATTACK;
-    static const std::string KEY_KEYBOARD_ITEM_1;
-    static const std::string KEY_KEYBOARD_ITEM_2;
-    static const std::string KEY_KEYBOARD_PAUSE;
-    static const std::string KEY_KEYBOARD_RIGHT;
-    static const std::string KEY_KEYBOARD_UP;
-    static const std::string KEY_KEYBOARD_LEFT;
-    static const std::string KEY_KEYBOARD_DOWN;
-    static const std::string KEY_JOYPAD_ACTION;
-    static const std::string KEY_JOYPAD_ATTACK;
-    static const std::string KEY_JOYPAD_ITEM_1;
-    static const std::string KEY_JOYPAD_ITEM_2;
-    static const std::string KEY_JOYPAD_PAUSE;
-    static const std::string KEY_JOYPAD_RIGHT;
-    static const std::string KEY_JOYPAD_UP;
-    static const std::string KEY_JOYPAD_LEFT;
-    static const std::string KEY_JOYPAD_DOWN;
-    static const std::string KEY_CURRENT_LIFE;
-    static const std::string KEY_CURRENT_MONEY;
-    static const std::string KEY_CURRENT_MAGIC;
-    static const std::string KEY_MAX_LIFE;
-    static const std::string KEY_MAX_MONEY;
-    static const std::string KEY_MAX_MAGIC;
-    static const std::string KEY_ITEM_SLOT_1;
-    static const std::string KEY_ITEM_SLOT_2;
-    static const std::string KEY_ABILITY_TUNIC;
-    static const std::string KEY_ABILITY_SWORD;
-    static const std::string KEY_ABILITY_SWORD_KNOWLEDGE;
-    static const std::string KEY_ABILITY_SHIELD;
-    static const std::string KEY_ABILITY_LIFT;
-    static const std::string KEY_ABILITY_SWIM;
-    static const std::string KEY_ABILITY_JUMP_OVER_WATER;
-    static const std::string KEY_ABILITY_RUN;
-    static const std::string KEY_ABILITY_DETECT_WEAK_WALLS;
-    static const std::string KEY_ABILITY_GET_BACK_FROM_DEATH;
+    static const Symbol KEY_SAVEGAME_VERSION;
+    static const Symbol KEY_STARTING_MAP;
+    static const Symbol KEY_STARTING_POINT;
+    static const Symbol KEY_KEYBOARD_ACTION;
+    static const Symbol KEY_KEYBOARD_ATTACK;
+    static const Symbol KEY_KEYBOARD_ITEM_1;
+    static const Symbol KEY_KEYBOARD_ITEM_2;
+    static const Symbol KEY_KEYBOARD_PAUSE;
+    static const Symbol KEY_KEYBOARD_RIGHT;
+    static const Symbol KEY_KEYBOARD_UP;
+    static const Symbol KEY_KEYBOARD_LEFT;
+    static const Symbol KEY_KEYBOARD_DOWN;
+    static const Symbol KEY_JOYPAD_ACTION;
+    static const Symbol KEY_JOYPAD_ATTACK;
+    static const Symbol KEY_JOYPAD_ITEM_1;
+    static const Symbol KEY_JOYPAD_ITEM_2;
+    static const Symbol KEY_JOYPAD_PAUSE;
+    static const Symbol KEY_JOYPAD_RIGHT;
+    static const Symbol KEY_JOYPAD_UP;
+    static const Symbol KEY_JOYPAD_LEFT;
+    static const Symbol KEY_JOYPAD_DOWN;
+    static const Symbol KEY_CURRENT_LIFE;
+    static const Symbol KEY_CURRENT_MONEY;
+    static const Symbol KEY_CURRENT_MAGIC;
+    static const Symbol KEY_MAX_LIFE;
+    static const Symbol KEY_MAX_MONEY;
+    static const Symbol KEY_MAX_MAGIC;
+    static const Symbol KEY_ITEM_SLOT_1;
+    static const Symbol KEY_ITEM_SLOT_2;
+    static const Symbol KEY_ABILITY_TUNIC;
+    static const Symbol KEY_ABILITY_SWORD;
+    static const Symbol KEY_ABILITY_SWORD_KNOWLEDGE;
+    static const Symbol KEY_ABILITY_SHIELD;
+    static const Symbol KEY_ABILITY_LIFT;
+    static const Symbol KEY_ABILITY_SWIM;
+    static const Symbol KEY_ABILITY_JUMP_OVER_WATER;
+    static const Symbol KEY_ABILITY_RUN;
+    static const Symbol KEY_ABILITY_DETECT_WEAK_WALLS;
+    static const Symbol KEY_ABILITY_GET_BACK_FROM_DEATH;
 
     // creation and destruction
     Savegame(MainLoop& main_loop, const std::string& file_name);
@@ -92,16 +110,18 @@ class SOLARUS_API Savegame: public ExportableToLua {
     const std::string& get_file_name() const;
 
     // data
-    bool is_string(const std::string& key) const;
-    std::string get_string(const std::string& key) const;
-    void set_string(const std::string& key, const std::string& value);
-    bool is_integer(const std::string& key) const;
-    int get_integer(const std::string& key) const;
-    void set_integer(const std::string& key, int value);
-    bool is_boolean(const std::string& key) const;
-    bool get_boolean(const std::string& key) const;
-    void set_boolean(const std::string& key, bool value);
-    void unset(const std::string& key);
+    bool is_string(const Symbol& key) const;
+    std::string get_string(const Symbol& key) const;
+    void set_string(const Symbol& key, const std::string& value);
+    bool is_integer(const Symbol& key) const;
+    int get_integer(const Symbol& key) const;
+    void set_integer(const Symbol& key, int value);
+    bool is_boolean(const Symbol& key) const;
+    bool get_boolean(const Symbol& key) const;
+    void set_boolean(const Symbol& key, bool value);
+    void unset(const Symbol& key);
+    const SavedValues& get_saved_values() const;
+    void set_saved_values(const SavedValues& saved_values);
 
     // unsaved data
     MainLoop& get_main_loop();
@@ -117,19 +137,7 @@ class SOLARUS_API Savegame: public ExportableToLua {
 
   private:
 
-    struct SavedValue {
-
-      enum {
-        VALUE_STRING,
-        VALUE_INTEGER,
-        VALUE_BOOLEAN
-      } type;
-
-      std::string string_data;
-      int int_data;  // Also used for boolean
-    };
-
-    std::map<std::string, SavedValue> saved_values;
+    SavedValues saved_values;
 
     bool empty;
     std::string file_name;   /**< Savegame file name relative to the quest write directory. */
@@ -138,6 +146,7 @@ class SOLARUS_API Savegame: public ExportableToLua {
     Game* game;              /**< nullptr if this savegame is not currently running */
 
     void import_from_file();
+    SavedValue& get_value_to_set(const Symbol& key);
     static int l_newindex(lua_State* l);
 
     void set_initial_values();
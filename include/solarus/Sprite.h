@@ -19,14 +19,17 @@
 
 #include "solarus/Common.h"
 #include "solarus/entities/NonAnimatedRegions.h"
+#include "solarus/lowlevel/Symbol.h"
 #include "solarus/lua/ScopedLuaRef.h"
 #include "solarus/Drawable.h"
 #include "solarus/SpritePtr.h"
-#include <map>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace Solarus {
 
+class LuaContext;
 class Size;
 class SpriteAnimation;
 class SpriteAnimationSet;
@@ -54,12 +57,12 @@ class Sprite: public Drawable {
     static void quit();
 
     // creation and destruction
-    explicit Sprite(const std::string& id);
+    explicit Sprite(const Symbol& id);
 
     void set_tileset(const Tileset& tileset);
 
     // animation set
-    const std::string& get_animation_set_id() const;
+    const Symbol& get_animation_set_id() const;
     const SpriteAnimationSet& get_animation_set() const;
     void enable_pixel_collisions();
     bool are_pixel_collisions_enabled() const;
@@ -71,9 +74,9 @@ class Sprite: public Drawable {
     const Rectangle& get_max_bounding_box() const;
 
     // animation state
-    const std::string& get_current_animation() const;
-    void set_current_animation(const std::string& animation_name);
-    bool has_animation(const std::string& animation_name) const;
+    const Symbol& get_current_animation() const;
+    void set_current_animation(const Symbol& animation_name);
+    bool has_animation(const Symbol& animation_name) const;
     int get_current_direction() const;
     int get_nb_directions() const;
     void set_current_direction(int current_direction);
@@ -107,6 +110,7 @@ class Sprite: public Drawable {
     bool test_collision(const Sprite& other, int x1, int y1, int x2, int y2) const;
 
     // update and draw
+    static void precompute_frames(const std::vector<Sprite*>& sprites, uint32_t now);
     virtual void update() override;
     virtual void raw_draw(Surface& dst_surface, const Point& dst_position) override;
     virtual void raw_draw_region(const Rectangle& region,
@@ -121,20 +125,32 @@ class Sprite: public Drawable {
 
   private:
 
-    static SpriteAnimationSet& get_animation_set(const std::string& id);
+    /**
+     * \brief A frame change computed in advance by precompute_frames().
+     */
+    struct FrameStep {
+      int frame;                       /**< New frame, or -1 if the animation finishes. */
+      uint32_t next_frame_date;        /**< Date of the next frame after this step. */
+    };
+
+    static SpriteAnimationSet& get_animation_set(const Symbol& id);
     int get_next_frame() const;
+    void precompute_frames(uint32_t now);
+    void invalidate_precomputed_frames();
+    void apply_precomputed_frames(LuaContext* lua_context);
+    void update_frames(uint32_t now, LuaContext* lua_context);
     Surface& get_intermediate_surface() const ;
     void set_frame_changed(bool frame_changed);
     void notify_finished();
 
     // animation set
-    static std::map<std::string, SpriteAnimationSet*> all_animation_sets;
-    const std::string animation_set_id;  /**< id of this sprite's animation set */
+    static std::unordered_map<Symbol, SpriteAnimationSet*> all_animation_sets;
+    const Symbol animation_set_id;       /**< id of this sprite's animation set */
     SpriteAnimationSet& animation_set;   /**< animation set of this sprite */
 
     // current state of the sprite
 
-    std::string current_animation_name;  /**< name of the current animation */
+    Symbol current_animation_name;       /**< name of the current animation */
     SpriteAnimation* current_animation;  /**< the current animation or nullptr if the sprite sheet has no animation */
     int current_direction;             /**< current direction of the animation (the first one is number 0);
                                         * it can be different from the movement direction
@@ -153,6 +169,11 @@ class Sprite: public Drawable {
         synchronize_to;                /**< another sprite to synchronize the frame to
                                         * when they have the same animation name (or nullptr) */
 
+    std::vector<FrameStep>
+        precomputed_frames;            /**< frame changes computed in advance for the current cycle */
+    uint32_t precomputed_frames_date;  /**< date precomputed_frames were computed for */
+    bool precomputed_frames_valid;     /**< false if the state changed since precomputed_frames were computed */
+
     // effects
     mutable SurfacePtr
         intermediate_surface;          /**< an intermediate surface used to show transitions and other effects */
@@ -20,8 +20,9 @@
 #include "solarus/Common.h"
 #include "solarus/lowlevel/Rectangle.h"
 #include "solarus/lowlevel/Size.h"
-#include <map>
+#include "solarus/lowlevel/Symbol.h"
 #include <string>
+#include <unordered_map>
 
 struct lua_State;
 
@@ -47,10 +48,10 @@ class SpriteAnimationSet {
 
     void set_tileset(const Tileset& tileset);
 
-    bool has_animation(const std::string& animation_name) const;
-    const SpriteAnimation& get_animation(const std::string& animation_name) const;
-    SpriteAnimation& get_animation(const std::string& animation_name);
-    const std::string& get_default_animation() const;
+    bool has_animation(const Symbol& animation_name) const;
+    const SpriteAnimation& get_animation(const Symbol& animation_name) const;
+    SpriteAnimation& get_animation(const Symbol& animation_name);
+    const Symbol& get_default_animation() const;
 
     void enable_pixel_collisions();
     bool are_pixel_collisions_enabled() const;
@@ -65,9 +66,9 @@ class SpriteAnimationSet {
         const SpriteAnimationData& animation_data);
 
     std::string id;                          /**< Id of this animation set. */
-    std::map<std::string, SpriteAnimation>
+    std::unordered_map<Symbol, SpriteAnimation>
             animations;                      /**< The animations. */
-    std::string default_animation_name;      /**< Name of the default animation. */
+    Symbol default_animation_name;           /**< Name of the default animation. */
     Size max_size;                           /**< Size of this biggest frame. */
     Rectangle max_bounding_box;              /**< Rectangle big enough to contain any frame.
                                               * Can be larger than max_size if
@@ -17,16 +17,16 @@
 #ifndef SOLARUS_SPRITE_PTR_H
 #define SOLARUS_SPRITE_PTR_H
 
-#include <memory>
+#include "solarus/lowlevel/IntrusivePtr.h"
 
 namespace Solarus {
 
 class Sprite;
 
 /**
- * \brief Alias for shared_ptr of Sprite.
+ * \brief Alias for IntrusivePtr of Sprite.
  */
-using SpritePtr = std::shared_ptr<Sprite>;
+using SpritePtr = IntrusivePtr<Sprite>;
 
 }
 
@@ -17,16 +17,16 @@
 #ifndef SOLARUS_TIMER_PTR_H
 #define SOLARUS_TIMER_PTR_H
 
-#include <memory>
+#include "solarus/lowlevel/IntrusivePtr.h"
 
 namespace Solarus {
 
 class Timer;
 
 /**
- * \brief Alias for shared_ptr of Timer.
+ * \brief Alias for IntrusivePtr of Timer.
  */
-using TimerPtr = std::shared_ptr<Timer>;
+using TimerPtr = IntrusivePtr<Timer>;
 
 }
 
@@ -43,7 +43,7 @@ class AnimatedTilePattern: public TilePattern {
 
     AnimatedTilePattern(Ground ground, AnimationSequence sequence,
         const Size& size, int x1, int y1, int x2, int y2, int x3, int y3,
-        bool parallax);
+        int parallax_ratio);
 
     static void initialize();
     static void update();
@@ -69,7 +69,8 @@ class AnimatedTilePattern: public TilePattern {
     Rectangle position_in_tileset[3]; /**< Array of 3 rectangles representing the 3 animation frames
                                        * of this tile pattern in the tileset image.
                                        * The 3 frames should have the same width and height. */
-    bool parallax;                    /**< Indicates that the tile pattern also makes parallax scrolling */
+    int parallax_ratio;               /**< Distance made by the viewport to move the tile pattern
+                                       * of 1 pixel, or 0 if there is no parallax scrolling. */
 
 };
 
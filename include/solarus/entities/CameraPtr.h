@@ -17,16 +17,16 @@
 #ifndef SOLARUS_CAMERA_PTR_H
 #define SOLARUS_CAMERA_PTR_H
 
-#include <memory>
+#include "solarus/lowlevel/IntrusivePtr.h"
 
 namespace Solarus {
 
 class Camera;
 
 /**
- * \brief Alias for shared_ptr of Camera.
+ * \brief Alias for IntrusivePtr of Camera.
  */
-using CameraPtr = std::shared_ptr<Camera>;
+using CameraPtr = IntrusivePtr<Camera>;
 
 }
 
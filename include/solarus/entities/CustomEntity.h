@@ -20,8 +20,10 @@
 #include "solarus/Common.h"
 #include "solarus/entities/Entity.h"
 #include "solarus/lua/ScopedLuaRef.h"
+#include <cstdint>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace Solarus {
@@ -68,22 +70,27 @@ class SOLARUS_API CustomEntity: public Entity {
     // What can traverse this custom entity.
     bool is_traversable_by_entity(Entity& entity);
     void set_traversable_by_entities(bool traversable);
-    void set_traversable_by_entities(const ScopedLuaRef& traversable_test_ref);
+    void set_traversable_by_entities(const ScopedLuaRef& traversable_test_ref, bool stable);
     void reset_traversable_by_entities();
     void set_traversable_by_entities(EntityType type, bool traversable);
-    void set_traversable_by_entities(EntityType type, const ScopedLuaRef& traversable_test_ref);
+    void set_traversable_by_entities(
+        EntityType type,
+        const ScopedLuaRef& traversable_test_ref,
+        bool stable
+    );
     void reset_traversable_by_entities(EntityType type);
 
     bool is_obstacle_for(Entity& other) override;
 
     // What this custom entity can traverse.
     void set_can_traverse_entities(bool traversable);
-    void set_can_traverse_entities(const ScopedLuaRef& traversable_test_ref);
+    void set_can_traverse_entities(const ScopedLuaRef& traversable_test_ref, bool stable);
     void reset_can_traverse_entities();
     void set_can_traverse_entities(EntityType type, bool traversable);
     void set_can_traverse_entities(
         EntityType type,
-        const ScopedLuaRef& traversable_test_ref
+        const ScopedLuaRef& traversable_test_ref,
+        bool stable
     );
     void reset_can_traverse_entities(EntityType type);
 
@@ -172,6 +179,10 @@ class SOLARUS_API CustomEntity: public Entity {
     /**
      * \brief Stores whether a custom entity can be traversed by or can traverse
      * other entities.
+     *
+     * When a Lua function is declared stable, its result for a given other
+     * entity is remembered until the state revision of one of both entities
+     * changes.
      */
     class TraversableInfo {
 
@@ -184,7 +195,8 @@ class SOLARUS_API CustomEntity: public Entity {
         );
         TraversableInfo(
             LuaContext& lua_context,
-            const ScopedLuaRef& traversable_test_ref
+            const ScopedLuaRef& traversable_test_ref,
+            bool stable
         );
 
         bool is_empty() const;
@@ -202,6 +214,24 @@ class SOLARUS_API CustomEntity: public Entity {
                                         * that decides, or LUA_REFNIL. */
         bool traversable;              /**< Traversable property (unused if
                                         * there is a Lua function). */
+        bool stable;                   /**< Whether the results of the Lua
+                                        * function can be remembered. */
+
+        /**
+         * \brief A remembered result of the Lua function.
+         */
+        struct CachedResult {
+          uint32_t current_revision;   /**< State revision of the custom entity. */
+          uint32_t other_revision;     /**< State revision of the other entity. */
+          bool traversable;            /**< Result of the Lua function. */
+        };
+
+        static constexpr size_t
+            max_cache_size = 64;       /**< Number of results to remember
+                                        * before starting again. */
+        mutable std::unordered_map<const Entity*, CachedResult>
+            cache;                     /**< Results of a stable Lua function
+                                        * for each other entity. */
 
     };
 
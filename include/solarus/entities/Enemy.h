@@ -24,6 +24,7 @@
 #include "solarus/entities/Entity.h"
 #include "solarus/entities/EntityPtr.h"
 #include "solarus/entities/Explosion.h"
+#include <array>
 #include <map>
 #include <string>
 
@@ -140,8 +141,8 @@ class Enemy: public Entity {
     void set_default_attack_consequences_sprite(const Sprite& sprite);
 
     // sprites
-    std::string get_animation() const;
-    void set_animation(const std::string& animation);
+    Symbol get_animation() const;
+    void set_animation(const Symbol& animation);
 
     // obstacles
     virtual bool is_obstacle_for(Entity& other) override;
@@ -195,6 +196,18 @@ class Enemy: public Entity {
 
   private:
 
+    /**
+     * \brief Stages of the immobilized state.
+     */
+    enum class ImmobilizedState {
+      NONE,                            /**< not immobilized */
+      IMMOBILIZED,                     /**< immobilized, animation "immobilized" */
+      SHAKING                          /**< about to walk again, animation "shaking" */
+    };
+
+    static constexpr int nb_attacks =
+        static_cast<int>(EnemyAttack::SCRIPT) + 1;  /**< Number of values of EnemyAttack. */
+
     // hurt the enemy
     void play_hurt_sound();
     bool is_sprite_finished_or_looping() const;
@@ -221,8 +234,8 @@ class Enemy: public Entity {
     bool can_hurt_hero_running;        /**< indicates that the enemy can attack the hero even when the hero is running */
     int minimum_shield_needed;         /**< shield number needed by the hero to avoid the attack of this enemy,
                                         * or 0 to make the attack unavoidable (default: 0) */
-    std::map<EnemyAttack, EnemyReaction>
-        attack_reactions;              /**< how the enemy reacts to each attack
+    std::array<EnemyReaction, nb_attacks>
+        attack_reactions;              /**< how the enemy reacts to each attack, indexed by EnemyAttack
                                            * (by default, it depends on the attacks) */
     std::string savegame_variable;     /**< name of the boolean variable indicating whether this enemy is killed,
                                         * or an empty string if it is not saved */
@@ -236,7 +249,8 @@ class Enemy: public Entity {
     uint32_t vulnerable_again_date;    /**< date when the enemy can be hurt again */
     bool can_attack;                   /**< indicates that the enemy can currently attack the hero */
     uint32_t can_attack_again_date;    /**< date when the enemy can attack again (0 means never) */
-    bool immobilized;                  /**< indicates that the enemy is currently immobilized */
+    ImmobilizedState
+        immobilized_state;             /**< whether the enemy is currently immobilized or shaking */
     uint32_t start_shaking_date;       /**< date when the enemy shakes */
     uint32_t end_shaking_date;         /**< date when the enemy stops shaking and walks again */
     bool dying_animation_started;      /**< whether the dying animation was started */
@@ -19,8 +19,9 @@
 
 #include "solarus/Common.h"
 #include "solarus/EnumInfo.h"
-#include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace Solarus {
 
@@ -30,6 +31,8 @@ class Sprite;
  * \brief Describes how an enemy reacts when it receives an attack.
  *
  * The reaction may be different between different sprites of the enemy.
+ * Sprite-specific reactions are stored in a small flat list because
+ * enemies only have a few sprites.
  */
 class SOLARUS_API EnemyReaction {
 
@@ -69,7 +72,8 @@ class SOLARUS_API EnemyReaction {
   private:
 
     Reaction general_reaction;                             /**< reaction to make unless sprite-specific override */
-    std::map<const Sprite*, Reaction> sprite_reactions;    /**< sprite-specific reaction (overrides the default one) */
+    std::vector<std::pair<const Sprite*, Reaction>>
+        sprite_reactions;                                  /**< sprite-specific reactions (override the default one) */
 
 };
 
@@ -26,7 +26,12 @@
 #include "solarus/entities/Ground.h"
 #include "solarus/entities/HeroPtr.h"
 #include "solarus/entities/TilePtr.h"
+#include "solarus/lowlevel/IntrusivePtr.h"
+#include "solarus/lowlevel/Rectangle.h"
+#include "solarus/lowlevel/Symbol.h"
+#include "solarus/MapData.h"
 #include "solarus/Transition.h"
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
@@ -38,11 +43,12 @@
 namespace Solarus {
 
 class Destination;
+struct GameCheckpoint;
 class Hero;
 class Map;
-class MapData;
 class NonAnimatedRegions;
-class Rectangle;
+class ParallaxLayers;
+class Sprite;
 class Tileset;
 class TilePattern;
 struct TileInfo;
@@ -67,13 +73,14 @@ class SOLARUS_API Entities {
 
     // Creation and destruction.
     Entities(Game& game, Map& map);
+    ~Entities();
 
     // Get entities.
     Hero& get_hero();
     const CameraPtr& get_camera() const;
     Ground get_tile_ground(int layer, int x, int y) const;
     EntityVector get_entities();
-    const std::shared_ptr<Destination>& get_default_destination();
+    const IntrusivePtr<Destination>& get_default_destination();
 
     // By name.
     EntityPtr get_entity(const std::string& name);
@@ -92,13 +99,13 @@ class SOLARUS_API Entities {
 
     // By type, template versions to avoid casts.
     template<typename T>
-    std::set<std::shared_ptr<const T>> get_entities_by_type() const;
+    std::set<IntrusivePtr<const T>> get_entities_by_type() const;
     template<typename T>
-    std::set<std::shared_ptr<T>> get_entities_by_type();
+    std::set<IntrusivePtr<T>> get_entities_by_type();
     template<typename T>
-    std::set<std::shared_ptr<const T>> get_entities_by_type(int layer) const;
+    std::set<IntrusivePtr<const T>> get_entities_by_type(int layer) const;
     template<typename T>
-    std::set<std::shared_ptr<T>> get_entities_by_type(int layer);
+    std::set<IntrusivePtr<T>> get_entities_by_type(int layer);
 
     // By coordinates.
     void get_entities_in_rectangle(const Rectangle& rectangle, ConstEntityVector& result) const;
@@ -128,6 +135,16 @@ class SOLARUS_API Entities {
     // Specific to some entity types.
     bool overlaps_raised_blocks(int layer, const Rectangle& rectangle) ;
 
+    // Occlusion.
+    bool is_hidden(const Rectangle& where, int layer) const;
+
+    // Entities created lazily.
+    void instantiate_deferred_entities(const Rectangle& where);
+
+    // Checkpoints.
+    void save_checkpoint(GameCheckpoint& checkpoint) const;
+    void restore_checkpoint(const GameCheckpoint& checkpoint);
+
     // Map events.
     void notify_map_started();
     void notify_map_opening_transition_finished();
@@ -162,7 +179,9 @@ class SOLARUS_API Entities {
         ZCache();
 
         int get_z(const ConstEntityPtr& entity) const;
+        int reserve();
         void add(const ConstEntityPtr& entity);
+        void add(const ConstEntityPtr& entity, int z);
         void remove(const ConstEntityPtr& entity);
         void bring_to_front(const ConstEntityPtr& entity);
         void bring_to_back(const ConstEntityPtr& entity);
@@ -174,10 +193,30 @@ class SOLARUS_API Entities {
         int max;
     };
 
+    /**
+     * \brief An entity of the map data whose creation is delayed until its
+     * region is about to be visible.
+     */
+    struct DeferredEntity {
+      EntityIndex index;       /**< Index of the entity in the map data. */
+      EntityType type;         /**< Type of the entity. */
+      std::string name;        /**< Name of the entity or an empty string. */
+      Point xy;                /**< Coordinates of the entity on the map. */
+      int z;                   /**< Z order reserved in its layer to keep the map file order. */
+    };
+
+    using DeferredEntityPredicate = std::function<bool(const DeferredEntity&)>;
+
     void initialize_layers();
     void set_tile_ground(int layer, int x8, int y8, Ground ground);
     void remove_marked_entities();
     void notify_entity_removed(Entity& entity);
+    void precompute_sprite_frames();
+    void update_occlusion();
+    static bool is_deferrable(EntityType type);
+    void update_deferred_entities();
+    bool has_deferred_entity(const DeferredEntityPredicate& predicate) const;
+    void instantiate_deferred_entities(const DeferredEntityPredicate& predicate);
     void update_crystal_blocks();
 
     // map
@@ -197,13 +236,20 @@ class SOLARUS_API Entities {
                                                      * here for performance. */
     ByLayer<std::vector<TilePtr>>
         tiles_in_animated_regions;                  /**< For each layer, animated tiles and tiles overlapping them. */
+    ByLayer<std::unique_ptr<ParallaxLayers>>
+        parallax_layers;                            /**< For each layer, parallax scrolling tiles drawn
+                                                     * from cached surfaces. */
+    std::vector<int> occluding_layers;              /**< List of size tiles_grid_size with, for each
+                                                     * 8x8 square, the highest layer where an opaque
+                                                     * non-animated tile covers it
+                                                     * (or the min layer - 1 if there is none). */
 
     // dynamic entities
     HeroPtr hero;                                   /**< The hero, also stored in Game because
                                                      * it is kept when changing maps. */
     CameraPtr camera;                               /**< The visible area of the map. */
 
-    std::map<std::string, EntityPtr>
+    std::unordered_map<Symbol, EntityPtr>
         named_entities;                             /**< Entities identified by a name. */
     EntityList all_entities;                        /**< All map entities except tiles and the hero. */
     std::map<EntityType, ByLayer<EntitySet>>
@@ -219,9 +265,26 @@ class SOLARUS_API Entities {
 
     EntityList entities_to_remove;                  /**< List of entities that need to be removed right now. */
 
-    std::shared_ptr<Destination>
+    std::vector<Sprite*>
+        sprites_to_precompute;                      /**< Sprites of entities to update at this cycle
+                                                     * (only valid during update()). */
+
+    IntrusivePtr<Destination>
         default_destination;                        /**< Default destination of this map or nullptr. */
 
+    // entities created lazily
+    std::vector<DeferredEntity>
+        deferred_entities;                          /**< Entities of the map data not created yet,
+                                                     * in map file order. */
+    std::multiset<std::string>
+        deferred_names;                             /**< Names of deferred entities, for fast lookups. */
+    Rectangle hero_region;                          /**< Last region of the hero whose entities were created. */
+    Rectangle camera_region;                        /**< Last region of the camera whose entities were created. */
+    int next_entity_z;                              /**< Z order to give to the next entity added,
+                                                     * if use_next_entity_z is set. */
+    bool use_next_entity_z;                         /**< Whether the next entity added takes a Z order
+                                                     * reserved earlier. */
+
 };
 
 /**
@@ -258,9 +321,9 @@ inline const CameraPtr& Entities::get_camera() const {
  * \return All entities of the type.
  */
 template<typename T>
-std::set<std::shared_ptr<const T>> Entities::get_entities_by_type() const {
+std::set<IntrusivePtr<const T>> Entities::get_entities_by_type() const {
 
-  std::set<std::shared_ptr<const T>> result;
+  std::set<IntrusivePtr<const T>> result;
 
   const EntityType type = T::ThisType;
   const auto& it = entities_by_type.find(type);
@@ -270,7 +333,7 @@ std::set<std::shared_ptr<const T>> Entities::get_entities_by_type() const {
 
   for (const auto& kvp : it->second) {
     for (const ConstEntityPtr& entity : kvp.second) {
-      result.insert(std::static_pointer_cast<const T>(entity));
+      result.insert(static_pointer_cast<const T>(entity));
     }
   }
   return result;
@@ -281,9 +344,9 @@ std::set<std::shared_ptr<const T>> Entities::get_entities_by_type() const {
  * \return All entities of the type.
  */
 template<typename T>
-std::set<std::shared_ptr<T>> Entities::get_entities_by_type() {
+std::set<IntrusivePtr<T>> Entities::get_entities_by_type() {
 
-  std::set<std::shared_ptr<T>> result;
+  std::set<IntrusivePtr<T>> result;
 
   const EntityType type = T::ThisType;
   const auto& it = entities_by_type.find(type);
@@ -293,7 +356,7 @@ std::set<std::shared_ptr<T>> Entities::get_entities_by_type() {
 
   for (const auto& kvp : it->second) {
     for (const EntityPtr& entity : kvp.second) {
-      result.insert(std::static_pointer_cast<T>(entity));
+      result.insert(static_pointer_cast<T>(entity));
     }
   }
   return result;
@@ -305,9 +368,9 @@ std::set<std::shared_ptr<T>> Entities::get_entities_by_type() {
  * \return All entities of the type on this layer.
  */
 template<typename T>
-std::set<std::shared_ptr<const T>> Entities::get_entities_by_type(int layer) const {
+std::set<IntrusivePtr<const T>> Entities::get_entities_by_type(int layer) const {
 
-  std::set<std::shared_ptr<const T>> result;
+  std::set<IntrusivePtr<const T>> result;
 
   const EntityType type = T::ThisType;
   const auto& it = entities_by_type.find(type);
@@ -321,7 +384,7 @@ std::set<std::shared_ptr<const T>> Entities::get_entities_by_type(int layer) con
     return result;
   }
   for (const EntityPtr& entity : layer_it->second) {
-    result.insert(std::static_pointer_cast<const T>(entity));
+    result.insert(static_pointer_cast<const T>(entity));
   }
   return result;
 }
@@ -332,9 +395,9 @@ std::set<std::shared_ptr<const T>> Entities::get_entities_by_type(int layer) con
  * \return All entities of the type on this layer.
  */
 template<typename T>
-std::set<std::shared_ptr<T>> Entities::get_entities_by_type(int layer) {
+std::set<IntrusivePtr<T>> Entities::get_entities_by_type(int layer) {
 
-  std::set<std::shared_ptr<T>> result;
+  std::set<IntrusivePtr<T>> result;
 
   const EntityType type = T::ThisType;
   const auto& it = entities_by_type.find(type);
@@ -348,7 +411,7 @@ std::set<std::shared_ptr<T>> Entities::get_entities_by_type(int layer) {
     return result;
   }
   for (const EntityPtr& entity : layer_it->second) {
-    result.insert(std::static_pointer_cast<T>(entity));
+    result.insert(static_pointer_cast<T>(entity));
   }
   return result;
 }
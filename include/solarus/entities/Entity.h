@@ -18,6 +18,7 @@
 #define SOLARUS_ENTITY_H
 
 #include "solarus/Common.h"
+#include "solarus/lowlevel/IntrusivePtr.h"
 #include "solarus/lua/ExportableToLua.h"
 #include "solarus/entities/EntityType.h"
 #include "solarus/entities/Ground.h"
@@ -25,6 +26,7 @@
 #include "solarus/entities/EnemyAttack.h"
 #include "solarus/entities/EnemyReaction.h"
 #include "solarus/lowlevel/Rectangle.h"
+#include "solarus/lowlevel/Symbol.h"
 #include "solarus/GameCommand.h"
 #include "solarus/SpritePtr.h"
 #include <list>
@@ -197,9 +199,9 @@ class SOLARUS_API Entity: public ExportableToLua {
     bool has_sprite() const;
     SpritePtr get_sprite(const std::string& sprite_name = "") const;
     std::vector<SpritePtr> get_sprites() const;
-    std::vector<NamedSprite> get_named_sprites() const;
+    const std::vector<NamedSprite>& get_named_sprites() const;
     SpritePtr create_sprite(
-        const std::string& animation_set_id,
+        const Symbol& animation_set_id,
         const std::string& sprite_name = ""
     );
     bool remove_sprite(Sprite& sprite);
@@ -208,16 +210,16 @@ class SOLARUS_API Entity: public ExportableToLua {
     bool bring_sprite_to_front(Sprite& sprite);
     std::string get_default_sprite_name() const;
     void set_default_sprite_name(const std::string& default_sprite_name);
-    virtual void notify_sprite_frame_changed(Sprite& sprite, const std::string& animation, int frame);
-    virtual void notify_sprite_animation_finished(Sprite& sprite, const std::string& animation);
+    virtual void notify_sprite_frame_changed(Sprite& sprite, const Symbol& animation, int frame);
+    virtual void notify_sprite_animation_finished(Sprite& sprite, const Symbol& animation);
     bool is_visible() const;
     void set_visible(bool visible);
     void set_animation_ignore_suspend(bool ignore_suspend);
 
     // Movement.
-    const std::shared_ptr<Movement>& get_movement();
-    std::shared_ptr<const Movement> get_movement() const;
-    void set_movement(const std::shared_ptr<Movement>& movement);
+    const IntrusivePtr<Movement>& get_movement();
+    IntrusivePtr<const Movement> get_movement() const;
+    void set_movement(const IntrusivePtr<Movement>& movement);
     void clear_movement();
     bool are_movement_notifications_enabled() const;
     void set_movement_notifications_enabled(bool notify);
@@ -382,6 +384,9 @@ class SOLARUS_API Entity: public ExportableToLua {
     std::string get_state_name() const;
     void update_state();
 
+    uint32_t get_state_revision() const;
+    void notify_state_changed();
+
   protected:
 
     // Creation.
@@ -402,6 +407,7 @@ class SOLARUS_API Entity: public ExportableToLua {
     // Ground.
     void update_ground_observers();
     void update_ground_below();
+    virtual Ground probe_ground(int layer, const Point& xy);
 
     // Collisions.
     virtual void notify_collision(
@@ -465,9 +471,9 @@ class SOLARUS_API Entity: public ExportableToLua {
     std::string default_sprite_name;            /**< Name of the sprite to get in get_sprite() without parameter. */
     bool visible;                               /**< Whether this entity's sprites are currently displayed. */
     bool drawn_in_y_order;                      /**< Whether this entity is drawn in Y order or in Z order. */
-    std::shared_ptr<Movement> movement;         /**< Movement of the entity.
+    IntrusivePtr<Movement> movement;            /**< Movement of the entity.
                                                  * nullptr indicates that the entity has no movement. */
-    std::vector<std::shared_ptr<Movement>>
+    std::vector<IntrusivePtr<Movement>>
         old_movements;                          /**< Old movements to destroy as soon as possible. */
     bool movement_notifications_enabled;        /**< Whether entity:on_position_changed() and friends should be called. */
     Entity* facing_entity;                      /**< The detector in front of this entity if any. */
@@ -487,6 +493,8 @@ class SOLARUS_API Entity: public ExportableToLua {
     bool being_removed;                         /**< indicates that the entity is not valid anymore because it is about to be removed */
     bool enabled;                               /**< indicates that the entity is enabled
                                                  * (if not, it will not be displayed and collisions will not be notified) */
+    uint32_t state_revision;                    /**< changes whenever the state of this entity changes,
+                                                 * unique among all entities ever created */
 
     bool suspended;                             /**< indicates that the animation and movement of this entity are suspended */
     uint32_t when_suspended;                    /**< indicates when this entity was suspended */
@@ -17,21 +17,21 @@
 #ifndef SOLARUS_ENTITY_PTR_H
 #define SOLARUS_ENTITY_PTR_H
 
-#include <memory>
+#include "solarus/lowlevel/IntrusivePtr.h"
 
 namespace Solarus {
 
 class Entity;
 
 /**
- * \brief Alias for shared_ptr of Entity.
+ * \brief Alias for IntrusivePtr of Entity.
  */
-using EntityPtr = std::shared_ptr<Entity>;
+using EntityPtr = IntrusivePtr<Entity>;
 
 /**
- * \brief Alias for shared_ptr of const Entity.
+ * \brief Alias for IntrusivePtr of const Entity.
  */
-using ConstEntityPtr = std::shared_ptr<const Entity>;
+using ConstEntityPtr = IntrusivePtr<const Entity>;
 
 }
 
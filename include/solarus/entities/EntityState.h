@@ -20,8 +20,8 @@
 #include "solarus/Common.h"
 #include "solarus/entities/CarriedObject.h"
 #include "solarus/entities/Hero.h"
+#include "solarus/lowlevel/IntrusivePtr.h"
 #include <cstdint>
-#include <memory>
 #include <string>
 
 namespace Solarus {
@@ -139,7 +139,7 @@ class Entity::State {
     virtual bool can_take_jumper() const;
     virtual void notify_jumper_activated(Jumper& jumper);
     bool is_carrying_item() const;
-    virtual std::shared_ptr<CarriedObject> get_carried_object() const;
+    virtual IntrusivePtr<CarriedObject> get_carried_object() const;
     virtual CarriedObject::Behavior get_previous_carried_object_behavior() const;
 
   protected:
@@ -46,7 +46,7 @@ class Explosion: public Entity {
 
     // state
     virtual void update() override;
-    virtual void notify_sprite_frame_changed(Sprite& sprite, const std::string& animation, int frame) override;
+    virtual void notify_sprite_frame_changed(Sprite& sprite, const Symbol& animation, int frame) override;
 
     // collisions
     virtual void notify_collision(Entity& other_entity, Sprite& this_sprite, Sprite& other_sprite) override;
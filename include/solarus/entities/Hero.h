@@ -21,7 +21,9 @@
 #include "solarus/entities/Entity.h"
 #include "solarus/entities/Ground.h"
 #include "solarus/hero/HeroSprites.h"
+#include "solarus/lowlevel/IntrusivePtr.h"
 #include "solarus/lowlevel/Point.h"
+#include <array>
 #include <memory>
 #include <string>
 
@@ -97,6 +99,7 @@ class Hero: public Entity {
     virtual void notify_map_started() override;
     virtual void notify_tileset_changed() override;
     void place_on_destination(Map& map, const Rectangle& previous_map_location);
+    void restore_position(const Point& xy, int layer, int direction4);
     virtual void notify_map_opening_transition_finished() override;
 
     /**
@@ -113,7 +116,7 @@ class Hero: public Entity {
     bool is_facing_direction4(int direction4) const;
     bool is_facing_direction8(int direction8) const;
     bool is_on_raised_blocks() const;
-    std::shared_ptr<const Stairs> get_stairs_overlapping() const;
+    IntrusivePtr<const Stairs> get_stairs_overlapping() const;
 
     /**
      * \name Movement.
@@ -265,7 +268,7 @@ class Hero: public Entity {
         bool with_sound);
     void start_frozen();
     void start_victory(const ScopedLuaRef& callback_ref);
-    void start_lifting(const std::shared_ptr<CarriedObject>& item_to_lift);
+    void start_lifting(const IntrusivePtr<CarriedObject>& item_to_lift);
     void start_running();
     void start_grabbing();
     bool can_pick_treasure(EquipmentItem& item);
@@ -323,10 +326,25 @@ class Hero: public Entity {
     void update_movement();
     void try_snap_to_facing_entity();
     void apply_additional_ground_movement();
-    std::shared_ptr<Teletransporter> get_delayed_teletransporter();
-    std::shared_ptr<CarriedObject> get_carried_object();
+    IntrusivePtr<Teletransporter> get_delayed_teletransporter();
+    IntrusivePtr<CarriedObject> get_carried_object();
 
     // ground
+    /**
+     * \brief Cached result of a ground probe.
+     *
+     * It remains valid as long as the hero stays on the same map and the
+     * ground revision of the map does not change.
+     */
+    struct GroundProbe {
+      int layer;
+      Point xy;
+      uint32_t ground_revision;
+      Ground ground;
+    };
+
+    virtual Ground probe_ground(int layer, const Point& xy) override;
+    void clear_ground_probes();
     void update_ground_effects();
     void update_ice();
     void stop_ice_movement();
@@ -348,7 +366,7 @@ class Hero: public Entity {
     int walking_speed;                     /**< current walking speed (possibly changed by the ground) */
 
     // state specific
-    std::shared_ptr<Teletransporter>
+    IntrusivePtr<Teletransporter>
         delayed_teletransporter;           /**< a teletransporter that will be activated when the hero finishes
                                             * a special behavior, such as falling into a hole or walking on stairs */
     bool on_raised_blocks;                 /**< indicates that the hero is currently on
@@ -366,6 +384,10 @@ class Hero: public Entity {
     uint32_t next_ice_date;                /**< when recomputing the additional movement on ice */
     int ice_movement_direction8;           /**< wanted movement direction a while ago */
     Point ground_dxy;                      /**< additional movement with special ground (hole or ice) */
+    std::array<GroundProbe, 8>
+        ground_probes;                     /**< recent ground probes, reused while nothing changes */
+    int num_ground_probes;                 /**< number of valid elements in ground_probes */
+    int next_ground_probe;                 /**< index in ground_probes of the next probe to replace */
 
 };
 
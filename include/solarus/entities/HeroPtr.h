@@ -17,16 +17,16 @@
 #ifndef SOLARUS_HERO_PTR_H
 #define SOLARUS_HERO_PTR_H
 
-#include <memory>
+#include "solarus/lowlevel/IntrusivePtr.h"
 
 namespace Solarus {
 
 class Hero;
 
 /**
- * \brief Alias for shared_ptr of Entity.
+ * \brief Alias for IntrusivePtr of Entity.
  */
-using HeroPtr = std::shared_ptr<Hero>;
+using HeroPtr = IntrusivePtr<Hero>;
 
 }
 
@@ -34,6 +34,10 @@ class Map;
  * tile. The tiles in such rectangles of the map can be pre-drawn once for all
  * on an intermediate surface for performance. Furthermore, this intermediate
  * surface is drawn lazily when the camera moves.
+ *
+ * This class also knows which 8x8 squares of the layer are entirely covered
+ * by opaque non-animated tiles. This allows to skip drawing what is hidden
+ * below them.
  */
 class NonAnimatedRegions {
 
@@ -44,11 +48,14 @@ class NonAnimatedRegions {
     void add_tile(const TileInfo& tile);
     void build(std::vector<TileInfo>& rejected_tiles);
     void notify_tileset_changed();
+    bool is_square_opaque(int square_index) const;
+    void update_hidden_cells();
     void draw_on_map();
 
   private:
 
     bool overlaps_animated_tile(const TileInfo& tile) const;
+    void compute_opaque_squares();
     void build_cell(int cell_index);
 
     Map& map;                               /**< The map. */
@@ -57,6 +64,8 @@ class NonAnimatedRegions {
         tiles;                              /**< All tiles contained in this layer and candidates to
                                              * be optimized. This list is cleared after build() is called. */
     std::vector<bool> are_squares_animated; /**< Whether each 8x8 square of the map has animated tiles. */
+    std::vector<bool> are_squares_opaque;   /**< Whether each 8x8 square of the map is entirely
+                                             * covered by an opaque non-animated tile of this layer. */
 
     // Handle the lazy drawing.
     Grid<TileInfo>
@@ -67,6 +76,8 @@ class NonAnimatedRegions {
         optimized_tiles_surfaces;           /**< All non-animated tiles are drawn here once for all
                                              * for performance. Each cell of the grid has a surface
                                              * or nullptr before it is drawn. */
+    std::vector<bool> are_cells_hidden;     /**< Whether each cell of the grid is entirely covered
+                                             * by opaque tiles of upper layers. */
 
 };
 
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_PARALLAX_LAYERS_H
+#define SOLARUS_PARALLAX_LAYERS_H
+
+#include "solarus/Common.h"
+#include "solarus/containers/Grid.h"
+#include "solarus/entities/TileInfo.h"
+#include "solarus/lowlevel/Rectangle.h"
+#include "solarus/lowlevel/SurfacePtr.h"
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace Solarus {
+
+class Map;
+
+/**
+ * \brief Manages the parallax scrolling tiles of a layer of the map.
+ *
+ * Parallax scrolling tiles with the same ratio always move together,
+ * so they are drawn once on intermediate surfaces that cover their
+ * extent. Like for non-animated regions, the extent is split into cells of
+ * fixed size that are drawn lazily, so that large parallax layers do not
+ * need huge surfaces and only visible cells are blitted at each frame.
+ * Tiles with different ratios are put on separate grids.
+ */
+class ParallaxLayers {
+
+  public:
+
+    ParallaxLayers(Map& map, int layer);
+
+    void add_tile(const TileInfo& tile);
+    void notify_tileset_changed();
+    void draw_on_map();
+
+  private:
+
+    /**
+     * \brief Parallax scrolling tiles sharing the same ratio.
+     */
+    struct ParallaxLayer {
+      std::vector<TileInfo> tiles;     /**< The tiles of this parallax layer. */
+      Rectangle box;                   /**< Bounding box of all tiles. */
+      std::unique_ptr<Grid<TileInfo>>
+          cells;                       /**< The tiles split into cells, relative to
+                                        * the bounding box, or nullptr before it is built. */
+      std::vector<SurfacePtr>
+          cell_surfaces;               /**< Tiles of each cell drawn once for all,
+                                        * or nullptr before the cell is drawn. */
+    };
+
+    void build_cells(ParallaxLayer& parallax_layer);
+    void build_cell(ParallaxLayer& parallax_layer, int cell_index);
+
+    Map& map;                          /**< The map. */
+    int layer;                         /**< Layer of the map managed by this object. */
+    std::map<int, ParallaxLayer>
+        parallax_layers;               /**< Tiles of this layer indexed by parallax ratio. */
+
+};
+
+}
+
+#endif
+
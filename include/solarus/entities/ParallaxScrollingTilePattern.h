@@ -25,7 +25,8 @@ namespace Solarus {
 /**
  * \brief Tile pattern with a parallax scrolling effect.
  *
- * The pattern moves from 1 pixel when the camera moves from 2 pixels.
+ * The pattern moves from 1 pixel when the camera moves from a number of
+ * pixels called the parallax ratio (2 by default).
  * This gives an illusion of depth. Only the position of where the pattern
  * is displayed changes: the real position of the tile never changes.
  * Therefore, placing such tiles on your map can be tricky because at runtime,
@@ -40,7 +41,12 @@ class ParallaxScrollingTilePattern: public SimpleTilePattern {
 
   public:
 
-    ParallaxScrollingTilePattern(Ground ground, const Point& xy, const Size& size);
+    ParallaxScrollingTilePattern(
+        Ground ground,
+        const Point& xy,
+        const Size& size,
+        int ratio
+    );
 
     virtual void draw(
         const SurfacePtr& dst_surface,
@@ -51,8 +57,11 @@ class ParallaxScrollingTilePattern: public SimpleTilePattern {
 
     virtual bool is_animated() const override;
     virtual bool is_drawn_at_its_position() const override;
+    virtual int get_parallax_ratio() const override;
 
-    static constexpr int ratio = 2;  /**< Distance made by the viewport to move the tile pattern of 1 pixel. */
+  private:
+
+    const int ratio;                         /**< Distance made by the viewport to move the tile pattern of 1 pixel. */
 
 };
 
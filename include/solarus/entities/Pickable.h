@@ -20,11 +20,11 @@
 #include "solarus/Common.h"
 #include "solarus/entities/Entity.h"
 #include "solarus/entities/EntityPtr.h"
+#include "solarus/lowlevel/IntrusivePtr.h"
 #include "solarus/lowlevel/Point.h"
 #include "solarus/movements/FallingHeight.h"
 #include "solarus/SpritePtr.h"
 #include "solarus/Treasure.h"
-#include <memory>
 #include <string>
 
 namespace Solarus {
@@ -46,7 +46,7 @@ class Pickable: public Entity {
         const Treasure& treasure
     );
 
-    static std::shared_ptr<Pickable> create(
+    static IntrusivePtr<Pickable> create(
         Game& game,
         const std::string& name,
         int layer,
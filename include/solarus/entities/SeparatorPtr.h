@@ -17,21 +17,21 @@
 #ifndef SOLARUS_SEPARATOR_PTR_H
 #define SOLARUS_SEPARATOR_PTR_H
 
-#include <memory>
+#include "solarus/lowlevel/IntrusivePtr.h"
 
 namespace Solarus {
 
 class Separator;
 
 /**
- * \brief Alias for shared_ptr of Separator.
+ * \brief Alias for IntrusivePtr of Separator.
  */
-using SeparatorPtr = std::shared_ptr<Separator>;
+using SeparatorPtr = IntrusivePtr<Separator>;
 
 /**
- * \brief Alias for shared_ptr of const Separator.
+ * \brief Alias for IntrusivePtr of const Separator.
  */
-using ConstSeparatorPtr = std::shared_ptr<const Separator>;
+using ConstSeparatorPtr = IntrusivePtr<const Separator>;
 
 }
 
@@ -21,8 +21,8 @@
 #include "solarus/Treasure.h"
 #include "solarus/Sprite.h"
 #include "solarus/entities/Entity.h"
+#include "solarus/lowlevel/IntrusivePtr.h"
 #include "solarus/lowlevel/TextSurface.h"
-#include <memory>
 #include <string>
 
 struct lua_State;
@@ -53,7 +53,7 @@ class ShopTreasure: public Entity {
         const std::string& dialog_id
     );
 
-    static std::shared_ptr<ShopTreasure> create(
+    static IntrusivePtr<ShopTreasure> create(
         Game& game,
         const std::string& name,
         int layer,
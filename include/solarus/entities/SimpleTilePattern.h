@@ -43,6 +43,7 @@ class SimpleTilePattern: public TilePattern {
     ) const override;
 
     virtual bool is_animated() const override;
+    virtual void update_opacity(const Tileset& tileset) override;
 
   protected:
 
@@ -19,9 +19,9 @@
 
 #include "solarus/Common.h"
 #include "solarus/entities/EntityPtr.h"
+#include "solarus/lowlevel/IntrusivePtr.h"
 #include "solarus/lowlevel/Point.h"
 #include <cstdint>
-#include <memory>
 
 namespace Solarus {
 
@@ -55,7 +55,7 @@ class StreamAction {
     bool test_obstacles(int dx, int dy);
     bool has_reached_target() const;
 
-    std::shared_ptr<Stream>
+    IntrusivePtr<Stream>
         stream;                   /**< The stream applied,
                                    * or nullptr if it was destroyed. */
     EntityPtr entity_moved;       /**< The entity the stream is applied to,
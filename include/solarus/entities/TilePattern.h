@@ -46,6 +46,7 @@ class TilePattern {
     int get_height() const;
     const Size& get_size() const;
     Ground get_ground() const;
+    bool is_opaque() const;
 
     static void initialize();
     static void quit();
@@ -73,6 +74,8 @@ class TilePattern {
     ) const = 0;
     virtual bool is_animated() const;
     virtual bool is_drawn_at_its_position() const;
+    virtual int get_parallax_ratio() const;
+    virtual void update_opacity(const Tileset& tileset);
 
   protected:
 
@@ -82,6 +85,9 @@ class TilePattern {
 
     Size size;               /**< Pattern size (multiple of 8). */
 
+    bool opaque;             /**< Whether drawing this pattern at its position
+                              * fully covers what is below it. */
+
 };
 
 }
@@ -17,16 +17,16 @@
 #ifndef SOLARUS_TILE_PTR_H
 #define SOLARUS_TILE_PTR_H
 
-#include <memory>
+#include "solarus/lowlevel/IntrusivePtr.h"
 
 namespace Solarus {
 
 class Tile;
 
 /**
- * \brief Alias for shared_ptr of Tile.
+ * \brief Alias for IntrusivePtr of Tile.
  */
-using TilePtr = std::shared_ptr<Tile>;
+using TilePtr = IntrusivePtr<Tile>;
 
 }
 
@@ -59,6 +59,7 @@ class Tileset {
         const std::string& id,
         const TilePatternData& pattern_data
     );
+    void update_patterns_opacity();
 
     const std::string id;                             /**< id of the tileset */
     std::unordered_map<std::string, std::unique_ptr<TilePattern>>
@@ -73,6 +73,8 @@ class SOLARUS_API TilePatternData {
     TilePatternData();
     explicit TilePatternData(const Rectangle& frame);
 
+    static constexpr int default_parallax_ratio = 2;  /**< Parallax ratio when the data file sets none. */
+
     Ground get_ground() const;
     void set_ground(Ground ground);
 
@@ -82,6 +84,9 @@ class SOLARUS_API TilePatternData {
     TileScrolling get_scrolling() const;
     void set_scrolling(TileScrolling scrolling);
 
+    int get_parallax_ratio() const;
+    void set_parallax_ratio(int parallax_ratio);
+
     TilePatternRepeatMode get_repeat_mode() const;
     void set_repeat_mode(TilePatternRepeatMode repeat_mode);
 
@@ -98,6 +103,8 @@ class SOLARUS_API TilePatternData {
     Ground ground;                     /**< Terrain of this pattern. */
     int default_layer;                 /**< Initial layer when creating a tile. */
     TileScrolling scrolling;           /**< Kind of scrolling if any. */
+    int parallax_ratio;                /**< Distance made by the camera to move the pattern
+                                        * of 1 pixel in case of parallax scrolling. */
     TilePatternRepeatMode repeat_mode; /**< How this patterns intends to be repeated. */
     std::vector<Rectangle> frames;     /**< Coordinates of the pattern's frame(s).
                                         * - 1 element: one frame (no animation).
@@ -18,7 +18,7 @@
 #define SOLARUS_HERO_CARRYING_STATE_H
 
 #include "solarus/hero/PlayerMovementState.h"
-#include <memory>
+#include "solarus/lowlevel/IntrusivePtr.h"
 
 namespace Solarus {
 
@@ -29,7 +29,7 @@ class Hero::CarryingState: public Hero::PlayerMovementState {
 
   public:
 
-    CarryingState(Hero& hero, const std::shared_ptr<CarriedObject>& carried_object);
+    CarryingState(Hero& hero, const IntrusivePtr<CarriedObject>& carried_object);
 
     void start(const State* previous_state) override;
     void stop(const State* next_state) override;
@@ -44,14 +44,14 @@ class Hero::CarryingState: public Hero::PlayerMovementState {
     bool can_take_stairs() const override;
     void set_animation_stopped() override;
     void set_animation_walking() override;
-    std::shared_ptr<CarriedObject> get_carried_object() const override;
+    IntrusivePtr<CarriedObject> get_carried_object() const override;
     CarriedObject::Behavior get_previous_carried_object_behavior() const override;
 
   private:
 
     void throw_item();
 
-    std::shared_ptr<CarriedObject> carried_object;         /**< the item to carry */
+    IntrusivePtr<CarriedObject> carried_object;            /**< the item to carry */
 
 };
 
@@ -18,7 +18,7 @@
 #define SOLARUS_HERO_FORCED_WALKING_STATE_H
 
 #include "solarus/hero/HeroState.h"
-#include <memory>
+#include "solarus/lowlevel/IntrusivePtr.h"
 #include <string>
 
 namespace Solarus {
@@ -59,7 +59,7 @@ class Hero::ForcedWalkingState: public HeroState {
 
   private:
 
-    std::shared_ptr<PathMovement> movement;      /**< the movement applied to the hero */
+    IntrusivePtr<PathMovement> movement;         /**< the movement applied to the hero */
 
 };
 
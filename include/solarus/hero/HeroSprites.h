@@ -19,10 +19,11 @@
 
 #include "solarus/Common.h"
 #include "solarus/entities/Ground.h"
+#include "solarus/lowlevel/IntrusivePtr.h"
 #include "solarus/lowlevel/Rectangle.h"
+#include "solarus/lowlevel/Symbol.h"
 #include "solarus/lua/ScopedLuaRef.h"
 #include "solarus/SpritePtr.h"
-#include <memory>
 #include <string>
 
 namespace Solarus {
@@ -56,14 +57,14 @@ class HeroSprites {
     void notify_map_started();
     void notify_tileset_changed();
 
-    const std::string& get_tunic_sprite_id() const;
-    void set_tunic_sprite_id(const std::string& sprite_id);
-    const std::string& get_sword_sprite_id() const;
-    void set_sword_sprite_id(const std::string& sprite_id);
+    const Symbol& get_tunic_sprite_id() const;
+    void set_tunic_sprite_id(const Symbol& sprite_id);
+    const Symbol& get_sword_sprite_id() const;
+    void set_sword_sprite_id(const Symbol& sprite_id);
     const std::string& get_sword_sound_id() const;
     void set_sword_sound_id(const std::string& sound_id);
-    const std::string& get_shield_sprite_id() const;
-    void set_shield_sprite_id(const std::string& sprite_id);
+    const Symbol& get_shield_sprite_id() const;
+    void set_shield_sprite_id(const Symbol& sprite_id);
 
     Rectangle get_max_bounding_box() const;
 
@@ -88,8 +89,8 @@ class HeroSprites {
     void restore_animation_direction();
     void set_ignore_suspend(bool ignore_suspend);
 
-    bool has_tunic_animation(const std::string& animation) const;
-    const std::string& get_tunic_animation() const;
+    bool has_tunic_animation(const Symbol& animation) const;
+    const Symbol& get_tunic_animation() const;
 
     void set_animation_stopped_common();
     void set_animation_stopped_normal();
@@ -119,10 +120,10 @@ class HeroSprites {
     void set_animation_victory();
     void set_animation_prepare_running();
     void set_animation_running();
-    void set_animation_boomerang(const std::string& tunic_preparing_animation);
-    void set_animation(const std::string& animation);
+    void set_animation_boomerang(const Symbol& tunic_preparing_animation);
+    void set_animation(const Symbol& animation);
     void set_animation(
-        const std::string& animation,
+        const Symbol& animation,
         const ScopedLuaRef& callback_ref
     );
 
@@ -130,7 +131,7 @@ class HeroSprites {
     void destroy_ground();
     void play_ground_sound();
 
-    void set_lifted_item(const std::shared_ptr<CarriedObject>& lifted_item);
+    void set_lifted_item(const IntrusivePtr<CarriedObject>& lifted_item);
 
   private:
 
@@ -151,8 +152,8 @@ class HeroSprites {
     void stop_displaying_shield();
     void stop_displaying_trail();
 
-    void set_tunic_animation(const std::string& animation);
-    void set_tunic_animation(const std::string& animation, const ScopedLuaRef& callback_ref);
+    void set_tunic_animation(const Symbol& animation);
+    void set_tunic_animation(const Symbol& animation, const ScopedLuaRef& callback_ref);
 
     LuaContext& get_lua_context();
 
@@ -163,13 +164,13 @@ class HeroSprites {
     Equipment& equipment;                   /**< Equipment of the player. */
 
     // Tunic.
-    std::string tunic_sprite_id;            /**< Animation set used for the tunic.
+    Symbol tunic_sprite_id;                 /**< Animation set used for the tunic.
                                              * By default, "hero/tunicX" where X is the tunic level. */
     bool has_default_tunic_sprite;          /**< Whether tunic_sprite_id has the defaut value. */
     SpritePtr tunic_sprite;                 /**< sprite of the current tunic */
 
     // Sword.
-    std::string sword_sprite_id;            /**< Animation set used for the sword.
+    Symbol sword_sprite_id;                 /**< Animation set used for the sword.
                                              * An empty string means no sword sprite.
                                              * By default, "hero/swordX" where X is the sword level. */
     bool has_default_sword_sprite;          /**< Whether sword_sprite_id has the defaut value. */
@@ -181,7 +182,7 @@ class HeroSprites {
     bool has_default_sword_sound;           /**< Whether sword_sound_id has the defaut value. */
 
     // Shield.
-    std::string shield_sprite_id;           /**< Animation set used for the shield.
+    Symbol shield_sprite_id;                /**< Animation set used for the shield.
                                              * An empty string means no shield sprite.
                                              * By default, "hero/shieldX" where X is the shield level. */
     bool has_default_shield_sprite;         /**< Whether shield_sprite_id has the defaut value. */
@@ -212,7 +213,7 @@ class HeroSprites {
     Rectangle clipping_rectangle;           /**< when drawing the sprites onto a map, indicates an area of the map to be restricted to
                                              * (usually, the whole map is considered and this rectangle's values are all 0) */
 
-    std::shared_ptr<CarriedObject>
+    IntrusivePtr<CarriedObject>
         lifted_item;                        /**< if not nullptr, an item to display above the hero */
 
     ScopedLuaRef animation_callback_ref;    /**< Lua ref of a function to call when a custom animation ends. */
@@ -18,7 +18,7 @@
 #define SOLARUS_HERO_HOOKSHOT_STATE_H
 
 #include "solarus/hero/HeroState.h"
-#include <memory>
+#include "solarus/lowlevel/IntrusivePtr.h"
 
 namespace Solarus {
 
@@ -56,7 +56,7 @@ class Hero::HookshotState: public HeroState {
 
     void finish_movement();
 
-    std::shared_ptr<Hookshot> hookshot;     /**< the hookshot thrown by the hero */
+    IntrusivePtr<Hookshot> hookshot;        /**< the hookshot thrown by the hero */
 };
 
 }
@@ -18,7 +18,7 @@
 #define SOLARUS_HERO_JUMPING_STATE_H
 
 #include "solarus/hero/HeroState.h"
-#include <memory>
+#include "solarus/lowlevel/IntrusivePtr.h"
 
 namespace Solarus {
 
@@ -61,16 +61,16 @@ class Hero::JumpingState: public HeroState {
     virtual bool can_avoid_sensor() const override;
     virtual bool can_avoid_switch() const override;
     virtual bool can_be_hurt(Entity* attacker) const override;
-    virtual std::shared_ptr<CarriedObject> get_carried_object() const override;
+    virtual IntrusivePtr<CarriedObject> get_carried_object() const override;
     virtual CarriedObject::Behavior get_previous_carried_object_behavior() const override;
 
   private:
 
-    std::shared_ptr<JumpMovement>
+    IntrusivePtr<JumpMovement>
         movement;                 /**< the movement applied to the hero */
     int direction8;               /**< direction of the jump (0 to 7) */
     bool with_sound;              /**< indicates that a jump sound is played */
-    std::shared_ptr<CarriedObject>
+    IntrusivePtr<CarriedObject>
         carried_object;             /**< an item carried by the hero while making
                                    * this jump, or nullptr */
 
@@ -18,7 +18,7 @@
 #define SOLARUS_HERO_LIFTING_STATE_H
 
 #include "solarus/entities/EntityState.h"
-#include <memory>
+#include "solarus/lowlevel/IntrusivePtr.h"
 
 namespace Solarus {
 
@@ -29,7 +29,7 @@ class Hero::LiftingState: public HeroState {
 
   public:
 
-    LiftingState(Hero& hero, const std::shared_ptr<CarriedObject>& lifted_item);
+    LiftingState(Hero& hero, const IntrusivePtr<CarriedObject>& lifted_item);
 
     virtual void start(const State* previous_state) override;
     virtual void stop(const State* next_state) override;
@@ -41,7 +41,7 @@ class Hero::LiftingState: public HeroState {
 
     void throw_item();
 
-    std::shared_ptr<CarriedObject> lifted_item;    /**< the item currently being lifted */
+    IntrusivePtr<CarriedObject> lifted_item;       /**< the item currently being lifted */
 };
 
 }
@@ -19,8 +19,8 @@
 
 #include "solarus/Common.h"
 #include "solarus/hero/HeroState.h"
+#include "solarus/lowlevel/IntrusivePtr.h"
 #include <cstdint>
-#include <memory>
 #include <string>
 
 namespace Solarus {
@@ -65,18 +65,18 @@ class Hero::PlayerMovementState: public HeroState {
 
     PlayerMovementState(Hero& hero, const std::string& state_name);
 
-    const std::shared_ptr<PlayerMovement>& get_player_movement();
-    std::shared_ptr<const PlayerMovement> get_player_movement() const;
+    const IntrusivePtr<PlayerMovement>& get_player_movement();
+    IntrusivePtr<const PlayerMovement> get_player_movement() const;
 
   private:
 
     void cancel_jumper();
 
-    std::shared_ptr<PlayerMovement>
+    IntrusivePtr<PlayerMovement>
         player_movement;               /**< The movement created by this state.
                                         * The movement of the hero is also this object,
                                         * unless a script decided to change it. */
-    std::shared_ptr<Jumper>
+    IntrusivePtr<Jumper>
         current_jumper;                /**< The jumper about to be triggered or nullptr */
     uint32_t jumper_start_date;        /**< Date to trigger the jumper
                                         * (because a small delay is necessary) */
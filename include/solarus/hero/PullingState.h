@@ -18,7 +18,7 @@
 #define SOLARUS_HERO_PULLING_STATE_H
 
 #include "solarus/hero/HeroState.h"
-#include <memory>
+#include "solarus/lowlevel/IntrusivePtr.h"
 
 namespace Solarus {
 
@@ -58,7 +58,7 @@ class Hero::PullingState: public HeroState {
     void stop_moving_pulled_entity();
 
     Entity* pulled_entity;             /**< The entity the hero is pulling (or nullptr). */
-    std::shared_ptr<PathMovement>
+    IntrusivePtr<PathMovement>
         pulling_movement;              /**< The movement created by this state.
                                         * The movement of the hero is also this object,
                                         * unless a script decided to change it. */
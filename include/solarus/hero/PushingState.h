@@ -18,7 +18,7 @@
 #define SOLARUS_HERO_PUSHING_STATE_H
 
 #include "solarus/hero/HeroState.h"
-#include <memory>
+#include "solarus/lowlevel/IntrusivePtr.h"
 
 namespace Solarus {
 
@@ -58,7 +58,7 @@ class Hero::PushingState: public HeroState {
 
     int pushing_direction4;            /**< Direction where the hero is looking (0 to 3). */
     Entity* pushed_entity;             /**< The entity the hero is pushing or nullptr. */
-    std::shared_ptr<PathMovement>
+    IntrusivePtr<PathMovement>
         pushing_movement;              /**< The movement created by this state.
                                         * The movement of the hero is also this object,
                                         * unless a script decided to change it. */
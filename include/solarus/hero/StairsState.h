@@ -19,8 +19,8 @@
 
 #include "solarus/entities/Stairs.h"
 #include "solarus/hero/HeroState.h"
+#include "solarus/lowlevel/IntrusivePtr.h"
 #include <cstdint>
-#include <memory>
 
 namespace Solarus {
 
@@ -33,7 +33,7 @@ class Hero::StairsState: public HeroState {
 
     StairsState(
         Hero& hero,
-        const std::shared_ptr<const Stairs>& stairs,
+        const IntrusivePtr<const Stairs>& stairs,
         Stairs::Way way
     );
 
@@ -47,13 +47,13 @@ class Hero::StairsState: public HeroState {
     virtual bool can_come_from_bad_ground() const override;
     virtual bool is_teletransporter_delayed() const override;
     virtual int get_wanted_movement_direction8() const override;
-    virtual std::shared_ptr<CarriedObject> get_carried_object() const override;
+    virtual IntrusivePtr<CarriedObject> get_carried_object() const override;
     virtual CarriedObject::Behavior get_previous_carried_object_behavior() const override;
     virtual void notify_layer_changed() override;
 
   private:
 
-    std::shared_ptr<const Stairs>
+    IntrusivePtr<const Stairs>
         stairs;                        /**< The stairs the hero is currently taking. */
     Stairs::Way way;                   /**< indicates the way the hero is taking the stairs:
                                         * - for stairs inside a single floor, NORMAL_WAY means that the hero is going upstairs
@@ -64,7 +64,7 @@ class Hero::StairsState: public HeroState {
                                         * phase of the animations (0: not started, 1: initial animation,
                                         * 2: diagonal animation, 3: final animation) */
     uint32_t next_phase_date;          /**< date when the stairs phase changes */
-    std::shared_ptr<CarriedObject>
+    IntrusivePtr<CarriedObject>
         carried_object;                  /**< an item carried by the hero while taking the stairs, or nullptr */
 
 };
@@ -71,6 +71,8 @@ class FontResource {
      */
     struct FontFile {
       std::string file_name;                          /**< Name of the font file, relative to the data directory. */
+      bool is_bitmap;                                 /**< Whether this is a bitmap font or an outline font. */
+      bool loaded;                                    /**< Whether the content of the file is loaded. */
       std::string buffer;                             /**< The font file loaded into memory. */
 
       SurfacePtr bitmap_font;                         /**< The font bitmap. Only used for bitmap fonts. */
@@ -80,6 +82,7 @@ class FontResource {
     };
 
     static void load_fonts();
+    static FontFile& get_font_file(const std::string& font_id);
 
     static bool fonts_loaded;
     static std::map<std::string, FontFile> fonts;
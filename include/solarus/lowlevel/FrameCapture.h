@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_FRAME_CAPTURE_H
+#define SOLARUS_FRAME_CAPTURE_H
+
+#include "solarus/Common.h"
+#include <string>
+
+namespace Solarus {
+
+class Arguments;
+class Surface;
+
+/**
+ * \brief Records rendered frames of the quest surface to image files.
+ *
+ * Each captured frame is copied into one of a few preallocated buffers
+ * and written to disk by a separate thread, so that the main loop never
+ * waits for image compression.
+ * If all buffers are still being written, the frame is dropped and counted.
+ *
+ * Capturing works with -no-video too, which allows visual regression tests
+ * on machines without a display.
+ */
+class SOLARUS_API FrameCapture {
+
+  public:
+
+    /**
+     * \brief File formats of captured frames.
+     */
+    enum class Format {
+      PNG,     /**< One PNG file per frame. */
+      RAW      /**< One file per frame with RGBA bytes and no header. */
+    };
+
+    static void initialize(const Arguments& args);
+    static void quit();
+
+    static bool is_capturing();
+    static bool start(const std::string& capture_directory, Format capture_format);
+    static void stop();
+
+    static void capture(const Surface& surface);
+
+};
+
+}
+
+#endif
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_INTRUSIVE_PTR_H
+#define SOLARUS_INTRUSIVE_PTR_H
+
+#include "solarus/Common.h"
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+namespace Solarus {
+
+/**
+ * \brief Shared state between an object and its weak handles.
+ *
+ * It is created the first time a weak handle to the object is needed,
+ * and lives until both the object and all its weak handles are gone.
+ */
+struct IntrusiveWeakLink {
+
+  bool alive;         /**< Whether the object still exists. */
+  int count;          /**< Number of weak handles, plus one while the object
+                       * exists. */
+
+};
+
+/**
+ * \brief Reference-counted handle to an object that stores its own counter.
+ *
+ * This is a lighter replacement of std::shared_ptr for engine objects.
+ * Copying a handle only increments a plain integer stored in the object
+ * itself: there is no separate control block and no atomic operation.
+ * As a consequence, handles to a given object must only be copied or
+ * destroyed from one thread at a time.
+ *
+ * Because the counter is in the object, a new handle can be created at
+ * any time from a raw pointer to an object already owned by other handles.
+ *
+ * T must provide the following const functions:
+ * - void add_reference(): increments the counter,
+ * - void remove_reference(): decrements the counter and destroys the
+ *   object when it reaches zero,
+ * - IntrusiveWeakLink* get_weak_link(): returns the weak link of the
+ *   object, only required by IntrusiveWeakPtr.
+ *
+ * \param T Type of the object.
+ */
+template<typename T>
+class IntrusivePtr {
+
+  public:
+
+    using element_type = T;
+
+    IntrusivePtr() noexcept;
+    IntrusivePtr(std::nullptr_t) noexcept;
+    explicit IntrusivePtr(T* object);
+    IntrusivePtr(const IntrusivePtr& other);
+    IntrusivePtr(IntrusivePtr&& other) noexcept;
+    template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+    IntrusivePtr(const IntrusivePtr<U>& other);
+    template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+    IntrusivePtr(IntrusivePtr<U>&& other) noexcept;
+    ~IntrusivePtr();
+
+    IntrusivePtr& operator=(const IntrusivePtr& other);
+    IntrusivePtr& operator=(IntrusivePtr&& other) noexcept;
+    template<typename U>
+    IntrusivePtr& operator=(const IntrusivePtr<U>& other);
+    template<typename U>
+    IntrusivePtr& operator=(IntrusivePtr<U>&& other) noexcept;
+    IntrusivePtr& operator=(std::nullptr_t);
+
+    void reset();
+    void reset(T* object);
+    void swap(IntrusivePtr& other) noexcept;
+
+    T* get() const noexcept;
+    T& operator*() const noexcept;
+    T* operator->() const noexcept;
+    explicit operator bool() const noexcept;
+
+  private:
+
+    template<typename U>
+    friend class IntrusivePtr;
+
+    T* object;          /**< The object or nullptr. */
+
+};
+
+/**
+ * \brief Non-owning handle to an object managed by IntrusivePtr.
+ *
+ * It does not keep the object alive but knows when it is destroyed.
+ *
+ * \param T Type of the object.
+ */
+template<typename T>
+class IntrusiveWeakPtr {
+
+  public:
+
+    IntrusiveWeakPtr() noexcept;
+    template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+    IntrusiveWeakPtr(const IntrusivePtr<U>& ptr);
+    IntrusiveWeakPtr(const IntrusiveWeakPtr& other) noexcept;
+    IntrusiveWeakPtr(IntrusiveWeakPtr&& other) noexcept;
+    ~IntrusiveWeakPtr();
+
+    IntrusiveWeakPtr& operator=(const IntrusiveWeakPtr& other) noexcept;
+    IntrusiveWeakPtr& operator=(IntrusiveWeakPtr&& other) noexcept;
+
+    void reset() noexcept;
+    void swap(IntrusiveWeakPtr& other) noexcept;
+
+    bool expired() const noexcept;
+    IntrusivePtr<T> lock() const;
+
+  private:
+
+    T* object;                  /**< The object, only valid if not expired. */
+    IntrusiveWeakLink* link;    /**< Weak link of the object or nullptr. */
+
+};
+
+template<typename T, typename... Args>
+IntrusivePtr<T> make_intrusive(Args&&... args);
+
+template<typename T, typename U>
+IntrusivePtr<T> static_pointer_cast(const IntrusivePtr<U>& ptr);
+template<typename T, typename U>
+IntrusivePtr<T> dynamic_pointer_cast(const IntrusivePtr<U>& ptr);
+template<typename T, typename U>
+IntrusivePtr<T> const_pointer_cast(const IntrusivePtr<U>& ptr);
+
+// Comparison operators
+template<typename T, typename U>
+bool operator==(const IntrusivePtr<T>& lhs, const IntrusivePtr<U>& rhs) noexcept;
+template<typename T, typename U>
+bool operator!=(const IntrusivePtr<T>& lhs, const IntrusivePtr<U>& rhs) noexcept;
+template<typename T, typename U>
+bool operator<(const IntrusivePtr<T>& lhs, const IntrusivePtr<U>& rhs) noexcept;
+template<typename T>
+bool operator==(const IntrusivePtr<T>& lhs, std::nullptr_t) noexcept;
+template<typename T>
+bool operator==(std::nullptr_t, const IntrusivePtr<T>& rhs) noexcept;
+template<typename T>
+bool operator!=(const IntrusivePtr<T>& lhs, std::nullptr_t) noexcept;
+template<typename T>
+bool operator!=(std::nullptr_t, const IntrusivePtr<T>& rhs) noexcept;
+
+}
+
+namespace std {
+
+/**
+ * \brief Hash function of IntrusivePtr, for unordered containers.
+ */
+template<typename T>
+struct hash<Solarus::IntrusivePtr<T>> {
+  size_t operator()(const Solarus::IntrusivePtr<T>& ptr) const noexcept {
+    return hash<T*>()(ptr.get());
+  }
+};
+
+}
+
+#include "solarus/lowlevel/IntrusivePtr.inl"
+
+#endif
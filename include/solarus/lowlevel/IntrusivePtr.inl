@@ -0,0 +1,488 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <utility>
+
+namespace Solarus {
+
+////////////////////////////////////////////////////////////
+// IntrusivePtr methods
+
+/**
+ * \brief Creates an empty handle.
+ */
+template<typename T>
+inline IntrusivePtr<T>::IntrusivePtr() noexcept:
+  object(nullptr) {
+}
+
+/**
+ * \brief Creates an empty handle.
+ */
+template<typename T>
+inline IntrusivePtr<T>::IntrusivePtr(std::nullptr_t) noexcept:
+  object(nullptr) {
+}
+
+/**
+ * \brief Creates a handle to an object.
+ * \param object The object or nullptr. It may already have other handles.
+ */
+template<typename T>
+inline IntrusivePtr<T>::IntrusivePtr(T* object):
+  object(object) {
+
+  if (object != nullptr) {
+    object->add_reference();
+  }
+}
+
+/**
+ * \brief Copy constructor.
+ * \param other The handle to copy.
+ */
+template<typename T>
+inline IntrusivePtr<T>::IntrusivePtr(const IntrusivePtr& other):
+  IntrusivePtr(other.object) {
+}
+
+/**
+ * \brief Move constructor.
+ * \param other The handle to move. It becomes empty.
+ */
+template<typename T>
+inline IntrusivePtr<T>::IntrusivePtr(IntrusivePtr&& other) noexcept:
+  object(other.object) {
+
+  other.object = nullptr;
+}
+
+/**
+ * \brief Creates a handle from a handle to a derived type.
+ * \param other The handle to copy.
+ */
+template<typename T>
+template<typename U, typename>
+inline IntrusivePtr<T>::IntrusivePtr(const IntrusivePtr<U>& other):
+  IntrusivePtr(other.object) {
+}
+
+/**
+ * \brief Moves a handle to a derived type into a new handle.
+ * \param other The handle to move. It becomes empty.
+ */
+template<typename T>
+template<typename U, typename>
+inline IntrusivePtr<T>::IntrusivePtr(IntrusivePtr<U>&& other) noexcept:
+  object(other.object) {
+
+  other.object = nullptr;
+}
+
+/**
+ * \brief Destructor.
+ *
+ * Destroys the object if this was its last handle.
+ */
+template<typename T>
+inline IntrusivePtr<T>::~IntrusivePtr() {
+
+  if (object != nullptr) {
+    object->remove_reference();
+  }
+}
+
+/**
+ * \brief Assignment operator.
+ * \param other The handle to copy.
+ * \return This handle.
+ */
+template<typename T>
+inline IntrusivePtr<T>& IntrusivePtr<T>::operator=(const IntrusivePtr& other) {
+
+  IntrusivePtr(other).swap(*this);
+  return *this;
+}
+
+/**
+ * \brief Move assignment operator.
+ * \param other The handle to move. It becomes empty.
+ * \return This handle.
+ */
+template<typename T>
+inline IntrusivePtr<T>& IntrusivePtr<T>::operator=(IntrusivePtr&& other) noexcept {
+
+  IntrusivePtr(std::move(other)).swap(*this);
+  return *this;
+}
+
+/**
+ * \brief Assigns a handle to a derived type.
+ * \param other The handle to copy.
+ * \return This handle.
+ */
+template<typename T>
+template<typename U>
+inline IntrusivePtr<T>& IntrusivePtr<T>::operator=(const IntrusivePtr<U>& other) {
+
+  IntrusivePtr(other).swap(*this);
+  return *this;
+}
+
+/**
+ * \brief Moves a handle to a derived type into this one.
+ * \param other The handle to move. It becomes empty.
+ * \return This handle.
+ */
+template<typename T>
+template<typename U>
+inline IntrusivePtr<T>& IntrusivePtr<T>::operator=(IntrusivePtr<U>&& other) noexcept {
+
+  IntrusivePtr(std::move(other)).swap(*this);
+  return *this;
+}
+
+/**
+ * \brief Makes this handle empty.
+ * \return This handle.
+ */
+template<typename T>
+inline IntrusivePtr<T>& IntrusivePtr<T>::operator=(std::nullptr_t) {
+
+  reset();
+  return *this;
+}
+
+/**
+ * \brief Makes this handle empty.
+ */
+template<typename T>
+inline void IntrusivePtr<T>::reset() {
+
+  IntrusivePtr().swap(*this);
+}
+
+/**
+ * \brief Makes this handle point to another object.
+ * \param object The object or nullptr.
+ */
+template<typename T>
+inline void IntrusivePtr<T>::reset(T* object) {
+
+  IntrusivePtr(object).swap(*this);
+}
+
+/**
+ * \brief Exchanges the objects of two handles.
+ * \param other Another handle.
+ */
+template<typename T>
+inline void IntrusivePtr<T>::swap(IntrusivePtr& other) noexcept {
+
+  std::swap(object, other.object);
+}
+
+/**
+ * \brief Returns the object.
+ * \return The object or nullptr.
+ */
+template<typename T>
+inline T* IntrusivePtr<T>::get() const noexcept {
+  return object;
+}
+
+/**
+ * \brief Returns the object.
+ * \return The object. The handle must not be empty.
+ */
+template<typename T>
+inline T& IntrusivePtr<T>::operator*() const noexcept {
+  return *object;
+}
+
+/**
+ * \brief Returns the object.
+ * \return The object. The handle must not be empty.
+ */
+template<typename T>
+inline T* IntrusivePtr<T>::operator->() const noexcept {
+  return object;
+}
+
+/**
+ * \brief Returns whether this handle is not empty.
+ * \return \c true if there is an object.
+ */
+template<typename T>
+inline IntrusivePtr<T>::operator bool() const noexcept {
+  return object != nullptr;
+}
+
+////////////////////////////////////////////////////////////
+// IntrusiveWeakPtr methods
+
+/**
+ * \brief Creates an expired weak handle.
+ */
+template<typename T>
+inline IntrusiveWeakPtr<T>::IntrusiveWeakPtr() noexcept:
+  object(nullptr),
+  link(nullptr) {
+}
+
+/**
+ * \brief Creates a weak handle to the object of a handle.
+ * \param ptr The handle. If empty, the weak handle is expired.
+ */
+template<typename T>
+template<typename U, typename>
+inline IntrusiveWeakPtr<T>::IntrusiveWeakPtr(const IntrusivePtr<U>& ptr):
+  object(ptr.get()),
+  link(object != nullptr ? object->get_weak_link() : nullptr) {
+
+  if (link != nullptr) {
+    ++link->count;
+  }
+}
+
+/**
+ * \brief Copy constructor.
+ * \param other The weak handle to copy.
+ */
+template<typename T>
+inline IntrusiveWeakPtr<T>::IntrusiveWeakPtr(const IntrusiveWeakPtr& other) noexcept:
+  object(other.object),
+  link(other.link) {
+
+  if (link != nullptr) {
+    ++link->count;
+  }
+}
+
+/**
+ * \brief Move constructor.
+ * \param other The weak handle to move. It becomes expired.
+ */
+template<typename T>
+inline IntrusiveWeakPtr<T>::IntrusiveWeakPtr(IntrusiveWeakPtr&& other) noexcept:
+  object(other.object),
+  link(other.link) {
+
+  other.object = nullptr;
+  other.link = nullptr;
+}
+
+/**
+ * \brief Destructor.
+ */
+template<typename T>
+inline IntrusiveWeakPtr<T>::~IntrusiveWeakPtr() {
+
+  if (link != nullptr && --link->count == 0) {
+    delete link;
+  }
+}
+
+/**
+ * \brief Assignment operator.
+ * \param other The weak handle to copy.
+ * \return This weak handle.
+ */
+template<typename T>
+inline IntrusiveWeakPtr<T>& IntrusiveWeakPtr<T>::operator=(const IntrusiveWeakPtr& other) noexcept {
+
+  IntrusiveWeakPtr(other).swap(*this);
+  return *this;
+}
+
+/**
+ * \brief Move assignment operator.
+ * \param other The weak handle to move. It becomes expired.
+ * \return This weak handle.
+ */
+template<typename T>
+inline IntrusiveWeakPtr<T>& IntrusiveWeakPtr<T>::operator=(IntrusiveWeakPtr&& other) noexcept {
+
+  IntrusiveWeakPtr(std::move(other)).swap(*this);
+  return *this;
+}
+
+/**
+ * \brief Makes this weak handle expired.
+ */
+template<typename T>
+inline void IntrusiveWeakPtr<T>::reset() noexcept {
+
+  IntrusiveWeakPtr().swap(*this);
+}
+
+/**
+ * \brief Exchanges the objects of two weak handles.
+ * \param other Another weak handle.
+ */
+template<typename T>
+inline void IntrusiveWeakPtr<T>::swap(IntrusiveWeakPtr& other) noexcept {
+
+  std::swap(object, other.object);
+  std::swap(link, other.link);
+}
+
+/**
+ * \brief Returns whether the object no longer exists.
+ * \return \c true if the object was destroyed or if there was no object.
+ */
+template<typename T>
+inline bool IntrusiveWeakPtr<T>::expired() const noexcept {
+  return link == nullptr || !link->alive;
+}
+
+/**
+ * \brief Returns a handle to the object if it still exists.
+ * \return A handle to the object, or an empty handle if it was destroyed.
+ */
+template<typename T>
+inline IntrusivePtr<T> IntrusiveWeakPtr<T>::lock() const {
+
+  if (expired()) {
+    return nullptr;
+  }
+  return IntrusivePtr<T>(object);
+}
+
+////////////////////////////////////////////////////////////
+// Free functions
+
+/**
+ * \brief Creates an object and returns a handle to it.
+ * \param args Arguments of the constructor of T.
+ * \return The handle.
+ */
+template<typename T, typename... Args>
+inline IntrusivePtr<T> make_intrusive(Args&&... args) {
+  return IntrusivePtr<T>(new T(std::forward<Args>(args)...));
+}
+
+/**
+ * \brief Equivalent of std::static_pointer_cast for IntrusivePtr.
+ * \param ptr The handle to convert.
+ * \return A handle of the requested type to the same object.
+ */
+template<typename T, typename U>
+inline IntrusivePtr<T> static_pointer_cast(const IntrusivePtr<U>& ptr) {
+  return IntrusivePtr<T>(static_cast<T*>(ptr.get()));
+}
+
+/**
+ * \brief Equivalent of std::dynamic_pointer_cast for IntrusivePtr.
+ * \param ptr The handle to convert.
+ * \return A handle of the requested type to the same object,
+ * or an empty handle if the object does not have this type.
+ */
+template<typename T, typename U>
+inline IntrusivePtr<T> dynamic_pointer_cast(const IntrusivePtr<U>& ptr) {
+  return IntrusivePtr<T>(dynamic_cast<T*>(ptr.get()));
+}
+
+/**
+ * \brief Equivalent of std::const_pointer_cast for IntrusivePtr.
+ * \param ptr The handle to convert.
+ * \return A handle of the requested type to the same object.
+ */
+template<typename T, typename U>
+inline IntrusivePtr<T> const_pointer_cast(const IntrusivePtr<U>& ptr) {
+  return IntrusivePtr<T>(const_cast<T*>(ptr.get()));
+}
+
+/**
+ * \brief Returns whether two handles point to the same object.
+ * \param lhs A handle.
+ * \param rhs Another handle.
+ * \return \c true if the objects are the same.
+ */
+template<typename T, typename U>
+inline bool operator==(const IntrusivePtr<T>& lhs, const IntrusivePtr<U>& rhs) noexcept {
+  return lhs.get() == rhs.get();
+}
+
+/**
+ * \brief Returns whether two handles point to different objects.
+ * \param lhs A handle.
+ * \param rhs Another handle.
+ * \return \c true if the objects are different.
+ */
+template<typename T, typename U>
+inline bool operator!=(const IntrusivePtr<T>& lhs, const IntrusivePtr<U>& rhs) noexcept {
+  return lhs.get() != rhs.get();
+}
+
+/**
+ * \brief Compares the addresses of the objects of two handles.
+ *
+ * This gives the same total order as std::shared_ptr, so that handles
+ * can be stored in sorted containers.
+ *
+ * \param lhs A handle.
+ * \param rhs Another handle.
+ * \return \c true if the first object is before the second one in memory.
+ */
+template<typename T, typename U>
+inline bool operator<(const IntrusivePtr<T>& lhs, const IntrusivePtr<U>& rhs) noexcept {
+
+  using Pointer = typename std::common_type<T*, U*>::type;
+  return std::less<Pointer>()(lhs.get(), rhs.get());
+}
+
+/**
+ * \brief Returns whether a handle is empty.
+ * \param lhs A handle.
+ * \return \c true if there is no object.
+ */
+template<typename T>
+inline bool operator==(const IntrusivePtr<T>& lhs, std::nullptr_t) noexcept {
+  return lhs.get() == nullptr;
+}
+
+/**
+ * \brief Returns whether a handle is empty.
+ * \param rhs A handle.
+ * \return \c true if there is no object.
+ */
+template<typename T>
+inline bool operator==(std::nullptr_t, const IntrusivePtr<T>& rhs) noexcept {
+  return rhs.get() == nullptr;
+}
+
+/**
+ * \brief Returns whether a handle is not empty.
+ * \param lhs A handle.
+ * \return \c true if there is an object.
+ */
+template<typename T>
+inline bool operator!=(const IntrusivePtr<T>& lhs, std::nullptr_t) noexcept {
+  return lhs.get() != nullptr;
+}
+
+/**
+ * \brief Returns whether a handle is not empty.
+ * \param rhs A handle.
+ * \return \c true if there is an object.
+ */
+template<typename T>
+inline bool operator!=(std::nullptr_t, const IntrusivePtr<T>& rhs) noexcept {
+  return rhs.get() != nullptr;
+}
+
+}
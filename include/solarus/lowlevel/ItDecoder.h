@@ -34,6 +34,8 @@ class ItDecoder {
 
   public:
 
+    static void initialize();
+
     ItDecoder();
 
     void load(const std::string& sound_buffer);
@@ -20,6 +20,8 @@
 #include "solarus/Common.h"
 #include "solarus/lowlevel/Sound.h"
 #include "solarus/lua/ScopedLuaRef.h"
+#include <cstdint>
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
@@ -35,7 +37,13 @@ class SpcDecoder;
  *
  * A music should be in format .spc (Snes), .it (Impulse Tracker module) or .ogg.
  * The .mp3 format will probably be supported in a future version.
- * Only one music can be played at the same time.
+ * Only one music can be played at the same time, except during a crossfade.
+ *
+ * The file of a music can be read and its first buffers decoded in advance
+ * with preload(), on a background thread except for IT musics, so that
+ * starting it later only needs to hand the decoded buffers to the audio
+ * system.
+ *
  * Before using this class, the audio system should have been
  * initialized, by calling Sound::initialize().
  * Sound and Music are the only classes that depends on audio libraries.
@@ -90,9 +98,22 @@ class SOLARUS_API Music {
     );
     static void stop_playing();
     static const std::string& get_current_music_id();
+    static void preload(const std::string& music_id);
+    static const std::string& get_preloaded_music_id();
+    static uint32_t get_crossfade_duration();
+    static void set_crossfade_duration(uint32_t crossfade_duration);
 
   private:
 
+    /**
+     * \brief A chunk of decoded PCM data to put in a streaming buffer.
+     */
+    struct DecodedChunk {
+      std::vector<ALshort> samples;              /**< 16-bit PCM data. */
+      ALenum al_format = AL_NONE;                /**< OpenAL format of the data. */
+      ALsizei sample_rate = 0;                   /**< Sample rate in Hz. */
+    };
+
     Music();
     Music(
         const std::string& music_id,
@@ -100,17 +121,25 @@ class SOLARUS_API Music {
         const ScopedLuaRef& callback_ref
     );
 
+    bool prepare();
     bool start();
     void stop();
     bool is_paused();
     void set_paused(bool pause);
     void set_callback(const ScopedLuaRef& callback_ref);
 
-    void decode_spc(ALuint destination_buffer, ALsizei nb_samples);
-    void decode_it(ALuint destination_buffer, ALsizei nb_samples);
-    void decode_ogg(ALuint destination_buffer, ALsizei nb_samples);
+    bool decode(DecodedChunk& chunk, ALsizei nb_samples);
+    void decode_spc(DecodedChunk& chunk, ALsizei nb_samples);
+    void decode_it(DecodedChunk& chunk, ALsizei nb_samples);
+    bool decode_ogg(DecodedChunk& chunk, ALsizei nb_samples);
+    void fill_buffer(ALuint destination_buffer, const DecodedChunk& chunk);
 
     bool update_playing();
+    void start_fade(bool fade_in);
+    bool update_fade();
+    void update_gain();
+
+    static void cancel_preload();
 
     std::string id;                              /**< id of this music */
     std::string file_name;                       /**< name of the file to play */
@@ -121,16 +150,34 @@ class SOLARUS_API Music {
     static constexpr int nb_buffers = 8;
     ALuint buffers[nb_buffers];                  /**< multiple buffers used to stream the music */
     ALuint source;                               /**< the OpenAL source streaming the buffers */
-
-    static std::unique_ptr<SpcDecoder>
-        spc_decoder;                             /**< The SPC decoder. */
-    static std::unique_ptr<ItDecoder>
-        it_decoder;                              /**< The IT decoder. */
-    static std::unique_ptr<OggDecoder>
-        ogg_decoder;                             /**< The OGG decoder. */
+    std::unique_ptr<SpcDecoder>
+        spc_decoder;                             /**< The SPC decoder of this music if any. */
+    std::unique_ptr<ItDecoder>
+        it_decoder;                              /**< The IT decoder of this music if any. */
+    std::unique_ptr<OggDecoder>
+        ogg_decoder;                             /**< The OGG decoder of this music if any. */
+    std::vector<DecodedChunk>
+        prepared_chunks;                         /**< Chunks decoded by prepare() for the
+                                                  * initial buffers, empty once started. */
+    DecodedChunk streaming_chunk;                /**< Chunk reused while streaming. */
+    std::string error_message;                   /**< Problem detected by prepare(),
+                                                  * reported later on the main thread. */
+    uint32_t fade_start_date;                    /**< When the current fade started. */
+    uint32_t fade_duration;                      /**< Duration of the current fade or 0. */
+    bool fading_in;                              /**< Whether the current fade is a fade-in. */
+
+    static bool initialized;                     /**< Whether the music system is initialized. */
     static float volume;                         /**< volume of musics (0.0 to 1.0) */
+    static uint32_t crossfade_duration;          /**< Duration of crossfades in
+                                                  * milliseconds, 0 means no crossfade. */
 
     static std::unique_ptr<Music> current_music; /**< the music currently played (if any) */
+    static std::unique_ptr<Music>
+        fading_out_music;                        /**< Previous music still fading out (if any). */
+    static std::unique_ptr<Music>
+        preloaded_music;                         /**< Music being prepared in the background (if any). */
+    static std::future<bool>
+        preloaded_music_ready;                   /**< Result of the background preparation. */
 
 };
 
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_SOFTWARE_BLITTER_H
+#define SOLARUS_SOFTWARE_BLITTER_H
+
+#include "solarus/Common.h"
+#include "solarus/lowlevel/BlendMode.h"
+#include <SDL.h>
+#include <cstdint>
+
+namespace Solarus {
+
+class Color;
+class Point;
+class Rectangle;
+
+/**
+ * \brief Draws 32-bit software surfaces onto each other.
+ *
+ * Replaces SDL's generic blitters for the operations that dominate
+ * software rendering: opaque copy, alpha blending, additive and
+ * multiplicative blending, and color fills.
+ * Rows of pixels are processed with SSE2 or NEON instructions when
+ * available, computing premultiplied colors in registers so that surfaces
+ * keep their usual straight-alpha format.
+ *
+ * 8-bit indexed sources are expanded on the fly through their palette.
+ *
+ * Each function returns \c false without drawing anything if the surfaces
+ * are not supported. The caller should then use SDL instead.
+ */
+class SOLARUS_API SoftwareBlitter {
+
+  public:
+
+    static bool blit(
+        SDL_Surface& src_surface,
+        const Rectangle& region,
+        SDL_Surface& dst_surface,
+        const Point& dst_position,
+        BlendMode blend_mode,
+        const uint32_t* palette = nullptr
+    );
+
+    static bool blit_scaled(
+        SDL_Surface& src_surface,
+        int scale,
+        const Rectangle& region,
+        SDL_Surface& dst_surface,
+        const Point& dst_position,
+        BlendMode blend_mode
+    );
+
+    static bool fill(
+        SDL_Surface& dst_surface,
+        const Rectangle& where,
+        const Color& color,
+        BlendMode blend_mode
+    );
+
+    static void expand_indexed(
+        SDL_Surface& src_surface,
+        const uint32_t* palette,
+        const Rectangle& region,
+        uint32_t* dst,
+        int dst_pitch
+    );
+
+};
+
+}
+
+#endif
@@ -18,9 +18,12 @@
 #define SOLARUS_SOUND_H
 
 #include "solarus/Common.h"
+#include "solarus/lowlevel/Symbol.h"
+#include <cstdint>
 #include <string>
 #include <list>
-#include <map>
+#include <unordered_map>
+#include <vector>
 #include <al.h>
 #include <alc.h>
 #include <vorbis/vorbisfile.h>
@@ -64,7 +67,7 @@ class SOLARUS_API Sound {
 
     static void load_all();
     static bool exists(const std::string& sound_id);
-    static void play(const std::string& sound_id);
+    static void play(const Symbol& sound_id);
 
     static void initialize(const Arguments& args);
     static void quit();
@@ -74,23 +77,77 @@ class SOLARUS_API Sound {
     static int get_volume();
     static void set_volume(int volume);
 
+    // Voice limits.
+    static int get_max_voices();
+    static void set_max_voices(int max_voices);
+    static int get_default_max_voices_per_sound();
+    static void set_default_max_voices_per_sound(int max_voices);
+    static bool is_coalescing_louder();
+    static void set_coalescing_louder(bool louder);
+    static int get_sound_max_voices(const Symbol& sound_id);
+    static void set_sound_max_voices(const Symbol& sound_id, int max_voices);
+    static int get_sound_priority(const Symbol& sound_id);
+    static void set_sound_priority(const Symbol& sound_id, int priority);
+    static int get_num_voices();
+    static int get_num_voices(const Symbol& sound_id);
+
   private:
 
+    /**
+     * \brief A source playing this sound.
+     */
+    struct Voice {
+      ALuint source;                /**< The OpenAL source. */
+      uint32_t serial;              /**< Increases with each voice started,
+                                     * so that lower values are older voices. */
+    };
+
+    /**
+     * \brief PCM samples decoded from a sound file.
+     */
+    struct DecodedSamples {
+      std::vector<char> samples;    /**< 16-bit stereo samples. */
+      ALsizei sample_rate;          /**< Sample rate in Hz. */
+      std::string error;            /**< Error message if decoding failed. */
+    };
+
+    std::string get_file_name() const;
     ALuint decode_file(const std::string& file_name);
+    static DecodedSamples decode_samples(const std::string& file_name);
+    static ALuint create_buffer(const std::string& file_name, const DecodedSamples& decoded);
     bool update_playing();
+    static Sound& get_sound(const Symbol& sound_id);
+    bool make_room();
+    void stop_oldest_voice();
 
     static ALCdevice* device;
     static ALCcontext* context;
 
     std::string id;                              /**< id of this sound */
     ALuint buffer;                               /**< the OpenAL buffer containing the PCM decoded data of this sound */
-    std::list<ALuint> sources;                   /**< the sources currently playing this sound */
+    std::list<Voice> sources;                    /**< the sources currently playing this sound, oldest first */
+    int max_voices;                              /**< maximum number of sources playing this sound,
+                                                  * 0 for no limit or -1 to use the default value */
+    int priority;                                /**< voices of sounds with a lower priority are
+                                                  * stopped first when there are too many voices */
+    uint32_t last_start_tick;                    /**< tick when this sound was last started */
+    int num_coalesced;                           /**< number of times this sound was played again
+                                                  * during last_start_tick */
     static std::list<Sound*> current_sounds;     /**< the sounds currently playing */
-    static std::map<std::string, Sound> all_sounds;   /**< all sounds created before */
+    static std::unordered_map<Symbol, Sound>
+        all_sounds;                              /**< all sounds created before */
 
     static bool initialized;                     /**< indicates that the audio system is initialized */
     static bool sounds_preloaded;                /**< true if load_all() was called */
     static float volume;                         /**< the volume of sound effects (0.0 to 1.0) */
+    static int max_voices_total;                 /**< maximum number of sources playing at the same time
+                                                  * (0 means no limit) */
+    static int default_max_voices_per_sound;     /**< maximum number of sources playing the same sound
+                                                  * unless a sound overrides it (0 means no limit) */
+    static bool coalescing_louder;               /**< whether playing a sound again in the same tick
+                                                  * makes it louder instead of being ignored */
+    static uint32_t current_tick;                /**< incremented at each update */
+    static uint32_t last_voice_serial;           /**< serial of the last voice started */
 
 };
 
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_STARTUP_PROFILE_H
+#define SOLARUS_STARTUP_PROFILE_H
+
+#include "solarus/Common.h"
+#include <chrono>
+#include <string>
+
+namespace Solarus {
+
+class Arguments;
+
+/**
+ * \brief Measures the time spent in each phase of the engine startup.
+ *
+ * When the -startup-profile option is set, the duration of each phase
+ * from the launch to the first frame is logged once the first frame is
+ * drawn.
+ * Phases may run in parallel in several threads.
+ */
+class SOLARUS_API StartupProfile {
+
+  public:
+
+    /**
+     * \brief Measures a startup phase during its lifetime.
+     */
+    class SOLARUS_API Phase {
+
+      public:
+
+        explicit Phase(const std::string& name);
+        ~Phase();
+
+        Phase(const Phase& other) = delete;
+        Phase& operator=(const Phase& other) = delete;
+
+      private:
+
+        std::string name;                                 /**< Name of the phase. */
+        std::chrono::steady_clock::time_point start;      /**< When the phase started. */
+    };
+
+    static void initialize(const Arguments& args);
+    static bool is_enabled();
+    static void notify_first_frame();
+
+};
+
+}
+
+#endif
@@ -19,6 +19,7 @@
 
 #include "solarus/Common.h"
 #include "solarus/lowlevel/PixelBits.h"
+#include "solarus/lowlevel/Rectangle.h"
 #include "solarus/lowlevel/SurfacePtr.h"
 #include "solarus/Drawable.h"
 #include <SDL.h>
@@ -45,6 +46,8 @@ class Surface;
 class Surface: public Drawable {
 
   // low-level classes allowed to manipulate directly the internal SDL surface encapsulated
+  friend class LightMap;
+  friend class ParticleEmitter;
   friend class TextSurface;
   friend class PixelBits;
 
@@ -62,10 +65,10 @@ class Surface: public Drawable {
     Surface(int width, int height);
     explicit Surface(SDL_Surface* internal_surface);
 
-    // Surfaces should only created with std::make_shared.
+    // Surfaces should only created with make_intrusive.
     // This is what create() functions do, so you should call them rather than
     // constructors.
-    // This is because they are always reference-counted with shared_ptr
+    // This is because they are always reference-counted with IntrusivePtr
     // internally for drawing.
     static SurfacePtr create(int width, int height);
     static SurfacePtr create(const Size& size);
@@ -87,6 +90,12 @@ class Surface: public Drawable {
     void set_opacity(uint8_t opacity);
 
     std::string get_pixels() const;
+    bool read_pixels(uint32_t* pixels) const;
+    bool is_region_opaque(const Rectangle& region) const;
+
+    bool is_indexed() const;
+    std::vector<Color> get_palette() const;
+    bool set_palette(const std::vector<Color>& colors);
 
     void apply_pixel_filter(const PixelFilter& pixel_filter, Surface& dst_surface);
 
@@ -139,7 +148,11 @@ class Surface: public Drawable {
 
     void create_software_surface();
     void convert_software_surface();
+    void update_palette_pixels();
     void create_texture_from_surface();
+    void update_texture();
+    void mark_dirty(const Rectangle& where);
+    void mark_all_dirty();
     void add_subsurface(const SurfacePtr& src_surface, const Rectangle& region, const Point& dst_position);
     void clear_subsurfaces();
     void render(
@@ -164,6 +177,12 @@ class Surface: public Drawable {
         internal_color;                   /**< The background color to use, if any. */
     bool is_rendered;                     /**< Whether the current surface has been rendered.
                                            * Set to false when drawing a surface on this one. */
+    std::vector<Rectangle>
+        dirty_regions;                    /**< Regions of the software surface modified since
+                                           * the texture was last updated. */
+    std::vector<uint32_t>
+        palette_pixels;                   /**< For 8-bit indexed surfaces, each palette entry
+                                           * in the video pixel format. Empty otherwise. */
     uint8_t opacity;                      /**< Opacity (0: transparent, 255: opaque). */
     int width, height;                    /**< Size of the texture, avoid to use SDL_QueryTexture. */
 
@@ -17,16 +17,16 @@
 #ifndef SOLARUS_SURFACE_PTR_H
 #define SOLARUS_SURFACE_PTR_H
 
-#include <memory>
+#include "solarus/lowlevel/IntrusivePtr.h"
 
 namespace Solarus {
 
 class Surface;
 
 /**
- * \brief Alias for shared_ptr of Surface.
+ * \brief Alias for IntrusivePtr of Surface.
  */
-using SurfacePtr = std::shared_ptr<Surface>;
+using SurfacePtr = IntrusivePtr<Surface>;
 
 }
 
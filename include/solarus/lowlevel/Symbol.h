@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_SYMBOL_H
+#define SOLARUS_SYMBOL_H
+
+#include "solarus/Common.h"
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <string>
+
+namespace Solarus {
+
+/**
+ * \brief An interned identifier.
+ *
+ * Each distinct string is stored only once in a global table that is never
+ * cleared, and a symbol is just a pointer to its entry.
+ * Copying, comparing and hashing symbols therefore never touches the
+ * characters: equality is a pointer comparison and the hash is computed once
+ * when the string is interned.
+ *
+ * This is intended for names used as keys in per-frame code: animation
+ * names, sprite ids, entity names, sound ids and savegame keys.
+ * Creating a symbol from a string has the cost of a hash table lookup,
+ * so frequently used constant symbols should be created once and kept.
+ *
+ * Symbols can be created from any thread.
+ */
+class SOLARUS_API Symbol {
+
+  public:
+
+    Symbol();
+    Symbol(const std::string& name);
+    Symbol(const char* name);
+
+    static bool find(const std::string& name, Symbol& symbol);
+
+    const std::string& str() const;
+    const char* c_str() const;
+    bool empty() const;
+    size_t get_hash() const;
+
+    const void* get_handle() const;
+    static Symbol from_handle(const void* handle);
+
+  private:
+
+    /**
+     * \brief The unique storage of an interned string.
+     */
+    struct Entry {
+      std::string name;     /**< The string. */
+      size_t hash;          /**< Hash of the string. */
+    };
+
+    struct Table;
+
+    explicit Symbol(const Entry* entry);
+
+    static Table& get_table();
+    static const Entry* intern(const std::string& name);
+
+    static const Entry empty_entry;  /**< Entry of the empty string. */
+
+    const Entry* entry;     /**< The unique entry of this string. */
+
+};
+
+// Comparison operators.
+// Order is alphabetical so that sorted containers of symbols are
+// deterministic, but equality only compares pointers.
+bool operator==(const Symbol& lhs, const Symbol& rhs);
+bool operator!=(const Symbol& lhs, const Symbol& rhs);
+bool operator<(const Symbol& lhs, const Symbol& rhs);
+
+// Comparison with strings, without interning them.
+bool operator==(const Symbol& lhs, const std::string& rhs);
+bool operator==(const std::string& lhs, const Symbol& rhs);
+bool operator!=(const Symbol& lhs, const std::string& rhs);
+bool operator!=(const std::string& lhs, const Symbol& rhs);
+bool operator==(const Symbol& lhs, const char* rhs);
+bool operator==(const char* lhs, const Symbol& rhs);
+bool operator!=(const Symbol& lhs, const char* rhs);
+bool operator!=(const char* lhs, const Symbol& rhs);
+
+// Concatenation with strings.
+std::string operator+(const Symbol& lhs, const std::string& rhs);
+std::string operator+(const std::string& lhs, const Symbol& rhs);
+std::string operator+(const Symbol& lhs, const char* rhs);
+std::string operator+(const char* lhs, const Symbol& rhs);
+
+// Output to stream
+SOLARUS_API std::ostream& operator<<(std::ostream& stream, const Symbol& symbol);
+
+}
+
+namespace std {
+
+/**
+ * \brief Hash function of symbols, for unordered containers.
+ *
+ * This returns the hash precomputed when the symbol was interned.
+ */
+template<>
+struct hash<Solarus::Symbol> {
+  size_t operator()(const Solarus::Symbol& symbol) const {
+    return symbol.get_hash();
+  }
+};
+
+}
+
+#include "solarus/lowlevel/Symbol.inl"
+
+#endif
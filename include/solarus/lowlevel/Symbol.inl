@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+namespace Solarus {
+
+/**
+ * \brief Creates an empty symbol.
+ */
+inline Symbol::Symbol():
+  entry(&empty_entry) {
+}
+
+/**
+ * \brief Creates a symbol from a string, interning it if necessary.
+ * \param name The string.
+ */
+inline Symbol::Symbol(const std::string& name):
+  entry(intern(name)) {
+}
+
+/**
+ * \brief Creates a symbol from a string, interning it if necessary.
+ * \param name The string.
+ */
+inline Symbol::Symbol(const char* name):
+  entry(intern(name)) {
+}
+
+/**
+ * \brief Creates a symbol from its entry.
+ * \param entry An interned entry.
+ */
+inline Symbol::Symbol(const Entry* entry):
+  entry(entry) {
+}
+
+/**
+ * \brief Returns the string of this symbol.
+ *
+ * The string lives as long as the program: the reference can be kept.
+ *
+ * \return The string.
+ */
+inline const std::string& Symbol::str() const {
+  return entry->name;
+}
+
+/**
+ * \brief Returns the string of this symbol as a C string.
+ * \return The string.
+ */
+inline const char* Symbol::c_str() const {
+  return entry->name.c_str();
+}
+
+/**
+ * \brief Returns whether this symbol is the empty string.
+ * \return \c true if the string is empty.
+ */
+inline bool Symbol::empty() const {
+  return entry == &empty_entry;
+}
+
+/**
+ * \brief Returns the hash of this symbol.
+ * \return The hash, computed when the string was interned.
+ */
+inline size_t Symbol::get_hash() const {
+  return entry->hash;
+}
+
+/**
+ * \brief Returns an opaque value that uniquely identifies this symbol.
+ *
+ * This is useful to store a symbol outside C++, for example as a Lua light
+ * userdata.
+ *
+ * \return The handle of this symbol.
+ */
+inline const void* Symbol::get_handle() const {
+  return entry;
+}
+
+/**
+ * \brief Returns the symbol of a handle.
+ * \param handle A value previously returned by get_handle().
+ * \return The corresponding symbol.
+ */
+inline Symbol Symbol::from_handle(const void* handle) {
+  return Symbol(static_cast<const Entry*>(handle));
+}
+
+/**
+ * \brief Returns whether two symbols are equal.
+ * \param lhs A symbol.
+ * \param rhs Another symbol.
+ * \return \c true if they have the same string.
+ */
+inline bool operator==(const Symbol& lhs, const Symbol& rhs) {
+  return lhs.get_handle() == rhs.get_handle();
+}
+
+/**
+ * \brief Returns whether two symbols are different.
+ * \param lhs A symbol.
+ * \param rhs Another symbol.
+ * \return \c true if they have different strings.
+ */
+inline bool operator!=(const Symbol& lhs, const Symbol& rhs) {
+  return lhs.get_handle() != rhs.get_handle();
+}
+
+/**
+ * \brief Compares the strings of two symbols.
+ * \param lhs A symbol.
+ * \param rhs Another symbol.
+ * \return \c true if the first string is before the second one.
+ */
+inline bool operator<(const Symbol& lhs, const Symbol& rhs) {
+  return lhs != rhs && lhs.str() < rhs.str();
+}
+
+/**
+ * \brief Compares a symbol to a string.
+ * \param lhs A symbol.
+ * \param rhs A string.
+ * \return \c true if the symbol has this string.
+ */
+inline bool operator==(const Symbol& lhs, const std::string& rhs) {
+  return lhs.str() == rhs;
+}
+
+/**
+ * \brief Compares a string to a symbol.
+ * \param lhs A string.
+ * \param rhs A symbol.
+ * \return \c true if the symbol has this string.
+ */
+inline bool operator==(const std::string& lhs, const Symbol& rhs) {
+  return lhs == rhs.str();
+}
+
+/**
+ * \brief Compares a symbol to a string.
+ * \param lhs A symbol.
+ * \param rhs A string.
+ * \return \c true if the symbol has a different string.
+ */
+inline bool operator!=(const Symbol& lhs, const std::string& rhs) {
+  return lhs.str() != rhs;
+}
+
+/**
+ * \brief Compares a string to a symbol.
+ * \param lhs A string.
+ * \param rhs A symbol.
+ * \return \c true if the symbol has a different string.
+ */
+inline bool operator!=(const std::string& lhs, const Symbol& rhs) {
+  return lhs != rhs.str();
+}
+
+/**
+ * \brief Compares a symbol to a string.
+ * \param lhs A symbol.
+ * \param rhs A string.
+ * \return \c true if the symbol has this string.
+ */
+inline bool operator==(const Symbol& lhs, const char* rhs) {
+  return lhs.str() == rhs;
+}
+
+/**
+ * \brief Compares a string to a symbol.
+ * \param lhs A string.
+ * \param rhs A symbol.
+ * \return \c true if the symbol has this string.
+ */
+inline bool operator==(const char* lhs, const Symbol& rhs) {
+  return lhs == rhs.str();
+}
+
+/**
+ * \brief Compares a symbol to a string.
+ * \param lhs A symbol.
+ * \param rhs A string.
+ * \return \c true if the symbol has a different string.
+ */
+inline bool operator!=(const Symbol& lhs, const char* rhs) {
+  return lhs.str() != rhs;
+}
+
+/**
+ * \brief Compares a string to a symbol.
+ * \param lhs A string.
+ * \param rhs A symbol.
+ * \return \c true if the symbol has a different string.
+ */
+inline bool operator!=(const char* lhs, const Symbol& rhs) {
+  return lhs != rhs.str();
+}
+
+/**
+ * \brief Concatenates a symbol and a string.
+ * \param lhs A symbol.
+ * \param rhs A string.
+ * \return The concatenation.
+ */
+inline std::string operator+(const Symbol& lhs, const std::string& rhs) {
+  return lhs.str() + rhs;
+}
+
+/**
+ * \brief Concatenates a string and a symbol.
+ * \param lhs A string.
+ * \param rhs A symbol.
+ * \return The concatenation.
+ */
+inline std::string operator+(const std::string& lhs, const Symbol& rhs) {
+  return lhs + rhs.str();
+}
+
+/**
+ * \brief Concatenates a symbol and a string.
+ * \param lhs A symbol.
+ * \param rhs A string.
+ * \return The concatenation.
+ */
+inline std::string operator+(const Symbol& lhs, const char* rhs) {
+  return lhs.str() + rhs;
+}
+
+/**
+ * \brief Concatenates a string and a symbol.
+ * \param lhs A string.
+ * \param rhs A symbol.
+ * \return The concatenation.
+ */
+inline std::string operator+(const char* lhs, const Symbol& rhs) {
+  return lhs + rhs.str();
+}
+
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_WORKER_POOL_H
+#define SOLARUS_WORKER_POOL_H
+
+#include "solarus/Common.h"
+#include <functional>
+
+namespace Solarus {
+
+/**
+ * \brief A small pool of persistent threads to parallelize pure computations.
+ *
+ * Work submitted here must not touch Lua, the video system or anything
+ * else that is not thread-safe: only independent data owned by each item.
+ * The calling thread participates in the work and parallel_for() returns
+ * only once every item is processed.
+ */
+class SOLARUS_API WorkerPool {
+
+  public:
+
+    /**
+     * \brief Function processing the items [begin, end[ of a parallel loop.
+     */
+    using RangeFunction = std::function<void(int begin, int end)>;
+
+    static void initialize();
+    static void quit();
+
+    static int get_num_workers();
+    static void parallel_for(int count, int min_chunk_size, const RangeFunction& function);
+
+};
+
+}
+
+#endif
+
@@ -18,7 +18,7 @@
 #define SOLARUS_EXPORTABLE_TO_LUA_H
 
 #include "solarus/Common.h"
-#include <memory>
+#include "solarus/lowlevel/IntrusivePtr.h"
 #include <string>
 
 namespace Solarus {
@@ -28,17 +28,27 @@ class LuaContext;
 /**
  * \brief Interface of a C++ type that can also exist as a Lua userdata.
  *
- * Use std::shared_ptr to safely share the object between C++ and Lua,
+ * Use IntrusivePtr to safely share the object between C++ and Lua,
  * no matter which world stops using it first.
+ * The reference counter is stored in the object and is not atomic:
+ * these objects must only be shared by the main thread.
  */
-class ExportableToLua:
-    public std::enable_shared_from_this<ExportableToLua> {
+class ExportableToLua {
 
   public:
 
     ExportableToLua();
+    ExportableToLua(const ExportableToLua& other);
     virtual ~ExportableToLua();
 
+    ExportableToLua& operator=(const ExportableToLua& other);
+
+    // Reference counting, used by IntrusivePtr.
+    void add_reference() const;
+    void remove_reference() const;
+    int get_reference_count() const;
+    IntrusiveWeakLink* get_weak_link() const;
+
     LuaContext* get_lua_context() const;
     void set_lua_context(LuaContext* lua_context);
     bool is_known_to_lua() const;
@@ -54,6 +64,13 @@ class ExportableToLua:
 
   private:
 
+    void destroy() const;
+
+    mutable int reference_count; /**< Number of IntrusivePtr to this object. */
+    mutable IntrusiveWeakLink*
+        weak_link;               /**< Link with weak handles to this object,
+                                  * or nullptr if there was none. */
+
     LuaContext* lua_context;     /**< The Solarus Lua API, or nullptr if
                                   * not currently exported to Lua. */
 
@@ -64,6 +81,25 @@ class ExportableToLua:
 
 };
 
+/**
+ * \brief Increments the reference counter.
+ */
+inline void ExportableToLua::add_reference() const {
+  ++reference_count;
+}
+
+/**
+ * \brief Decrements the reference counter.
+ *
+ * Destroys the object if no reference remains.
+ */
+inline void ExportableToLua::remove_reference() const {
+
+  if (--reference_count == 0) {
+    destroy();
+  }
+}
+
 }
 
 #endif
@@ -17,16 +17,16 @@
 #ifndef SOLARUS_EXPORTABLE_TO_LUA_PTR_H
 #define SOLARUS_EXPORTABLE_TO_LUA_PTR_H
 
-#include <memory>
+#include "solarus/lowlevel/IntrusivePtr.h"
 
 namespace Solarus {
 
 class ExportableToLua;
 
 /**
- * \brief Alias for shared_ptr of ExportableToLua.
+ * \brief Alias for IntrusivePtr of ExportableToLua.
  */
-using ExportableToLuaPtr = std::shared_ptr<ExportableToLua>;
+using ExportableToLuaPtr = IntrusivePtr<ExportableToLua>;
 
 }
 
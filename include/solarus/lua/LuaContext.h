@@ -27,7 +27,9 @@
 #include "solarus/entities/HeroPtr.h"
 #include "solarus/lowlevel/Debug.h"
 #include "solarus/lowlevel/InputEvent.h"
+#include "solarus/lowlevel/IntrusivePtr.h"
 #include "solarus/lowlevel/SurfacePtr.h"
+#include "solarus/lowlevel/Symbol.h"
 #include "solarus/lua/ExportableToLuaPtr.h"
 #include "solarus/lua/ScopedLuaRef.h"
 #include "solarus/Ability.h"
@@ -37,7 +39,6 @@
 #include <lua.hpp>
 #include <list>
 #include <map>
-#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -63,10 +64,12 @@ class ExportableToLua;
 class EquipmentItem;
 class Game;
 class JumpMovement;
+class LightMap;
 class MainLoop;
 class Map;
 class Movement;
 class Npc;
+class ParticleEmitter;
 class PathFindingMovement;
 class PathMovement;
 class PixelMovement;
@@ -121,6 +124,8 @@ class LuaContext {
     static const std::string surface_module_name;
     static const std::string text_surface_module_name;
     static const std::string sprite_module_name;
+    static const std::string particle_emitter_module_name;
+    static const std::string light_map_module_name;
     static const std::string menu_module_name;
     static const std::string language_module_name;
     static const std::string movement_module_name;
@@ -235,10 +240,10 @@ class LuaContext {
 
     // Movements.
     void start_movement_on_point(
-        const std::shared_ptr<Movement>& movement,
+        const IntrusivePtr<Movement>& movement,
         int point_index
     );
-    void stop_movement_on_point(const std::shared_ptr<Movement>& movement);
+    void stop_movement_on_point(const IntrusivePtr<Movement>& movement);
     void update_movements();
 
     // Entities.
@@ -297,13 +302,13 @@ class LuaContext {
 
     // Sprite events.
     void sprite_on_animation_finished(
-        Sprite& sprite, const std::string& animation);
+        Sprite& sprite, const Symbol& animation);
     void sprite_on_animation_changed(
-        Sprite& sprite, const std::string& animation);
+        Sprite& sprite, const Symbol& animation);
     void sprite_on_direction_changed(
-        Sprite& sprite, const std::string& animation, int direction);
+        Sprite& sprite, const Symbol& animation, int direction);
     void sprite_on_frame_changed(
-        Sprite& sprite, const std::string& animation, int frame);
+        Sprite& sprite, const Symbol& animation, int frame);
 
     // Movement events.
     void movement_on_position_changed(Movement& movement, const Point& xy);
@@ -349,6 +354,8 @@ class LuaContext {
     bool game_on_input(Game& game, const InputEvent& event);
     bool game_on_command_pressed(Game& game, GameCommand command);
     bool game_on_command_released(Game& game, GameCommand command);
+    ScopedLuaRef game_on_checkpoint_saving(Game& game);
+    void game_on_checkpoint_restored(Game& game, const ScopedLuaRef& data_ref);
 
     // Map events.
     void map_on_started(Map& map, Destination* destination);
@@ -447,12 +454,25 @@ class LuaContext {
       main_api_get_type,
       main_api_get_metatable,
       main_api_get_os,
+      main_api_start_profiler,
+      main_api_stop_profiler,
+      main_api_is_profiling,
 
       // Audio API.
       audio_api_get_sound_volume,
       audio_api_set_sound_volume,
       audio_api_play_sound,
       audio_api_preload_sounds,
+      audio_api_get_max_sound_voices,
+      audio_api_set_max_sound_voices,
+      audio_api_get_max_voices_per_sound,
+      audio_api_set_max_voices_per_sound,
+      audio_api_get_sound_max_voices,
+      audio_api_set_sound_max_voices,
+      audio_api_get_sound_priority,
+      audio_api_set_sound_priority,
+      audio_api_is_sound_coalescing_louder,
+      audio_api_set_sound_coalescing_louder,
       audio_api_get_music_volume,
       audio_api_set_music_volume,
       audio_api_play_music,
@@ -464,6 +484,9 @@ class LuaContext {
       audio_api_set_music_channel_volume,
       audio_api_get_music_tempo,
       audio_api_set_music_tempo,
+      audio_api_preload_music,
+      audio_api_get_music_crossfade_duration,
+      audio_api_set_music_crossfade_duration,
 
       // Video API.
       video_api_get_window_title,
@@ -481,6 +504,9 @@ class LuaContext {
       video_api_get_window_size,
       video_api_set_window_size,
       video_api_reset_window_size,
+      video_api_start_capture,
+      video_api_stop_capture,
+      video_api_is_capturing,
 
       // Input API.
       input_api_is_joypad_enabled,
@@ -550,6 +576,8 @@ class LuaContext {
       surface_api_set_opacity,
       surface_api_get_pixels,
       surface_api_set_pixels,
+      surface_api_get_palette,
+      surface_api_set_palette,
 
       // Text surface API.
       text_surface_api_create,
@@ -591,6 +619,43 @@ class LuaContext {
       sprite_api_set_ignore_suspend,  // TODO rename to set_suspended_with_map() like timers
       sprite_api_synchronize,
 
+      // Particle emitter API.
+      particle_emitter_api_create,
+      particle_emitter_api_get_num_particles,
+      particle_emitter_api_get_max_particles,
+      particle_emitter_api_is_emitting,
+      particle_emitter_api_set_emitting,
+      particle_emitter_api_get_emission_rate,
+      particle_emitter_api_set_emission_rate,
+      particle_emitter_api_get_emission_size,
+      particle_emitter_api_set_emission_size,
+      particle_emitter_api_get_lifetime,
+      particle_emitter_api_set_lifetime,
+      particle_emitter_api_get_speed,
+      particle_emitter_api_set_speed,
+      particle_emitter_api_get_angle,
+      particle_emitter_api_set_angle,
+      particle_emitter_api_get_gravity,
+      particle_emitter_api_set_gravity,
+      particle_emitter_api_get_frame_delay,
+      particle_emitter_api_set_frame_delay,
+      particle_emitter_api_emit,
+      particle_emitter_api_clear,
+
+      // Light map API.
+      light_map_api_create,
+      light_map_api_get_scale,
+      light_map_api_get_ambient_color,
+      light_map_api_set_ambient_color,
+      light_map_api_get_view_position,
+      light_map_api_set_view_position,
+      light_map_api_add_light,
+      light_map_api_set_light_position,
+      light_map_api_remove_light,
+      light_map_api_has_light,
+      light_map_api_clear_lights,
+      light_map_api_get_num_lights,
+
       // Movement API.
       movement_api_create,
       movement_api_get_xy,
@@ -634,6 +699,8 @@ class LuaContext {
       path_finding_movement_api_set_target,
       path_finding_movement_api_get_speed,
       path_finding_movement_api_set_speed,
+      path_finding_movement_api_is_hierarchical,
+      path_finding_movement_api_set_hierarchical,
       circle_movement_api_set_center,
       circle_movement_api_get_radius,
       circle_movement_api_set_radius,
@@ -725,6 +792,10 @@ class LuaContext {
       game_api_capture_command_binding,
       game_api_simulate_command_pressed,
       game_api_simulate_command_released,
+      game_api_has_checkpoint,
+      game_api_save_checkpoint,
+      game_api_restore_checkpoint,
+      game_api_remove_checkpoint,
 
       // Equipment item API.
       item_api_get_name,
@@ -794,6 +865,8 @@ class LuaContext {
       map_api_get_entities_by_type,
       map_api_get_entities_in_rectangle,
       map_api_get_entities_in_region,
+      map_api_get_entities_on_segment,
+      map_api_raycast,
       map_api_get_hero,
       map_api_set_entities_enabled,
       map_api_remove_entities,
@@ -994,6 +1067,7 @@ class LuaContext {
       custom_entity_api_set_drawn_in_y_order,
       custom_entity_api_set_traversable_by,
       custom_entity_api_set_can_traverse,
+      custom_entity_api_clear_traversable_cache,
       custom_entity_api_can_traverse_ground,
       custom_entity_api_set_can_traverse_ground,
       custom_entity_api_add_collision_test,
@@ -1062,6 +1136,8 @@ class LuaContext {
     void register_surface_module();
     void register_text_surface_module();
     void register_sprite_module();
+    void register_particle_emitter_module();
+    void register_light_map_module();
     void register_movement_module();
     void register_menu_module();
     void register_language_module();
@@ -1069,6 +1145,7 @@ class LuaContext {
     void register_map_module();
     void register_entity_module();
     void register_testing_module();
+    void register_ffi_accessors();
 
     // Pushing objects to Lua.
     static void push_main(lua_State* l);
@@ -1080,6 +1157,8 @@ class LuaContext {
     static void push_surface(lua_State* l, Surface& surface);
     static void push_text_surface(lua_State* l, TextSurface& text_surface);
     static void push_sprite(lua_State* l, Sprite& sprite);
+    static void push_particle_emitter(lua_State* l, ParticleEmitter& emitter);
+    static void push_light_map(lua_State* l, LightMap& light_map);
     static void push_item(lua_State* l, EquipmentItem& item);
     static void push_movement(lua_State* l, Movement& movement);
     static void push_game(lua_State* l, Savegame& game);
@@ -1127,69 +1206,73 @@ class LuaContext {
     static bool is_surface(lua_State* l, int index);
     static SurfacePtr check_surface(lua_State* l, int index);
     static bool is_text_surface(lua_State* l, int index);
-    static std::shared_ptr<TextSurface> check_text_surface(lua_State* l, int index);
+    static IntrusivePtr<TextSurface> check_text_surface(lua_State* l, int index);
     static bool is_sprite(lua_State* l, int index);
     static SpritePtr check_sprite(lua_State* l, int index);
+    static bool is_particle_emitter(lua_State* l, int index);
+    static IntrusivePtr<ParticleEmitter> check_particle_emitter(lua_State* l, int index);
+    static bool is_light_map(lua_State* l, int index);
+    static IntrusivePtr<LightMap> check_light_map(lua_State* l, int index);
     static bool is_item(lua_State* l, int index);
-    static std::shared_ptr<EquipmentItem> check_item(lua_State* l, int index);
+    static IntrusivePtr<EquipmentItem> check_item(lua_State* l, int index);
     static bool is_movement(lua_State* l, int index);
-    static std::shared_ptr<Movement> check_movement(lua_State* l, int index);
+    static IntrusivePtr<Movement> check_movement(lua_State* l, int index);
     static bool is_straight_movement(lua_State* l, int index);
-    static std::shared_ptr<StraightMovement> check_straight_movement(lua_State* l, int index);
+    static IntrusivePtr<StraightMovement> check_straight_movement(lua_State* l, int index);
     static bool is_random_movement(lua_State* l, int index);
-    static std::shared_ptr<RandomMovement> check_random_movement(lua_State* l, int index);
+    static IntrusivePtr<RandomMovement> check_random_movement(lua_State* l, int index);
     static bool is_target_movement(lua_State* l, int index);
-    static std::shared_ptr<TargetMovement> check_target_movement(lua_State* l, int index);
+    static IntrusivePtr<TargetMovement> check_target_movement(lua_State* l, int index);
     static bool is_path_movement(lua_State* l, int index);
-    static std::shared_ptr<PathMovement> check_path_movement(lua_State* l, int index);
+    static IntrusivePtr<PathMovement> check_path_movement(lua_State* l, int index);
     static bool is_random_path_movement(lua_State* l, int index);
-    static std::shared_ptr<RandomPathMovement> check_random_path_movement(lua_State* l, int index);
+    static IntrusivePtr<RandomPathMovement> check_random_path_movement(lua_State* l, int index);
     static bool is_path_finding_movement(lua_State* l, int index);
-    static std::shared_ptr<PathFindingMovement> check_path_finding_movement(lua_State* l, int index);
+    static IntrusivePtr<PathFindingMovement> check_path_finding_movement(lua_State* l, int index);
     static bool is_circle_movement(lua_State* l, int index);
-    static std::shared_ptr<CircleMovement> check_circle_movement(lua_State* l, int index);
+    static IntrusivePtr<CircleMovement> check_circle_movement(lua_State* l, int index);
     static bool is_jump_movement(lua_State* l, int index);
-    static std::shared_ptr<JumpMovement> check_jump_movement(lua_State* l, int index);
+    static IntrusivePtr<JumpMovement> check_jump_movement(lua_State* l, int index);
     static bool is_pixel_movement(lua_State* l, int index);
-    static std::shared_ptr<PixelMovement> check_pixel_movement(lua_State* l, int index);
+    static IntrusivePtr<PixelMovement> check_pixel_movement(lua_State* l, int index);
     static bool is_game(lua_State* l, int index);
-    static std::shared_ptr<Savegame> check_game(lua_State* l, int index);
+    static IntrusivePtr<Savegame> check_game(lua_State* l, int index);
     static bool is_map(lua_State* l, int index);
-    static std::shared_ptr<Map> check_map(lua_State* l, int index);
+    static IntrusivePtr<Map> check_map(lua_State* l, int index);
     static bool is_entity(lua_State* l, int index);
     static EntityPtr check_entity(lua_State* l, int index);
     static bool is_hero(lua_State* l, int index);
     static HeroPtr check_hero(lua_State* l, int index);
     static bool is_camera(lua_State* l, int index);
-    static std::shared_ptr<Camera> check_camera(lua_State* l, int index);
+    static IntrusivePtr<Camera> check_camera(lua_State* l, int index);
     static bool is_destination(lua_State* l, int index);
-    static std::shared_ptr<Destination> check_destination(lua_State* l, int index);
+    static IntrusivePtr<Destination> check_destination(lua_State* l, int index);
     static bool is_teletransporter(lua_State* l, int index);
-    static std::shared_ptr<Teletransporter> check_teletransporter(lua_State* l, int index);
+    static IntrusivePtr<Teletransporter> check_teletransporter(lua_State* l, int index);
     static bool is_npc(lua_State* l, int index);
-    static std::shared_ptr<Npc> check_npc(lua_State* l, int index);
+    static IntrusivePtr<Npc> check_npc(lua_State* l, int index);
     static bool is_chest(lua_State* l, int index);
-    static std::shared_ptr<Chest> check_chest(lua_State* l, int index);
+    static IntrusivePtr<Chest> check_chest(lua_State* l, int index);
     static bool is_block(lua_State* l, int index);
-    static std::shared_ptr<Block> check_block(lua_State* l, int index);
+    static IntrusivePtr<Block> check_block(lua_State* l, int index);
     static bool is_switch(lua_State* l, int index);
-    static std::shared_ptr<Switch> check_switch(lua_State* l, int index);
+    static IntrusivePtr<Switch> check_switch(lua_State* l, int index);
     static bool is_stream(lua_State* l, int index);
-    static std::shared_ptr<Stream> check_stream(lua_State* l, int index);
+    static IntrusivePtr<Stream> check_stream(lua_State* l, int index);
     static bool is_door(lua_State* l, int index);
-    static std::shared_ptr<Door> check_door(lua_State* l, int index);
+    static IntrusivePtr<Door> check_door(lua_State* l, int index);
     static bool is_shop_treasure(lua_State* l, int index);
-    static std::shared_ptr<ShopTreasure> check_shop_treasure(lua_State* l, int index);
+    static IntrusivePtr<ShopTreasure> check_shop_treasure(lua_State* l, int index);
     static bool is_pickable(lua_State* l, int index);
-    static std::shared_ptr<Pickable> check_pickable(lua_State* l, int index);
+    static IntrusivePtr<Pickable> check_pickable(lua_State* l, int index);
     static bool is_destructible(lua_State* l, int index);
-    static std::shared_ptr<Destructible> check_destructible(lua_State* l, int index);
+    static IntrusivePtr<Destructible> check_destructible(lua_State* l, int index);
     static bool is_dynamic_tile(lua_State* l, int index);
-    static std::shared_ptr<DynamicTile> check_dynamic_tile(lua_State* l, int index);
+    static IntrusivePtr<DynamicTile> check_dynamic_tile(lua_State* l, int index);
     static bool is_enemy(lua_State* l, int index);
-    static std::shared_ptr<Enemy> check_enemy(lua_State* l, int index);
+    static IntrusivePtr<Enemy> check_enemy(lua_State* l, int index);
     static bool is_custom_entity(lua_State* l, int index);
-    static std::shared_ptr<CustomEntity> check_custom_entity(lua_State* l, int index);
+    static IntrusivePtr<CustomEntity> check_custom_entity(lua_State* l, int index);
 
     // Events.
     void on_started();
@@ -1217,10 +1300,10 @@ class LuaContext {
     bool on_mouse_button_released(const InputEvent& event);
     bool on_command_pressed(GameCommand command);
     bool on_command_released(GameCommand command);
-    void on_animation_finished(const std::string& animation);
-    void on_animation_changed(const std::string& animation);
-    void on_direction_changed(const std::string& animation, int direction);
-    void on_frame_changed(const std::string& animation, int frame);
+    void on_animation_finished(const Symbol& animation);
+    void on_animation_changed(const Symbol& animation);
+    void on_direction_changed(const Symbol& animation, int direction);
+    void on_frame_changed(const Symbol& animation, int frame);
     void on_position_changed(const Point& xy);
     void on_obstacle_reached();
     void on_changed();
@@ -1253,6 +1336,8 @@ class LuaContext {
     void on_moving();
     void on_moved();
     void on_map_changed(Map& map);
+    ScopedLuaRef on_checkpoint_saving();
+    void on_checkpoint_restored(const ScopedLuaRef& data_ref);
     void on_pickable_created(Pickable& pickable);
     void on_variant_changed(int variant);
     void on_amount_changed(int amount);
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_LUA_FFI_H
+#define SOLARUS_LUA_FFI_H
+
+#include "solarus/Common.h"
+
+/**
+ * \file LuaFfi.h
+ * \brief Plain C accessors to the most frequently used properties of
+ * entities, sprites and movements.
+ *
+ * LuaJIT cannot compile calls to classic Lua C functions into traces.
+ * These functions have a stable C ABI so that the LuaJIT FFI can call them
+ * from compiled code instead.
+ * When LuaJIT is available, the Lua API methods of the same name are
+ * replaced at startup by wrappers that call them.
+ *
+ * Each handle is the address of the block of a Solarus userdata, which is
+ * what the FFI passes when a userdata is given for a pointer argument.
+ * Callers must make sure that the handle has the expected type.
+ *
+ * None of these functions calls Lua: setters that trigger Lua events
+ * (like entity:set_position()) are not exposed here, because a C function
+ * called through the FFI must not reenter the Lua state.
+ */
+
+extern "C" {
+
+SOLARUS_API void solarus_entity_get_position(const void* entity, int* x_y_layer);
+SOLARUS_API void solarus_entity_get_center_position(const void* entity, int* x_y_layer);
+SOLARUS_API void solarus_entity_get_bounding_box(const void* entity, int* x_y_width_height);
+SOLARUS_API void solarus_entity_get_size(const void* entity, int* width_height);
+SOLARUS_API void solarus_entity_get_origin(const void* entity, int* x_y);
+SOLARUS_API int solarus_entity_is_enabled(const void* entity);
+SOLARUS_API int solarus_entity_is_visible(const void* entity);
+SOLARUS_API void solarus_entity_set_visible(void* entity, int visible);
+
+SOLARUS_API int solarus_sprite_get_direction(const void* sprite);
+SOLARUS_API int solarus_sprite_get_frame(const void* sprite);
+SOLARUS_API int solarus_sprite_is_paused(const void* sprite);
+SOLARUS_API void solarus_sprite_get_xy(const void* sprite, int* x_y);
+SOLARUS_API void solarus_sprite_set_xy(void* sprite, int x, int y);
+
+SOLARUS_API void solarus_movement_get_xy(const void* movement, int* x_y);
+SOLARUS_API int solarus_straight_movement_get_speed(const void* movement);
+SOLARUS_API double solarus_straight_movement_get_angle(const void* movement);
+
+}
+
+#endif
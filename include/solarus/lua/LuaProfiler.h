@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_LUA_PROFILER_H
+#define SOLARUS_LUA_PROFILER_H
+
+#include "solarus/Common.h"
+#include <string>
+
+struct lua_State;
+
+namespace Solarus {
+
+class Arguments;
+
+/**
+ * \brief Sampling profiler of Lua scripts.
+ *
+ * While the profiler runs, a count hook interrupts Lua every few thousand
+ * virtual machine instructions and records the current Lua call stack,
+ * with the source file and line of each frame.
+ * When it stops, identical stacks are aggregated and written in the
+ * collapsed format of flame graph tools: one line per stack,
+ * frames separated by semicolons from the outermost one, followed by
+ * the number of samples.
+ *
+ * No hook is installed while the profiler is stopped, so it costs nothing
+ * when it is not used.
+ * Time spent in C functions is not sampled, and with LuaJIT, code compiled
+ * into traces does not run hooks.
+ */
+class SOLARUS_API LuaProfiler {
+
+  public:
+
+    static constexpr int default_period = 1000;  /**< Default number of instructions
+                                                  * between two samples. */
+
+    static void initialize(const Arguments& args);
+    static void quit();
+    static void set_lua_state(lua_State* l);
+
+    static bool is_running();
+    static bool start(const std::string& output_file_name, int period);
+    static int stop();
+
+};
+
+}
+
+#endif
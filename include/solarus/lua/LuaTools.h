@@ -20,6 +20,7 @@
 #include "solarus/Common.h"
 #include "solarus/EnumInfo.h"
 #include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Symbol.h"
 #include "solarus/lua/LuaException.h"
 #include "solarus/SolarusFatal.h"
 #include <map>
@@ -156,6 +157,21 @@ std::string opt_string_field(
     const std::string& default_value
 );
 
+// Symbol
+Symbol check_symbol(
+    lua_State* l,
+    int index
+);
+Symbol opt_symbol(
+    lua_State* l,
+    int index,
+    const Symbol& default_value
+);
+void push_symbol(
+    lua_State* l,
+    const Symbol& symbol
+);
+
 // bool
 bool check_boolean(
     lua_State* l,
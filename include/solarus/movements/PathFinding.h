@@ -35,6 +35,11 @@ class Rectangle;
  * In the current implementation, the computed path always corresponds to a
  * shape of 16*16. If the entity to move is bigger, some obstacles may prevent
  * it from following the computed path.
+ *
+ * The search is limited to targets close to the source.
+ * In hierarchical mode, farther targets are reached by first finding
+ * waypoints in the PathFindingGraph of the map and then by computing
+ * the path between each pair of consecutive waypoints.
  */
 class SOLARUS_API PathFinding {
 
@@ -45,6 +50,9 @@ class SOLARUS_API PathFinding {
         Entity& source_entity,
         Entity& target_entity);
 
+    bool is_hierarchical() const;
+    void set_hierarchical(bool hierarchical);
+
     std::string compute_path();
     std::string compute_path(const Point& offset);
 
@@ -74,6 +82,8 @@ class SOLARUS_API PathFinding {
       bool operator<(const Node& other) const;
     };
 
+    std::string find_path(const Point& source, const Point& target, const Rectangle& area);
+    std::string find_long_path(const Point& source, const Point& target);
     int get_square_index(const Point& location) const;
     bool is_node_transition_valid(const Node& node, int direction) const;
     void add_index_sorted(Node* node);
@@ -85,6 +95,8 @@ class SOLARUS_API PathFinding {
     Map& map;                          /**< the map */
     Entity& source_entity;             /**< the entity to move */
     Entity& target_entity;             /**< the target point */
+    bool hierarchical;                 /**< whether long paths are computed with the
+                                        * path finding graph of the map */
 
     std::map<int, Node> closed_list;   /**< the closed list, indexed by the node locations on the map */
     std::map<int, Node> open_list;     /**< the open list, indexed by the node locations on the map */
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_PATH_FINDING_GRAPH_H
+#define SOLARUS_PATH_FINDING_GRAPH_H
+
+#include "solarus/Common.h"
+#include "solarus/lowlevel/Point.h"
+#include "solarus/lowlevel/Rectangle.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Solarus {
+
+class Map;
+
+/**
+ * \brief Abstract graph of a map layer used to compute long paths.
+ *
+ * The map is divided into square clusters of 12x12 squares.
+ * Entrances are the places where a 16x16 box can cross the border between
+ * two clusters, and the cost of the shortest path between each pair of
+ * entrances of a cluster is precomputed.
+ * A long path can then be found by searching this small graph first,
+ * and then refining it cluster by cluster with the usual A* algorithm.
+ *
+ * The graph only takes the ground into account: static tiles and dynamic
+ * entities that change the ground.
+ * It is built the first time it is needed and when the ground of the map
+ * changes, only clusters whose ground actually changed are recomputed.
+ * Other obstacles like enemies or blocks are only considered when refining
+ * the path.
+ */
+class SOLARUS_API PathFindingGraph {
+
+  public:
+
+    static constexpr int cluster_size = 12;  /**< Size of a cluster in 8x8 squares. */
+
+    PathFindingGraph(Map& map, int layer, uint32_t ground_obstacles);
+
+    bool find_waypoints(
+        const Point& source,
+        const Point& target,
+        std::vector<Point>& waypoints
+    );
+    Rectangle get_cluster_box(const Point& location) const;
+
+  private:
+
+    /**
+     * \brief Entrances of a cluster and the costs between them.
+     */
+    struct Cluster {
+      std::vector<int> entrances;     /**< Square index of each entrance, sorted. */
+      std::vector<int> costs;         /**< Cost between each pair of entrances,
+                                       * or -1 if there is no path inside the cluster. */
+      std::vector<std::pair<int, int>>
+          links;                      /**< Entrances of this cluster with the square
+                                       * they lead to in a neighbour cluster. */
+    };
+
+    void update();
+    void compute_squares();
+    bool is_node_free(int x8, int y8) const;
+    int get_cluster_index(int square) const;
+    void add_entrances(int square_1, int square_2, std::vector<Cluster>& new_clusters) const;
+    void add_border_entrances(
+        int first_square_1, int first_square_2, int step, int length,
+        std::vector<Cluster>& new_clusters
+    ) const;
+    void find_entrances(std::vector<Cluster>& new_clusters) const;
+    void compute_costs(Cluster& cluster, int cluster_index) const;
+    void get_costs_in_cluster(int cluster_index, int source, std::vector<int>& costs) const;
+    int get_cost_in_cluster(int cluster_index, const std::vector<int>& costs, int square) const;
+
+    Map& map;                         /**< The map. */
+    const int layer;                  /**< Layer of the map represented by this graph. */
+    const uint32_t ground_obstacles;  /**< Bit field of the grounds that are obstacles. */
+    const int width8;                 /**< Map width in 8x8 squares. */
+    const int height8;                /**< Map height in 8x8 squares. */
+    const int num_clusters_x;         /**< Number of clusters in a row. */
+    const int num_clusters_y;         /**< Number of clusters in a column. */
+    bool built;                       /**< Whether the graph was computed once. */
+    uint32_t ground_revision;         /**< Ground revision of the map when the graph was updated. */
+    std::vector<bool> static_blocked; /**< Whether each square has an obstacle tile. */
+    std::vector<bool> nodes_free;     /**< Whether a 16x16 box can be at each square. */
+    std::vector<Cluster> clusters;    /**< Entrances and costs of each cluster. */
+
+};
+
+}
+
+#endif
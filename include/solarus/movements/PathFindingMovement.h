@@ -40,6 +40,8 @@ class SOLARUS_API PathFindingMovement: public PathMovement {
     explicit PathFindingMovement(int speed);
 
     void set_target(const EntityPtr& target);
+    bool is_hierarchical() const;
+    void set_hierarchical(bool hierarchical);
     virtual bool is_finished() const override;
 
     virtual const std::string& get_lua_type_name() const override;
@@ -53,6 +55,8 @@ class SOLARUS_API PathFindingMovement: public PathMovement {
 
     EntityPtr target;               /**< the entity targeted by this movement (usually the hero) */
     uint32_t next_recomputation_date;
+    bool hierarchical;              /**< whether far targets are reached through
+                                     * the path finding graph of the map */
 
 };
 
@@ -41,7 +41,7 @@ DialogBoxSystem::DialogBoxSystem(Game& game):
   selected_first_answer(true) {
 
   for (int i = 0; i < nb_visible_lines; i++) {
-    line_surfaces[i] = std::make_shared<TextSurface>(
+    line_surfaces[i] = make_intrusive<TextSurface>(
         0,
         0,
         TextSurface::HorizontalAlignment::LEFT,
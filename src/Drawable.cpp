@@ -61,7 +61,7 @@ Point Drawable::get_origin() const {
  *
  * \param movement The movement to apply.
  */
-void Drawable::start_movement(const std::shared_ptr<Movement>& movement) {
+void Drawable::start_movement(const IntrusivePtr<Movement>& movement) {
 
   stop_movement();
   this->movement = movement;
@@ -84,7 +84,7 @@ void Drawable::stop_movement() {
  * \brief Returns the current movement of this drawable object.
  * \return The object's movement, or nullptr if there is no movement.
  */
-const std::shared_ptr<Movement>& Drawable::get_movement() {
+const IntrusivePtr<Movement>& Drawable::get_movement() {
   return movement;
 }
 
@@ -390,7 +390,7 @@ void Equipment::load_items() {
       CurrentQuest::get_resources(ResourceType::ITEM);
   for (const auto& kvp: item_elements) {
     const std::string& item_id = kvp.first;
-    std::shared_ptr<EquipmentItem> item = std::make_shared<EquipmentItem>(*this);
+    IntrusivePtr<EquipmentItem> item = make_intrusive<EquipmentItem>(*this);
     item->set_name(item_id);
     items[item_id] = item;
   }
@@ -543,7 +543,7 @@ int Equipment::get_item_slot(const EquipmentItem& item) const {
  * \param ability An ability.
  * \return Name of the boolean savegame variable that stores this ability.
  */
-std::string Equipment::get_ability_savegame_variable(Ability ability) const {
+const Symbol& Equipment::get_ability_savegame_variable(Ability ability) const {
 
   switch (ability) {
 
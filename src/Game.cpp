@@ -26,6 +26,7 @@
 #include "solarus/lowlevel/Debug.h"
 #include "solarus/lowlevel/Music.h"
 #include "solarus/lowlevel/Surface.h"
+#include "solarus/lowlevel/TextSurface.h"
 #include "solarus/lowlevel/Video.h"
 #include "solarus/lua/LuaContext.h"
 #include "solarus/CommandsEffects.h"
@@ -46,7 +47,7 @@ namespace Solarus {
  * \param main_loop The Solarus root object.
  * \param savegame The saved data of this game.
  */
-Game::Game(MainLoop& main_loop, const std::shared_ptr<Savegame>& savegame):
+Game::Game(MainLoop& main_loop, const IntrusivePtr<Savegame>& savegame):
   main_loop(main_loop),
   savegame(savegame),
   pause_allowed(true),
@@ -62,14 +63,16 @@ Game::Game(MainLoop& main_loop, const std::shared_ptr<Savegame>& savegame):
   previous_map_surface(nullptr),
   transition_style(Transition::Style::IMMEDIATE),
   transition(nullptr),
-  crystal_state(false) {
+  crystal_state(false),
+  checkpoints(),
+  checkpoint_to_restore(nullptr) {
 
   // notify objects
   savegame->set_game(this);
 
   // initialize members
   commands = std::unique_ptr<GameCommands>(new GameCommands(*this));
-  hero = std::make_shared<Hero>(get_equipment());
+  hero = make_intrusive<Hero>(get_equipment());
   update_commands_effects();
 
   // Maybe we are restarting after a game-over sequence.
@@ -153,6 +156,9 @@ void Game::stop() {
     }
   }
 
+  checkpoints.clear();
+  checkpoint_to_restore = nullptr;
+
   get_lua_context().game_on_finished(*this);
   get_savegame().notify_game_finished();
   get_savegame().set_game(nullptr);
@@ -435,7 +441,7 @@ void Game::update_transitions() {
       if (!special_destination) {
         EntityPtr destination;
         if (destination_name.empty()) {
-          std::shared_ptr<Destination> default_destination = next_map->get_entities().get_default_destination();
+          IntrusivePtr<Destination> default_destination = next_map->get_entities().get_default_destination();
           if (default_destination != nullptr) {
             destination = default_destination;
             destination_name = destination->get_name();
@@ -446,7 +452,7 @@ void Game::update_transitions() {
         }
         if (destination != nullptr && destination->get_type() == EntityType::DESTINATION) {
           starting_location_mode =
-              std::static_pointer_cast<Destination>(destination)->get_starting_location_mode();
+              static_pointer_cast<Destination>(destination)->get_starting_location_mode();
         }
       }
 
@@ -530,9 +536,23 @@ void Game::update_transitions() {
     set_suspended_by_script(false);
 
     hero->place_on_destination(*current_map, previous_map_location);
+    if (checkpoint_to_restore != nullptr) {
+      crystal_state = checkpoint_to_restore->crystal_state;
+      hero->restore_position(
+          checkpoint_to_restore->hero_xy,
+          checkpoint_to_restore->hero_layer,
+          checkpoint_to_restore->hero_direction
+      );
+    }
     transition->start();
     current_map->start();
     notify_map_changed();
+
+    if (checkpoint_to_restore != nullptr) {
+      std::unique_ptr<GameCheckpoint> checkpoint = std::move(checkpoint_to_restore);
+      current_map->get_entities().restore_checkpoint(*checkpoint);
+      get_lua_context().game_on_checkpoint_restored(*this, checkpoint->script_data);
+    }
   }
 }
 
@@ -638,7 +658,7 @@ void Game::set_current_map(
   // prepare the next map
   if (current_map == nullptr || map_id != current_map->get_id()) {
     // another map
-    next_map = std::make_shared<Map>(map_id);
+    next_map = make_intrusive<Map>(map_id);
     next_map->load(*this);
     next_map->check_suspended();
   }
@@ -683,6 +703,10 @@ bool Game::get_crystal_state() const {
  */
 void Game::change_crystal_state() {
   crystal_state = !crystal_state;
+
+  if (has_current_map()) {
+    get_current_map().notify_ground_changed();
+  }
 }
 
 /**
@@ -952,4 +976,123 @@ void Game::simulate_command_released(GameCommand command){
   commands->game_command_released(command);
 }
 
+/**
+ * \brief Creates a checkpoint in memory where the current map can be
+ * restarted from.
+ *
+ * This includes all savegame values (and therefore the equipment),
+ * the state of crystal blocks, the current map, the position of the hero
+ * and the position, layer and enabled state of named entities.
+ * This is not a full state of the game: see GameCheckpoint.
+ * The game:on_checkpoint_saving() event is called to let scripts attach
+ * their own data.
+ *
+ * \return The checkpoint created.
+ */
+GameCheckpoint Game::create_checkpoint() {
+
+  Debug::check_assertion(has_current_map(), "No current map");
+
+  GameCheckpoint checkpoint;
+  checkpoint.saved_values = get_savegame().get_saved_values();
+  checkpoint.crystal_state = crystal_state;
+  checkpoint.map_id = current_map->get_id();
+  checkpoint.map_data = current_map->get_data();
+  checkpoint.hero_xy = hero->get_xy();
+  checkpoint.hero_layer = hero->get_layer();
+  checkpoint.hero_direction = hero->get_animation_direction();
+  current_map->get_entities().save_checkpoint(checkpoint);
+  checkpoint.script_data = get_lua_context().game_on_checkpoint_saving(*this);
+  return checkpoint;
+}
+
+/**
+ * \brief Restarts the map of a checkpoint previously created.
+ *
+ * Savegame values are restored immediately.
+ * The map of the checkpoint is restarted from its data without transition
+ * at the next cycle, the hero is placed where he was, named entities get
+ * back their position, layer and enabled state (or are removed again) and
+ * then game:on_checkpoint_restored() is called.
+ *
+ * Entities created by scripts after the map was started, timers and
+ * movements are not restored: they restart as in the initial state of the
+ * map.
+ *
+ * \param checkpoint The checkpoint to restore.
+ * \return \c false if the game is currently changing maps or restarting:
+ * nothing is done in this case.
+ */
+bool Game::restore_checkpoint(const GameCheckpoint& checkpoint) {
+
+  if (!started || restarting || current_map == nullptr || next_map != nullptr) {
+    return false;
+  }
+
+  Debug::check_assertion(checkpoint.map_data != nullptr, "Missing map data in checkpoint");
+
+  get_savegame().set_saved_values(checkpoint.saved_values);
+  update_commands_effects();
+
+  hero->reset_movement();
+
+  // Always start a fresh copy of the map, even if it is the current one.
+  next_map = make_intrusive<Map>(checkpoint.map_id);
+  next_map->load(*this, checkpoint.map_data);
+  next_map->check_suspended();
+  current_map->check_suspended();
+
+  next_map->set_destination("_same");
+  transition_style = Transition::Style::IMMEDIATE;
+  checkpoint_to_restore = std::unique_ptr<GameCheckpoint>(new GameCheckpoint(checkpoint));
+  return true;
+}
+
+/**
+ * \brief Returns whether a checkpoint with the given name was saved.
+ * \param name Name of a checkpoint.
+ * \return \c true if it exists.
+ */
+bool Game::has_checkpoint(const std::string& name) const {
+  return checkpoints.find(name) != checkpoints.end();
+}
+
+/**
+ * \brief Captures the current state of the game and keeps it with a name.
+ *
+ * Any previous checkpoint with the same name is replaced.
+ *
+ * \param name Name of the checkpoint.
+ */
+void Game::save_checkpoint(const std::string& name) {
+
+  checkpoints[name] = create_checkpoint();
+}
+
+/**
+ * \brief Restores a checkpoint previously saved with a name.
+ * \param name Name of the checkpoint. It must exist.
+ * \return \c false if the game is currently changing maps or restarting.
+ */
+bool Game::restore_checkpoint(const std::string& name) {
+
+  const auto& it = checkpoints.find(name);
+  Debug::check_assertion(it != checkpoints.end(),
+      std::string("No such checkpoint: '") + name + "'");
+
+  return restore_checkpoint(it->second);
+}
+
+/**
+ * \brief Deletes a checkpoint previously saved with a name.
+ *
+ * Does nothing if there is no such checkpoint.
+ *
+ * \param name Name of the checkpoint.
+ */
+void Game::remove_checkpoint(const std::string& name) {
+
+  checkpoints.erase(name);
+}
+
 }
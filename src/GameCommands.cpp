@@ -615,11 +615,11 @@ void GameCommands::set_joypad_binding(GameCommand command, const std::string& jo
  * \return The savegame variable that stores the keyboard key mapped to this
  * game command, or an empty string if this command is GameCommand::NONE.
  */
-const std::string& GameCommands::get_keyboard_binding_savegame_variable(
+const Symbol& GameCommands::get_keyboard_binding_savegame_variable(
     GameCommand command) const {
 
-  static const std::map<GameCommand, std::string> savegame_variables = {
-      { GameCommand::NONE, "" },
+  static const std::map<GameCommand, Symbol> savegame_variables = {
+      { GameCommand::NONE, Symbol() },
       { GameCommand::ACTION, Savegame::KEY_KEYBOARD_ACTION },
       { GameCommand::ATTACK, Savegame::KEY_KEYBOARD_ATTACK },
       { GameCommand::ITEM_1, Savegame::KEY_KEYBOARD_ITEM_1 },
@@ -641,11 +641,11 @@ const std::string& GameCommands::get_keyboard_binding_savegame_variable(
  * \return The savegame variable that stores the joypad action mapped to this
  * game command, or an empty string if this command is GameCommand::NONE.
  */
-const std::string& GameCommands::get_joypad_binding_savegame_variable(
+const Symbol& GameCommands::get_joypad_binding_savegame_variable(
     GameCommand command) const {
 
-  static const std::map<GameCommand, std::string> savegame_variables = {
-      { GameCommand::NONE, "" },
+  static const std::map<GameCommand, Symbol> savegame_variables = {
+      { GameCommand::NONE, Symbol() },
       { GameCommand::ACTION, Savegame::KEY_JOYPAD_ACTION },
       { GameCommand::ATTACK, Savegame::KEY_JOYPAD_ATTACK },
       { GameCommand::ITEM_1, Savegame::KEY_JOYPAD_ITEM_1 },
@@ -669,7 +669,7 @@ const std::string& GameCommands::get_joypad_binding_savegame_variable(
 InputEvent::KeyboardKey GameCommands::get_saved_keyboard_binding(
     GameCommand command) const {
 
-  const std::string& savegame_variable = get_keyboard_binding_savegame_variable(command);
+  const Symbol& savegame_variable = get_keyboard_binding_savegame_variable(command);
   const std::string& keyboard_key_name = get_savegame().get_string(savegame_variable);
   return name_to_enum(keyboard_key_name, InputEvent::KEY_NONE);
 }
@@ -684,7 +684,7 @@ InputEvent::KeyboardKey GameCommands::get_saved_keyboard_binding(
 void GameCommands::set_saved_keyboard_binding(
     GameCommand command, InputEvent::KeyboardKey keyboard_key) {
 
-  const std::string& savegame_variable = get_keyboard_binding_savegame_variable(command);
+  const Symbol& savegame_variable = get_keyboard_binding_savegame_variable(command);
   const std::string& keyboard_key_name = enum_to_name(keyboard_key);
   get_savegame().set_string(savegame_variable, keyboard_key_name);
 }
@@ -715,7 +715,7 @@ GameCommand GameCommands::get_command_from_keyboard(
 std::string GameCommands::get_saved_joypad_binding(
     GameCommand command) const {
 
-  const std::string& savegame_variable = get_joypad_binding_savegame_variable(command);
+  const Symbol& savegame_variable = get_joypad_binding_savegame_variable(command);
   return get_savegame().get_string(savegame_variable);
 }
 
@@ -728,7 +728,7 @@ std::string GameCommands::get_saved_joypad_binding(
 void GameCommands::set_saved_joypad_binding(
     GameCommand command, const std::string& joypad_string) {
 
-  const std::string& savegame_variable = get_joypad_binding_savegame_variable(command);
+  const Symbol& savegame_variable = get_joypad_binding_savegame_variable(command);
   get_savegame().set_string(savegame_variable, joypad_string);
 }
 
@@ -0,0 +1,475 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/entities/Entity.h"
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Rectangle.h"
+#include "solarus/lowlevel/SoftwareBlitter.h"
+#include "solarus/lowlevel/Surface.h"
+#include "solarus/lowlevel/Video.h"
+#include "solarus/lua/LuaContext.h"
+#include "solarus/LightMap.h"
+#include "solarus/Transition.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Solarus {
+
+constexpr int LightMap::max_scale;
+constexpr int LightMap::max_cached_shapes;
+
+namespace {
+
+/**
+ * \brief Divides a coordinate, rounding towards negative infinity.
+ * \param value The value to divide.
+ * \param divisor A positive divisor.
+ * \return The quotient.
+ */
+int floor_divide(int value, int divisor) {
+  return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+}
+
+/**
+ * \brief Creates a light map.
+ *
+ * Initially, there is no light and the ambient color is black.
+ *
+ * \param size Size of the light map in pixels, usually the camera size.
+ * \param scale Resolution reduction factor between 1 and max_scale:
+ * lights are computed on blocks of scale x scale pixels.
+ */
+LightMap::LightMap(const Size& size, int scale):
+  Drawable(),
+  size(size),
+  scale(scale),
+  ambient_color(0, 0, 0),
+  view_position(),
+  lights(),
+  next_light_id(1),
+  light_surface(nullptr),
+  enlarged_surface(nullptr),
+  shapes() {
+
+  Debug::check_assertion(!size.is_flat(), "Invalid light map size");
+  Debug::check_assertion(scale >= 1 && scale <= max_scale, "Invalid light map scale");
+
+  light_surface = Surface::create(
+      (size.width + scale - 1) / scale,
+      (size.height + scale - 1) / scale
+  );
+  light_surface->set_software_destination(true);
+  light_surface->set_blend_mode(BlendMode::NONE);
+  light_surface->create_software_surface();
+}
+
+/**
+ * \brief Returns the resolution reduction factor of this light map.
+ * \return The scale.
+ */
+int LightMap::get_scale() const {
+  return scale;
+}
+
+/**
+ * \brief Returns the light where there is no light source.
+ * \return The ambient color.
+ */
+const Color& LightMap::get_ambient_color() const {
+  return ambient_color;
+}
+
+/**
+ * \brief Sets the light where there is no light source.
+ *
+ * Black means complete darkness and white means no darkening at all.
+ *
+ * \param ambient_color The ambient color. Its alpha is ignored.
+ */
+void LightMap::set_ambient_color(const Color& ambient_color) {
+  this->ambient_color = ambient_color;
+}
+
+/**
+ * \brief Returns the map coordinates of the top-left corner of the light map.
+ * \return The view position.
+ */
+const Point& LightMap::get_view_position() const {
+  return view_position;
+}
+
+/**
+ * \brief Sets the map coordinates of the top-left corner of the light map.
+ *
+ * Call this function when the camera moves.
+ *
+ * \param view_position The view position.
+ */
+void LightMap::set_view_position(const Point& view_position) {
+  this->view_position = view_position;
+}
+
+/**
+ * \brief Adds a light at a fixed position.
+ * \param xy Map coordinates of the center of the light.
+ * \param radius Radius of the light in pixels.
+ * \param color Color at the center. Its alpha scales the intensity.
+ * \param falloff How fast the intensity decreases from the center:
+ * 1 is linear, higher values give a smaller bright area.
+ * \return Id of the new light.
+ */
+int LightMap::add_light(const Point& xy, int radius, const Color& color, double falloff) {
+
+  Debug::check_assertion(radius > 0, "Invalid light radius");
+  Debug::check_assertion(falloff > 0.0, "Invalid light falloff");
+
+  const int light_id = next_light_id++;
+  lights.push_back({ light_id, xy, IntrusiveWeakPtr<Entity>(), false, radius, color, falloff });
+  return light_id;
+}
+
+/**
+ * \brief Adds a light that follows an entity.
+ *
+ * The light is not shown while the entity is disabled,
+ * and is removed when the entity is removed from the map.
+ *
+ * \param entity The entity to follow. The light is at its center.
+ * \param radius Radius of the light in pixels.
+ * \param color Color at the center. Its alpha scales the intensity.
+ * \param falloff How fast the intensity decreases from the center:
+ * 1 is linear, higher values give a smaller bright area.
+ * \return Id of the new light.
+ */
+int LightMap::add_light(const EntityPtr& entity, int radius, const Color& color, double falloff) {
+
+  Debug::check_assertion(entity != nullptr, "Missing light entity");
+  Debug::check_assertion(radius > 0, "Invalid light radius");
+  Debug::check_assertion(falloff > 0.0, "Invalid light falloff");
+
+  const int light_id = next_light_id++;
+  lights.push_back({ light_id, Point(), entity, true, radius, color, falloff });
+  return light_id;
+}
+
+/**
+ * \brief Returns whether a light exists.
+ * \param light_id Id of a light.
+ * \return \c true if this light is in the light map.
+ */
+bool LightMap::has_light(int light_id) const {
+
+  return std::any_of(lights.begin(), lights.end(), [light_id](const Light& light) {
+    return light.id == light_id;
+  });
+}
+
+/**
+ * \brief Moves a light.
+ * \param light_id Id of a light.
+ * \param xy Map coordinates of the center of the light, or offset from the
+ * center of the entity if the light follows an entity.
+ * \return \c false if there is no such light.
+ */
+bool LightMap::set_light_position(int light_id, const Point& xy) {
+
+  for (Light& light : lights) {
+    if (light.id == light_id) {
+      light.xy = xy;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * \brief Removes a light.
+ * \param light_id Id of a light.
+ * \return \c false if there is no such light.
+ */
+bool LightMap::remove_light(int light_id) {
+
+  const auto it = std::find_if(lights.begin(), lights.end(), [light_id](const Light& light) {
+    return light.id == light_id;
+  });
+  if (it == lights.end()) {
+    return false;
+  }
+  lights.erase(it);
+  return true;
+}
+
+/**
+ * \brief Removes all lights.
+ */
+void LightMap::clear_lights() {
+  lights.clear();
+}
+
+/**
+ * \brief Returns the number of lights.
+ * \return The number of lights, including lights of disabled entities.
+ */
+int LightMap::get_num_lights() const {
+  return static_cast<int>(lights.size());
+}
+
+/**
+ * \brief Returns the size of this light map.
+ * \return The size in pixels.
+ */
+Size LightMap::get_size() const {
+  return size;
+}
+
+/**
+ * \brief Returns the shape of a light, computing it if it is not cached.
+ * \param radius Radius in light map pixels.
+ * \param color Color at the center.
+ * \param falloff Exponent of the intensity decrease.
+ * \return A surface with the light added to black.
+ */
+const SurfacePtr& LightMap::get_shape(int radius, const Color& color, double falloff) {
+
+  uint8_t r, g, b, a;
+  color.get_components(r, g, b, a);
+  const ShapeKey key(
+      radius,
+      (uint32_t(r) << 24) | (uint32_t(g) << 16) | (uint32_t(b) << 8) | a,
+      static_cast<int>(falloff * 100.0 + 0.5)
+  );
+
+  const auto it = shapes.find(key);
+  if (it != shapes.end()) {
+    return it->second;
+  }
+
+  if (static_cast<int>(shapes.size()) >= max_cached_shapes) {
+    // Lights keep changing: start again rather than growing forever.
+    shapes.clear();
+  }
+
+  const int diameter = 2 * radius + 1;
+  SurfacePtr shape = Surface::create(diameter, diameter);
+  shape->set_software_destination(true);
+  shape->set_blend_mode(BlendMode::ADD);
+  shape->create_software_surface();
+
+  SDL_Surface& pixels = *shape->internal_surface;
+  const double alpha = a / 255.0;
+  for (int y = 0; y < diameter; ++y) {
+    uint32_t* row = reinterpret_cast<uint32_t*>(
+        static_cast<uint8_t*>(pixels.pixels) + y * pixels.pitch
+    );
+    for (int x = 0; x < diameter; ++x) {
+      const double dx = x - radius;
+      const double dy = y - radius;
+      const double distance = std::sqrt(dx * dx + dy * dy) / (radius + 0.5);
+      const double intensity = distance >= 1.0 ?
+          0.0 : std::pow(1.0 - distance, falloff) * alpha;
+      row[x] = SDL_MapRGBA(
+          pixels.format,
+          static_cast<uint8_t>(r * intensity + 0.5),
+          static_cast<uint8_t>(g * intensity + 0.5),
+          static_cast<uint8_t>(b * intensity + 0.5),
+          255
+      );
+    }
+  }
+  shape->mark_all_dirty();
+
+  return shapes.emplace(key, shape).first->second;
+}
+
+/**
+ * \brief Computes the lights at the reduced resolution.
+ *
+ * Lights of entities that were removed are forgotten.
+ */
+void LightMap::render() {
+
+  SDL_Surface& light_pixels = *light_surface->internal_surface;
+
+  uint8_t r, g, b, a;
+  ambient_color.get_components(r, g, b, a);
+  SDL_FillRect(&light_pixels, nullptr, SDL_MapRGBA(light_pixels.format, r, g, b, 255));
+
+  const Rectangle light_box(light_surface->get_size());
+  auto it = lights.begin();
+  while (it != lights.end()) {
+    const Light& light = *it;
+    Point center = light.xy;
+    if (light.follows_entity) {
+      const EntityPtr& entity = light.entity.lock();
+      if (entity == nullptr || entity->is_being_removed()) {
+        it = lights.erase(it);
+        continue;
+      }
+      if (!entity->is_enabled()) {
+        ++it;
+        continue;
+      }
+      center += entity->get_center_point();
+    }
+
+    const int radius = (light.radius + scale - 1) / scale;
+    const Point top_left(
+        floor_divide(center.x - view_position.x, scale) - radius,
+        floor_divide(center.y - view_position.y, scale) - radius
+    );
+    const Rectangle shape_box(top_left, Size(2 * radius + 1, 2 * radius + 1));
+    if (shape_box.overlaps(light_box)) {
+      Surface& shape = *get_shape(radius, light.color, light.falloff);
+      if (!SoftwareBlitter::blit(
+          *shape.internal_surface,
+          Rectangle(shape.get_size()),
+          light_pixels,
+          top_left,
+          BlendMode::ADD
+      )) {
+        // Unusual pixel format: let SDL do it.
+        SDL_Rect dst_rect = { top_left.x, top_left.y, 0, 0 };
+        SDL_BlitSurface(shape.internal_surface.get(), nullptr, &light_pixels, &dst_rect);
+      }
+    }
+    ++it;
+  }
+
+  light_surface->mark_all_dirty();
+}
+
+/**
+ * \brief Multiplies the destination by the enlarged lights.
+ * \param region The subrectangle of the light map to draw.
+ * \param dst_surface The destination surface.
+ * \param dst_position Coordinates on the destination surface.
+ */
+void LightMap::draw_lights_region(
+    const Rectangle& region,
+    Surface& dst_surface,
+    const Point& dst_position
+) {
+  if (dst_surface.software_destination || !Video::is_acceleration_enabled()) {
+    // Enlarge and multiply in a single pass.
+    if (dst_surface.internal_surface == nullptr) {
+      dst_surface.create_software_surface();
+    }
+    else {
+      dst_surface.convert_software_surface();
+    }
+
+    if (SoftwareBlitter::blit_scaled(
+        *light_surface->internal_surface,
+        scale,
+        region,
+        *dst_surface.internal_surface,
+        dst_position,
+        BlendMode::MULTIPLY
+    )) {
+      dst_surface.mark_dirty(Rectangle(dst_position, region.get_size()));
+      return;
+    }
+  }
+
+  // GPU destination or unusual pixel format: enlarge the lights first
+  // and draw them as a normal surface.
+  if (enlarged_surface == nullptr) {
+    enlarged_surface = Surface::create(size);
+    enlarged_surface->set_software_destination(true);
+    enlarged_surface->set_blend_mode(BlendMode::MULTIPLY);
+    enlarged_surface->create_software_surface();
+  }
+
+  if (!SoftwareBlitter::blit_scaled(
+      *light_surface->internal_surface,
+      scale,
+      Rectangle(size),
+      *enlarged_surface->internal_surface,
+      Point(),
+      BlendMode::NONE
+  )) {
+    SDL_Rect dst_rect = {
+        0,
+        0,
+        light_surface->get_width() * scale,
+        light_surface->get_height() * scale
+    };
+    SDL_BlitScaled(
+        light_surface->internal_surface.get(),
+        nullptr,
+        enlarged_surface->internal_surface.get(),
+        &dst_rect
+    );
+  }
+  enlarged_surface->mark_all_dirty();
+  enlarged_surface->raw_draw_region(region, dst_surface, dst_position);
+}
+
+/**
+ * \brief Draws the light map on a surface.
+ * \param dst_surface The destination surface.
+ * \param dst_position Coordinates on the destination surface.
+ */
+void LightMap::raw_draw(
+    Surface& dst_surface,
+    const Point& dst_position
+) {
+  raw_draw_region(Rectangle(size), dst_surface, dst_position);
+}
+
+/**
+ * \brief Draws a region of the light map on a surface.
+ * \param region The subrectangle to draw in the light map.
+ * \param dst_surface The destination surface.
+ * \param dst_position Coordinates on the destination surface.
+ */
+void LightMap::raw_draw_region(
+    const Rectangle& region,
+    Surface& dst_surface,
+    const Point& dst_position
+) {
+  render();
+  draw_lights_region(region, dst_surface, dst_position);
+}
+
+/**
+ * \brief Draws a transition effect on this drawable object.
+ * \param transition The transition effect to apply.
+ */
+void LightMap::draw_transition(Transition& transition) {
+  transition.draw(*light_surface);
+}
+
+/**
+ * \brief Returns the surface where transitions on this drawable object
+ * are applied.
+ * \return The surface for transitions.
+ */
+Surface& LightMap::get_transition_surface() {
+  return *light_surface;
+}
+
+/**
+ * \brief Returns the name identifying this type in Lua.
+ * \return The name identifying this type in Lua.
+ */
+const std::string& LightMap::get_lua_type_name() const {
+  return LuaContext::light_map_module_name;
+}
+
+}
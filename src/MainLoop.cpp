@@ -14,26 +14,34 @@
  * You should have received a copy of the GNU General Public License along
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
+#include "solarus/entities/Hero.h"
 #include "solarus/entities/TilePattern.h"
 #include "solarus/lowlevel/Color.h"
 #include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/FrameCapture.h"
 #include "solarus/lowlevel/Logger.h"
 #include "solarus/lowlevel/Music.h"
 #include "solarus/lowlevel/QuestFiles.h"
+#include "solarus/lowlevel/Sound.h"
+#include "solarus/lowlevel/StartupProfile.h"
 #include "solarus/lowlevel/String.h"
 #include "solarus/lowlevel/Surface.h"
 #include "solarus/lowlevel/System.h"
+#include "solarus/lowlevel/TextSurface.h"
 #include "solarus/lowlevel/Video.h"
 #include "solarus/lua/LuaContext.h"
+#include "solarus/lua/LuaProfiler.h"
 #include "solarus/lua/LuaTools.h"
 #include "solarus/Arguments.h"
 #include "solarus/CurrentQuest.h"
 #include "solarus/Game.h"
+#include "solarus/Map.h"
 #include "solarus/QuestProperties.h"
 #include "solarus/MainLoop.h"
 #include "solarus/Savegame.h"
 #include "solarus/Settings.h"
 #include <lua.hpp>
+#include <future>
 #include <sstream>
 #include <string>
 #include <thread>
@@ -126,6 +134,7 @@ MainLoop::MainLoop(const Arguments& args):
   num_lua_commands_pushed(0),
   num_lua_commands_done(0) {
 
+  StartupProfile::initialize(args);
   Logger::info(std::string("Solarus ") + SOLARUS_VERSION);
 
   // Main loop settings.
@@ -140,11 +149,21 @@ MainLoop::MainLoop(const Arguments& args):
   // Try to open the quest.
   const std::string& quest_path = get_quest_path(args);
   Logger::info("Opening quest '" + quest_path + "'");
-  if (!QuestFiles::open_quest(args.get_program_name(), quest_path)) {
-    Debug::error("No quest was found in the directory '" + quest_path + "'");
-    return;
+  {
+    StartupProfile::Phase phase("Quest files");
+    if (!QuestFiles::open_quest(args.get_program_name(), quest_path)) {
+      Debug::error("No quest was found in the directory '" + quest_path + "'");
+      return;
+    }
   }
 
+  // Read the quest resource list from data while the engine features
+  // are initialized: it only needs the quest files.
+  std::future<void> quest_database = std::async(std::launch::async, []() {
+    StartupProfile::Phase phase("Quest database");
+    CurrentQuest::initialize();
+  });
+
   // Initialize engine features (audio, video...).
   System::initialize(args);
 
@@ -155,12 +174,14 @@ MainLoop::MainLoop(const Arguments& args):
     Logger::info("Turbo mode: no");
   }
 
-  // Read the quest resource list from data.
-  CurrentQuest::initialize();
+  quest_database.get();
   TilePattern::initialize();
 
   // Read the quest general properties.
-  load_quest_properties();
+  {
+    StartupProfile::Phase phase("Quest properties");
+    load_quest_properties();
+  }
 
   // Create the quest surface.
   root_surface = Surface::create(
@@ -168,11 +189,18 @@ MainLoop::MainLoop(const Arguments& args):
   );
   root_surface->set_software_destination(false);  // Accelerate this surface.
 
+  // Start capturing frames if requested.
+  FrameCapture::initialize(args);
+
   // Run the Lua world.
   // Do this after the creation of the window, but before showing the window,
   // because Lua might change the video mode initially.
-  lua_context = std::unique_ptr<LuaContext>(new LuaContext(*this));
-  lua_context->initialize();
+  LuaProfiler::initialize(args);
+  {
+    StartupProfile::Phase phase("Lua");
+    lua_context = std::unique_ptr<LuaContext>(new LuaContext(*this));
+    lua_context->initialize();
+  }
 
   // Set up the Lua console.
   const std::string& lua_console_arg = args.get_argument_value("-lua-console");
@@ -186,7 +214,10 @@ MainLoop::MainLoop(const Arguments& args):
   }
 
   // Finally show the window.
-  Video::show_window();
+  {
+    StartupProfile::Phase phase("Show window");
+    Video::show_window();
+  }
 }
 
 /**
@@ -206,6 +237,8 @@ MainLoop::~MainLoop() {
   if (lua_context != nullptr) {
     lua_context->exit();
   }
+  LuaProfiler::quit();
+  FrameCapture::quit();
   TilePattern::quit();
   CurrentQuest::quit();
   QuestFiles::close_quest();
@@ -372,7 +405,11 @@ void MainLoop::run() {
 
     // 3. Redraw the screen.
     if (num_updates > 0) {
-      draw();
+      {
+        StartupProfile::Phase phase("First draw");
+        draw();
+      }
+      StartupProfile::notify_first_frame();
     }
 
     // 4. Sleep if we have time, to save CPU and GPU cycles.
@@ -497,12 +534,15 @@ void MainLoop::update() {
  */
 void MainLoop::draw() {
 
+  // Captured frames need the quest surface in RAM.
+  root_surface->set_software_destination(FrameCapture::is_capturing());
   root_surface->clear();
 
   if (game != nullptr) {
     game->draw(root_surface);
   }
   lua_context->main_on_draw(root_surface);
+  FrameCapture::capture(*root_surface);
   Video::render(root_surface);
 }
 
@@ -531,6 +571,10 @@ void MainLoop::load_quest_properties() {
       properties.get_max_quest_size()
   );
 
+  Sound::set_max_voices(properties.get_max_sound_voices());
+  Sound::set_default_max_voices_per_sound(properties.get_max_voices_per_sound());
+  Sound::set_coalescing_louder(properties.get_louder_coalesced_sounds());
+
 }
 
 /**
@@ -19,6 +19,7 @@
 #include "solarus/entities/GroundInfo.h"
 #include "solarus/entities/Hero.h"
 #include "solarus/entities/NonAnimatedRegions.h"
+#include "solarus/entities/ParallaxLayers.h"
 #include "solarus/entities/TilePattern.h"
 #include "solarus/entities/Tileset.h"
 #include "solarus/lowlevel/Debug.h"
@@ -32,9 +33,73 @@
 #include "solarus/ResourceProvider.h"
 #include "solarus/Savegame.h"
 #include "solarus/Sprite.h"
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
 
 namespace Solarus {
 
+namespace {
+
+/**
+ * \brief Visits the pixels of a segment in order, like Bresenham's algorithm.
+ *
+ * Each pixel shares an edge or a corner with the previous one.
+ *
+ * \param source First pixel of the segment.
+ * \param target Last pixel of the segment.
+ * \param visit Function called for each pixel. The walk stops when it
+ * returns \c true.
+ */
+template<typename Function>
+void walk_segment(const Point& source, const Point& target, Function visit) {
+
+  const int dx = std::abs(target.x - source.x);
+  const int dy = -std::abs(target.y - source.y);
+  const int step_x = source.x < target.x ? 1 : -1;
+  const int step_y = source.y < target.y ? 1 : -1;
+  int error = dx + dy;
+  Point xy = source;
+  while (!visit(xy) && xy != target) {
+    const int error2 = 2 * error;
+    if (error2 >= dy) {
+      error += dy;
+      xy.x += step_x;
+    }
+    if (error2 <= dx) {
+      error += dx;
+      xy.y += step_y;
+    }
+  }
+}
+
+/**
+ * \brief Returns the smallest rectangle containing a segment.
+ * \param source First pixel of the segment.
+ * \param target Last pixel of the segment.
+ * \return The bounding box of the segment.
+ */
+Rectangle get_segment_bounding_box(const Point& source, const Point& target) {
+
+  return Rectangle(
+      std::min(source.x, target.x),
+      std::min(source.y, target.y),
+      std::abs(target.x - source.x) + 1,
+      std::abs(target.y - source.y) + 1
+  );
+}
+
+/**
+ * \brief Returns the 8x8 cell of the map containing a point.
+ * \param xy A point.
+ * \return The rectangle of its cell.
+ */
+Rectangle get_cell_box(const Point& xy) {
+  return Rectangle(xy.x & ~7, xy.y & ~7, 8, 8);
+}
+
+}
+
 /**
  * \brief Creates a map.
  * \param id Id of the map, used to determine the data file and
@@ -51,11 +116,14 @@ Map::Map(const std::string& id):
   floor(MapData::NO_FLOOR),
   background_surface(nullptr),
   foreground_surface(nullptr),
+  data(nullptr),
   loaded(false),
   started(false),
   destination_name(""),
   entities(nullptr),
-  suspended(false) {
+  suspended(false),
+  ground_revision(0),
+  path_finding_graphs() {
 
 }
 
@@ -89,6 +157,7 @@ void Map::set_tileset(const std::string& tileset_id) {
   ResourceProvider& resource_provider = get_game().get_resource_provider();
   tileset = &resource_provider.get_tileset(tileset_id);
   get_entities().notify_tileset_changed();
+  path_finding_graphs.clear();  // The ground of tiles has changed.
   this->tileset_id = tileset_id;
   build_background_surface();
 }
@@ -265,6 +334,7 @@ void Map::unload() {
     background_surface = nullptr;
     foreground_surface = nullptr;
     entities = nullptr;
+    data = nullptr;
 
     loaded = false;
   }
@@ -279,35 +349,53 @@ void Map::unload() {
  */
 void Map::load(Game& game) {
 
-  background_surface = Surface::create(
-      Video::get_quest_size()
-  );
-
   // Read the map data file.
-  MapData data;
+  std::shared_ptr<MapData> data = std::make_shared<MapData>();
   const std::string& file_name = std::string("maps/") + get_id() + ".dat";
-  bool success = data.import_from_quest_file(file_name);
+  bool success = data->import_from_quest_file(file_name);
 
   if (!success) {
     Debug::die("Failed to load map data file '" + file_name + "'");
   }
 
-  // Initialize the map from the data just read.
+  load(game, data);
+}
+
+/**
+ * \brief Loads the map into a game from data already read.
+ *
+ * This avoids reading the map data file again, for example when restoring
+ * a game checkpoint.
+ *
+ * \param game The game.
+ * \param data The data of this map.
+ */
+void Map::load(Game& game, const std::shared_ptr<const MapData>& data) {
+
+  Debug::check_assertion(data != nullptr, "Missing map data");
+
+  background_surface = Surface::create(
+      Video::get_quest_size()
+  );
+
+  // Initialize the map from the data.
+  this->data = data;
   this->game = &game;
   ResourceProvider& resource_provider = game.get_resource_provider();
-  location.set_xy(data.get_location());
-  location.set_size(data.get_size());
-  width8 = data.get_size().width / 8;
-  height8 = data.get_size().height / 8;
-  min_layer = data.get_min_layer();
-  max_layer = data.get_max_layer();
-  music_id = data.get_music_id();
-  set_world(data.get_world());
-  set_floor(data.get_floor());
-  tileset_id = data.get_tileset_id();
+  location.set_xy(data->get_location());
+  location.set_size(data->get_size());
+  width8 = data->get_size().width / 8;
+  height8 = data->get_size().height / 8;
+  min_layer = data->get_min_layer();
+  max_layer = data->get_max_layer();
+  music_id = data->get_music_id();
+  Music::preload(music_id);  // Decode it in the background while the map loads.
+  set_world(data->get_world());
+  set_floor(data->get_floor());
+  tileset_id = data->get_tileset_id();
   tileset = &resource_provider.get_tileset(tileset_id);
   entities = std::unique_ptr<Entities>(new Entities(game, *this));
-  entities->create_entities(data);
+  entities->create_entities(*data);
 
   build_background_surface();
   build_foreground_surface();
@@ -315,6 +403,14 @@ void Map::load(Game& game) {
   loaded = true;
 }
 
+/**
+ * \brief Returns the data this map was loaded from.
+ * \return The map data, or nullptr if the map is not loaded.
+ */
+const std::shared_ptr<const MapData>& Map::get_data() const {
+  return data;
+}
+
 /**
  * \brief Returns the shared Lua context.
  *
@@ -384,7 +480,7 @@ Destination* Map::get_destination() {
 
   Debug::check_assertion(is_loaded(), "This map is not loaded");
 
-  std::shared_ptr<Destination> destination;
+  IntrusivePtr<Destination> destination;
   if (!destination_name.empty()) {
     // Use the destination whose name was specified.
     const EntityPtr& entity = get_entities().find_entity(destination_name);
@@ -401,7 +497,7 @@ Destination* Map::get_destination() {
       // quest is released.
     }
     else {
-      destination = std::static_pointer_cast<Destination>(entity);
+      destination = static_pointer_cast<Destination>(entity);
     }
   }
 
@@ -554,6 +650,13 @@ void Map::build_background_surface() {
  */
 void Map::draw_background(const SurfacePtr& dst_surface) {
 
+  const CameraPtr& camera = get_camera();
+  if (camera != nullptr &&
+      entities->is_hidden(camera->get_bounding_box(), get_min_layer() - 1)) {
+    // The whole visible area is covered by opaque tiles.
+    return;
+  }
+
   background_surface->draw(dst_surface);
 }
 
@@ -777,9 +880,6 @@ bool Map::test_collision_with_ground(
     const Entity& entity_to_check,
     bool& found_diagonal_wall) const {
 
-  bool on_obstacle = false;
-  int x_in_tile, y_in_tile;
-
   // If the point is outside the map, this is an obstacle.
   if (test_collision_with_border(x, y)) {
     return true;
@@ -787,6 +887,31 @@ bool Map::test_collision_with_ground(
 
   // Get the ground property under this point.
   Ground ground = get_ground(layer, x, y, &entity_to_check);
+  return is_ground_obstacle(ground, x, y, entity_to_check, found_diagonal_wall);
+}
+
+/**
+ * \brief Tests whether a point of the map with the given ground is an
+ * obstacle.
+ * \param ground The ground at this point.
+ * \param x X coordinate of the point to check.
+ * \param y Y coordinate of the point to check.
+ * \param entity_to_check The entity to check (used to decide what grounds are
+ * considered as obstacle).
+ * \param [out] found_diagonal_wall \c true if the ground is a diagonal wall,
+ * unchanged otherwise.
+ * \return \c true if the point is an obstacle.
+ */
+bool Map::is_ground_obstacle(
+    Ground ground,
+    int x,
+    int y,
+    const Entity& entity_to_check,
+    bool& found_diagonal_wall) const {
+
+  bool on_obstacle = false;
+  int x_in_tile, y_in_tile;
+
   switch (ground) {
 
   case Ground::EMPTY:
@@ -861,12 +986,13 @@ bool Map::test_collision_with_entities(
   get_entities().get_entities_in_rectangle(collision_box, entities_nearby);
   for (const EntityPtr& entity_nearby: entities_nearby) {
 
-    if (entity_nearby->overlaps(collision_box) &&
-        (entity_nearby->get_layer() == layer || entity_nearby->has_layer_independent_collisions()) &&
-        entity_nearby->is_obstacle_for(entity_to_check, collision_box) &&
+    // Cheap tests first: is_obstacle_for() is virtual and may call Lua.
+    if (entity_nearby.get() != &entity_to_check &&
         entity_nearby->is_enabled() &&
         !entity_nearby->is_being_removed() &&
-        entity_nearby.get() != &entity_to_check) {
+        (entity_nearby->get_layer() == layer || entity_nearby->has_layer_independent_collisions()) &&
+        entity_nearby->overlaps(collision_box) &&
+        entity_nearby->is_obstacle_for(entity_to_check, collision_box)) {
       return true;
     }
   }
@@ -993,6 +1119,163 @@ bool Map::test_collision_with_obstacles(
   return test_collision_with_obstacles(layer, point.x, point.y, entity_to_check);
 }
 
+/**
+ * \brief Finds the first obstacle on a segment.
+ *
+ * This gives the same result as testing each pixel of the segment in order
+ * with test_collision_with_obstacles(), but much faster.
+ * The ground grid is walked cell by cell: the ground of static tiles is
+ * read once per 8x8 cell, and dynamic entities are only tested
+ * in the cells they overlap.
+ *
+ * \param layer Layer of the segment.
+ * \param source First pixel of the segment.
+ * \param target Last pixel of the segment.
+ * \param entity_to_check The entity to check (used to decide what is
+ * considered as obstacle). It never stops the segment itself.
+ * \param[out] hit_point The first obstacle pixel, unchanged if there is none.
+ * \param[out] hit_entity The entity that is the obstacle at this pixel,
+ * or \c nullptr if it is the ground or the map border.
+ * \return \c true if an obstacle was found.
+ */
+bool Map::raycast(
+    int layer,
+    const Point& source,
+    const Point& target,
+    Entity& entity_to_check,
+    Point& hit_point,
+    EntityPtr& hit_entity) {
+
+  hit_entity = nullptr;
+
+  // Get the dynamic entities around the segment with a single query.
+  EntityVector entities_nearby;
+  get_entities().get_entities_in_rectangle_sorted(
+      get_segment_bounding_box(source, target), entities_nearby
+  );
+  EntityVector obstacles;
+  EntityVector ground_modifiers;
+  for (const EntityPtr& entity_nearby : entities_nearby) {
+    if (entity_nearby.get() == &entity_to_check ||
+        !entity_nearby->is_enabled() ||
+        entity_nearby->is_being_removed()) {
+      continue;
+    }
+    if (entity_nearby->get_layer() == layer ||
+        entity_nearby->has_layer_independent_collisions()) {
+      obstacles.push_back(entity_nearby);
+    }
+    if (entity_nearby->get_layer() == layer &&
+        entity_nearby->get_modified_ground() != Ground::EMPTY) {
+      ground_modifiers.push_back(entity_nearby);
+    }
+  }
+
+  // State of the current cell.
+  Rectangle cell_box;  // Empty until the first pixel.
+  Ground cell_ground = Ground::EMPTY;
+  bool cell_ground_modified = false;
+  EntityVector cell_obstacles;
+
+  bool found_diagonal_wall = false;
+  bool found = false;
+  walk_segment(source, target, [&](const Point& xy) {
+
+    if (test_collision_with_border(xy)) {
+      found = true;
+    }
+    else {
+      if (!cell_box.contains(xy)) {
+        // Entering a new cell.
+        cell_box = get_cell_box(xy);
+        cell_ground = entities->get_tile_ground(layer, xy.x, xy.y);
+        cell_ground_modified = false;
+        for (const EntityPtr& ground_modifier : ground_modifiers) {
+          if (ground_modifier->overlaps(cell_box)) {
+            cell_ground_modified = true;
+            break;
+          }
+        }
+        cell_obstacles.clear();
+        for (const EntityPtr& obstacle : obstacles) {
+          if (obstacle->overlaps(cell_box)) {
+            cell_obstacles.push_back(obstacle);
+          }
+        }
+      }
+
+      const Ground ground = cell_ground_modified ?
+          get_ground(layer, xy, &entity_to_check) : cell_ground;
+      found = is_ground_obstacle(ground, xy.x, xy.y, entity_to_check, found_diagonal_wall);
+
+      const Rectangle pixel_box(xy, Size(1, 1));
+      for (const EntityPtr& obstacle : cell_obstacles) {
+        if (found) {
+          break;
+        }
+        if (obstacle->overlaps(pixel_box) &&
+            obstacle->is_obstacle_for(entity_to_check, pixel_box)) {
+          hit_entity = obstacle;
+          found = true;
+        }
+      }
+    }
+
+    if (found) {
+      hit_point = xy;
+    }
+    return found;
+  });
+
+  return found;
+}
+
+/**
+ * \brief Returns the entities that overlap a segment.
+ *
+ * Entities are returned in the order the segment reaches them,
+ * and in Z order for entities reached at the same pixel.
+ *
+ * \param source First pixel of the segment.
+ * \param target Last pixel of the segment.
+ * \param[out] result The entities on the segment.
+ */
+void Map::get_entities_on_segment(
+    const Point& source,
+    const Point& target,
+    EntityVector& result) {
+
+  EntityVector remaining;
+  get_entities().get_entities_in_rectangle_sorted(
+      get_segment_bounding_box(source, target), remaining
+  );
+
+  Rectangle cell_box;  // Empty until the first pixel.
+  std::vector<size_t> cell_entities;
+  walk_segment(source, target, [&](const Point& xy) {
+
+    if (!cell_box.contains(xy)) {
+      // Entering a new cell: only keep entities that overlap it.
+      cell_box = get_cell_box(xy);
+      cell_entities.clear();
+      for (size_t i = 0; i < remaining.size(); ++i) {
+        if (remaining[i] != nullptr && remaining[i]->overlaps(cell_box)) {
+          cell_entities.push_back(i);
+        }
+      }
+    }
+
+    for (size_t i : cell_entities) {
+      EntityPtr& entity = remaining[i];
+      if (entity != nullptr && entity->overlaps(xy)) {
+        result.push_back(entity);
+        entity = nullptr;
+      }
+    }
+    return result.size() == remaining.size();
+  });
+}
+
 /**
  * \brief Returns whether there is empty ground in the specified rectangle.
  *
@@ -1111,6 +1394,53 @@ Ground Map::get_ground(
   return entities->get_tile_ground(layer, xy.x, xy.y);
 }
 
+/**
+ * \brief Returns a counter that changes whenever the ground may have changed
+ * somewhere on the map.
+ *
+ * Results of get_ground() remain valid as long as this value does not
+ * change, so they can be cached.
+ *
+ * \return The current ground revision.
+ */
+uint32_t Map::get_ground_revision() const {
+  return ground_revision;
+}
+
+/**
+ * \brief Notifies the map that the ground may have changed somewhere.
+ *
+ * This is called when a ground modifier entity appears, disappears, moves
+ * or changes its ground.
+ * It invalidates ground information cached by entities.
+ */
+void Map::notify_ground_changed() {
+  ++ground_revision;
+}
+
+/**
+ * \brief Returns the graph used to compute long paths on a layer.
+ *
+ * The graph is created the first time it is requested for a layer and a
+ * set of ground obstacles.
+ *
+ * \param layer A layer of the map.
+ * \param ground_obstacles Bit field of the grounds that are obstacles
+ * for the entity that looks for a path (one bit for each value of Ground).
+ * \return The corresponding graph.
+ */
+PathFindingGraph& Map::get_path_finding_graph(int layer, uint32_t ground_obstacles) {
+
+  std::unique_ptr<PathFindingGraph>& graph =
+      path_finding_graphs[std::make_pair(layer, ground_obstacles)];
+  if (graph == nullptr) {
+    graph = std::unique_ptr<PathFindingGraph>(
+        new PathFindingGraph(*this, layer, ground_obstacles)
+    );
+  }
+  return *graph;
+}
+
 /**
  * \brief Returns the modified ground of an entity at the specified point.
  *
@@ -0,0 +1,566 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Random.h"
+#include "solarus/lowlevel/Rectangle.h"
+#include "solarus/lowlevel/Surface.h"
+#include "solarus/lowlevel/System.h"
+#include "solarus/lua/LuaContext.h"
+#include "solarus/ParticleEmitter.h"
+#include "solarus/Transition.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Solarus {
+
+/**
+ * \brief Creates a particle emitter.
+ *
+ * The emitter is initially not emitting.
+ *
+ * \param sheet Image containing the frames of particles.
+ * \param frame_size Size of each frame in the sheet.
+ * \param max_particles Maximum number of particles alive at the same time.
+ */
+ParticleEmitter::ParticleEmitter(
+    const SurfacePtr& sheet,
+    const Size& frame_size,
+    int max_particles
+):
+  Drawable(),
+  sheet(sheet),
+  transition_surface(Surface::create(1, 1)),
+  frame_size(frame_size),
+  num_columns(1),
+  num_frames(1),
+  frame_delay(0),
+  max_particles(max_particles),
+  emitting(false),
+  emission_rate(0.0),
+  emission_debt(0.0),
+  emission_size(),
+  min_lifetime(1000),
+  max_lifetime(1000),
+  min_speed(0.0),
+  max_speed(0.0),
+  angle(0.0),
+  spread(0.0),
+  gravity_x(0.0),
+  gravity_y(0.0),
+  random_engine(Random::get_number(std::numeric_limits<int>::max()) + 1) {
+
+  Debug::check_assertion(sheet != nullptr, "Missing particle sheet");
+  Debug::check_assertion(!frame_size.is_flat(), "Invalid particle frame size");
+  Debug::check_assertion(max_particles > 0, "Invalid maximum number of particles");
+
+  num_columns = std::max(sheet->get_width() / frame_size.width, 1);
+  const int num_rows = std::max(sheet->get_height() / frame_size.height, 1);
+  num_frames = num_columns * num_rows;
+
+  xs.reserve(max_particles);
+  ys.reserve(max_particles);
+  speeds_x.reserve(max_particles);
+  speeds_y.reserve(max_particles);
+  ages.reserve(max_particles);
+  lifetimes.reserve(max_particles);
+  frames.reserve(max_particles);
+}
+
+/**
+ * \brief Returns the image containing the frames of particles.
+ * \return The sprite sheet.
+ */
+const SurfacePtr& ParticleEmitter::get_sheet() const {
+  return sheet;
+}
+
+/**
+ * \brief Returns the size of a frame of particle.
+ * \return The frame size.
+ */
+const Size& ParticleEmitter::get_frame_size() const {
+  return frame_size;
+}
+
+/**
+ * \brief Returns the number of frames in the sheet.
+ * \return The number of frames.
+ */
+int ParticleEmitter::get_num_frames() const {
+  return num_frames;
+}
+
+/**
+ * \brief Returns the delay between two frames of a particle.
+ * \return The frame delay in milliseconds, or 0 if the frames are spread
+ * over the lifetime of each particle.
+ */
+uint32_t ParticleEmitter::get_frame_delay() const {
+  return frame_delay;
+}
+
+/**
+ * \brief Sets the delay between two frames of a particle.
+ *
+ * With a delay, the frames of a particle loop.
+ * With no delay, each particle shows each frame once during its lifetime.
+ *
+ * \param frame_delay The frame delay in milliseconds, or 0.
+ */
+void ParticleEmitter::set_frame_delay(uint32_t frame_delay) {
+  this->frame_delay = frame_delay;
+}
+
+/**
+ * \brief Returns the maximum number of particles alive at the same time.
+ * \return The maximum number of particles.
+ */
+int ParticleEmitter::get_max_particles() const {
+  return max_particles;
+}
+
+/**
+ * \brief Returns the number of particles currently alive.
+ * \return The number of particles.
+ */
+int ParticleEmitter::get_num_particles() const {
+  return static_cast<int>(xs.size());
+}
+
+/**
+ * \brief Returns whether particles are continuously emitted.
+ * \return \c true if the emitter is emitting.
+ */
+bool ParticleEmitter::is_emitting() const {
+  return emitting;
+}
+
+/**
+ * \brief Sets whether particles are continuously emitted.
+ *
+ * Particles already alive continue to live when emission stops.
+ *
+ * \param emitting \c true to emit particles.
+ */
+void ParticleEmitter::set_emitting(bool emitting) {
+
+  this->emitting = emitting;
+  emission_debt = 0.0;
+}
+
+/**
+ * \brief Returns the number of particles emitted per second.
+ * \return The emission rate.
+ */
+double ParticleEmitter::get_emission_rate() const {
+  return emission_rate;
+}
+
+/**
+ * \brief Sets the number of particles emitted per second.
+ * \param emission_rate The emission rate.
+ */
+void ParticleEmitter::set_emission_rate(double emission_rate) {
+  this->emission_rate = std::max(emission_rate, 0.0);
+}
+
+/**
+ * \brief Returns the size of the area where particles appear.
+ * \return The emission size.
+ */
+const Size& ParticleEmitter::get_emission_size() const {
+  return emission_size;
+}
+
+/**
+ * \brief Sets the size of the area where particles appear.
+ *
+ * The area is centered on the origin of the emitter.
+ *
+ * \param emission_size The emission size.
+ */
+void ParticleEmitter::set_emission_size(const Size& emission_size) {
+  this->emission_size = emission_size;
+}
+
+/**
+ * \brief Returns the lifetime range of new particles.
+ * \param[out] min_lifetime The minimum lifetime in milliseconds.
+ * \param[out] max_lifetime The maximum lifetime in milliseconds.
+ */
+void ParticleEmitter::get_lifetime(uint32_t& min_lifetime, uint32_t& max_lifetime) const {
+
+  min_lifetime = this->min_lifetime;
+  max_lifetime = this->max_lifetime;
+}
+
+/**
+ * \brief Sets the lifetime range of new particles.
+ * \param min_lifetime The minimum lifetime in milliseconds.
+ * \param max_lifetime The maximum lifetime in milliseconds.
+ */
+void ParticleEmitter::set_lifetime(uint32_t min_lifetime, uint32_t max_lifetime) {
+
+  this->min_lifetime = std::max(min_lifetime, static_cast<uint32_t>(1));
+  this->max_lifetime = std::max(max_lifetime, this->min_lifetime);
+}
+
+/**
+ * \brief Returns the initial speed range of new particles.
+ * \param[out] min_speed The minimum speed in pixels per second.
+ * \param[out] max_speed The maximum speed in pixels per second.
+ */
+void ParticleEmitter::get_speed(double& min_speed, double& max_speed) const {
+
+  min_speed = this->min_speed;
+  max_speed = this->max_speed;
+}
+
+/**
+ * \brief Sets the initial speed range of new particles.
+ * \param min_speed The minimum speed in pixels per second.
+ * \param max_speed The maximum speed in pixels per second.
+ */
+void ParticleEmitter::set_speed(double min_speed, double max_speed) {
+
+  this->min_speed = std::max(min_speed, 0.0);
+  this->max_speed = std::max(max_speed, this->min_speed);
+}
+
+/**
+ * \brief Returns the direction of new particles.
+ * \param[out] angle The mean direction in radians.
+ * \param[out] spread The maximum deviation from this direction in radians.
+ */
+void ParticleEmitter::get_angle(double& angle, double& spread) const {
+
+  angle = this->angle;
+  spread = this->spread;
+}
+
+/**
+ * \brief Sets the direction of new particles.
+ * \param angle The mean direction in radians (0 is east, pi/2 is north).
+ * \param spread The maximum deviation from this direction in radians.
+ */
+void ParticleEmitter::set_angle(double angle, double spread) {
+
+  this->angle = angle;
+  this->spread = std::abs(spread);
+}
+
+/**
+ * \brief Returns the acceleration applied to all particles.
+ * \param[out] x Horizontal acceleration in pixels per second squared.
+ * \param[out] y Vertical acceleration in pixels per second squared.
+ */
+void ParticleEmitter::get_gravity(double& x, double& y) const {
+
+  x = gravity_x;
+  y = gravity_y;
+}
+
+/**
+ * \brief Sets the acceleration applied to all particles.
+ * \param x Horizontal acceleration in pixels per second squared.
+ * \param y Vertical acceleration in pixels per second squared
+ * (positive values go down).
+ */
+void ParticleEmitter::set_gravity(double x, double y) {
+
+  gravity_x = x;
+  gravity_y = y;
+}
+
+/**
+ * \brief Returns a random number in a range.
+ * \param min Lower bound.
+ * \param max Upper bound.
+ * \return A random number between min and max.
+ */
+float ParticleEmitter::get_random(float min, float max) {
+
+  if (max <= min) {
+    return min;
+  }
+  return std::uniform_real_distribution<float>(min, max)(random_engine);
+}
+
+/**
+ * \brief Emits particles immediately.
+ *
+ * Particles beyond the maximum number are not created.
+ *
+ * \param count Number of particles to emit.
+ */
+void ParticleEmitter::emit(int count) {
+
+  count = std::min(count, max_particles - get_num_particles());
+  if (count <= 0) {
+    return;
+  }
+
+  const float half_width = emission_size.width / 2.0f;
+  const float half_height = emission_size.height / 2.0f;
+  for (int i = 0; i < count; ++i) {
+    const float speed = get_random(min_speed, max_speed);
+    const float direction = get_random(angle - spread, angle + spread);
+    xs.push_back(get_random(-half_width, half_width));
+    ys.push_back(get_random(-half_height, half_height));
+    speeds_x.push_back(speed * std::cos(direction));
+    speeds_y.push_back(-speed * std::sin(direction));
+    ages.push_back(0.0f);
+    lifetimes.push_back(get_random(min_lifetime, max_lifetime));
+    frames.push_back(0);
+  }
+}
+
+/**
+ * \brief Removes all particles.
+ */
+void ParticleEmitter::clear() {
+
+  xs.clear();
+  ys.clear();
+  speeds_x.clear();
+  speeds_y.clear();
+  ages.clear();
+  lifetimes.clear();
+  frames.clear();
+  emission_debt = 0.0;
+}
+
+/**
+ * \brief Removes particles whose lifetime is over.
+ *
+ * The order of remaining particles is preserved.
+ */
+void ParticleEmitter::remove_dead_particles() {
+
+  const int num_particles = get_num_particles();
+  int num_alive = 0;
+  for (int i = 0; i < num_particles; ++i) {
+    if (ages[i] >= lifetimes[i]) {
+      continue;
+    }
+    if (num_alive != i) {
+      xs[num_alive] = xs[i];
+      ys[num_alive] = ys[i];
+      speeds_x[num_alive] = speeds_x[i];
+      speeds_y[num_alive] = speeds_y[i];
+      ages[num_alive] = ages[i];
+      lifetimes[num_alive] = lifetimes[i];
+      frames[num_alive] = frames[i];
+    }
+    ++num_alive;
+  }
+
+  xs.resize(num_alive);
+  ys.resize(num_alive);
+  speeds_x.resize(num_alive);
+  speeds_y.resize(num_alive);
+  ages.resize(num_alive);
+  lifetimes.resize(num_alive);
+  frames.resize(num_alive);
+}
+
+/**
+ * \brief Returns the size of a particle.
+ * \return The frame size.
+ */
+Size ParticleEmitter::get_size() const {
+  return frame_size;
+}
+
+/**
+ * \brief Emits new particles and advances existing ones of one time step.
+ */
+void ParticleEmitter::update() {
+
+  Drawable::update();
+
+  if (is_suspended()) {
+    return;
+  }
+
+  const float delta_ms = static_cast<float>(System::timestep);
+  const float delta = delta_ms / 1000.0f;
+
+  if (emitting) {
+    emission_debt += emission_rate * delta;
+    const int count = static_cast<int>(emission_debt);
+    emission_debt -= count;
+    emit(count);
+  }
+
+  // Branch-free loops over separate arrays: the compiler can vectorize them.
+  const int num_particles = get_num_particles();
+  float* x = xs.data();
+  float* y = ys.data();
+  float* speed_x = speeds_x.data();
+  float* speed_y = speeds_y.data();
+  float* age = ages.data();
+  const float* lifetime = lifetimes.data();
+  int* frame = frames.data();
+
+  const float acceleration_x = static_cast<float>(gravity_x) * delta;
+  const float acceleration_y = static_cast<float>(gravity_y) * delta;
+  for (int i = 0; i < num_particles; ++i) {
+    speed_x[i] += acceleration_x;
+    speed_y[i] += acceleration_y;
+    x[i] += speed_x[i] * delta;
+    y[i] += speed_y[i] * delta;
+    age[i] += delta_ms;
+  }
+
+  if (frame_delay > 0) {
+    // Looping animation.
+    const float frames_per_ms = 1.0f / frame_delay;
+    for (int i = 0; i < num_particles; ++i) {
+      frame[i] = static_cast<int>(age[i] * frames_per_ms) % num_frames;
+    }
+  }
+  else {
+    // One animation over the whole lifetime.
+    const int last_frame = num_frames - 1;
+    for (int i = 0; i < num_particles; ++i) {
+      frame[i] = std::min(static_cast<int>(age[i] * num_frames / lifetime[i]), last_frame);
+    }
+  }
+
+  remove_dead_particles();
+}
+
+/**
+ * \brief Draws all particles.
+ * \param dst_surface The destination surface.
+ * \param dst_position Coordinates on the destination surface.
+ * The origin of the emitter will appear at these coordinates.
+ */
+void ParticleEmitter::raw_draw(
+    Surface& dst_surface,
+    const Point& dst_position
+) {
+  const int num_particles = get_num_particles();
+  if (num_particles == 0) {
+    return;
+  }
+
+  const int width = frame_size.width;
+  const int height = frame_size.height;
+  const Point top_left = dst_position - Point(width / 2, height / 2);
+
+  // The sheet may be shared with the caller: only use our blend mode
+  // and opacity while drawing.
+  const BlendMode sheet_blend_mode = sheet->get_blend_mode();
+  const uint8_t sheet_opacity = sheet->get_opacity();
+  sheet->set_blend_mode(get_blend_mode());
+  sheet->set_opacity(sheet_opacity * transition_surface->get_opacity() / 255);
+  for (int i = 0; i < num_particles; ++i) {
+    const Rectangle src_rect(
+        (frames[i] % num_columns) * width,
+        (frames[i] / num_columns) * height,
+        width,
+        height
+    );
+    const Point particle_xy(
+        static_cast<int>(std::floor(xs[i])),
+        static_cast<int>(std::floor(ys[i]))
+    );
+    sheet->raw_draw_region(src_rect, dst_surface, top_left + particle_xy);
+  }
+  sheet->set_blend_mode(sheet_blend_mode);
+  sheet->set_opacity(sheet_opacity);
+}
+
+/**
+ * \brief Draws the particles that are in a region of the emitter.
+ * \param region The subrectangle to draw, relative to the origin of the
+ * emitter. Particles are clipped to it.
+ * \param dst_surface The destination surface.
+ * \param dst_position Coordinates on the destination surface.
+ * The origin of the emitter will appear at these coordinates.
+ */
+void ParticleEmitter::raw_draw_region(
+    const Rectangle& region,
+    Surface& dst_surface,
+    const Point& dst_position
+) {
+  const int num_particles = get_num_particles();
+  if (num_particles == 0) {
+    return;
+  }
+
+  const int width = frame_size.width;
+  const int height = frame_size.height;
+
+  // The sheet may be shared with the caller: only use our blend mode
+  // and opacity while drawing.
+  const BlendMode sheet_blend_mode = sheet->get_blend_mode();
+  const uint8_t sheet_opacity = sheet->get_opacity();
+  sheet->set_blend_mode(get_blend_mode());
+  sheet->set_opacity(sheet_opacity * transition_surface->get_opacity() / 255);
+  for (int i = 0; i < num_particles; ++i) {
+    const Rectangle particle_rect(
+        static_cast<int>(std::floor(xs[i])) - width / 2,
+        static_cast<int>(std::floor(ys[i])) - height / 2,
+        width,
+        height
+    );
+    const Rectangle visible_rect = particle_rect.get_intersection(region);
+    if (visible_rect.is_flat()) {
+      continue;
+    }
+    const Rectangle src_rect(
+        (frames[i] % num_columns) * width + visible_rect.get_x() - particle_rect.get_x(),
+        (frames[i] / num_columns) * height + visible_rect.get_y() - particle_rect.get_y(),
+        visible_rect.get_width(),
+        visible_rect.get_height()
+    );
+    sheet->raw_draw_region(src_rect, dst_surface, dst_position + visible_rect.get_xy());
+  }
+  sheet->set_blend_mode(sheet_blend_mode);
+  sheet->set_opacity(sheet_opacity);
+}
+
+/**
+ * \brief Draws a transition effect on this drawable object.
+ * \param transition The transition effect to apply.
+ */
+void ParticleEmitter::draw_transition(Transition& transition) {
+  transition.draw(*transition_surface);
+}
+
+/**
+ * \brief Returns the surface where transitions on this drawable object
+ * are applied.
+ * \return The surface for transitions.
+ */
+Surface& ParticleEmitter::get_transition_surface() {
+  return *transition_surface;
+}
+
+/**
+ * \brief Returns the name identifying this type in Lua.
+ * \return The name identifying this type in Lua.
+ */
+const std::string& ParticleEmitter::get_lua_type_name() const {
+  return LuaContext::particle_emitter_module_name;
+}
+
+}
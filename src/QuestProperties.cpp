@@ -74,6 +74,13 @@ int l_quest(lua_State* l) {
     const std::string& max_quest_size_string =
         LuaTools::opt_string_field(l, 1, "max_quest_size", normal_quest_size_string);
 
+    const int max_sound_voices =
+        LuaTools::opt_int_field(l, 1, "max_sound_voices", 32);
+    const int max_voices_per_sound =
+        LuaTools::opt_int_field(l, 1, "max_voices_per_sound", 4);
+    const bool louder_coalesced_sounds =
+        LuaTools::opt_boolean_field(l, 1, "louder_coalesced_sounds", false);
+
     properties.set_solarus_version(solarus_version);
     properties.set_quest_write_dir(quest_write_dir);
     properties.set_title(title);
@@ -117,6 +124,16 @@ int l_quest(lua_State* l) {
     properties.set_min_quest_size(min_quest_size);
     properties.set_max_quest_size(max_quest_size);
 
+    if (max_sound_voices < 0) {
+      LuaTools::arg_error(l, 1, "Bad field 'max_sound_voices' (must be a positive number or 0)");
+    }
+    if (max_voices_per_sound < 0) {
+      LuaTools::arg_error(l, 1, "Bad field 'max_voices_per_sound' (must be a positive number or 0)");
+    }
+    properties.set_max_sound_voices(max_sound_voices);
+    properties.set_max_voices_per_sound(max_voices_per_sound);
+    properties.set_louder_coalesced_sounds(louder_coalesced_sounds);
+
     return 0;
   });
 }
@@ -126,7 +143,10 @@ int l_quest(lua_State* l) {
 /**
  * \brief Creates quest properties.
  */
-QuestProperties::QuestProperties() {
+QuestProperties::QuestProperties():
+  max_sound_voices(32),
+  max_voices_per_sound(4),
+  louder_coalesced_sounds(false) {
 }
 
 /**
@@ -164,6 +184,9 @@ bool QuestProperties::export_to_lua(std::ostream& out) const {
       << "  normal_quest_size = \"" << normal_quest_size.width << 'x' << normal_quest_size.height << "\",\n"
       << "  min_quest_size = \"" << min_quest_size.width << 'x' << min_quest_size.height << "\",\n"
       << "  max_quest_size = \"" << max_quest_size.width << 'x' << max_quest_size.height << "\",\n"
+      << "  max_sound_voices = " << max_sound_voices << ",\n"
+      << "  max_voices_per_sound = " << max_voices_per_sound << ",\n"
+      << "  louder_coalesced_sounds = " << (louder_coalesced_sounds ? "true" : "false") << ",\n"
       << "}\n\n";
 
   return true;
@@ -361,4 +384,56 @@ void QuestProperties::set_max_quest_size(const Size& max_quest_size) {
   this->max_quest_size = max_quest_size;
 }
 
+/**
+ * \brief Returns the maximum number of sounds playing at the same time.
+ * \return The "max_sound_voices" value.
+ */
+int QuestProperties::get_max_sound_voices() const {
+  return max_sound_voices;
+}
+
+/**
+ * \brief Sets the maximum number of sounds playing at the same time.
+ * \param max_sound_voices The "max_sound_voices" value.
+ */
+void QuestProperties::set_max_sound_voices(int max_sound_voices) {
+  this->max_sound_voices = max_sound_voices;
+}
+
+/**
+ * \brief Returns the maximum number of instances of a sound playing at the
+ * same time.
+ * \return The "max_voices_per_sound" value.
+ */
+int QuestProperties::get_max_voices_per_sound() const {
+  return max_voices_per_sound;
+}
+
+/**
+ * \brief Sets the maximum number of instances of a sound playing at the
+ * same time.
+ * \param max_voices_per_sound The "max_voices_per_sound" value.
+ */
+void QuestProperties::set_max_voices_per_sound(int max_voices_per_sound) {
+  this->max_voices_per_sound = max_voices_per_sound;
+}
+
+/**
+ * \brief Returns whether a sound played several times in the same tick
+ * becomes louder.
+ * \return The "louder_coalesced_sounds" value.
+ */
+bool QuestProperties::get_louder_coalesced_sounds() const {
+  return louder_coalesced_sounds;
+}
+
+/**
+ * \brief Sets whether a sound played several times in the same tick
+ * becomes louder.
+ * \param louder_coalesced_sounds The "louder_coalesced_sounds" value.
+ */
+void QuestProperties::set_louder_coalesced_sounds(bool louder_coalesced_sounds) {
+  this->louder_coalesced_sounds = louder_coalesced_sounds;
+}
+
 }
@@ -15,6 +15,7 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "solarus/ResourceProvider.h"
+#include "solarus/lowlevel/Surface.h"
 
 namespace Solarus {
 
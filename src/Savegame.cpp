@@ -17,60 +17,63 @@
 #include "solarus/Savegame.h"
 #include "solarus/SavegameConverterV1.h"
 #include "solarus/MainLoop.h"
+#include "solarus/EquipmentItem.h"
 #include "solarus/lowlevel/QuestFiles.h"
 #include "solarus/lowlevel/InputEvent.h"
 #include "solarus/lowlevel/Debug.h"
 #include "solarus/lua/LuaContext.h"
 #include "solarus/lua/LuaTools.h"
 #include <lua.hpp>
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 namespace Solarus {
 
 const int Savegame::SAVEGAME_VERSION = 2;
 
-const std::string Savegame::KEY_SAVEGAME_VERSION = "_version";         /**< Format of this savegame file. */
-const std::string Savegame::KEY_STARTING_MAP = "_starting_map";        /**< Map id where to start the savegame. */
-const std::string Savegame::KEY_STARTING_POINT = "_starting_point";    /**< Destination name on the starting map. */
-const std::string Savegame::KEY_KEYBOARD_ACTION = "_keyboard_action";  /**< Keyboard key mapped to the action command. */
-const std::string Savegame::KEY_KEYBOARD_ATTACK = "_keyboard_attack";  /**< Keyboard key mapped to the attack command. */
-const std::string Savegame::KEY_KEYBOARD_ITEM_1 = "_keyboard_item_1";  /**< Keyboard key mapped to the item 1 command. */
-const std::string Savegame::KEY_KEYBOARD_ITEM_2 = "_keyboard_item_2";  /**< Keyboard key mapped to the item 2 command. */
-const std::string Savegame::KEY_KEYBOARD_PAUSE = "_keyboard_pause";    /**< Keyboard key mapped to the pause command. */
-const std::string Savegame::KEY_KEYBOARD_RIGHT = "_keyboard_right";    /**< Keyboard key mapped to the right command. */
-const std::string Savegame::KEY_KEYBOARD_UP = "_keyboard_up";          /**< Keyboard key mapped to the up command. */
-const std::string Savegame::KEY_KEYBOARD_LEFT = "_keyboard_left";      /**< Keyboard key mapped to the left command. */
-const std::string Savegame::KEY_KEYBOARD_DOWN = "_keyboard_down";      /**< Keyboard key mapped to the down command. */
-const std::string Savegame::KEY_JOYPAD_ACTION = "_joypad_action";      /**< Joypad string mapped to the action command. */
-const std::string Savegame::KEY_JOYPAD_ATTACK = "_joypad_attack";      /**< Joypad string mapped to the attack command. */
-const std::string Savegame::KEY_JOYPAD_ITEM_1 = "_joypad_item_1";      /**< Joypad string mapped to the item 1 command. */
-const std::string Savegame::KEY_JOYPAD_ITEM_2 = "_joypad_item_2";      /**< Joypad string mapped to the item 2 command. */
-const std::string Savegame::KEY_JOYPAD_PAUSE = "_joypad_pause";        /**< Joypad string mapped to the pause command. */
-const std::string Savegame::KEY_JOYPAD_RIGHT = "_joypad_right";        /**< Joypad string mapped to the right command. */
-const std::string Savegame::KEY_JOYPAD_UP = "_joypad_up_key";          /**< Joypad string mapped to the up command. */
-const std::string Savegame::KEY_JOYPAD_LEFT = "_joypad_left_key";      /**< Joypad string mapped to the left command. */
-const std::string Savegame::KEY_JOYPAD_DOWN = "_joypad_down_key";      /**< Joypad string mapped to the down command. */
-const std::string Savegame::KEY_CURRENT_LIFE = "_current_life";        /**< Number of life points. */
-const std::string Savegame::KEY_CURRENT_MONEY = "_current_money";      /**< Amount of money. */
-const std::string Savegame::KEY_CURRENT_MAGIC = "_current_magic";      /**< Number of magic points. */
-const std::string Savegame::KEY_MAX_LIFE = "_max_life";                /**< Maximum allowed life points. */
-const std::string Savegame::KEY_MAX_MONEY = "_max_money";              /**< Maximum allowed money. */
-const std::string Savegame::KEY_MAX_MAGIC = "_max_magic";              /**< Maximum allowed magic points. */
-const std::string Savegame::KEY_ITEM_SLOT_1 = "_item_slot_1";          /**< Name of the equipment item in slot 1. */
-const std::string Savegame::KEY_ITEM_SLOT_2 = "_item_slot_2";          /**< Name of the equipment item in slot 2. */
-const std::string Savegame::KEY_ABILITY_TUNIC = "_ability_tunic"; /**< Resistance level. */
-const std::string Savegame::KEY_ABILITY_SWORD = "_ability_sword";      /**< Attack level. */
-const std::string Savegame::KEY_ABILITY_SWORD_KNOWLEDGE =
+const Symbol Savegame::KEY_SAVEGAME_VERSION = "_version";         /**< Format of this savegame file. */
+const Symbol Savegame::KEY_STARTING_MAP = "_starting_map";        /**< Map id where to start the savegame. */
+const Symbol Savegame::KEY_STARTING_POINT = "_starting_point";    /**< Destination name on the starting map. */
+const Symbol Savegame::KEY_KEYBOARD_ACTION = "_keyboard_action";  /**< Keyboard key mapped to the action command. */
+const Symbol Savegame::KEY_KEYBOARD_ATTACK = "_keyboard_attack";  /**< Keyboard key mapped to the attack command. */
+const Symbol Savegame::KEY_KEYBOARD_ITEM_1 = "_keyboard_item_1";  /**< Keyboard key mapped to the item 1 command. */
+const Symbol Savegame::KEY_KEYBOARD_ITEM_2 = "_keyboard_item_2";  /**< Keyboard key mapped to the item 2 command. */
+const Symbol Savegame::KEY_KEYBOARD_PAUSE = "_keyboard_pause";    /**< Keyboard key mapped to the pause command. */
+const Symbol Savegame::KEY_KEYBOARD_RIGHT = "_keyboard_right";    /**< Keyboard key mapped to the right command. */
+const Symbol Savegame::KEY_KEYBOARD_UP = "_keyboard_up";          /**< Keyboard key mapped to the up command. */
+const Symbol Savegame::KEY_KEYBOARD_LEFT = "_keyboard_left";      /**< Keyboard key mapped to the left command. */
+const Symbol Savegame::KEY_KEYBOARD_DOWN = "_keyboard_down";      /**< Keyboard key mapped to the down command. */
+const Symbol Savegame::KEY_JOYPAD_ACTION = "_joypad_action";      /**< Joypad string mapped to the action command. */
+const Symbol Savegame::KEY_JOYPAD_ATTACK = "_joypad_attack";      /**< Joypad string mapped to the attack command. */
+const Symbol Savegame::KEY_JOYPAD_ITEM_1 = "_joypad_item_1";      /**< Joypad string mapped to the item 1 command. */
+const Symbol Savegame::KEY_JOYPAD_ITEM_2 = "_joypad_item_2";      /**< Joypad string mapped to the item 2 command. */
+const Symbol Savegame::KEY_JOYPAD_PAUSE = "_joypad_pause";        /**< Joypad string mapped to the pause command. */
+const Symbol Savegame::KEY_JOYPAD_RIGHT = "_joypad_right";        /**< Joypad string mapped to the right command. */
+const Symbol Savegame::KEY_JOYPAD_UP = "_joypad_up_key";          /**< Joypad string mapped to the up command. */
+const Symbol Savegame::KEY_JOYPAD_LEFT = "_joypad_left_key";      /**< Joypad string mapped to the left command. */
+const Symbol Savegame::KEY_JOYPAD_DOWN = "_joypad_down_key";      /**< Joypad string mapped to the down command. */
+const Symbol Savegame::KEY_CURRENT_LIFE = "_current_life";        /**< Number of life points. */
+const Symbol Savegame::KEY_CURRENT_MONEY = "_current_money";      /**< Amount of money. */
+const Symbol Savegame::KEY_CURRENT_MAGIC = "_current_magic";      /**< Number of magic points. */
+const Symbol Savegame::KEY_MAX_LIFE = "_max_life";                /**< Maximum allowed life points. */
+const Symbol Savegame::KEY_MAX_MONEY = "_max_money";              /**< Maximum allowed money. */
+const Symbol Savegame::KEY_MAX_MAGIC = "_max_magic";              /**< Maximum allowed magic points. */
+const Symbol Savegame::KEY_ITEM_SLOT_1 = "_item_slot_1";          /**< Name of the equipment item in slot 1. */
+const Symbol Savegame::KEY_ITEM_SLOT_2 = "_item_slot_2";          /**< Name of the equipment item in slot 2. */
+const Symbol Savegame::KEY_ABILITY_TUNIC = "_ability_tunic"; /**< Resistance level. */
+const Symbol Savegame::KEY_ABILITY_SWORD = "_ability_sword";      /**< Attack level. */
+const Symbol Savegame::KEY_ABILITY_SWORD_KNOWLEDGE =
     "_ability_sword_knowledge";                                        /**< Super spin attack ability level. */
-const std::string Savegame::KEY_ABILITY_SHIELD = "_ability_shield";    /**< Protection level. */
-const std::string Savegame::KEY_ABILITY_LIFT = "_ability_lift";        /**< Lift level. */
-const std::string Savegame::KEY_ABILITY_SWIM = "_ability_swim";        /**< Swim level. */
-const std::string Savegame::KEY_ABILITY_JUMP_OVER_WATER =
+const Symbol Savegame::KEY_ABILITY_SHIELD = "_ability_shield";    /**< Protection level. */
+const Symbol Savegame::KEY_ABILITY_LIFT = "_ability_lift";        /**< Lift level. */
+const Symbol Savegame::KEY_ABILITY_SWIM = "_ability_swim";        /**< Swim level. */
+const Symbol Savegame::KEY_ABILITY_JUMP_OVER_WATER =
     "_ability_jump_over_water";                                        /**< Jump over water level. */
-const std::string Savegame::KEY_ABILITY_RUN = "_ability_run";          /**< Run level. */
-const std::string Savegame::KEY_ABILITY_DETECT_WEAK_WALLS =
+const Symbol Savegame::KEY_ABILITY_RUN = "_ability_run";          /**< Run level. */
+const Symbol Savegame::KEY_ABILITY_DETECT_WEAK_WALLS =
     "_ability_detect_weak_walls";                                      /**< Weak walls detection level. */
-const std::string Savegame::KEY_ABILITY_GET_BACK_FROM_DEATH =
+const Symbol Savegame::KEY_ABILITY_GET_BACK_FROM_DEATH =
     "_ability_get_back_from_death";                                    /**< Resurrection ability level. */
 
 /**
@@ -87,7 +90,7 @@ Savegame::Savegame(MainLoop& main_loop, const std::string& file_name):
   equipment(*this),
   game(nullptr) {
 
-  // Don't call initialize() manually because the shared_ptr does not exist
+  // Don't call initialize() manually because the IntrusivePtr does not exist
   // at this point, but is needed by initialize() when calling item scripts.
 }
 
@@ -283,11 +286,19 @@ int Savegame::l_newindex(lua_State* l) {
  */
 void Savegame::save() {
 
-  std::ostringstream oss;
+  // Write values sorted by key so that the file does not depend on the
+  // hash table order.
+  std::vector<Symbol> keys;
+  keys.reserve(saved_values.size());
   for (const auto& kvp: saved_values) {
-    const std::string& key = kvp.first;
+    keys.push_back(kvp.first);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  std::ostringstream oss;
+  for (const Symbol& key: keys) {
     oss << key << " = ";
-    const SavedValue& value = kvp.second;
+    const SavedValue& value = saved_values.at(key);
     if (value.type == SavedValue::VALUE_BOOLEAN) {
       oss << (value.int_data ? "true" : "false");
     }
@@ -382,9 +393,9 @@ void Savegame::notify_game_finished() {
  * \param key Name of the value to get.
  * \return true if this value exists and is a string.
  */
-bool Savegame::is_string(const std::string& key) const {
+bool Savegame::is_string(const Symbol& key) const {
 
-  SOLARUS_ASSERT(LuaTools::is_valid_lua_identifier(key),
+  SOLARUS_ASSERT(LuaTools::is_valid_lua_identifier(key.str()),
       std::string("Savegame variable '") + key + "' is not a valid key");
 
   bool result = false;
@@ -401,9 +412,9 @@ bool Savegame::is_string(const std::string& key) const {
  * \param key Name of the value to get.
  * \return The string value associated with this key or an empty string.
  */
-std::string Savegame::get_string(const std::string& key) const {
+std::string Savegame::get_string(const Symbol& key) const {
 
-  SOLARUS_ASSERT(LuaTools::is_valid_lua_identifier(key),
+  SOLARUS_ASSERT(LuaTools::is_valid_lua_identifier(key.str()),
       std::string("Savegame variable '") + key + "' is not a valid key");
 
   const auto& it = saved_values.find(key);
@@ -425,13 +436,11 @@ std::string Savegame::get_string(const std::string& key) const {
  * \param key Name of the value to set.
  * \param value The string value to associate with this key.
  */
-void Savegame::set_string(const std::string& key, const std::string& value) {
+void Savegame::set_string(const Symbol& key, const std::string& value) {
 
-  Debug::check_assertion(LuaTools::is_valid_lua_identifier(key),
-      std::string("Savegame variable '") + key + "' is not a valid key");
-
-  saved_values[key].type = SavedValue::VALUE_STRING;
-  saved_values[key].string_data = value;
+  SavedValue& saved_value = get_value_to_set(key);
+  saved_value.type = SavedValue::VALUE_STRING;
+  saved_value.string_data = value;
 }
 
 /**
@@ -439,9 +448,9 @@ void Savegame::set_string(const std::string& key, const std::string& value) {
  * \param key Name of the value to get.
  * \return true if this value exists and is an integer.
  */
-bool Savegame::is_integer(const std::string& key) const {
+bool Savegame::is_integer(const Symbol& key) const {
 
-  SOLARUS_ASSERT(LuaTools::is_valid_lua_identifier(key),
+  SOLARUS_ASSERT(LuaTools::is_valid_lua_identifier(key.str()),
       std::string("Savegame variable '") + key + "' is not a valid key");
 
   bool result = false;
@@ -458,9 +467,9 @@ bool Savegame::is_integer(const std::string& key) const {
  * \param key Name of the value to get.
  * \return The integer value associated with this key or 0.
  */
-int Savegame::get_integer(const std::string& key) const {
+int Savegame::get_integer(const Symbol& key) const {
 
-  SOLARUS_ASSERT(LuaTools::is_valid_lua_identifier(key),
+  SOLARUS_ASSERT(LuaTools::is_valid_lua_identifier(key.str()),
       std::string("Savegame variable '") + key + "' is not a valid key");
 
   const auto& it = saved_values.find(key);
@@ -481,13 +490,11 @@ int Savegame::get_integer(const std::string& key) const {
  * \param key Name of the value to set.
  * \param value The integer value to associate with this key.
  */
-void Savegame::set_integer(const std::string& key, int value) {
-
-  Debug::check_assertion(LuaTools::is_valid_lua_identifier(key),
-      std::string("Savegame variable '") + key + "' is not a valid key");
+void Savegame::set_integer(const Symbol& key, int value) {
 
-  saved_values[key].type = SavedValue::VALUE_INTEGER;
-  saved_values[key].int_data = value;
+  SavedValue& saved_value = get_value_to_set(key);
+  saved_value.type = SavedValue::VALUE_INTEGER;
+  saved_value.int_data = value;
 }
 
 /**
@@ -495,9 +502,9 @@ void Savegame::set_integer(const std::string& key, int value) {
  * \param key Name of the value to get.
  * \return true if this value exists and is a boolean.
  */
-bool Savegame::is_boolean(const std::string& key) const {
+bool Savegame::is_boolean(const Symbol& key) const {
 
-  SOLARUS_ASSERT(LuaTools::is_valid_lua_identifier(key),
+  SOLARUS_ASSERT(LuaTools::is_valid_lua_identifier(key.str()),
       std::string("Savegame variable '") + key + "' is not a valid key");
 
   bool result = false;
@@ -514,9 +521,9 @@ bool Savegame::is_boolean(const std::string& key) const {
  * \param key Name of the value to get.
  * \return The boolean value associated with this key or false.
  */
-bool Savegame::get_boolean(const std::string& key) const {
+bool Savegame::get_boolean(const Symbol& key) const {
 
-  SOLARUS_ASSERT(LuaTools::is_valid_lua_identifier(key),
+  SOLARUS_ASSERT(LuaTools::is_valid_lua_identifier(key.str()),
       std::string("Savegame variable '") + key + "' is not a valid key");
 
   const auto& it = saved_values.find(key);
@@ -537,27 +544,65 @@ bool Savegame::get_boolean(const std::string& key) const {
  * \param key Name of the value to set.
  * \param value The boolean value to associate with this key.
  */
-void Savegame::set_boolean(const std::string& key, bool value) {
+void Savegame::set_boolean(const Symbol& key, bool value) {
 
-  Debug::check_assertion(LuaTools::is_valid_lua_identifier(key),
-      std::string("Savegame variable '") + key + "' is not a valid key");
+  SavedValue& saved_value = get_value_to_set(key);
+  saved_value.type = SavedValue::VALUE_BOOLEAN;
+  saved_value.int_data = value;
+}
 
-  saved_values[key].type = SavedValue::VALUE_BOOLEAN;
-  saved_values[key].int_data = value;
+/**
+ * \brief Returns the value of a key to be set, creating it if necessary.
+ *
+ * The key is only validated when it is created: existing keys are
+ * already valid.
+ *
+ * \param key Name of the value.
+ * \return The value associated with this key.
+ */
+Savegame::SavedValue& Savegame::get_value_to_set(const Symbol& key) {
+
+  auto it = saved_values.find(key);
+  if (it == saved_values.end()) {
+    Debug::check_assertion(LuaTools::is_valid_lua_identifier(key.str()),
+        std::string("Savegame variable '") + key + "' is not a valid key");
+    it = saved_values.emplace(key, SavedValue()).first;
+  }
+  return it->second;
 }
 
 /**
  * \brief Unsets a value saved.
  * \param key Name of the value to unset.
  */
-void Savegame::unset(const std::string& key) {
+void Savegame::unset(const Symbol& key) {
 
-  Debug::check_assertion(LuaTools::is_valid_lua_identifier(key),
+  Debug::check_assertion(LuaTools::is_valid_lua_identifier(key.str()),
       std::string("Savegame variable '") + key + "' is not a valid key");
 
   saved_values.erase(key);
 }
 
+/**
+ * \brief Returns all values of this savegame.
+ * \return The saved values.
+ */
+const Savegame::SavedValues& Savegame::get_saved_values() const {
+  return saved_values;
+}
+
+/**
+ * \brief Replaces all values of this savegame.
+ *
+ * This is used to restore values previously obtained with
+ * get_saved_values(). Nothing is written to the file.
+ *
+ * \param saved_values The new values.
+ */
+void Savegame::set_saved_values(const SavedValues& saved_values) {
+  this->saved_values = saved_values;
+}
+
 /**
  * \brief Returns the name identifying this type in Lua.
  * \return The name identifying this type in Lua.
@@ -26,6 +26,7 @@
 #include "solarus/lowlevel/Size.h"
 #include "solarus/lowlevel/Surface.h"
 #include "solarus/lowlevel/System.h"
+#include "solarus/lowlevel/WorkerPool.h"
 #include "solarus/lua/LuaContext.h"
 #include "solarus/lua/LuaTools.h"
 #include "solarus/movements/Movement.h"
@@ -36,7 +37,7 @@
 
 namespace Solarus {
 
-std::map<std::string, SpriteAnimationSet*> Sprite::all_animation_sets;
+std::unordered_map<Symbol, SpriteAnimationSet*> Sprite::all_animation_sets;
 
 /**
  * \brief Initializes the sprites system.
@@ -65,7 +66,7 @@ void Sprite::quit() {
  * \param id id of the animation set
  * \return the corresponding animation set
  */
-SpriteAnimationSet& Sprite::get_animation_set(const std::string& id) {
+SpriteAnimationSet& Sprite::get_animation_set(const Symbol& id) {
 
   SpriteAnimationSet* animation_set = nullptr;
   auto it = all_animation_sets.find(id);
@@ -73,7 +74,7 @@ SpriteAnimationSet& Sprite::get_animation_set(const std::string& id) {
     animation_set = it->second;
   }
   else {
-    animation_set = new SpriteAnimationSet(id);
+    animation_set = new SpriteAnimationSet(id.str());
     all_animation_sets[id] = animation_set;
   }
 
@@ -86,7 +87,7 @@ SpriteAnimationSet& Sprite::get_animation_set(const std::string& id) {
  * \brief Creates a sprite with the specified animation set.
  * \param id name of an animation set
  */
-Sprite::Sprite(const std::string& id):
+Sprite::Sprite(const Symbol& id):
   Drawable(),
   animation_set_id(id),
   animation_set(get_animation_set(id)),
@@ -97,6 +98,9 @@ Sprite::Sprite(const std::string& id):
   paused(false),
   finished(false),
   synchronize_to(nullptr),
+  precomputed_frames(),
+  precomputed_frames_date(0),
+  precomputed_frames_valid(false),
   intermediate_surface(nullptr),
   blink_delay(0),
   blink_is_sprite_visible(true),
@@ -110,7 +114,7 @@ Sprite::Sprite(const std::string& id):
  * \brief Returns the id of the animation set of this sprite.
  * \return the animation set id of this sprite
  */
-const std::string& Sprite::get_animation_set_id() const {
+const Symbol& Sprite::get_animation_set_id() const {
   return animation_set_id;
 }
 
@@ -227,6 +231,7 @@ uint32_t Sprite::get_frame_delay() const {
  */
 void Sprite::set_frame_delay(uint32_t frame_delay) {
   this->frame_delay = frame_delay;
+  invalidate_precomputed_frames();
 }
 
 /**
@@ -247,7 +252,7 @@ int Sprite::get_next_frame() const {
  * \brief Returns the current animation of the sprite.
  * \return the name of the current animation of the sprite
  */
-const std::string& Sprite::get_current_animation() const {
+const Symbol& Sprite::get_current_animation() const {
   return current_animation_name;
 }
 
@@ -259,7 +264,7 @@ const std::string& Sprite::get_current_animation() const {
  *
  * \param animation_name name of the new animation of the sprite
  */
-void Sprite::set_current_animation(const std::string& animation_name) {
+void Sprite::set_current_animation(const Symbol& animation_name) {
 
   if (animation_name != this->current_animation_name || !is_animation_started()) {
 
@@ -297,7 +302,7 @@ void Sprite::set_current_animation(const std::string& animation_name) {
  * \param animation_name an animation name
  * \return true if this animation exists
  */
-bool Sprite::has_animation(const std::string& animation_name) const {
+bool Sprite::has_animation(const Symbol& animation_name) const {
   return animation_set.has_animation(animation_name);
 }
 
@@ -392,6 +397,7 @@ void Sprite::set_current_frame(int current_frame, bool notify_script) {
 
   finished = false;
   next_frame_date = System::now() + get_frame_delay();
+  invalidate_precomputed_frames();
 
   if (current_frame != this->current_frame) {
     this->current_frame = current_frame;
@@ -444,6 +450,7 @@ void Sprite::set_frame_changed(bool frame_changed) {
  */
 void Sprite::set_synchronized_to(const SpritePtr& other) {
   this->synchronize_to = other;
+  invalidate_precomputed_frames();
 }
 
 /**
@@ -477,6 +484,7 @@ void Sprite::restart_animation() {
  */
 void Sprite::stop_animation() {
   finished = true;
+  invalidate_precomputed_frames();
 }
 
 /**
@@ -492,6 +500,7 @@ void Sprite::set_suspended(bool suspended) {
       !ignore_suspend) {
 
     Drawable::set_suspended(suspended);
+    invalidate_precomputed_frames();
 
     // compte next_frame_date if the animation is being resumed
     if (!suspended) {
@@ -537,6 +546,7 @@ void Sprite::set_paused(bool paused) {
 
   if (paused != this->paused) {
     this->paused = paused;
+    invalidate_precomputed_frames();
 
     // compte next_frame_date if the animation is being resumed
     if (!paused) {
@@ -657,6 +667,167 @@ bool Sprite::test_collision(const Sprite& other, int x1, int y1, int x2, int y2)
   return pixel_bits1.test_collision(pixel_bits2, location1, location2);
 }
 
+/**
+ * \brief Computes in advance the frame changes of several sprites for the
+ * current cycle.
+ *
+ * This only does the frame timing arithmetic, in parallel, and never calls
+ * C++ or Lua callbacks: frame changes are then applied and notified in the
+ * usual order when each sprite is updated.
+ * Sprites whose state changes in the meantime just recompute
+ * their frames normally.
+ *
+ * \param sprites The sprites to process.
+ * They must not be modified by other threads during this call.
+ * \param now The current simulated date.
+ */
+void Sprite::precompute_frames(const std::vector<Sprite*>& sprites, uint32_t now) {
+
+  WorkerPool::parallel_for(
+      static_cast<int>(sprites.size()),
+      64,
+      [&sprites, now](int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+      sprites[i]->precompute_frames(now);
+    }
+  });
+}
+
+/**
+ * \brief Computes in advance the frame changes of this sprite for a date.
+ *
+ * This function is thread-safe as long as no other thread uses this sprite:
+ * it only stores the result in precomputed_frames, without changing the
+ * current state of the sprite or notifying anyone.
+ *
+ * \param now The current simulated date.
+ */
+void Sprite::precompute_frames(uint32_t now) {
+
+  precomputed_frames.clear();
+  precomputed_frames_valid = false;
+
+  if (is_suspended() ||
+      paused ||
+      synchronize_to != nullptr ||
+      current_animation == nullptr ||
+      current_direction < 0 ||
+      current_direction >= get_nb_directions()) {
+    // Let update() handle the general case.
+    return;
+  }
+
+  bool finished = this->finished;
+  int current_frame = this->current_frame;
+  uint32_t next_frame_date = this->next_frame_date;
+  const uint32_t frame_delay = get_frame_delay();
+
+  // Same steps as update_frames(), without side effects.
+  while (!finished &&
+      frame_delay > 0 &&
+      now >= next_frame_date
+  ) {
+    int next_frame = current_animation->get_next_frame(current_direction, current_frame);
+
+    if (next_frame == -1) {
+      finished = true;
+    }
+    else {
+      current_frame = next_frame;
+      uint32_t old_next_frame_date = next_frame_date;
+      next_frame_date += frame_delay;
+      if (next_frame_date < old_next_frame_date) {
+        next_frame_date = std::numeric_limits<uint32_t>::max();
+      }
+    }
+    precomputed_frames.push_back({ next_frame, next_frame_date });
+  }
+
+  precomputed_frames_date = now;
+  precomputed_frames_valid = true;
+}
+
+/**
+ * \brief Discards frame changes computed in advance.
+ *
+ * Call this function whenever something changes the frame timing of
+ * the sprite.
+ */
+void Sprite::invalidate_precomputed_frames() {
+  precomputed_frames_valid = false;
+}
+
+/**
+ * \brief Applies and notifies frame changes computed in advance.
+ *
+ * Stops early if a callback modifies the sprite: the remaining steps are
+ * then recomputed by update_frames().
+ *
+ * \param lua_context The Lua context or nullptr.
+ */
+void Sprite::apply_precomputed_frames(LuaContext* lua_context) {
+
+  for (size_t i = 0; i < precomputed_frames.size() && precomputed_frames_valid; ++i) {
+    const FrameStep& step = precomputed_frames[i];
+
+    if (step.frame == -1) {
+      finished = true;
+      notify_finished();
+    }
+    else {
+      current_frame = step.frame;
+      next_frame_date = step.next_frame_date;
+    }
+    set_frame_changed(true);
+
+    if (lua_context != nullptr) {
+      lua_context->sprite_on_frame_changed(*this, current_animation_name, current_frame);
+    }
+  }
+  precomputed_frames_valid = false;
+}
+
+/**
+ * \brief Changes the current frame according to the time elapsed.
+ *
+ * If the frame changes, next_frame_date is updated.
+ *
+ * \param now The current simulated date.
+ * \param lua_context The Lua context or nullptr.
+ */
+void Sprite::update_frames(uint32_t now, LuaContext* lua_context) {
+
+  while (!finished &&
+      !is_suspended() &&
+      !paused &&
+      get_frame_delay() > 0 &&
+      now >= next_frame_date
+  ) {
+    int next_frame = get_next_frame();
+
+    // Test if the animation is finished.
+    if (next_frame == -1) {
+      finished = true;
+      notify_finished();
+    }
+    else {
+      current_frame = next_frame;
+      uint32_t old_next_frame_date = next_frame_date;
+      next_frame_date += get_frame_delay();
+      if (next_frame_date < old_next_frame_date) {
+        // Overflow. Can happen with data files generated with the editor
+        // before 1.4 (frame_delay is too big).
+        next_frame_date = std::numeric_limits<uint32_t>::max();
+      }
+    }
+    set_frame_changed(true);
+
+    if (lua_context != nullptr) {
+      lua_context->sprite_on_frame_changed(*this, current_animation_name, current_frame);
+    }
+  }
+}
+
 /**
  * \brief Checks whether the frame has to be changed.
  *
@@ -682,35 +853,12 @@ void Sprite::update() {
       || synchronize_to->get_current_frame() > get_nb_frames()) {
 
     // Update frames normally (with time).
-    while (!finished &&
-        !is_suspended() &&
-        !paused &&
-        get_frame_delay() > 0 &&
-        now >= next_frame_date
-    ) {
-      int next_frame = get_next_frame();
-
-      // Test if the animation is finished.
-      if (next_frame == -1) {
-        finished = true;
-        notify_finished();
-      }
-      else {
-        current_frame = next_frame;
-        uint32_t old_next_frame_date = next_frame_date;
-        next_frame_date += get_frame_delay();
-        if (next_frame_date < old_next_frame_date) {
-          // Overflow. Can happen with data files generated with the editor
-          // before 1.4 (frame_delay is too big).
-          next_frame_date = std::numeric_limits<uint32_t>::max();
-        }
-      }
-      set_frame_changed(true);
-
-      if (lua_context != nullptr) {
-        lua_context->sprite_on_frame_changed(*this, current_animation_name, current_frame);
-      }
+    if (precomputed_frames_valid && precomputed_frames_date == now) {
+      // The frame changes are already known.
+      apply_precomputed_frames(lua_context);
     }
+    precomputed_frames_valid = false;
+    update_frames(now, lua_context);
   }
   else {
     // Take the same frame as the other sprite.
@@ -767,7 +915,7 @@ void Sprite::raw_draw(
     get_intermediate_surface().set_blend_mode(get_blend_mode());
     get_intermediate_surface().draw_region(
         Rectangle(get_size()),
-        std::static_pointer_cast<Surface>(dst_surface.shared_from_this()),
+        SurfacePtr(&dst_surface),
         dst_position - get_origin()
     );
   }
@@ -836,7 +984,7 @@ void Sprite::raw_draw_region(
     get_intermediate_surface().set_blend_mode(get_blend_mode());
     get_intermediate_surface().draw_region(
         src_position,
-        std::static_pointer_cast<Surface>(dst_surface.shared_from_this()),
+        SurfacePtr(&dst_surface),
         dst_position2
     );
   }
@@ -90,7 +90,7 @@ void SpriteAnimationDirection::draw(Surface& dst_surface,
 
   src_image.draw_region(
       current_frame_rect,
-      std::static_pointer_cast<Surface>(dst_surface.shared_from_this()),
+      SurfacePtr(&dst_surface),
       position_top_left
   );
 }
@@ -20,6 +20,7 @@
 #include "solarus/lowlevel/QuestFiles.h"
 #include "solarus/lowlevel/Debug.h"
 #include "solarus/lowlevel/Rectangle.h"
+#include "solarus/lowlevel/Surface.h"
 #include "solarus/lua/LuaTools.h"
 #include "solarus/SpriteData.h"
 #include <algorithm>
@@ -89,7 +90,7 @@ void SpriteAnimationSet::add_animation(
   }
 
   animations.emplace(
-    animation_name,
+    Symbol(animation_name),
     SpriteAnimation(src_image, directions, frame_delay, frame_to_loop_on)
   );
 }
@@ -114,7 +115,7 @@ void SpriteAnimationSet::set_tileset(const Tileset& tileset) {
  * \return true if this animation exists
  */
 bool SpriteAnimationSet::has_animation(
-    const std::string& animation_name) const {
+    const Symbol& animation_name) const {
   return animations.find(animation_name) != animations.end();
 }
 
@@ -124,7 +125,7 @@ bool SpriteAnimationSet::has_animation(
  * \return The specified animation.
  */
 const SpriteAnimation& SpriteAnimationSet::get_animation(
-    const std::string& animation_name) const {
+    const Symbol& animation_name) const {
 
   Debug::check_assertion(has_animation(animation_name),
       std::string("No animation '") + animation_name
@@ -140,7 +141,7 @@ const SpriteAnimation& SpriteAnimationSet::get_animation(
  * \return The specified animation.
  */
 SpriteAnimation& SpriteAnimationSet::get_animation(
-    const std::string& animation_name) {
+    const Symbol& animation_name) {
 
   Debug::check_assertion(has_animation(animation_name),
       std::string("No animation '") + animation_name
@@ -154,7 +155,7 @@ SpriteAnimation& SpriteAnimationSet::get_animation(
  * \brief Returns the name of the default animation, i.e. the first one.
  * \return the name of the default animation
  */
-const std::string& SpriteAnimationSet::get_default_animation() const {
+const Symbol& SpriteAnimationSet::get_default_animation() const {
   return default_animation_name;
 }
 
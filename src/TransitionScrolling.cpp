@@ -228,7 +228,7 @@ void TransitionScrolling::draw(Surface& dst_surface) {
   // blit both surfaces
   both_maps_surface->draw_region(
       current_scrolling_position,
-      std::static_pointer_cast<Surface>(dst_surface.shared_from_this())
+      SurfacePtr(&dst_surface)
   );
 }
 
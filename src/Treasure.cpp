@@ -24,7 +24,6 @@
 #include "solarus/lua/LuaContext.h"
 #include "solarus/lowlevel/Surface.h"
 #include "solarus/lowlevel/Debug.h"
-#include <memory>
 
 namespace Solarus {
 
@@ -191,7 +190,7 @@ void Treasure::give_to_player() const {
  */
 SpritePtr Treasure::create_sprite() const {
 
-  SpritePtr sprite = std::make_shared<Sprite>("entities/items");
+  SpritePtr sprite = make_intrusive<Sprite>("entities/items");
   sprite->set_current_animation(get_item_name());
   sprite->set_current_direction(get_variant() - 1);
   return sprite;
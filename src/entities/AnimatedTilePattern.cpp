@@ -55,7 +55,8 @@ uint32_t AnimatedTilePattern::next_frame_date = 0;
  * \param y2 y position of the second frame in the tileset
  * \param x3 x position of the third frame in the tileset
  * \param y3 y position of the third frame in the tileset
- * \param parallax true to also set parallax scrolling to the tile pattern
+ * \param parallax_ratio Distance made by the viewport to move the tile
+ * pattern of 1 pixel, or 0 for no parallax scrolling.
  */
 AnimatedTilePattern::AnimatedTilePattern(Ground ground,
     AnimationSequence sequence,
@@ -63,10 +64,10 @@ AnimatedTilePattern::AnimatedTilePattern(Ground ground,
     int x1, int y1,
     int x2, int y2,
     int x3, int y3,
-    bool parallax):
+    int parallax_ratio):
   TilePattern(ground, size),
   sequence(sequence),
-  parallax(parallax) {
+  parallax_ratio(parallax_ratio) {
 
   this->position_in_tileset[0] = Rectangle(x1, y1);
   this->position_in_tileset[1] = Rectangle(x2, y2);
@@ -136,8 +137,8 @@ void AnimatedTilePattern::draw(
   const Rectangle& src = position_in_tileset[current_frames[sequence]];
   Point dst = dst_position;
 
-  if (parallax) {
-    dst += viewport / ParallaxScrollingTilePattern::ratio;
+  if (parallax_ratio != 0) {
+    dst += viewport / parallax_ratio;
   }
 
   tileset_image->draw_region(src, dst_surface, dst);
@@ -157,7 +158,7 @@ void AnimatedTilePattern::draw(
  * \return true to if this tile pattern is always drawn at its coordinates
  */
 bool AnimatedTilePattern::is_drawn_at_its_position() const {
-  return !parallax;
+  return parallax_ratio == 0;
 }
 
 }
@@ -30,7 +30,6 @@
 #include "solarus/lowlevel/Sound.h"
 #include "solarus/lowlevel/System.h"
 #include "solarus/lowlevel/Debug.h"
-#include <memory>
 #include <string>
 
 namespace Solarus {
@@ -66,7 +65,7 @@ Arrow::Arrow(const Hero& hero):
 
   std::string path = " ";
   path[0] = '0' + (direction * 2);
-  set_movement(std::make_shared<PathMovement>(
+  set_movement(make_intrusive<PathMovement>(
       path, 192, true, false, false
   ));
 
@@ -206,6 +205,8 @@ bool Arrow::is_jumper_obstacle(Jumper& /* jumper */, const Rectangle& /* candida
  */
 void Arrow::update() {
 
+  static const Symbol reached_obstacle_animation = "reached_obstacle";
+
   Entity::update();
 
   if (is_suspended()) {
@@ -222,7 +223,7 @@ void Arrow::update() {
     if (entity_reached != nullptr) {
       // the arrow just hit an entity (typically an enemy) and this entity may have a movement
       Point dxy = get_xy() - entity_reached->get_xy();
-      set_movement(std::make_shared<RelativeMovement>(
+      set_movement(make_intrusive<RelativeMovement>(
           entity_reached, dxy.x, dxy.y, true
       ));
     }
@@ -239,7 +240,7 @@ void Arrow::update() {
       disappear_date = now;
     }
     else if (entity_reached->get_type() == EntityType::ENEMY &&
-        (std::static_pointer_cast<Enemy>(entity_reached)->is_dying())) {
+        (static_pointer_cast<Enemy>(entity_reached)->is_dying())) {
       // the enemy is dying
       disappear_date = now;
     }
@@ -249,7 +250,7 @@ void Arrow::update() {
   bool reached_obstacle = false;
 
   const SpritePtr& sprite = get_sprite();
-  if (sprite != nullptr && sprite->get_current_animation() != "reached_obstacle") {
+  if (sprite != nullptr && sprite->get_current_animation() != reached_obstacle_animation) {
 
     if (entity_reached != nullptr) {
       // the arrow was just attached to an entity
@@ -334,9 +335,7 @@ void Arrow::attach_to(Entity& entity_reached) {
   Debug::check_assertion(this->entity_reached == nullptr,
       "This arrow is already attached to an entity");
 
-  this->entity_reached = std::static_pointer_cast<Entity>(
-      entity_reached.shared_from_this()
-  );
+  this->entity_reached = EntityPtr(&entity_reached);
   stop_now = true;
 }
 
@@ -439,8 +438,10 @@ void Arrow::notify_attacked_enemy(
  */
 bool Arrow::has_reached_map_border() {
 
+  static const Symbol flying_animation = "flying";
+
   const SpritePtr& sprite = get_sprite();
-  if (sprite != nullptr && sprite->get_current_animation() != "flying") {
+  if (sprite != nullptr && sprite->get_current_animation() != flying_animation) {
     return false;
   }
 
@@ -27,7 +27,6 @@
 #include "solarus/lowlevel/Debug.h"
 #include "solarus/lowlevel/Sound.h"
 #include "solarus/lua/LuaContext.h"
-#include <memory>
 
 namespace Solarus {
 
@@ -224,8 +223,8 @@ bool Block::start_movement_by_hero() {
   int dx = get_x() - hero.get_x();
   int dy = get_y() - hero.get_y();
 
-  set_movement(std::make_shared<RelativeMovement>(
-      std::static_pointer_cast<Hero>(hero.shared_from_this()),
+  set_movement(make_intrusive<RelativeMovement>(
+      HeroPtr(&hero),
       dx,
       dy,
       false
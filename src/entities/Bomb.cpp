@@ -26,7 +26,6 @@
 #include "solarus/CommandsEffects.h"
 #include "solarus/Map.h"
 #include "solarus/Sprite.h"
-#include <memory>
 
 namespace Solarus {
 
@@ -156,7 +155,7 @@ void Bomb::notify_collision_with_stream(Stream& stream, int /* dx */, int /* dy
       std::string path = "  ";
       path[0] = path[1] = '0' + stream.get_direction();
       clear_movement();
-      set_movement(std::make_shared<PathMovement>(
+      set_movement(make_intrusive<PathMovement>(
           path, 64, false, false, false
       ));
     }
@@ -189,7 +188,7 @@ bool Bomb::notify_action_command_pressed() {
       && get_hero().get_facing_entity() == this
       && get_hero().is_facing_point_in(get_bounding_box())) {
 
-    get_hero().start_lifting(std::make_shared<CarriedObject>(
+    get_hero().start_lifting(make_intrusive<CarriedObject>(
         get_hero(),
         *this,
         "entities/bomb",
@@ -225,6 +224,8 @@ void Bomb::set_suspended(bool suspended) {
  */
 void Bomb::update() {
 
+  static const Symbol stopped_explosion_soon_animation = "stopped_explosion_soon";
+
   Entity::update();
 
   if (is_suspended()) {
@@ -239,8 +240,8 @@ void Bomb::update() {
   else if (now >= explosion_date - 1500) {
     const SpritePtr& sprite = get_sprite();
     if (sprite != nullptr &&
-        sprite->get_current_animation() != "stopped_explosion_soon") {
-      sprite->set_current_animation("stopped_explosion_soon");
+        sprite->get_current_animation() != stopped_explosion_soon_animation) {
+      sprite->set_current_animation(stopped_explosion_soon_animation);
     }
   }
 
@@ -258,7 +259,7 @@ void Bomb::update() {
  */
 void Bomb::explode() {
 
-  get_entities().add_entity(std::make_shared<Explosion>(
+  get_entities().add_entity(make_intrusive<Explosion>(
       "", get_layer(), get_center_point(), true
   ));
   Sound::play("explosion");
@@ -29,6 +29,7 @@
 #include "solarus/movements/TargetMovement.h"
 #include "solarus/Game.h"
 #include "solarus/Map.h"
+#include "solarus/Sprite.h"
 
 namespace Solarus {
 
@@ -80,8 +81,8 @@ Boomerang::Boomerang(
 
   }
 
-  std::shared_ptr<StraightMovement> movement =
-      std::make_shared<StraightMovement>(false, false);
+  IntrusivePtr<StraightMovement> movement =
+      make_intrusive<StraightMovement>(false, false);
   movement->set_speed(speed);
   movement->set_angle(angle);
   movement->set_max_distance(max_distance);
@@ -262,7 +263,7 @@ void Boomerang::update() {
   if (!going_back && has_to_go_back) {
     going_back = true;
     clear_movement();
-    set_movement(std::make_shared<TargetMovement>(hero, 0, 0, speed, true));
+    set_movement(make_intrusive<TargetMovement>(hero, 0, 0, speed, true));
     get_entities().set_entity_layer(*this, hero->get_layer()); // because the hero's layer may have changed
   }
 }
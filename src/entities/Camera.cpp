@@ -56,7 +56,7 @@ private:
   Point separator_scrolling_delta;        /**< increment to the camera position when crossing a separator. */
   uint32_t separator_next_scrolling_date; /**< Next camera position change when crossing a separator. */
   int separator_scrolling_direction4;     /**< Direction when scrolling. */
-  std::shared_ptr<Separator>
+  IntrusivePtr<Separator>
       separator_traversed;                /**< Separator currently being traversed or nullptr. */
 
 };
@@ -156,9 +156,7 @@ void TrackingState::traverse_separator(Separator& separator) {
   separator_scrolling_position = camera.get_bounding_box();
 
   // Start scrolling.
-  separator_traversed = std::static_pointer_cast<Separator>(
-      separator.shared_from_this()
-  );
+  separator_traversed = IntrusivePtr<Separator>(&separator);
   separator_scrolling_delta = Point();
   separator_target_position = separator_scrolling_position;
 
@@ -442,10 +440,10 @@ Rectangle Camera::apply_separators(const Rectangle& area) const {
   // TODO simplify: treat horizontal separators first and then all vertical ones.
   int adjusted_x = x;  // Updated coordinates after applying separators.
   int adjusted_y = y;
-  std::vector<std::shared_ptr<const Separator>> applied_separators;
-  const std::set<std::shared_ptr<const Separator>>& separators =
+  std::vector<IntrusivePtr<const Separator>> applied_separators;
+  const std::set<IntrusivePtr<const Separator>>& separators =
       get_entities().get_entities_by_type<Separator>();
-  for (const std::shared_ptr<const Separator>& separator: separators) {
+  for (const IntrusivePtr<const Separator>& separator: separators) {
 
     if (separator->is_vertical()) {
       // Vertical separator.
@@ -494,7 +492,7 @@ Rectangle Camera::apply_separators(const Rectangle& area) const {
 
     must_adjust_x = false;
     must_adjust_y = false;
-    for (const std::shared_ptr<const Separator>& separator: applied_separators) {
+    for (const IntrusivePtr<const Separator>& separator: applied_separators) {
 
       if (separator->is_vertical()) {
         // Vertical separator.
@@ -34,7 +34,6 @@
 #include "solarus/Sprite.h"
 #include "solarus/Game.h"
 #include "solarus/Map.h"
-#include <memory>
 
 namespace Solarus {
 
@@ -97,7 +96,7 @@ CarriedObject::CarriedObject(
   set_drawn_in_y_order(true);
 
   // create the lift movement and the sprite
-  std::shared_ptr<PixelMovement> movement = std::make_shared<PixelMovement>(
+  IntrusivePtr<PixelMovement> movement = make_intrusive<PixelMovement>(
       lifting_trajectories[direction], 100, false, true
   );
   main_sprite = create_sprite(animation_set_id, "main");
@@ -187,8 +186,8 @@ void CarriedObject::throw_item(int direction) {
 
   // set the movement of the item sprite
   set_y(hero.get_y());
-  std::shared_ptr<StraightMovement> movement =
-      std::make_shared<StraightMovement>(false, false);
+  IntrusivePtr<StraightMovement> movement =
+      make_intrusive<StraightMovement>(false, false);
   movement->set_speed(200);
   movement->set_angle(Geometry::degrees_to_radians(direction * 90));
   clear_movement();
@@ -248,7 +247,7 @@ void CarriedObject::break_item() {
     }
   }
   else {
-    get_entities().add_entity(std::make_shared<Explosion>(
+    get_entities().add_entity(make_intrusive<Explosion>(
         "", get_layer(), get_xy(), true
     ));
     Sound::play("explosion");
@@ -354,6 +353,11 @@ void CarriedObject::set_suspended(bool suspended) {
  */
 void CarriedObject::update() {
 
+  static const Symbol stopped_animation = "stopped";
+  static const Symbol walking_animation = "walking";
+  static const Symbol stopped_explosion_soon_animation = "stopped_explosion_soon";
+  static const Symbol walking_explosion_soon_animation = "walking_explosion_soon";
+
   // update the sprite and the position
   Entity::update();
 
@@ -367,8 +371,8 @@ void CarriedObject::update() {
 
     // make the item follow the hero
     clear_movement();
-    set_movement(std::make_shared<RelativeMovement>(
-        std::static_pointer_cast<Hero>(hero.shared_from_this()),
+    set_movement(make_intrusive<RelativeMovement>(
+        HeroPtr(&hero),
         0,
         -18,
         true
@@ -385,12 +389,12 @@ void CarriedObject::update() {
     }
     else if (will_explode_soon()) {
 
-      std::string animation = main_sprite->get_current_animation();
-      if (animation == "stopped") {
-        main_sprite->set_current_animation("stopped_explosion_soon");
+      const Symbol& animation = main_sprite->get_current_animation();
+      if (animation == stopped_animation) {
+        main_sprite->set_current_animation(stopped_explosion_soon_animation);
       }
-      else if (animation == "walking") {
-        main_sprite->set_current_animation("walking_explosion_soon");
+      else if (animation == walking_animation) {
+        main_sprite->set_current_animation(walking_explosion_soon_animation);
       }
     }
   }
@@ -183,6 +183,7 @@ void CustomEntity::set_traversable_by_entities(bool traversable) {
       *get_lua_context(),
       traversable
   );
+  notify_state_changed();
 }
 
 /**
@@ -195,14 +196,19 @@ void CustomEntity::set_traversable_by_entities(bool traversable) {
  * set_traversable_by_entities(EntityType, const ScopedLuaRef&).
  *
  * \param traversable_test_ref Lua ref to a function that will do the test.
+ * \param stable \c true if the result of the function only depends on the
+ * state of both entities, so that it can be remembered.
  */
 void CustomEntity::set_traversable_by_entities(
-    const ScopedLuaRef& traversable_test_ref
+    const ScopedLuaRef& traversable_test_ref,
+    bool stable
 ) {
   traversable_by_entities_general = TraversableInfo(
       *get_lua_context(),
-      traversable_test_ref
+      traversable_test_ref,
+      stable
   );
+  notify_state_changed();
 }
 
 /**
@@ -217,6 +223,7 @@ void CustomEntity::set_traversable_by_entities(
 void CustomEntity::reset_traversable_by_entities() {
 
   traversable_by_entities_general = TraversableInfo();
+  notify_state_changed();
 }
 
 /**
@@ -239,6 +246,7 @@ void CustomEntity::set_traversable_by_entities(
       *get_lua_context(),
       traversable
   );
+  notify_state_changed();
 }
 
 /**
@@ -252,15 +260,20 @@ void CustomEntity::set_traversable_by_entities(
  *
  * \param type A type of entities.
  * \param traversable_test_ref Lua ref to a function that will do the test.
+ * \param stable \c true if the result of the function only depends on the
+ * state of both entities, so that it can be remembered.
  */
 void CustomEntity::set_traversable_by_entities(
     EntityType type,
-    const ScopedLuaRef& traversable_test_ref
+    const ScopedLuaRef& traversable_test_ref,
+    bool stable
 ) {
   traversable_by_entities_type[type] = TraversableInfo(
       *get_lua_context(),
-      traversable_test_ref
+      traversable_test_ref,
+      stable
   );
+  notify_state_changed();
 }
 
 /**
@@ -277,6 +290,7 @@ void CustomEntity::set_traversable_by_entities(
 void CustomEntity::reset_traversable_by_entities(EntityType type) {
 
   traversable_by_entities_type.erase(type);
+  notify_state_changed();
 }
 
 /**
@@ -322,6 +336,7 @@ void CustomEntity::set_can_traverse_entities(bool traversable) {
       *get_lua_context(),
       traversable
   );
+  notify_state_changed();
 }
 
 /**
@@ -334,13 +349,19 @@ void CustomEntity::set_can_traverse_entities(bool traversable) {
  * set_can_traverse_entities(EntityType, const ScopedLuaRef&).
  *
  * \param traversable_test_ref Lua ref to a function that will do the test.
+ * \param stable \c true if the result of the function only depends on the
+ * state of both entities, so that it can be remembered.
  */
-void CustomEntity::set_can_traverse_entities(const ScopedLuaRef& traversable_test_ref) {
-
+void CustomEntity::set_can_traverse_entities(
+    const ScopedLuaRef& traversable_test_ref,
+    bool stable
+) {
   can_traverse_entities_general = TraversableInfo(
       *get_lua_context(),
-      traversable_test_ref
+      traversable_test_ref,
+      stable
   );
+  notify_state_changed();
 }
 
 /**
@@ -355,6 +376,7 @@ void CustomEntity::set_can_traverse_entities(const ScopedLuaRef& traversable_tes
 void CustomEntity::reset_can_traverse_entities() {
 
   can_traverse_entities_general = TraversableInfo();
+  notify_state_changed();
 }
 
 /**
@@ -379,6 +401,7 @@ void CustomEntity::set_can_traverse_entities(
       *get_lua_context(),
       traversable
   );
+  notify_state_changed();
 }
 
 /**
@@ -392,16 +415,21 @@ void CustomEntity::set_can_traverse_entities(
  *
  * \param type A type of entities.
  * \param traversable_test_ref Lua ref to a function that will do the test.
+ * \param stable \c true if the result of the function only depends on the
+ * state of both entities, so that it can be remembered.
  */
 void CustomEntity::set_can_traverse_entities(
     EntityType type,
-    const ScopedLuaRef& traversable_test_ref
+    const ScopedLuaRef& traversable_test_ref,
+    bool stable
 ) {
 
   can_traverse_entities_type[type] = TraversableInfo(
       *get_lua_context(),
-      traversable_test_ref
+      traversable_test_ref,
+      stable
   );
+  notify_state_changed();
 }
 
 /**
@@ -417,6 +445,7 @@ void CustomEntity::set_can_traverse_entities(
 void CustomEntity::reset_can_traverse_entities(EntityType type) {
 
   can_traverse_entities_type.erase(type);
+  notify_state_changed();
 }
 
 /**
@@ -1282,7 +1311,9 @@ void CustomEntity::draw_on_map() {
 CustomEntity::TraversableInfo::TraversableInfo():
     lua_context(nullptr),
     traversable_test_ref(),
-    traversable(false) {
+    traversable(false),
+    stable(false),
+    cache() {
 
 }
 
@@ -1297,7 +1328,9 @@ CustomEntity::TraversableInfo::TraversableInfo(
 ):
     lua_context(&lua_context),
     traversable_test_ref(),
-    traversable(traversable) {
+    traversable(traversable),
+    stable(false),
+    cache() {
 
 }
 
@@ -1305,14 +1338,19 @@ CustomEntity::TraversableInfo::TraversableInfo(
  * \brief Creates a traversable property as a Lua boolean function.
  * \param lua_context The Lua context.
  * \param traversable_test_ref Lua ref to a function.
+ * \param stable Whether the results of the function can be remembered
+ * until one of both entities changes its state.
  */
 CustomEntity::TraversableInfo::TraversableInfo(
     LuaContext& lua_context,
-    const ScopedLuaRef& traversable_test_ref
+    const ScopedLuaRef& traversable_test_ref,
+    bool stable
 ):
     lua_context(&lua_context),
     traversable_test_ref(traversable_test_ref),
-    traversable(false) {
+    traversable(false),
+    stable(stable),
+    cache() {
 
 }
 
@@ -1346,10 +1384,37 @@ bool CustomEntity::TraversableInfo::is_traversable(
     return traversable;
   }
 
-  // A Lua boolean function was set.
-  return lua_context->do_custom_entity_traversable_test_function(
+  if (!stable) {
+    // A Lua boolean function was set.
+    return lua_context->do_custom_entity_traversable_test_function(
+        traversable_test_ref, current_entity, other_entity
+    );
+  }
+
+  // A stable Lua boolean function was set: see if it was already called
+  // with the same states.
+  const uint32_t current_revision = current_entity.get_state_revision();
+  const uint32_t other_revision = other_entity.get_state_revision();
+  const auto& it = cache.find(&other_entity);
+  if (it != cache.end() &&
+      it->second.current_revision == current_revision &&
+      it->second.other_revision == other_revision) {
+    return it->second.traversable;
+  }
+
+  const bool result = lua_context->do_custom_entity_traversable_test_function(
       traversable_test_ref, current_entity, other_entity
   );
+
+  // Changing the rules from the function also changes the state revision,
+  // and then this object may not exist anymore.
+  if (current_entity.get_state_revision() == current_revision) {
+    if (cache.size() >= max_cache_size) {
+      cache.clear();
+    }
+    cache[&other_entity] = { current_revision, other_revision, result };
+  }
+  return result;
 }
 
 /**
@@ -34,7 +34,6 @@
 #include "solarus/Map.h"
 #include "solarus/Sprite.h"
 #include <lauxlib.h>
-#include <memory>
 
 namespace Solarus {
 
@@ -398,7 +397,7 @@ bool Destructible::notify_action_command_pressed() {
     if (get_equipment().has_ability(Ability::LIFT, get_weight())) {
 
       uint32_t explosion_date = get_can_explode() ? System::now() + 6000 : 0;
-      get_hero().start_lifting(std::make_shared<CarriedObject>(
+      get_hero().start_lifting(make_intrusive<CarriedObject>(
           get_hero(),
           *this,
           get_animation_set_id(),
@@ -442,6 +441,7 @@ bool Destructible::notify_action_command_pressed() {
  */
 void Destructible::play_destroy_animation() {
 
+  const bool was_ground_modifier = is_ground_modifier();
   is_being_cut = true;
   if (!destruction_sound_id.empty()) {
     Sound::play(destruction_sound_id);
@@ -453,7 +453,7 @@ void Destructible::play_destroy_animation() {
   if (!is_drawn_in_y_order()) {
     get_entities().bring_to_front(*this);  // Show animation destroy to front.
   }
-  if (is_ground_modifier()) {
+  if (was_ground_modifier) {
     update_ground_observers();  // The ground has just disappeared.
   }
 }
@@ -471,7 +471,7 @@ bool Destructible::is_waiting_for_regeneration() const {
  */
 void Destructible::explode() {
 
-  get_entities().add_entity(std::make_shared<Explosion>(
+  get_entities().add_entity(make_intrusive<Explosion>(
       "", get_layer(), get_xy(), true
   ));
   Sound::play("explosion");
@@ -528,6 +528,9 @@ void Destructible::update() {
     }
     is_regenerating = true;
     regeneration_date = 0;
+    if (is_ground_modifier()) {
+      update_ground_observers();  // The ground is back.
+    }
     get_lua_context()->destructible_on_regenerating(*this);
   }
   else if (is_regenerating &&
@@ -38,7 +38,6 @@
 #include "solarus/Savegame.h"
 #include "solarus/Sprite.h"
 #include "solarus/SpriteAnimationSet.h"
-#include <memory>
 #include <sstream>
 #include <iostream>
 
@@ -102,7 +101,7 @@ Enemy::Enemy(
   vulnerable_again_date(0),
   can_attack(true),
   can_attack_again_date(0),
-  immobilized(false),
+  immobilized_state(ImmobilizedState::NONE),
   start_shaking_date(0),
   end_shaking_date(0),
   dying_animation_started(false),
@@ -158,7 +157,7 @@ EntityPtr Enemy::create(
   }
 
   // create the enemy
-  std::shared_ptr<Enemy> enemy = std::make_shared<Enemy>(
+  IntrusivePtr<Enemy> enemy = make_intrusive<Enemy>(
       game, name, layer, xy, breed, treasure
   );
 
@@ -610,12 +609,7 @@ EnemyReaction::Reaction Enemy::get_attack_consequence(
     EnemyAttack attack,
     const Sprite* this_sprite) const {
 
-  const auto& it = attack_reactions.find(attack);
-  if (it == attack_reactions.end()) {
-    // Attack consequence was not initialized. Return a default value.
-    return EnemyReaction::Reaction();
-  }
-  return it->second.get_reaction(this_sprite);
+  return attack_reactions[static_cast<int>(attack)].get_reaction(this_sprite);
 }
 
 /**
@@ -638,7 +632,7 @@ void Enemy::set_attack_consequence(
     oss << "Invalid amount of life: " << life_lost;
     Debug::die(oss.str());
   }
-  attack_reactions[attack].set_general_reaction(reaction, life_lost);
+  attack_reactions[static_cast<int>(attack)].set_general_reaction(reaction, life_lost);
 }
 
 /**
@@ -659,7 +653,7 @@ void Enemy::set_attack_consequence_sprite(
     oss << "Invalid amount of life: " << life_lost;
     Debug::die(oss.str());
   }
-  attack_reactions[attack].set_sprite_reaction(&sprite, reaction, life_lost);
+  attack_reactions[static_cast<int>(attack)].set_sprite_reaction(&sprite, reaction, life_lost);
 }
 
 /**
@@ -689,9 +683,8 @@ void Enemy::set_no_attack_consequences_sprite(const Sprite& sprite) {
  */
 void Enemy::set_default_attack_consequences() {
 
-  for (const auto& kvp : attack_names) {
-    EnemyAttack attack = kvp.first;
-    attack_reactions[attack].set_default_reaction();
+  for (EnemyReaction& reaction : attack_reactions) {
+    reaction.set_default_reaction();
   }
   set_attack_consequence(EnemyAttack::SWORD, EnemyReaction::ReactionType::HURT, 1); // multiplied by the sword strength
   set_attack_consequence(EnemyAttack::THROWN_ITEM, EnemyReaction::ReactionType::HURT, 1); // multiplied depending on the item
@@ -725,11 +718,11 @@ void Enemy::set_default_attack_consequences_sprite(const Sprite& sprite) {
  *
  * \return name of the current animation of the first sprite
  */
-std::string Enemy::get_animation() const {
+Symbol Enemy::get_animation() const {
 
   const SpritePtr& sprite = get_sprite();
   if (sprite == nullptr) {
-    return "";
+    return Symbol();
   }
 
   return sprite->get_current_animation();
@@ -742,7 +735,7 @@ std::string Enemy::get_animation() const {
  *
  * \param animation name of the animation to set
  */
-void Enemy::set_animation(const std::string& animation) {
+void Enemy::set_animation(const Symbol& animation) {
 
   for (const SpritePtr& sprite: get_sprites()) {
     sprite->set_current_animation(animation);
@@ -754,6 +747,9 @@ void Enemy::set_animation(const std::string& animation) {
  */
 void Enemy::update() {
 
+  static const Symbol immobilized_animation = "immobilized";
+  static const Symbol shaking_animation = "shaking";
+
   Entity::update();
 
   if (is_suspended() || !is_enabled()) {
@@ -774,7 +770,7 @@ void Enemy::update() {
       }
       else if (is_immobilized()) {
         clear_movement();
-        set_animation("immobilized");
+        set_animation(immobilized_animation);
         notify_immobilized();
       }
       else {
@@ -793,24 +789,23 @@ void Enemy::update() {
     can_attack = true;
   }
 
-  if (is_immobilized() &&
+  if (immobilized_state == ImmobilizedState::SHAKING &&
       !is_killed() &&
-      now >= end_shaking_date &&
-      get_animation() == "shaking"
+      now >= end_shaking_date
   ) {
     restart();
   }
 
-  if (is_immobilized() &&
+  if (immobilized_state == ImmobilizedState::IMMOBILIZED &&
       !is_killed() &&
       !is_being_hurt() &&
       now >= start_shaking_date &&
-      !get_animation().empty() &&
-      get_animation() != "shaking"
+      get_sprite() != nullptr
   ) {
 
+    immobilized_state = ImmobilizedState::SHAKING;
     end_shaking_date = now + 2000;
-    set_animation("shaking");
+    set_animation(shaking_animation);
   }
 
   if (exploding) {
@@ -821,7 +816,7 @@ void Enemy::update() {
       Point xy;
       xy.x = get_top_left_x() + Random::get_number(get_width());
       xy.y = get_top_left_y() + Random::get_number(get_height());
-      get_entities().add_entity(std::make_shared<Explosion>(
+      get_entities().add_entity(make_intrusive<Explosion>(
           "", get_map().get_max_layer(), xy, false
       ));
       Sound::play("explosion");
@@ -1117,10 +1112,12 @@ void Enemy::restart() {
     return;
   }
 
+  static const Symbol walking_animation = "walking";
+
   if (is_immobilized()) {
     stop_immobilized();
   }
-  set_animation("walking");
+  set_animation(walking_animation);
   get_lua_context()->enemy_on_restarted(*this);
 }
 
@@ -1199,7 +1196,7 @@ void Enemy::try_hurt(EnemyAttack attack, Entity& source, Sprite* this_sprite) {
 
     case EnemyReaction::ReactionType::HURT:
 
-      if (is_immobilized() && get_animation() == "shaking") {
+      if (immobilized_state == ImmobilizedState::SHAKING) {
         stop_immobilized();
       }
 
@@ -1262,6 +1259,8 @@ void Enemy::try_hurt(EnemyAttack attack, Entity& source, Sprite* this_sprite) {
  */
 void Enemy::hurt(Entity& source, Sprite* this_sprite) {
 
+  static const Symbol hurt_animation = "hurt";
+
   uint32_t now = System::now();
 
   // update the enemy state
@@ -1271,7 +1270,7 @@ void Enemy::hurt(Entity& source, Sprite* this_sprite) {
   can_attack_again_date = now + 300;
 
   // graphics and sounds
-  set_animation("hurt");
+  set_animation(hurt_animation);
   play_hurt_sound();
 
   // stop any movement
@@ -1280,8 +1279,8 @@ void Enemy::hurt(Entity& source, Sprite* this_sprite) {
   // push the enemy back
   if (pushed_back_when_hurt) {
     double angle = source.get_angle(*this, nullptr, this_sprite);
-    std::shared_ptr<StraightMovement> movement =
-        std::make_shared<StraightMovement>(false, true);
+    IntrusivePtr<StraightMovement> movement =
+        make_intrusive<StraightMovement>(false, true);
     movement->set_max_distance(24);
     movement->set_speed(120);
     movement->set_angle(angle);
@@ -1491,7 +1490,7 @@ bool Enemy::is_sprite_finished_or_looping() const {
  */
 void Enemy::immobilize() {
 
-  immobilized = true;
+  immobilized_state = ImmobilizedState::IMMOBILIZED;
   start_shaking_date = System::now() + 5000;
 }
 
@@ -1500,7 +1499,7 @@ void Enemy::immobilize() {
  */
 void Enemy::stop_immobilized() {
 
-  immobilized = false;
+  immobilized_state = ImmobilizedState::NONE;
   end_shaking_date = 0;
 }
 
@@ -1510,7 +1509,7 @@ void Enemy::stop_immobilized() {
  */
 bool Enemy::is_immobilized() const {
 
-  return immobilized;
+  return immobilized_state != ImmobilizedState::NONE;
 }
 
 /**
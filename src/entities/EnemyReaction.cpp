@@ -74,8 +74,16 @@ void EnemyReaction::set_sprite_reaction(const Sprite* sprite, ReactionType react
     set_general_reaction(reaction, life_lost);
   }
   else {
-    sprite_reactions[sprite].type = reaction;
-    sprite_reactions[sprite].life_lost = life_lost;
+    Reaction sprite_reaction;
+    sprite_reaction.type = reaction;
+    sprite_reaction.life_lost = life_lost;
+    for (std::pair<const Sprite*, Reaction>& kvp : sprite_reactions) {
+      if (kvp.first == sprite) {
+        kvp.second = sprite_reaction;
+        return;
+      }
+    }
+    sprite_reactions.emplace_back(sprite, sprite_reaction);
   }
 }
 
@@ -88,9 +96,10 @@ const EnemyReaction::Reaction& EnemyReaction::get_reaction(
     const Sprite* sprite) const {
 
   if (sprite != nullptr) {
-    auto it = sprite_reactions.find(sprite);
-    if (it != sprite_reactions.end()) {
-      return it->second;
+    for (const std::pair<const Sprite*, Reaction>& kvp : sprite_reactions) {
+      if (kvp.first == sprite) {
+        return kvp.second;
+      }
     }
   }
   return general_reaction;
@@ -21,6 +21,7 @@
 #include "solarus/entities/EntityTypeInfo.h"
 #include "solarus/entities/Hero.h"
 #include "solarus/entities/NonAnimatedRegions.h"
+#include "solarus/entities/ParallaxLayers.h"
 #include "solarus/entities/Separator.h"
 #include "solarus/entities/SeparatorPtr.h"
 #include "solarus/entities/Stairs.h"
@@ -31,9 +32,13 @@
 #include "solarus/lowlevel/Debug.h"
 #include "solarus/lowlevel/Music.h"
 #include "solarus/lowlevel/Surface.h"
+#include "solarus/lowlevel/System.h"
 #include "solarus/lua/LuaContext.h"
 #include "solarus/Game.h"
+#include "solarus/GameCheckpoint.h"
 #include "solarus/Map.h"
+#include "solarus/Sprite.h"
+#include <algorithm>
 #include <sstream>
 #include <lua.hpp>
 
@@ -146,6 +151,8 @@ Entities::Entities(Game& game, Map& map):
   tiles_ground(),
   non_animated_regions(),
   tiles_in_animated_regions(),
+  parallax_layers(),
+  occluding_layers(),
   hero(game.get_hero()),
   camera(nullptr),
   named_entities(),
@@ -155,7 +162,13 @@ Entities::Entities(Game& game, Map& map):
   entities_drawn_not_at_their_position(),
   entities_to_draw(),
   entities_to_remove(),
-  default_destination(nullptr) {
+  default_destination(nullptr),
+  deferred_entities(),
+  deferred_names(),
+  hero_region(),
+  camera_region(),
+  next_entity_z(0),
+  use_next_entity_z(false) {
 
   // Initialize the size.
   initialize_layers();
@@ -170,6 +183,10 @@ Entities::Entities(Game& game, Map& map):
     non_animated_regions[layer] = std::unique_ptr<NonAnimatedRegions>(
         new NonAnimatedRegions(map, layer)
     );
+
+    parallax_layers[layer] = std::unique_ptr<ParallaxLayers>(
+        new ParallaxLayers(map, layer)
+    );
   }
 
   // Initialize the quadtree.
@@ -178,7 +195,15 @@ Entities::Entities(Game& game, Map& map):
   quadtree.initialize(quadtree_space);
 
   // Create the camera.
-  add_entity(std::make_shared<Camera>(map));
+  add_entity(make_intrusive<Camera>(map));
+}
+
+/**
+ * \brief Destructor.
+ *
+ * Defined here because the layer caches are incomplete types in the header.
+ */
+Entities::~Entities() {
 }
 
 /**
@@ -186,6 +211,21 @@ Entities::Entities(Game& game, Map& map):
  */
 void Entities::create_entities(const MapData& data) {
 
+  // On maps split by separators, only the region where the game starts
+  // is visible: entities of other regions can wait until they get close.
+  // This requires the map data to stay available.
+  bool defer = false;
+  if (map.get_data().get() == &data) {
+    for (int layer = map.get_min_layer(); layer <= map.get_max_layer() && !defer; ++layer) {
+      for (int i = 0; i < data.get_num_entities(layer); ++i) {
+        if (data.get_entity({ layer, i }).get_type() == EntityType::SEPARATOR) {
+          defer = true;
+          break;
+        }
+      }
+    }
+  }
+
   // Create entities from the map data file.
   LuaContext& lua_context = map.get_lua_context();
   for (int layer = map.get_min_layer(); layer <= map.get_max_layer(); ++layer) {
@@ -195,6 +235,22 @@ void Entities::create_entities(const MapData& data) {
       if (!EntityTypeInfo::can_be_stored_in_map_file(type)) {
         Debug::error("Illegal entity type in map data: " + enum_to_name(type));
       }
+
+      if (defer && is_deferrable(type)) {
+        // Remember it for later and keep its place in the Z order.
+        DeferredEntity deferred_entity;
+        deferred_entity.index = { layer, i };
+        deferred_entity.type = type;
+        deferred_entity.name = entity_data.get_name();
+        deferred_entity.xy = entity_data.get_xy();
+        deferred_entity.z = z_caches[layer].reserve();
+        if (!deferred_entity.name.empty()) {
+          deferred_names.insert(deferred_entity.name);
+        }
+        deferred_entities.push_back(deferred_entity);
+        continue;
+      }
+
       if (lua_context.create_map_entity_from_data(map, entity_data)) {
         lua_pop(lua_context.get_internal_state(), 1);  // Discard the created entity on the stack.
       }
@@ -237,7 +293,7 @@ EntityVector Entities::get_entities() {
  * \return The default destination, or nullptr if there exists no destination
  * on this map.
  */
-const std::shared_ptr<Destination>& Entities::get_default_destination() {
+const IntrusivePtr<Destination>& Entities::get_default_destination() {
   return default_destination;
 }
 
@@ -289,9 +345,26 @@ EntityPtr Entities::get_entity(const std::string& name) {
  */
 EntityPtr Entities::find_entity(const std::string& name) {
 
-  auto it = named_entities.find(name);
+  // Don't intern names that no entity has.
+  Symbol symbol;
+  auto it = named_entities.end();
+  if (Symbol::find(name, symbol)) {
+    it = named_entities.find(symbol);
+  }
   if (it == named_entities.end()) {
-    return nullptr;
+
+    if (deferred_names.find(name) == deferred_names.end()) {
+      return nullptr;
+    }
+
+    // The entity exists in the map data but was not created yet.
+    instantiate_deferred_entities([&name](const DeferredEntity& deferred_entity) {
+      return deferred_entity.name == name;
+    });
+    it = named_entities.find(Symbol(name));
+    if (it == named_entities.end()) {
+      return nullptr;
+    }
   }
 
   const EntityPtr& entity = it->second;
@@ -313,6 +386,10 @@ EntityPtr Entities::find_entity(const std::string& name) {
  */
 EntityVector Entities::get_entities_with_prefix(const std::string& prefix) {
 
+  instantiate_deferred_entities([&prefix](const DeferredEntity& deferred_entity) {
+    return deferred_entity.name.substr(0, prefix.size()) == prefix;
+  });
+
   EntityVector entities;
 
   if (prefix.empty()) {
@@ -362,6 +439,11 @@ EntityVector Entities::get_entities_with_prefix_sorted(const std::string& prefix
 EntityVector Entities::get_entities_with_prefix(
     EntityType type, const std::string& prefix) {
 
+  instantiate_deferred_entities([type, &prefix](const DeferredEntity& deferred_entity) {
+    return deferred_entity.type == type &&
+        deferred_entity.name.substr(0, prefix.size()) == prefix;
+  });
+
   EntityVector entities;
 
   if (prefix.empty()) {
@@ -418,7 +500,9 @@ bool Entities::has_entity_with_prefix(const std::string& prefix) const {
     }
   }
 
-  return false;
+  return has_deferred_entity([&prefix](const DeferredEntity& deferred_entity) {
+    return deferred_entity.name.substr(0, prefix.size()) == prefix;
+  });
 }
 
 /**
@@ -490,6 +574,7 @@ void Entities::get_entities_in_region(
 
   // Find the bounding box of the region.
   Rectangle region_box = get_region_box(xy);
+  instantiate_deferred_entities(region_box);
 
   // Get entities in that rectangle.
   get_entities_in_rectangle(region_box, result);
@@ -591,6 +676,12 @@ void Entities::get_entities_in_region_sorted(
  */
 EntitySet Entities::get_entities_by_type(EntityType type) {
 
+  if (is_deferrable(type)) {
+    instantiate_deferred_entities([type](const DeferredEntity& deferred_entity) {
+      return deferred_entity.type == type;
+    });
+  }
+
   EntitySet result;
   for (int layer = map.get_min_layer(); layer <= map.get_max_layer(); ++layer) {
     const EntitySet& layer_entities = get_entities_by_type(type, layer);
@@ -671,7 +762,7 @@ int Entities::get_entity_relative_z_order(const ConstEntityPtr& entity) const {
  */
 void Entities::bring_to_front(Entity& entity) {
 
-  const EntityPtr& shared_entity = std::static_pointer_cast<Entity>(entity.shared_from_this());
+  EntityPtr shared_entity(&entity);
   int layer = entity.get_layer();
   z_caches.at(layer).bring_to_front(shared_entity);
 }
@@ -682,7 +773,7 @@ void Entities::bring_to_front(Entity& entity) {
  */
 void Entities::bring_to_back(Entity& entity) {
 
-  const EntityPtr& shared_entity = std::static_pointer_cast<Entity>(entity.shared_from_this());
+  EntityPtr shared_entity(&entity);
   int layer = entity.get_layer();
   z_caches.at(layer).bring_to_back(shared_entity);
 }
@@ -697,14 +788,25 @@ void Entities::notify_map_started() {
     std::vector<TileInfo> tiles_in_animated_regions_info;
     non_animated_regions.at(layer)->build(tiles_in_animated_regions_info);
     for (const TileInfo& tile_info : tiles_in_animated_regions_info) {
+      if (tile_info.pattern->get_parallax_ratio() != 0) {
+        // Drawn with the other parallax tiles of the layer.
+        parallax_layers.at(layer)->add_tile(tile_info);
+        continue;
+      }
+
       // This tile is non-optimizable, create it for real.
-      TilePtr tile = std::make_shared<Tile>(tile_info);
+      TilePtr tile = make_intrusive<Tile>(tile_info);
       tiles_in_animated_regions.at(layer).push_back(tile);
       add_entity(tile);
     }
   }
 
   // Now, tiles_in_animated_regions contains the tiles that won't be optimized.
+  update_occlusion();
+
+  // Create the entities of the starting region.
+  update_deferred_entities();
+
   // Notify entities.
   for (const EntityPtr& entity: all_entities) {
     entity->notify_map_started();
@@ -735,7 +837,9 @@ void Entities::notify_tileset_changed() {
   // Redraw optimized tiles (i.e. non animated ones).
   for (int layer = map.get_min_layer(); layer <= map.get_max_layer(); ++layer) {
     non_animated_regions[layer]->notify_tileset_changed();
+    parallax_layers[layer]->notify_tileset_changed();
   }
+  update_occlusion();
 
   for (const EntityPtr& entity: all_entities) {
     entity->notify_tileset_changed();
@@ -766,6 +870,7 @@ void Entities::initialize_layers() {
     tiles_ground[layer] = std::vector<Ground>();
     non_animated_regions[layer] = std::unique_ptr<NonAnimatedRegions>();
     tiles_in_animated_regions[layer] = std::vector<TilePtr>();
+    parallax_layers[layer] = std::unique_ptr<ParallaxLayers>();
     z_caches[layer] = ZCache();
   }
 }
@@ -960,10 +1065,27 @@ void Entities::add_entity(const EntityPtr& entity) {
   Debug::check_assertion(map.is_valid_layer(entity->get_layer()),
       "No such layer on this map");
 
+  const bool reserved_z = use_next_entity_z;
+  use_next_entity_z = false;
+  if (!reserved_z &&
+      !entity->get_name().empty() &&
+      deferred_names.find(entity->get_name()) != deferred_names.end()) {
+    // A deferred entity of the map file has the same name:
+    // create it first so that it keeps its name.
+    const std::string name = entity->get_name();
+    instantiate_deferred_entities([&name](const DeferredEntity& deferred_entity) {
+      return deferred_entity.name == name;
+    });
+  }
+
   const EntityType type = entity->get_type();
   if (type != EntityType::TILE) {  // Tiles are optimized specifically.
     const int layer = entity->get_layer();
 
+    if (entity->is_ground_modifier()) {
+      map.notify_ground_changed();
+    }
+
     // Update the quadtree.
     quadtree.add(entity, entity->get_max_bounding_box());
 
@@ -972,13 +1094,13 @@ void Entities::add_entity(const EntityPtr& entity) {
 
       case EntityType::CAMERA:
         Debug::check_assertion(camera == nullptr, "Only one camera is supported");
-        camera = std::static_pointer_cast<Camera>(entity);
+        camera = static_pointer_cast<Camera>(entity);
         break;
 
       case EntityType::DESTINATION:
         {
-          std::shared_ptr<Destination> destination =
-              std::static_pointer_cast<Destination>(entity);
+          IntrusivePtr<Destination> destination =
+              static_pointer_cast<Destination>(entity);
           if (this->default_destination == nullptr || destination->is_default()) {
             this->default_destination = destination;
           }
@@ -995,7 +1117,12 @@ void Entities::add_entity(const EntityPtr& entity) {
     }
 
     // Track the insertion order.
-    z_caches[layer].add(entity);
+    if (reserved_z) {
+      z_caches[layer].add(entity, next_entity_z);
+    }
+    else {
+      z_caches[layer].add(entity);
+    }
 
     // Update the list of entities by type.
     auto it = entities_by_type.find(type);
@@ -1044,7 +1171,7 @@ void Entities::add_entity(const EntityPtr& entity) {
 
       entity->set_name(name);
     }
-    named_entities[name] = entity;
+    named_entities[Symbol(name)] = entity;
   }
 
   // Notify the entity.
@@ -1061,17 +1188,21 @@ void Entities::remove_entity(Entity& entity) {
 
   if (!entity.is_being_removed()) {
     // Destroy the entity next frame.
-    const EntityPtr& shared_entity = std::static_pointer_cast<Entity>(entity.shared_from_this());
+    EntityPtr shared_entity(&entity);
     entities_to_remove.push_back(shared_entity);
 
     // Tell the entity.
     entity.notify_being_removed();
 
+    if (entity.is_ground_modifier()) {
+      map.notify_ground_changed();
+    }
+
     // Remove the entity from the by name list
     // to allow users to create a new one with
     // the same name right now.
     if (!entity.get_name().empty()) {
-      named_entities.erase(entity.get_name());
+      named_entities.erase(Symbol(entity.get_name()));
     }
   }
 }
@@ -1118,7 +1249,7 @@ void Entities::remove_marked_entities() {
     all_entities.remove(entity);
     const std::string& name = entity->get_name();
     if (!name.empty()) {
-      named_entities.erase(name);
+      named_entities.erase(Symbol(name));
     }
 
     // Update the specific entities lists.
@@ -1177,6 +1308,12 @@ void Entities::update() {
 
   Debug::check_assertion(map.is_started(), "The map is not started");
 
+  // Create entities whose region is about to be visible.
+  update_deferred_entities();
+
+  // Advance sprite animations in parallel before the serial updates.
+  precompute_sprite_frames();
+
   // First update the hero.
   hero->update();
 
@@ -1199,6 +1336,40 @@ void Entities::update() {
   remove_marked_entities();
 }
 
+/**
+ * \brief Computes in advance the frame changes of sprites of all entities
+ * about to be updated.
+ *
+ * This is only the frame timing bookkeeping, which is done in parallel.
+ * Frame change events are still delivered by each entity's update,
+ * in the usual order.
+ */
+void Entities::precompute_sprite_frames() {
+
+  sprites_to_precompute.clear();
+
+  const auto& add_sprites = [this](const Entity& entity) {
+    for (const Entity::NamedSprite& named_sprite: entity.get_named_sprites()) {
+      if (!named_sprite.removed) {
+        sprites_to_precompute.push_back(named_sprite.sprite.get());
+      }
+    }
+  };
+
+  add_sprites(*hero);
+  for (const EntityPtr& entity: all_entities) {
+    if (
+        !entity->is_being_removed() &&
+        entity->get_type() != EntityType::CAMERA
+    ) {
+      add_sprites(*entity);
+    }
+  }
+
+  Sprite::precompute_frames(sprites_to_precompute, System::now());
+  sprites_to_precompute.clear();
+}
+
 /**
  * \brief Draws the entities on the map surface.
  */
@@ -1263,13 +1434,20 @@ void Entities::draw() {
 
   for (int layer = map.get_min_layer(); layer <= map.get_max_layer(); ++layer) {
 
+    // Draw the parallax scrolling tiles, which are usually backgrounds.
+    parallax_layers[layer]->draw_on_map();
+
     // Draw the animated tiles and the tiles that overlap them:
     // in other words, draw all regions containing animated tiles
     // (and maybe more, but we don't care because non-animated tiles
     // will be drawn later).
     for (unsigned int i = 0; i < tiles_in_animated_regions[layer].size(); i++) {
       Tile& tile = *tiles_in_animated_regions[layer][i];
-      if (tile.overlaps(*camera) || !tile.is_drawn_at_its_position()) {
+      if (!tile.is_drawn_at_its_position()) {
+        tile.draw_on_map();
+      }
+      else if (tile.overlaps(*camera) &&
+          !is_hidden(tile.get_bounding_box(), layer)) {
         tile.draw_on_map();
       }
     }
@@ -1301,7 +1479,7 @@ void Entities::set_entity_layer(Entity& entity, int layer) {
 
   if (layer != old_layer) {
 
-    const EntityPtr& shared_entity = std::static_pointer_cast<Entity>(entity.shared_from_this());
+    EntityPtr shared_entity(&entity);
 
     // Track the insertion order.
     z_caches.at(old_layer).remove(shared_entity);
@@ -1316,6 +1494,10 @@ void Entities::set_entity_layer(Entity& entity, int layer) {
       sets[layer].insert(shared_entity);
     }
 
+    if (entity.is_ground_modifier()) {
+      map.notify_ground_changed();
+    }
+
     // Update the entity after the lists because this function might be called again.
     entity.set_layer(layer);
   }
@@ -1332,8 +1514,270 @@ void Entities::notify_entity_bounding_box_changed(Entity& entity) {
 
   // Note that if the entity is not in the quadtree
   // (i.e. not managed by MapEntities) this does nothing.
-  EntityPtr shared_entity = std::static_pointer_cast<Entity>(entity.shared_from_this());
+  EntityPtr shared_entity(&entity);
   quadtree.move(shared_entity, shared_entity->get_max_bounding_box());
+
+  if (entity.is_ground_modifier()) {
+    map.notify_ground_changed();
+  }
+}
+
+/**
+ * \brief Determines for each 8x8 square of the map the highest layer where
+ * it is covered by an opaque non-animated tile.
+ *
+ * This function should be called when the non-animated regions are built
+ * or when the opacity of tile patterns changes.
+ */
+void Entities::update_occlusion() {
+
+  occluding_layers.assign(tiles_grid_size, map.get_min_layer() - 1);
+  for (int layer = map.get_min_layer(); layer <= map.get_max_layer(); ++layer) {
+    const NonAnimatedRegions& regions = *non_animated_regions[layer];
+    for (int i = 0; i < tiles_grid_size; ++i) {
+      if (regions.is_square_opaque(i)) {
+        occluding_layers[i] = layer;
+      }
+    }
+  }
+
+  for (int layer = map.get_min_layer(); layer <= map.get_max_layer(); ++layer) {
+    non_animated_regions[layer]->update_hidden_cells();
+  }
+}
+
+/**
+ * \brief Returns whether a rectangle of the map is entirely hidden by
+ * opaque non-animated tiles of layers above a given one.
+ *
+ * Only static tiles are taken into account since they never move.
+ *
+ * \param where A rectangle in map coordinates.
+ * \param layer The layer of what would be drawn there.
+ * Use the min layer - 1 to check the background of the map.
+ * \return \c true if anything drawn there on this layer would be
+ * entirely covered.
+ */
+bool Entities::is_hidden(const Rectangle& where, int layer) const {
+
+  if (occluding_layers.empty() ||
+      where.is_flat() ||
+      where.get_x() < 0 ||
+      where.get_y() < 0 ||
+      where.get_x() + where.get_width() > map_width8 * 8 ||
+      where.get_y() + where.get_height() > map_height8 * 8) {
+    return false;
+  }
+
+  const int x8_1 = where.get_x() / 8;
+  const int y8_1 = where.get_y() / 8;
+  const int x8_2 = (where.get_x() + where.get_width() - 1) / 8;
+  const int y8_2 = (where.get_y() + where.get_height() - 1) / 8;
+  for (int y8 = y8_1; y8 <= y8_2; ++y8) {
+    for (int x8 = x8_1; x8 <= x8_2; ++x8) {
+      if (occluding_layers[y8 * map_width8 + x8] <= layer) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * \brief Returns whether entities of a type may be created lazily.
+ *
+ * Only entity types that do not affect the rest of the map before
+ * they are close to the hero can be deferred.
+ *
+ * \param type A type of entity.
+ * \return \c true if entities of this type may be deferred.
+ */
+bool Entities::is_deferrable(EntityType type) {
+
+  switch (type) {
+
+  case EntityType::CHEST:
+  case EntityType::CUSTOM:
+  case EntityType::DESTRUCTIBLE:
+  case EntityType::ENEMY:
+  case EntityType::NPC:
+  case EntityType::PICKABLE:
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+/**
+ * \brief Creates the deferred entities of the regions of the hero
+ * and of the camera.
+ *
+ * Nothing is done if these regions did not change since the last call.
+ */
+void Entities::update_deferred_entities() {
+
+  if (deferred_entities.empty()) {
+    return;
+  }
+
+  const Rectangle& new_hero_region = get_region_box(hero->get_center_point());
+  const Rectangle& new_camera_region = camera != nullptr ?
+      get_region_box(camera->get_center_point()) : new_hero_region;
+  if (new_hero_region == hero_region && new_camera_region == camera_region) {
+    return;
+  }
+  hero_region = new_hero_region;
+  camera_region = new_camera_region;
+
+  instantiate_deferred_entities([this](const DeferredEntity& deferred_entity) {
+    return hero_region.contains(deferred_entity.xy) ||
+        camera_region.contains(deferred_entity.xy);
+  });
+}
+
+/**
+ * \brief Creates the deferred entities placed in a rectangle.
+ * \param where A rectangle of the map.
+ */
+void Entities::instantiate_deferred_entities(const Rectangle& where) {
+
+  instantiate_deferred_entities([&where](const DeferredEntity& deferred_entity) {
+    return where.contains(deferred_entity.xy);
+  });
+}
+
+/**
+ * \brief Returns whether a deferred entity satisfies a condition.
+ * \param predicate The condition to test.
+ * \return \c true if at least one entity not created yet satisfies it.
+ */
+bool Entities::has_deferred_entity(const DeferredEntityPredicate& predicate) const {
+
+  return std::any_of(deferred_entities.begin(), deferred_entities.end(), predicate);
+}
+
+/**
+ * \brief Creates the deferred entities that satisfy a condition.
+ *
+ * They get the Z order they would have had if they were created
+ * when the map was loaded.
+ *
+ * \param predicate The condition to test.
+ */
+void Entities::instantiate_deferred_entities(const DeferredEntityPredicate& predicate) {
+
+  if (deferred_entities.empty()) {
+    return;
+  }
+
+  // Take them out of the list first: their creation runs scripts
+  // that may look for other entities.
+  std::vector<DeferredEntity> to_create;
+  std::vector<DeferredEntity> remaining;
+  for (DeferredEntity& deferred_entity : deferred_entities) {
+    if (predicate(deferred_entity)) {
+      to_create.push_back(std::move(deferred_entity));
+    }
+    else {
+      remaining.push_back(std::move(deferred_entity));
+    }
+  }
+  deferred_entities = std::move(remaining);
+  if (to_create.empty()) {
+    return;
+  }
+
+  for (const DeferredEntity& deferred_entity : to_create) {
+    if (!deferred_entity.name.empty()) {
+      deferred_names.erase(deferred_names.find(deferred_entity.name));
+    }
+  }
+
+  const std::shared_ptr<const MapData> data = map.get_data();
+  LuaContext& lua_context = map.get_lua_context();
+  for (const DeferredEntity& deferred_entity : to_create) {
+    next_entity_z = deferred_entity.z;
+    use_next_entity_z = true;
+    if (lua_context.create_map_entity_from_data(map, data->get_entity(deferred_entity.index))) {
+      lua_pop(lua_context.get_internal_state(), 1);  // Discard the created entity on the stack.
+    }
+    use_next_entity_z = false;
+  }
+}
+
+/**
+ * \brief Captures the state of the named entities of the map.
+ *
+ * Entities of the map data that were removed are also stored, so that
+ * they can be removed again when the checkpoint is restored.
+ * Entities not created yet are still in their initial state:
+ * nothing is stored for them.
+ *
+ * \param checkpoint The checkpoint to fill.
+ */
+void Entities::save_checkpoint(GameCheckpoint& checkpoint) const {
+
+  checkpoint.entities.clear();
+  for (const auto& kvp: named_entities) {
+    const EntityPtr& entity = kvp.second;
+    if (entity->get_type() == EntityType::HERO ||
+        entity->is_being_removed()) {
+      continue;
+    }
+    GameCheckpoint::EntityCheckpoint state;
+    state.name = entity->get_name();
+    state.xy = entity->get_xy();
+    state.layer = entity->get_layer();
+    state.enabled = entity->is_enabled();
+    checkpoint.entities.push_back(state);
+  }
+
+  for (const auto& kvp: map.get_data()->get_named_entities_indexes()) {
+    const std::string& name = kvp.first;
+    Symbol symbol;
+    if (Symbol::find(name, symbol)) {
+      const auto it = named_entities.find(symbol);
+      if (it != named_entities.end() && !it->second->is_being_removed()) {
+        continue;
+      }
+    }
+    if (deferred_names.find(name) != deferred_names.end()) {
+      continue;
+    }
+    GameCheckpoint::EntityCheckpoint state;
+    state.name = name;
+    state.removed = true;
+    checkpoint.entities.push_back(state);
+  }
+}
+
+/**
+ * \brief Gives back to named entities the state captured in a checkpoint.
+ *
+ * Entities of the checkpoint that do not exist on this map are ignored.
+ *
+ * \param checkpoint The checkpoint to restore.
+ */
+void Entities::restore_checkpoint(const GameCheckpoint& checkpoint) {
+
+  for (const GameCheckpoint::EntityCheckpoint& state: checkpoint.entities) {
+
+    const EntityPtr entity = find_entity(state.name);
+    if (entity == nullptr) {
+      continue;
+    }
+
+    if (state.removed) {
+      remove_entity(*entity);
+      continue;
+    }
+
+    entity->set_xy(state.xy);
+    set_entity_layer(*entity, state.layer);
+    entity->notify_position_changed();
+    entity->set_enabled(state.enabled);
+  }
 }
 
 /**
@@ -1394,6 +1838,16 @@ int Entities::ZCache::get_z(const ConstEntityPtr& entity) const {
   return z_values.at(entity);
 }
 
+/**
+ * \brief Reserves a Z order at the end of the structure for an entity
+ * that will be added later.
+ * \return The reserved Z order.
+ */
+int Entities::ZCache::reserve() {
+
+  return ++max;
+}
+
 /**
  * \brief Inserts an entity at the end of the structure.
  *
@@ -1405,6 +1859,19 @@ void Entities::ZCache::add(const ConstEntityPtr& entity) {
   z_values.insert(std::make_pair(entity, max));
 }
 
+/**
+ * \brief Inserts an entity with a Z order reserved earlier.
+ *
+ * Nothing happens if the entity was already present.
+ *
+ * \param entity The entity to add.
+ * \param z A value returned by reserve().
+ */
+void Entities::ZCache::add(const ConstEntityPtr& entity, int z) {
+
+  z_values.insert(std::make_pair(entity, z));
+}
+
 /**
  * \brief Removes an entity from the structure.
  *
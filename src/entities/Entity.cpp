@@ -24,6 +24,7 @@
 #include "solarus/entities/Npc.h"
 #include "solarus/entities/Separator.h"
 #include "solarus/entities/SeparatorPtr.h"
+#include "solarus/entities/Stream.h"
 #include "solarus/entities/StreamAction.h"
 #include "solarus/entities/Switch.h"
 #include "solarus/entities/Tileset.h"
@@ -44,6 +45,15 @@
 
 namespace Solarus {
 
+namespace {
+
+/**
+ * \brief Last state revision given to an entity.
+ */
+uint32_t last_state_revision = 0;
+
+}
+
 /**
  * \brief Creates an entity, specifying its position, its name and its direction.
  * \param name Name identifying the entity on the map or an empty string.
@@ -80,6 +90,7 @@ Entity::Entity(
   initialized(false),
   being_removed(false),
   enabled(true),
+  state_revision(++last_state_revision),
   suspended(false),
   when_suspended(0),
   optimization_distance(default_optimization_distance),
@@ -169,6 +180,9 @@ Ground Entity::get_modified_ground() const {
  */
 void Entity::update_ground_observers() {
 
+  // Invalidate ground information cached by entities.
+  get_map().notify_ground_changed();
+
   // Update overlapping entities that are sensible to their ground.
   const Rectangle& box = get_bounding_box();
   std::vector<EntityPtr> entities_nearby;
@@ -232,14 +246,28 @@ void Entity::update_ground_below() {
   }
 
   Ground previous_ground = this->ground_below;
-  this->ground_below = get_map().get_ground(
-      get_layer(), get_ground_point(), this
-  );
+  this->ground_below = probe_ground(get_layer(), get_ground_point());
   if (this->ground_below != previous_ground) {
     notify_ground_below_changed();
   }
 }
 
+/**
+ * \brief Returns the ground of the map at a point, ignoring this entity.
+ *
+ * By default, this is just Map::get_ground().
+ * Entities that query the ground often can redefine this function to
+ * cache the results.
+ *
+ * \param layer Layer of the point.
+ * \param xy Coordinates of the point.
+ * \return The ground at this place.
+ */
+Ground Entity::probe_ground(int layer, const Point& xy) {
+
+  return get_map().get_ground(layer, xy, this);
+}
+
 /**
  * \brief Returns whether entities of this type can be drawn.
  *
@@ -1300,7 +1328,7 @@ std::vector<SpritePtr> Entity::get_sprites() const {
  * \brief Returns all sprites of this entity and their names.
  * \return The sprites and their names.
  */
-std::vector<Entity::NamedSprite> Entity::get_named_sprites() const {
+const std::vector<Entity::NamedSprite>& Entity::get_named_sprites() const {
   return sprites;
 }
 
@@ -1311,10 +1339,10 @@ std::vector<Entity::NamedSprite> Entity::get_named_sprites() const {
  * \return The sprite created.
  */
 SpritePtr Entity::create_sprite(
-    const std::string& animation_set_id,
+    const Symbol& animation_set_id,
     const std::string& sprite_name
 ) {
-  SpritePtr sprite = std::make_shared<Sprite>(animation_set_id);
+  SpritePtr sprite = make_intrusive<Sprite>(animation_set_id);
 
   NamedSprite named_sprite;
   named_sprite.name = sprite_name;
@@ -1450,7 +1478,7 @@ void Entity::set_default_sprite_name(const std::string& default_sprite_name) {
  * \param animation the current animation
  * \param frame the new frame
  */
-void Entity::notify_sprite_frame_changed(Sprite& /* sprite */, const std::string& /* animation */, int /* frame */) {
+void Entity::notify_sprite_frame_changed(Sprite& /* sprite */, const Symbol& /* animation */, int /* frame */) {
 }
 
 /**
@@ -1462,7 +1490,7 @@ void Entity::notify_sprite_frame_changed(Sprite& /* sprite */, const std::string
  * \param sprite the sprite
  * \param animation the animation just finished
  */
-void Entity::notify_sprite_animation_finished(Sprite& /* sprite */, const std::string& /* animation */) {
+void Entity::notify_sprite_animation_finished(Sprite& /* sprite */, const Symbol& /* animation */) {
 }
 
 /**
@@ -1485,7 +1513,7 @@ void Entity::set_visible(bool visible) {
  * \brief Returns the current movement of the entity.
  * \return the entity's movement, or nullptr if there is no movement
  */
-const std::shared_ptr<Movement>& Entity::get_movement() {
+const IntrusivePtr<Movement>& Entity::get_movement() {
   return movement;
 }
 
@@ -1493,7 +1521,7 @@ const std::shared_ptr<Movement>& Entity::get_movement() {
  * \brief Returns the current movement of the entity.
  * \return the entity's movement, or nullptr if there is no movement
  */
-std::shared_ptr<const Movement> Entity::get_movement() const {
+IntrusivePtr<const Movement> Entity::get_movement() const {
   return movement;
 }
 
@@ -1501,7 +1529,7 @@ std::shared_ptr<const Movement> Entity::get_movement() const {
  * \brief Sets the movement of this entity.
  * \param movement the movement to set, or nullptr to set no movement
  */
-void Entity::set_movement(const std::shared_ptr<Movement>& movement) {
+void Entity::set_movement(const IntrusivePtr<Movement>& movement) {
 
   clear_movement();
   this->movement = movement;
@@ -2254,6 +2282,8 @@ void Entity::set_enabled(bool enabled) {
     return;
   }
 
+  notify_state_changed();
+
   if (enabled) {
     // Enable the entity.
 
@@ -3518,12 +3548,38 @@ void Entity::set_state(State* new_state) {
   this->state = std::unique_ptr<State>(new_state);
   this->state->start(old_state);  // May also change the state again.
 
+  notify_state_changed();
+
   if (this->state.get() == new_state) {
     // If the state has not already changed again.
     check_position();
   }
 }
 
+/**
+ * \brief Returns a number that changes whenever the state of this entity
+ * changes.
+ *
+ * This includes changes of the internal state and of the enabled status.
+ * Values are never reused, even by other entities, so they can be used to
+ * invalidate cached results that depend on this entity.
+ *
+ * \return The current state revision.
+ */
+uint32_t Entity::get_state_revision() const {
+  return state_revision;
+}
+
+/**
+ * \brief Notifies this entity that its state has changed.
+ *
+ * This invalidates results that were cached for the previous state
+ * revision.
+ */
+void Entity::notify_state_changed() {
+  state_revision = ++last_state_revision;
+}
+
 /**
  * \brief Returns the name of the entity's internal state.
  * \return A name describing the current state of the entity.
@@ -1099,7 +1099,7 @@ bool Entity::State::is_carrying_item() const {
  *
  * \return the item carried by the entity, or nullptr
  */
-std::shared_ptr<CarriedObject> Entity::State::get_carried_object() const {
+IntrusivePtr<CarriedObject> Entity::State::get_carried_object() const {
   return nullptr;
 }
 
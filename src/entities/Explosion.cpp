@@ -76,7 +76,7 @@ void Explosion::update() {
  * \param animation the current animation
  * \param frame the new frame
  */
-void Explosion::notify_sprite_frame_changed(Sprite& /* sprite */, const std::string& /* animation */, int frame) {
+void Explosion::notify_sprite_frame_changed(Sprite& /* sprite */, const Symbol& /* animation */, int frame) {
 
   if (frame == 1) {
     // also detect non-pixel precise collisions
@@ -110,7 +110,10 @@ Hero::Hero(Equipment& equipment):
   target_solid_ground_callback(),
   next_ground_date(0),
   next_ice_date(0),
-  ice_movement_direction8(0) {
+  ice_movement_direction8(0),
+  ground_probes(),
+  num_ground_probes(0),
+  next_ground_probe(0) {
 
   // position
   set_origin(8, 13);
@@ -141,7 +144,7 @@ EntityType Hero::get_type() const {
  *
  * \return The carried object or nullptr.
  */
-std::shared_ptr<CarriedObject> Hero::get_carried_object() {
+IntrusivePtr<CarriedObject> Hero::get_carried_object() {
   return get_state().get_carried_object();
 }
 
@@ -233,8 +236,8 @@ void Hero::update_ground_effects() {
     if (is_ground_visible() && get_movement() != nullptr) {
 
       // a special ground is displayed under the hero and it's time to play a sound
-      const std::shared_ptr<StraightMovement> movement =
-          std::dynamic_pointer_cast<StraightMovement>(get_movement());
+      const IntrusivePtr<StraightMovement> movement =
+          dynamic_pointer_cast<StraightMovement>(get_movement());
       if (movement != nullptr) {
         // TODO replace the dynamic_pointer_cast by a virtual method get_speed() in Movement.
         double speed = movement->get_speed();
@@ -548,8 +551,10 @@ void Hero::place_on_map(Map& map) {
     return;
   }
 
+  clear_ground_probes();
+
   // Add the hero to the map.
-  const HeroPtr& shared_hero = std::static_pointer_cast<Hero>(shared_from_this());
+  HeroPtr shared_hero(this);
   map.get_entities().add_entity(shared_hero);
 
   last_solid_ground_coords = { -1, -1 };
@@ -670,9 +675,9 @@ void Hero::place_on_destination(Map& map, const Rectangle& previous_map_location
       last_solid_ground_layer = get_layer();
 
       // Remove boomerangs in case the map remains the same.
-      const std::set<std::shared_ptr<Boomerang>>& boomerangs =
+      const std::set<IntrusivePtr<Boomerang>>& boomerangs =
           map.get_entities().get_entities_by_type<Boomerang>();
-      for (const std::shared_ptr<Boomerang>& boomerang : boomerangs) {
+      for (const IntrusivePtr<Boomerang>& boomerang : boomerangs) {
         boomerang->remove_from_map();
       }
 
@@ -680,7 +685,7 @@ void Hero::place_on_destination(Map& map, const Rectangle& previous_map_location
         get_lua_context()->destination_on_activated(*destination);
       }
 
-      const std::shared_ptr<const Stairs> stairs = get_stairs_overlapping();
+      const IntrusivePtr<const Stairs> stairs = get_stairs_overlapping();
       if (stairs != nullptr) {
         // The hero arrived on the map by stairs.
         set_state(new StairsState(*this, stairs, Stairs::REVERSE_WAY));
@@ -694,6 +699,33 @@ void Hero::place_on_destination(Map& map, const Rectangle& previous_map_location
   }
 }
 
+/**
+ * \brief Places the hero at a known position of the current map.
+ *
+ * This is used to restore a game checkpoint.
+ * The hero is left in the free state.
+ *
+ * \param xy Coordinates of the hero's origin on the map.
+ * \param layer Layer of the hero. It is replaced by the closest valid layer
+ * if it does not exist on this map.
+ * \param direction4 Direction of the hero's sprites (0 to 3).
+ */
+void Hero::restore_position(const Point& xy, int layer, int direction4) {
+
+  Map& map = get_map();
+  layer = std::max(map.get_min_layer(), std::min(layer, map.get_max_layer()));
+
+  set_xy(xy);
+  map.get_entities().notify_entity_bounding_box_changed(*this);
+  map.get_entities().set_entity_layer(*this, layer);
+  set_animation_direction(direction4);
+  last_solid_ground_coords = xy;
+  last_solid_ground_layer = layer;
+
+  start_free();
+  check_position();
+}
+
 /**
  * \brief This function is called when the opening transition of the map is finished.
  *
@@ -846,11 +878,11 @@ bool Hero::is_on_raised_blocks() const {
  * \brief Returns the stairs the hero may be currently overlapping.
  * \return the stairs the hero is currently overlapping, or nullptr
  */
-std::shared_ptr<const Stairs> Hero::get_stairs_overlapping() const {
+IntrusivePtr<const Stairs> Hero::get_stairs_overlapping() const {
 
-  std::set<std::shared_ptr<const Stairs>> all_stairs =
+  std::set<IntrusivePtr<const Stairs>> all_stairs =
       get_entities().get_entities_by_type<Stairs>(get_layer());
-  for (const std::shared_ptr<const Stairs>& stairs: all_stairs) {
+  for (const IntrusivePtr<const Stairs>& stairs: all_stairs) {
 
     if (overlaps(*stairs)) {
       return stairs;
@@ -1002,7 +1034,7 @@ int Hero::get_real_movement_direction8() {
  */
 bool Hero::is_moving_towards(int direction4) const {
 
-  const std::shared_ptr<const Movement>& movement = get_movement();
+  const IntrusivePtr<const Movement>& movement = get_movement();
   if (movement == nullptr || movement->is_stopped()) {
     return false;
   }
@@ -1125,13 +1157,13 @@ void Hero::check_position() {
     int layer = get_layer();
 
     if (layer > get_map().get_min_layer()
-        && get_map().get_ground(layer, x, y, this) == Ground::EMPTY
-        && get_map().get_ground(layer, x + 15, y, this) == Ground::EMPTY
-        && get_map().get_ground(layer, x, y + 15, this) == Ground::EMPTY
-        && get_map().get_ground(layer, x + 15, y + 15, this) == Ground::EMPTY) {
+        && probe_ground(layer, Point(x, y)) == Ground::EMPTY
+        && probe_ground(layer, Point(x + 15, y)) == Ground::EMPTY
+        && probe_ground(layer, Point(x, y + 15)) == Ground::EMPTY
+        && probe_ground(layer, Point(x + 15, y + 15)) == Ground::EMPTY) {
 
       get_entities().set_entity_layer(*this, layer - 1);
-      Ground new_ground = get_map().get_ground(get_layer(), x, y, this);
+      Ground new_ground = probe_ground(get_layer(), Point(x, y));
       if (get_state().is_free() &&
           (new_ground == Ground::TRAVERSABLE
            || new_ground == Ground::GRASS
@@ -1142,6 +1174,46 @@ void Hero::check_position() {
   }
 }
 
+/**
+ * \brief Returns the ground of the map at a point, ignoring the hero.
+ *
+ * The hero asks the same questions many times per cycle and while
+ * standing still, so recent results are kept until the map tells that
+ * some ground may have changed.
+ *
+ * \param layer Layer of the point.
+ * \param xy Coordinates of the point.
+ * \return The ground at this place.
+ */
+Ground Hero::probe_ground(int layer, const Point& xy) {
+
+  const uint32_t ground_revision = get_map().get_ground_revision();
+  for (int i = 0; i < num_ground_probes; ++i) {
+    const GroundProbe& probe = ground_probes[i];
+    if (probe.ground_revision == ground_revision &&
+        probe.layer == layer &&
+        probe.xy == xy) {
+      return probe.ground;
+    }
+  }
+
+  const Ground ground = get_map().get_ground(layer, xy, this);
+
+  ground_probes[next_ground_probe] = { layer, xy, ground_revision, ground };
+  next_ground_probe = (next_ground_probe + 1) % static_cast<int>(ground_probes.size());
+  num_ground_probes = std::min(num_ground_probes + 1, static_cast<int>(ground_probes.size()));
+  return ground;
+}
+
+/**
+ * \brief Forgets the results of previous ground probes.
+ */
+void Hero::clear_ground_probes() {
+
+  num_ground_probes = 0;
+  next_ground_probe = 0;
+}
+
 /**
  * \brief This function is called when the layer of this entity has just changed.
  */
@@ -1555,7 +1627,7 @@ void Hero::notify_collision_with_enemy(Enemy& /* enemy */) {
 void Hero::notify_collision_with_enemy(
     Enemy& enemy, Sprite& enemy_sprite, Sprite& this_sprite) {
 
-  const std::string this_sprite_id = this_sprite.get_animation_set_id();
+  const Symbol& this_sprite_id = this_sprite.get_animation_set_id();
   if (this_sprite_id == get_hero_sprites().get_sword_sprite_id()) {
     // the hero's sword overlaps the enemy
     enemy.try_hurt(EnemyAttack::SWORD, *this, &enemy_sprite);
@@ -1593,9 +1665,7 @@ void Hero::notify_collision_with_teletransporter(
     bool on_hole = get_ground_below() == Ground::HOLE;
     if (on_hole || get_state().is_teletransporter_delayed()) {
        // Fall into the hole (or do something else) first, transport later
-      this->delayed_teletransporter = std::static_pointer_cast<Teletransporter>(
-            teletransporter.shared_from_this()
-      );
+      this->delayed_teletransporter = IntrusivePtr<Teletransporter>(&teletransporter);
     }
     else {
       teletransporter.transport_hero(*this); // usual case: transport right now
@@ -1609,7 +1679,7 @@ void Hero::notify_collision_with_teletransporter(
  * (e.g. falling into a hole or taking stairs).
  * \return The delayed teletransporter or nullptr.
  */
-std::shared_ptr<Teletransporter> Hero::get_delayed_teletransporter() {
+IntrusivePtr<Teletransporter> Hero::get_delayed_teletransporter() {
   return delayed_teletransporter;
 }
 
@@ -1740,8 +1810,7 @@ void Hero::notify_collision_with_stairs(
     // Check whether the hero is trying to move in the direction of the stairs.
     int correct_direction = stairs.get_movement_direction(stairs_way);
     if (is_moving_towards(correct_direction / 2)) {
-      std::shared_ptr<const Stairs> shared_stairs =
-          std::static_pointer_cast<const Stairs>(stairs.shared_from_this());
+      IntrusivePtr<const Stairs> shared_stairs(&stairs);
       set_state(new StairsState(*this, shared_stairs, stairs_way));
     }
   }
@@ -1794,7 +1863,7 @@ void Hero::notify_collision_with_switch(Switch& sw, CollisionMode /* collision_m
 void Hero::notify_collision_with_switch(Switch& sw, Sprite& sprite_overlapping) {
 
   // it's normally a solid switch
-  const std::string& sprite_id = sprite_overlapping.get_animation_set_id();
+  const Symbol& sprite_id = sprite_overlapping.get_animation_set_id();
   if (sprite_id == get_hero_sprites().get_sword_sprite_id() && // the hero's sword is overlapping the switch
       sw.is_solid() &&
       get_state().can_sword_hit_crystal()) {
@@ -1831,7 +1900,7 @@ void Hero::notify_collision_with_crystal(Crystal& /* crystal */, CollisionMode c
  */
 void Hero::notify_collision_with_crystal(Crystal& crystal, Sprite& sprite_overlapping) {
 
-  const std::string sprite_id = sprite_overlapping.get_animation_set_id();
+  const Symbol& sprite_id = sprite_overlapping.get_animation_set_id();
   if (sprite_id == get_hero_sprites().get_sword_sprite_id() && // the hero's sword is overlapping the crystal
       get_state().can_sword_hit_crystal()) {
 
@@ -1912,7 +1981,7 @@ void Hero::notify_collision_with_bomb(Bomb& bomb, CollisionMode collision_mode)
 void Hero::notify_collision_with_explosion(
     Explosion& explosion, Sprite& sprite_overlapping) {
 
-  const std::string& sprite_id = sprite_overlapping.get_animation_set_id();
+  const Symbol& sprite_id = sprite_overlapping.get_animation_set_id();
   if (!get_state().can_avoid_explosion() &&
       sprite_id == get_hero_sprites().get_tunic_sprite_id() &&
       can_be_hurt(&explosion)) {
@@ -2456,7 +2525,7 @@ void Hero::start_frozen() {
  * \brief Makes the hero lift a destructible item.
  * \param item_to_lift The item to lift.
  */
-void Hero::start_lifting(const std::shared_ptr<CarriedObject>& item_to_lift) {
+void Hero::start_lifting(const IntrusivePtr<CarriedObject>& item_to_lift) {
   set_state(new LiftingState(*this, item_to_lift));
 }
 
@@ -30,7 +30,6 @@
 #include "solarus/entities/Hero.h"
 #include "solarus/entities/Stairs.h"
 #include "solarus/Map.h"
-#include <memory>
 #include <string>
 
 namespace Solarus {
@@ -45,7 +44,7 @@ Hookshot::Hookshot(const Hero& hero):
     has_to_go_back(false),
     going_back(false),
     entity_reached(nullptr),
-    link_sprite(std::make_shared<Sprite>("entities/hookshot")) {
+    link_sprite(make_intrusive<Sprite>("entities/hookshot")) {
 
   // initialize the entity
   int direction = hero.get_animation_direction();
@@ -61,7 +60,7 @@ Hookshot::Hookshot(const Hero& hero):
 
   std::string path = " ";
   path[0] = '0' + (direction * 2);
-  set_movement(std::make_shared<PathMovement>(path, 192, true, false, false));
+  set_movement(make_intrusive<PathMovement>(path, 192, true, false, false));
 }
 
 /**
@@ -184,8 +183,8 @@ void Hookshot::update() {
 
       if (has_to_go_back) {
         going_back = true;
-        std::shared_ptr<Movement> movement = std::make_shared<TargetMovement>(
-            std::static_pointer_cast<Hero>(get_hero().shared_from_this()),
+        IntrusivePtr<Movement> movement = make_intrusive<TargetMovement>(
+            HeroPtr(&get_hero()),
             0,
             0,
             192,
@@ -290,7 +289,7 @@ void Hookshot::attach_to(Entity& entity_reached) {
   }
   std::string path = " ";
   path[0] = '0' + (direction * 2);
-  get_hero().set_movement(std::make_shared<PathMovement>(
+  get_hero().set_movement(make_intrusive<PathMovement>(
       path, 192, true, false, false
   ));
 }
@@ -20,6 +20,7 @@
 #include "solarus/lowlevel/Debug.h"
 #include "solarus/lowlevel/Surface.h"
 #include "solarus/Map.h"
+#include <algorithm>
 
 namespace Solarus {
 
@@ -112,6 +113,96 @@ void NonAnimatedRegions::build(std::vector<TileInfo>& rejected_tiles) {
   // No need to keep all tiles at this point.
   // Just keep the non-animated ones to draw them lazily.
   tiles.clear();
+
+  compute_opaque_squares();
+}
+
+/**
+ * \brief Determines the 8x8 squares of the map that are entirely covered by
+ * an opaque non-animated tile of this layer.
+ *
+ * Squares containing animated tiles are never considered opaque
+ * because they are cleared from the optimized surfaces.
+ */
+void NonAnimatedRegions::compute_opaque_squares() {
+
+  const int map_width8 = map.get_width8();
+  const int map_height8 = map.get_height8();
+
+  are_squares_opaque.assign(map_width8 * map_height8, false);
+
+  for (size_t cell_index = 0; cell_index < non_animated_tiles.get_num_cells(); ++cell_index) {
+    for (const TileInfo& tile: non_animated_tiles.get_elements(cell_index)) {
+
+      if (!tile.pattern->is_opaque()) {
+        continue;
+      }
+
+      // Only keep squares entirely inside the tile.
+      const int x8_1 = std::max(0, (tile.box.get_x() + 7) / 8);
+      const int y8_1 = std::max(0, (tile.box.get_y() + 7) / 8);
+      const int x8_2 = std::min(map_width8, (tile.box.get_x() + tile.box.get_width()) / 8);
+      const int y8_2 = std::min(map_height8, (tile.box.get_y() + tile.box.get_height()) / 8);
+
+      for (int y8 = y8_1; y8 < y8_2; ++y8) {
+        for (int x8 = x8_1; x8 < x8_2; ++x8) {
+          const int index = y8 * map_width8 + x8;
+          if (!are_squares_animated[index]) {
+            are_squares_opaque[index] = true;
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+ * \brief Returns whether an 8x8 square of the map is entirely covered by an
+ * opaque non-animated tile of this layer.
+ * \param square_index Index of the square in the map.
+ * \return \c true if this square is opaque.
+ */
+bool NonAnimatedRegions::is_square_opaque(int square_index) const {
+
+  if (are_squares_opaque.empty()) {
+    // Not built yet.
+    return false;
+  }
+  return are_squares_opaque[square_index];
+}
+
+/**
+ * \brief Determines the cells that are entirely hidden by opaque tiles of
+ * upper layers.
+ *
+ * Such cells are not drawn at all.
+ * This function should be called when the opaque squares of any layer
+ * have changed.
+ */
+void NonAnimatedRegions::update_hidden_cells() {
+
+  const Entities& entities = map.get_entities();
+  const int num_columns = non_animated_tiles.get_num_columns();
+  const Size& cell_size = non_animated_tiles.get_cell_size();
+  const Rectangle map_box(map.get_size());
+
+  are_cells_hidden.assign(non_animated_tiles.get_num_cells(), false);
+  for (size_t cell_index = 0; cell_index < are_cells_hidden.size(); ++cell_index) {
+
+    const int row = cell_index / num_columns;
+    const int column = cell_index % num_columns;
+    const Rectangle cell_box(
+        column * cell_size.width,
+        row * cell_size.height,
+        cell_size.width,
+        cell_size.height
+    );
+
+    // The last cells might exceed the map border.
+    are_cells_hidden[cell_index] = entities.is_hidden(
+        cell_box.get_intersection(map_box), layer
+    );
+  }
 }
 
 /**
@@ -123,6 +214,9 @@ void NonAnimatedRegions::notify_tileset_changed() {
     optimized_tiles_surfaces[i] = nullptr;
   }
   // Everything will be redrawn when necessary.
+
+  // Tile patterns may have a different opacity with the new images.
+  compute_opaque_squares();
 }
 
 /**
@@ -194,8 +288,13 @@ void NonAnimatedRegions::draw_on_map() {
         continue;
       }
 
-      // Make sure this cell is built.
       int cell_index = i * num_columns + j;
+      if (!are_cells_hidden.empty() && are_cells_hidden[cell_index]) {
+        // Entirely covered by opaque tiles of upper layers.
+        continue;
+      }
+
+      // Make sure this cell is built.
       if (optimized_tiles_surfaces[cell_index] == nullptr) {
         // Lazily build the cell.
         build_cell(cell_index);
@@ -245,7 +344,58 @@ void NonAnimatedRegions::build_cell(int cell_index) {
 
   const std::vector<TileInfo>& tiles_in_cell =
       non_animated_tiles.get_elements(cell_index);
-  for (const TileInfo& tile: tiles_in_cell) {
+
+  // Find the tiles that would be entirely hidden, either by opaque tiles of
+  // upper layers or by opaque tiles drawn after them in this cell.
+  const Entities& entities = map.get_entities();
+  const int cell_width8 = cell_size.width / 8;
+  const int cell_height8 = cell_size.height / 8;
+  std::vector<bool> are_squares_covered(cell_width8 * cell_height8);
+  for (int y8 = 0; y8 < cell_height8; ++y8) {
+    for (int x8 = 0; x8 < cell_width8; ++x8) {
+      const Rectangle square(cell_xy.x + x8 * 8, cell_xy.y + y8 * 8, 8, 8);
+      are_squares_covered[y8 * cell_width8 + x8] = entities.is_hidden(square, layer);
+    }
+  }
+
+  std::vector<bool> are_tiles_hidden(tiles_in_cell.size(), false);
+  for (int k = static_cast<int>(tiles_in_cell.size()) - 1; k >= 0; --k) {
+
+    const TileInfo& tile = tiles_in_cell[k];
+    const int tile_x = tile.box.get_x() - cell_xy.x;
+    const int tile_y = tile.box.get_y() - cell_xy.y;
+    const int tile_x2 = tile_x + tile.box.get_width();
+    const int tile_y2 = tile_y + tile.box.get_height();
+
+    // Squares of the cell overlapped by the tile.
+    bool hidden = true;
+    for (int y8 = std::max(0, tile_y / 8); hidden && y8 < std::min(cell_height8, (tile_y2 + 7) / 8); ++y8) {
+      for (int x8 = std::max(0, tile_x / 8); x8 < std::min(cell_width8, (tile_x2 + 7) / 8); ++x8) {
+        if (!are_squares_covered[y8 * cell_width8 + x8]) {
+          hidden = false;
+          break;
+        }
+      }
+    }
+    are_tiles_hidden[k] = hidden;
+
+    if (!hidden && tile.pattern->is_opaque()) {
+      // Squares of the cell entirely inside the tile.
+      for (int y8 = std::max(0, (tile_y + 7) / 8); y8 < std::min(cell_height8, tile_y2 / 8); ++y8) {
+        for (int x8 = std::max(0, (tile_x + 7) / 8); x8 < std::min(cell_width8, tile_x2 / 8); ++x8) {
+          are_squares_covered[y8 * cell_width8 + x8] = true;
+        }
+      }
+    }
+  }
+
+  for (size_t k = 0; k < tiles_in_cell.size(); ++k) {
+
+    if (are_tiles_hidden[k]) {
+      continue;
+    }
+
+    const TileInfo& tile = tiles_in_cell[k];
 
     Rectangle dst_position(
         tile.box.get_x() - cell_xy.x,
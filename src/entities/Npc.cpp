@@ -29,7 +29,6 @@
 #include "solarus/Map.h"
 #include "solarus/Sprite.h"
 #include <lua.hpp>
-#include <memory>
 
 namespace Solarus {
 
@@ -288,9 +287,9 @@ bool Npc::notify_action_command_pressed() {
 
         std::string animation_set_id = "stopped";
         if (sprite != nullptr) {
-          animation_set_id = sprite->get_animation_set_id();
+          animation_set_id = sprite->get_animation_set_id().str();
         }
-        hero.start_lifting(std::make_shared<CarriedObject>(
+        hero.start_lifting(make_intrusive<CarriedObject>(
             hero,
             *this,
             animation_set_id,
@@ -356,6 +355,8 @@ bool Npc::notify_interaction_with_item(EquipmentItem& item_used) {
  */
 void Npc::notify_position_changed() {
 
+  static const Symbol walking_animation = "walking";
+
   Entity::notify_position_changed();
 
   if (subtype == USUAL_NPC) {
@@ -364,8 +365,8 @@ void Npc::notify_position_changed() {
     if (get_movement() != nullptr) {
       // The NPC is moving.
       if (sprite != nullptr) {
-        if (sprite->get_current_animation() != "walking") {
-          sprite->set_current_animation("walking");
+        if (sprite->get_current_animation() != walking_animation) {
+          sprite->set_current_animation(walking_animation);
         }
         int direction4 = get_movement()->get_displayed_direction4();
         sprite->set_current_direction(direction4);
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/entities/ParallaxLayers.h"
+#include "solarus/entities/TilePattern.h"
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Surface.h"
+#include "solarus/Map.h"
+#include <algorithm>
+
+namespace Solarus {
+
+/**
+ * \brief Constructor.
+ * \param map The map.
+ * \param layer The layer to represent.
+ */
+ParallaxLayers::ParallaxLayers(Map& map, int layer):
+  map(map),
+  layer(layer),
+  parallax_layers() {
+
+}
+
+/**
+ * \brief Adds a parallax scrolling tile.
+ * \param tile The tile to add. Its pattern must have a parallax ratio.
+ */
+void ParallaxLayers::add_tile(const TileInfo& tile) {
+
+  Debug::check_assertion(tile.layer == layer, "Wrong layer for add tile");
+
+  const int ratio = tile.pattern->get_parallax_ratio();
+  Debug::check_assertion(ratio > 0, "This tile is not a parallax scrolling tile");
+
+  ParallaxLayer& parallax_layer = parallax_layers[ratio];
+  if (parallax_layer.tiles.empty()) {
+    parallax_layer.box = tile.box;
+  }
+  else {
+    parallax_layer.box |= tile.box;
+  }
+  parallax_layer.tiles.push_back(tile);
+  parallax_layer.cells = nullptr;
+  parallax_layer.cell_surfaces.clear();
+}
+
+/**
+ * \brief Clears previous drawings because the tileset has changed.
+ */
+void ParallaxLayers::notify_tileset_changed() {
+
+  for (auto& kvp : parallax_layers) {
+    for (SurfacePtr& cell_surface : kvp.second.cell_surfaces) {
+      cell_surface = nullptr;
+    }
+  }
+  // Everything will be redrawn when necessary.
+}
+
+/**
+ * \brief Draws the parallax scrolling tiles of this layer on the current map.
+ *
+ * Parallax layers that scroll slower are drawn first.
+ */
+void ParallaxLayers::draw_on_map() {
+
+  if (parallax_layers.empty()) {
+    return;
+  }
+
+  const CameraPtr& camera = map.get_camera();
+  if (camera == nullptr) {
+    return;
+  }
+
+  const Point& viewport = camera->get_top_left_xy();
+  const Size& camera_size = camera->get_size();
+  for (auto it = parallax_layers.rbegin(); it != parallax_layers.rend(); ++it) {
+
+    const int ratio = it->first;
+    ParallaxLayer& parallax_layer = it->second;
+    if (parallax_layer.cells == nullptr) {
+      // Lazily split the tiles into cells.
+      build_cells(parallax_layer);
+    }
+
+    // All tiles of the layer move the same way.
+    const Point origin = parallax_layer.box.get_xy() - viewport + viewport / ratio;
+
+    // Check all grid cells that overlap the camera.
+    const Rectangle visible_box(-origin, camera_size);
+    if (!visible_box.overlaps(Rectangle(Point(), parallax_layer.box.get_size()))) {
+      continue;
+    }
+    const Grid<TileInfo>& cells = *parallax_layer.cells;
+    const int num_rows = cells.get_num_rows();
+    const int num_columns = cells.get_num_columns();
+    const Size& cell_size = cells.get_cell_size();
+
+    const int row1 = -origin.y / cell_size.height;
+    const int row2 = (-origin.y + camera_size.height) / cell_size.height;
+    const int column1 = -origin.x / cell_size.width;
+    const int column2 = (-origin.x + camera_size.width) / cell_size.width;
+
+    for (int i = std::max(row1, 0); i <= std::min(row2, num_rows - 1); ++i) {
+      for (int j = std::max(column1, 0); j <= std::min(column2, num_columns - 1); ++j) {
+
+        const int cell_index = i * num_columns + j;
+        if (parallax_layer.cell_surfaces[cell_index] == nullptr) {
+          // Lazily build the cell.
+          build_cell(parallax_layer, cell_index);
+        }
+
+        const Point cell_xy = {
+            j * cell_size.width,
+            i * cell_size.height
+        };
+        parallax_layer.cell_surfaces[cell_index]->draw(
+            map.get_camera_surface(), origin + cell_xy
+        );
+      }
+    }
+  }
+}
+
+/**
+ * \brief Splits the tiles of a parallax layer into cells.
+ * \param parallax_layer The parallax layer to build.
+ */
+void ParallaxLayers::build_cells(ParallaxLayer& parallax_layer) {
+
+  const Point& origin = parallax_layer.box.get_xy();
+  parallax_layer.cells = std::unique_ptr<Grid<TileInfo>>(
+      new Grid<TileInfo>(parallax_layer.box.get_size(), Size(512, 256))
+  );
+  for (const TileInfo& tile : parallax_layer.tiles) {
+    parallax_layer.cells->add(tile, Rectangle(
+        tile.box.get_xy() - origin,
+        tile.box.get_size()
+    ));
+  }
+  parallax_layer.cell_surfaces.assign(parallax_layer.cells->get_num_cells(), nullptr);
+}
+
+/**
+ * \brief Draws all tiles of a cell of a parallax layer on its surface.
+ * \param parallax_layer The parallax layer.
+ * \param cell_index Index of the cell to draw.
+ */
+void ParallaxLayers::build_cell(ParallaxLayer& parallax_layer, int cell_index) {
+
+  const Grid<TileInfo>& cells = *parallax_layer.cells;
+  Debug::check_assertion(
+      cell_index >= 0 && (size_t) cell_index < cells.get_num_cells(),
+      "Wrong cell index"
+  );
+
+  const int row = cell_index / cells.get_num_columns();
+  const int column = cell_index % cells.get_num_columns();
+
+  // Position of this cell on the map, ignoring the scrolling offset
+  // that is applied when drawing.
+  const Size& cell_size = cells.get_cell_size();
+  const Point cell_xy = parallax_layer.box.get_xy() + Point(
+      column * cell_size.width,
+      row * cell_size.height
+  );
+
+  SurfacePtr cell_surface = Surface::create(cell_size);
+  parallax_layer.cell_surfaces[cell_index] = cell_surface;
+  // Let this surface as a software destination because it is built only
+  // once (here) and never changes later.
+
+  const Tileset& tileset = map.get_tileset();
+  for (const TileInfo& tile : cells.get_elements(cell_index)) {
+
+    const Rectangle dst_position(
+        tile.box.get_xy() - cell_xy,
+        tile.box.get_size()
+    );
+    tile.pattern->fill_surface(cell_surface, dst_position, tileset, Point());
+  }
+}
+
+}
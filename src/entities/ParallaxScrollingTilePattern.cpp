@@ -25,10 +25,13 @@ namespace Solarus {
  * \param ground Kind of ground of the tile pattern.
  * \param xy Coordinates of the tile pattern in the tileset.
  * \param size Size of the tile pattern in the tileset.
+ * \param ratio Distance made by the viewport to move the tile pattern
+ * of 1 pixel.
  */
 ParallaxScrollingTilePattern::ParallaxScrollingTilePattern(
-    Ground ground, const Point& xy, const Size& size):
-  SimpleTilePattern(ground, xy, size) {
+    Ground ground, const Point& xy, const Size& size, int ratio):
+  SimpleTilePattern(ground, xy, size),
+  ratio(ratio) {
 
 }
 
@@ -50,8 +53,6 @@ void ParallaxScrollingTilePattern::draw(
   Point dst = dst_position;
   dst += viewport / ratio;
   tileset_image->draw_region(position_in_tileset, dst_surface, dst);
-
-  // one day, we can implement several scrolling layers just by changing the ratio
 }
 
 /**
@@ -84,5 +85,17 @@ bool ParallaxScrollingTilePattern::is_drawn_at_its_position() const {
   return false;
 }
 
+/**
+ * \brief Returns the parallax ratio of this tile pattern.
+ *
+ * The image of this pattern never changes: tiles with the same ratio
+ * can be drawn together from a cached surface.
+ *
+ * \return The parallax ratio.
+ */
+int ParallaxScrollingTilePattern::get_parallax_ratio() const {
+  return ratio;
+}
+
 }
 
@@ -97,7 +97,7 @@ EntityType Pickable::get_type() const {
  * decide if it disappears after some time)
  * \return the pickable item created, or nullptr
  */
-std::shared_ptr<Pickable> Pickable::create(
+IntrusivePtr<Pickable> Pickable::create(
     Game& /* game */,
     const std::string& name,
     int layer,
@@ -113,7 +113,7 @@ std::shared_ptr<Pickable> Pickable::create(
     return nullptr;
   }
 
-  std::shared_ptr<Pickable> pickable = std::make_shared<Pickable>(
+  IntrusivePtr<Pickable> pickable = make_intrusive<Pickable>(
       name, layer, xy, treasure
   );
 
@@ -243,7 +243,7 @@ void Pickable::notify_created() {
 void Pickable::initialize_movement() {
 
   if (is_falling()) {
-    set_movement(std::make_shared<FallingOnFloorMovement>(falling_height));
+    set_movement(make_intrusive<FallingOnFloorMovement>(falling_height));
   }
 }
 
@@ -294,8 +294,7 @@ void Pickable::notify_collision(Entity& entity_overlapping, CollisionMode /* col
   }
   else if (entity_followed == nullptr) {
 
-    EntityPtr shared_entity_overlapping =
-        std::static_pointer_cast<Entity>(entity_overlapping.shared_from_this());
+    EntityPtr shared_entity_overlapping(&entity_overlapping);
     if (entity_overlapping.get_type() == EntityType::BOOMERANG) {
       Boomerang& boomerang = static_cast<Boomerang&>(entity_overlapping);
       if (!boomerang.is_going_back()) {
@@ -313,7 +312,7 @@ void Pickable::notify_collision(Entity& entity_overlapping, CollisionMode /* col
 
     if (entity_followed != nullptr) {
       clear_movement();
-      set_movement(std::make_shared<RelativeMovement>(
+      set_movement(make_intrusive<RelativeMovement>(
           entity_followed, 0, 0, true
       ));
       falling_height = FALLING_NONE;
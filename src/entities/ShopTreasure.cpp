@@ -58,7 +58,7 @@ ShopTreasure::ShopTreasure(
   price(price),
   dialog_id(dialog_id),
   treasure_sprite(treasure.create_sprite()),
-  rupee_icon_sprite(std::make_shared<Sprite>("entities/rupee_icon")),
+  rupee_icon_sprite(make_intrusive<Sprite>("entities/rupee_icon")),
   price_digits(0, 0, TextSurface::HorizontalAlignment::LEFT, TextSurface::VerticalAlignment::TOP) {
 
   set_collision_modes(CollisionMode::COLLISION_FACING);
@@ -84,7 +84,7 @@ ShopTreasure::ShopTreasure(
  * \return The shop treasure created, or nullptr if it is already bought or if it
  * is not obtainable.
  */
-std::shared_ptr<ShopTreasure> ShopTreasure::create(
+IntrusivePtr<ShopTreasure> ShopTreasure::create(
     Game& /* game */,
     const std::string& name,
     int layer,
@@ -99,7 +99,7 @@ std::shared_ptr<ShopTreasure> ShopTreasure::create(
     return nullptr;
   }
 
-  return std::make_shared<ShopTreasure>(
+  return make_intrusive<ShopTreasure>(
       name, layer, xy, treasure, price, font_id, dialog_id
   );
 }
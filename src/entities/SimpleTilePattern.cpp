@@ -64,5 +64,20 @@ bool SimpleTilePattern::is_animated() const {
   return false;
 }
 
+/**
+ * \brief Determines whether this tile pattern is fully opaque.
+ *
+ * The pattern is opaque if all pixels of its region in the tileset image
+ * are opaque and if it is drawn at its position.
+ *
+ * \param tileset The tileset of this pattern.
+ */
+void SimpleTilePattern::update_opacity(const Tileset& tileset) {
+
+  const SurfacePtr& tileset_image = tileset.get_tiles_image();
+  opaque = is_drawn_at_its_position() &&
+      tileset_image != nullptr &&
+      tileset_image->is_region_opaque(position_in_tileset);
 }
 
+}
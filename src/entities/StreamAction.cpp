@@ -29,8 +29,8 @@ namespace Solarus {
  * \param entity_moved Entity the stream is applied to.
  */
 StreamAction::StreamAction(Stream& stream, Entity& entity_moved):
-  stream(std::static_pointer_cast<Stream>(stream.shared_from_this())),
-  entity_moved(std::static_pointer_cast<Entity>(entity_moved.shared_from_this())),
+  stream(IntrusivePtr<Stream>(&stream)),
+  entity_moved(EntityPtr(&entity_moved)),
   active(true),
   suspended(false),
   when_suspended(0),
@@ -34,7 +34,8 @@ namespace Solarus {
  */
 TilePattern::TilePattern(Ground ground, const Size& size):
   ground(ground),
-  size(size) {
+  size(size),
+  opaque(false) {
 
   // Check the width and the height.
   if (size.width <= 0 || size.height <= 0
@@ -111,6 +112,32 @@ void TilePattern::update() {
   TimeScrollingTilePattern::update();
 }
 
+/**
+ * \brief Returns whether this tile pattern is known to be fully opaque.
+ *
+ * An opaque tile pattern completely hides what is drawn below it,
+ * which allows to skip drawing hidden tiles.
+ * This is determined by update_opacity() when the tileset images are loaded.
+ *
+ * \return \c true if this tile pattern is fully opaque.
+ */
+bool TilePattern::is_opaque() const {
+  return opaque;
+}
+
+/**
+ * \brief Determines whether this tile pattern is fully opaque.
+ *
+ * This function is called when the tileset images are loaded or changed.
+ * The default implementation considers the pattern as non-opaque.
+ * Subclasses can redefine it if they know how to check their images.
+ *
+ * \param tileset The tileset of this pattern.
+ */
+void TilePattern::update_opacity(const Tileset& /* tileset */) {
+  opaque = false;
+}
+
 /**
  * \brief Returns whether this tile pattern is animated, i.e. not always drawn
  * the same way.
@@ -143,6 +170,21 @@ bool TilePattern::is_drawn_at_its_position() const {
   return true;
 }
 
+/**
+ * \brief Returns the parallax ratio of tiles having this tile pattern
+ * if they can be drawn on a cached parallax layer.
+ *
+ * Only parallax scrolling tile patterns whose image never changes
+ * can be cached.
+ * Returns 0 by default.
+ *
+ * \return The parallax ratio, or 0 if tiles with this pattern
+ * cannot be cached on a parallax layer.
+ */
+int TilePattern::get_parallax_ratio() const {
+  return 0;
+}
+
 /**
  * \brief Fills a rectangle by repeating this tile pattern.
  * \param dst_surface The destination surface.
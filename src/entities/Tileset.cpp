@@ -91,7 +91,7 @@ void Tileset::add_tile_pattern(
 
     case TileScrolling::PARALLAX:
       tile_pattern = new ParallaxScrollingTilePattern(
-          ground, frame.get_xy(), size
+          ground, frame.get_xy(), size, pattern_data.get_parallax_ratio()
       );
       break;
 
@@ -109,7 +109,8 @@ void Tileset::add_tile_pattern(
       return;
     }
 
-    bool parallax = scrolling == TileScrolling::PARALLAX;
+    const int parallax_ratio = (scrolling == TileScrolling::PARALLAX) ?
+        pattern_data.get_parallax_ratio() : 0;
     AnimatedTilePattern::AnimationSequence sequence = (frames.size() == 3) ?
         AnimatedTilePattern::ANIMATION_SEQUENCE_012 : AnimatedTilePattern::ANIMATION_SEQUENCE_0121;
     tile_pattern = new AnimatedTilePattern(
@@ -122,7 +123,7 @@ void Tileset::add_tile_pattern(
         frames[1].get_y(),
         frames[2].get_x(),
         frames[2].get_y(),
-        parallax
+        parallax_ratio
     );
   }
 
@@ -160,6 +161,19 @@ void Tileset::load() {
     Debug::error(std::string("Missing entities image for tileset '") + id + "': " + file_name);
     entities_image = Surface::create(16, 16);
   }
+
+  update_patterns_opacity();
+}
+
+/**
+ * \brief Determines which tile patterns are fully opaque with the current
+ * tiles image.
+ */
+void Tileset::update_patterns_opacity() {
+
+  for (const auto& kvp : tile_patterns) {
+    kvp.second->update_opacity(*this);
+  }
 }
 
 /**
@@ -237,6 +251,8 @@ void Tileset::set_images(const std::string& other_id) {
   entities_image = tmp_tileset.get_entities_image();
 
   background_color = tmp_tileset.get_background_color();
+
+  update_patterns_opacity();
 }
 
 }
@@ -55,6 +55,7 @@ TilePatternData::TilePatternData(const Rectangle& frame) :
     ground(Ground::TRAVERSABLE),
     default_layer(0),
     scrolling(TileScrolling::NONE),
+    parallax_ratio(default_parallax_ratio),
     repeat_mode(TilePatternRepeatMode::ALL),
     frames() {
 
@@ -109,6 +110,26 @@ void TilePatternData::set_scrolling(TileScrolling scrolling) {
   this->scrolling = scrolling;
 }
 
+/**
+ * \brief Returns the parallax ratio of this pattern.
+ *
+ * Only used when the scrolling property is TileScrolling::PARALLAX.
+ *
+ * \return Distance made by the camera to move the pattern of 1 pixel.
+ */
+int TilePatternData::get_parallax_ratio() const {
+  return parallax_ratio;
+}
+
+/**
+ * \brief Sets the parallax ratio of this pattern.
+ * \param parallax_ratio Distance made by the camera to move the pattern
+ * of 1 pixel. Must be positive.
+ */
+void TilePatternData::set_parallax_ratio(int parallax_ratio) {
+  this->parallax_ratio = parallax_ratio;
+}
+
 /**
  * \brief Returns how this pattern is intended to be repeated.
  */
@@ -382,6 +403,14 @@ int l_tile_pattern(lua_State* l) {
     );
     pattern_data.set_scrolling(scrolling);
 
+    const int parallax_ratio = LuaTools::opt_int_field(
+        l, 1, "parallax_ratio", TilePatternData::default_parallax_ratio
+    );
+    if (parallax_ratio <= 0) {
+      LuaTools::arg_error(l, 1, "Invalid parallax_ratio: must be positive");
+    }
+    pattern_data.set_parallax_ratio(parallax_ratio);
+
     const TilePatternRepeatMode repeat_mode = LuaTools::opt_enum_field<TilePatternRepeatMode>(
         l, 1, "repeat_mode", TilePatternRepeatMode::ALL
     );
@@ -533,6 +562,10 @@ bool TilesetData::export_to_lua(std::ostream& out) const {
       const std::string& scolling_name = enum_to_name(pattern.get_scrolling());
       out << "  scrolling = \"" << scolling_name << "\",\n";
     }
+    if (pattern.get_scrolling() == TileScrolling::PARALLAX &&
+        pattern.get_parallax_ratio() != TilePatternData::default_parallax_ratio) {
+      out << "  parallax_ratio = " << pattern.get_parallax_ratio() << ",\n";
+    }
     if (pattern.get_repeat_mode() != TilePatternRepeatMode::ALL) {
       const std::string& repeat_mode_name = enum_to_name(pattern.get_repeat_mode());
       out << "  repeat_mode = \"" << repeat_mode_name << "\",\n";
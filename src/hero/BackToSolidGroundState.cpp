@@ -28,7 +28,6 @@
 #include "solarus/Game.h"
 #include "solarus/Map.h"
 #include <lua.hpp>
-#include <memory>
 
 namespace Solarus {
 
@@ -95,14 +94,14 @@ void Hero::BackToSolidGroundState::start(const State* previous_state) {
     lua_pop(l, 3);
   }
 
-  hero.set_movement(std::make_shared<TargetMovement>(
+  hero.set_movement(make_intrusive<TargetMovement>(
       nullptr, xy.x, xy.y, 144, true
   ));
   get_entities().set_entity_layer(hero, layer);
 
-  const std::set<std::shared_ptr<Boomerang>>& boomerangs =
+  const std::set<IntrusivePtr<Boomerang>>& boomerangs =
       get_entities().get_entities_by_type<Boomerang>();
-  for (const std::shared_ptr<Boomerang>& boomerang : boomerangs) {
+  for (const IntrusivePtr<Boomerang>& boomerang : boomerangs) {
     boomerang->remove_from_map();
   }
 }
@@ -23,7 +23,6 @@
 #include "solarus/Game.h"
 #include "solarus/GameCommands.h"
 #include "solarus/Map.h"
-#include <memory>
 
 namespace Solarus {
 
@@ -93,8 +92,8 @@ void Hero::BoomerangState::update() {
       boomerang_direction8 = direction_pressed8;
     }
     double angle = Geometry::degrees_to_radians(boomerang_direction8 * 45);
-    get_entities().add_entity(std::make_shared<Boomerang>(
-        std::static_pointer_cast<Hero>(get_entity().shared_from_this()),
+    get_entities().add_entity(make_intrusive<Boomerang>(
+        HeroPtr(&get_entity()),
         max_distance,
         speed,
         angle,
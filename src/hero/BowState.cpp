@@ -21,7 +21,6 @@
 #include "solarus/hero/FreeState.h"
 #include "solarus/hero/HeroSprites.h"
 #include "solarus/lowlevel/Sound.h"
-#include <memory>
 
 namespace Solarus {
 
@@ -53,7 +52,7 @@ void Hero::BowState::update() {
   Hero& hero = get_entity();
   if (get_sprites().is_animation_finished()) {
     Sound::play("bow");
-    get_entities().add_entity(std::make_shared<Arrow>(hero));
+    get_entities().add_entity(make_intrusive<Arrow>(hero));
     hero.set_state(new FreeState(hero));
   }
 }
@@ -32,7 +32,7 @@ namespace Solarus {
  * \param carried_object The item to carry.
  */
 Hero::CarryingState::CarryingState(
-    Hero& hero, const std::shared_ptr<CarriedObject>& carried_object
+    Hero& hero, const IntrusivePtr<CarriedObject>& carried_object
 ):
   PlayerMovementState(hero, "carrying"),
   carried_object(carried_object) {
@@ -227,7 +227,7 @@ void Hero::CarryingState::set_animation_walking() {
  * \brief Returns the item currently carried by the hero in this state, if any.
  * \return the item carried by the hero, or nullptr
  */
-std::shared_ptr<CarriedObject> Hero::CarryingState::get_carried_object() const {
+IntrusivePtr<CarriedObject> Hero::CarryingState::get_carried_object() const {
   return carried_object;
 }
 
@@ -70,7 +70,7 @@ void Hero::FallingState::update() {
   if (!is_suspended() && get_sprites().is_animation_finished()) {
 
     // the hero has just finished falling
-    std::shared_ptr<Teletransporter> teletransporter = hero.get_delayed_teletransporter();
+    IntrusivePtr<Teletransporter> teletransporter = hero.get_delayed_teletransporter();
     if (teletransporter != nullptr) {
       // special hole with a teletransporter
       teletransporter->transport_hero(hero);
@@ -37,7 +37,7 @@ Hero::ForcedWalkingState::ForcedWalkingState(
     bool ignore_obstacles):
 
   HeroState(hero, "forced walking"),
-  movement(std::make_shared<PathMovement>(
+  movement(make_intrusive<PathMovement>(
       path, hero.get_walking_speed(), loop, ignore_obstacles, false
   )) {
 
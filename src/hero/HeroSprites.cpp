@@ -163,7 +163,7 @@ void HeroSprites::rebuild_equipment() {
  * \brief Returns the animation set id used for the tunic sprite.
  * \return The tunic sprite animation set id.
  */
-const std::string& HeroSprites::get_tunic_sprite_id() const {
+const Symbol& HeroSprites::get_tunic_sprite_id() const {
 
   return tunic_sprite_id;
 }
@@ -172,7 +172,7 @@ const std::string& HeroSprites::get_tunic_sprite_id() const {
  * \brief Sets the animation set id to use for the tunic sprite.
  * \param sprite_id The tunic sprite animation set id.
  */
-void HeroSprites::set_tunic_sprite_id(const std::string& sprite_id) {
+void HeroSprites::set_tunic_sprite_id(const Symbol& sprite_id) {
 
   if (sprite_id == this->tunic_sprite_id) {
     return;
@@ -180,7 +180,7 @@ void HeroSprites::set_tunic_sprite_id(const std::string& sprite_id) {
 
   this->tunic_sprite_id = sprite_id;
 
-  std::string animation;
+  Symbol animation;
   int direction = -1;
   if (tunic_sprite != nullptr) {
     // Delete the previous sprite, but save its animation and direction.
@@ -230,7 +230,7 @@ std::string HeroSprites::get_default_tunic_sprite_id() const {
  * \brief Returns the animation set id used for the sword sprite.
  * \return The sword sprite animation set id.
  */
-const std::string& HeroSprites::get_sword_sprite_id() const {
+const Symbol& HeroSprites::get_sword_sprite_id() const {
 
   return sword_sprite_id;
 }
@@ -240,7 +240,7 @@ const std::string& HeroSprites::get_sword_sprite_id() const {
  * \param sprite_id The sword sprite animation set id.
  * An empty string means no sword sprite.
  */
-void HeroSprites::set_sword_sprite_id(const std::string& sprite_id) {
+void HeroSprites::set_sword_sprite_id(const Symbol& sprite_id) {
 
   if (sprite_id == this->sword_sprite_id) {
     return;
@@ -248,7 +248,7 @@ void HeroSprites::set_sword_sprite_id(const std::string& sprite_id) {
 
   this->sword_sprite_id = sprite_id;
 
-  std::string animation;
+  Symbol animation;
   int direction = -1;
   if (sword_sprite != nullptr) {
     // Delete the previous sprite, but save its animation and direction.
@@ -349,7 +349,7 @@ std::string HeroSprites::get_default_sword_sound_id() const {
  * \brief Returns the animation set id used for the shield sprite.
  * \return The shield sprite animation set id.
  */
-const std::string& HeroSprites::get_shield_sprite_id() const {
+const Symbol& HeroSprites::get_shield_sprite_id() const {
 
   return shield_sprite_id;
 }
@@ -359,7 +359,7 @@ const std::string& HeroSprites::get_shield_sprite_id() const {
  * \param sprite_id The shield sprite animation set id.
  * An empty string means no sword sprite.
  */
-void HeroSprites::set_shield_sprite_id(const std::string& sprite_id) {
+void HeroSprites::set_shield_sprite_id(const Symbol& sprite_id) {
 
   if (sprite_id == this->shield_sprite_id) {
     return;
@@ -367,7 +367,7 @@ void HeroSprites::set_shield_sprite_id(const std::string& sprite_id) {
 
   this->shield_sprite_id = sprite_id;
 
-  std::string animation;
+  Symbol animation;
   int direction = -1;
   if (shield_sprite != nullptr) {
     // Delete the previous sprite, but save its animation and direction.
@@ -1444,7 +1444,7 @@ void HeroSprites::set_animation_running() {
  * when preparing the boomerang.
  */
 void HeroSprites::set_animation_boomerang(
-    const std::string& tunic_preparing_animation) {
+    const Symbol& tunic_preparing_animation) {
 
   set_tunic_animation(tunic_preparing_animation);
 
@@ -1464,7 +1464,7 @@ void HeroSprites::set_animation_boomerang(
  * \param animation Name of the animation to check.
  * \return \c true if the tunic sprite has an animation with this name.
  */
-bool HeroSprites::has_tunic_animation(const std::string& animation) const {
+bool HeroSprites::has_tunic_animation(const Symbol& animation) const {
 
   return tunic_sprite->has_animation(animation);
 }
@@ -1473,7 +1473,7 @@ bool HeroSprites::has_tunic_animation(const std::string& animation) const {
  * \brief Returns the current animation of the tunic sprite.
  * \return The animation name of the tunic sprite.
  */
-const std::string& HeroSprites::get_tunic_animation() const {
+const Symbol& HeroSprites::get_tunic_animation() const {
 
   return tunic_sprite->get_current_animation();
 }
@@ -1485,7 +1485,7 @@ const std::string& HeroSprites::get_tunic_animation() const {
  *
  * \param animation The animation name of the tunic sprite.
  */
-void HeroSprites::set_tunic_animation(const std::string& animation) {
+void HeroSprites::set_tunic_animation(const Symbol& animation) {
 
   set_tunic_animation(animation, ScopedLuaRef());
 }
@@ -1501,7 +1501,7 @@ void HeroSprites::set_tunic_animation(const std::string& animation) {
  * or an empty ref.
  */
 void HeroSprites::set_tunic_animation(
-    const std::string& animation,
+    const Symbol& animation,
     const ScopedLuaRef& callback_ref
 ) {
 
@@ -1520,7 +1520,7 @@ void HeroSprites::set_tunic_animation(
  *
  * \param animation Name of the animation to give to the hero's sprites.
  */
-void HeroSprites::set_animation(const std::string& animation) {
+void HeroSprites::set_animation(const Symbol& animation) {
 
   set_animation(animation, ScopedLuaRef());
 }
@@ -1538,7 +1538,7 @@ void HeroSprites::set_animation(const std::string& animation) {
  * or an empty ref.
  */
 void HeroSprites::set_animation(
-    const std::string& animation,
+    const Symbol& animation,
     const ScopedLuaRef& callback_ref
 ) {
 
@@ -1639,7 +1639,7 @@ void HeroSprites::play_ground_sound() {
  * \param lifted_item the item to display, or nullptr to stop displaying a lifted item
  */
 void HeroSprites::set_lifted_item(
-    const std::shared_ptr<CarriedObject>& lifted_item
+    const IntrusivePtr<CarriedObject>& lifted_item
 ) {
   this->lifted_item = lifted_item;
 }
@@ -44,7 +44,7 @@ void Hero::HookshotState::start(const State* previous_state) {
   HeroState::start(previous_state);
 
   get_sprites().set_animation("hookshot");
-  hookshot = std::make_shared<Hookshot>(get_entity());
+  hookshot = make_intrusive<Hookshot>(get_entity());
   get_entities().add_entity(hookshot);
 }
 
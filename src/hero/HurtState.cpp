@@ -25,7 +25,6 @@
 #include "solarus/Game.h"
 #include "solarus/Equipment.h"
 #include <algorithm>
-#include <memory>
 
 namespace Solarus {
 
@@ -70,8 +69,8 @@ void Hero::HurtState::start(const State* previous_state) {
 
   if (has_source) {
     double angle = Geometry::get_angle(source_xy, hero.get_xy());
-    std::shared_ptr<StraightMovement> movement =
-        std::make_shared<StraightMovement>(false, true);
+    IntrusivePtr<StraightMovement> movement =
+        make_intrusive<StraightMovement>(false, true);
     movement->set_max_distance(24);
     movement->set_speed(120);
     movement->set_angle(angle);
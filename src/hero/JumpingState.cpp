@@ -50,7 +50,7 @@ Hero::JumpingState::JumpingState(
     carried_object = hero.get_carried_object();
   }
 
-  this->movement = std::make_shared<JumpMovement>(
+  this->movement = make_intrusive<JumpMovement>(
       direction8, distance, 0, ignore_obstacles
   );
   this->direction8 = direction8;
@@ -317,7 +317,7 @@ bool Hero::JumpingState::can_be_hurt(Entity* /* attacker */) const {
  * \brief Returns the item currently carried by the hero in this state, if any.
  * \return the item carried by the hero, or nullptr
  */
-std::shared_ptr<CarriedObject> Hero::JumpingState::get_carried_object() const {
+IntrusivePtr<CarriedObject> Hero::JumpingState::get_carried_object() const {
   return carried_object;
 }
 
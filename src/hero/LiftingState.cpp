@@ -34,7 +34,7 @@ namespace Solarus {
  */
 Hero::LiftingState::LiftingState(
     Hero& hero,
-    const std::shared_ptr<CarriedObject>& lifted_item
+    const IntrusivePtr<CarriedObject>& lifted_item
 ):
   HeroState(hero, "lifting"),
   lifted_item(lifted_item) {
@@ -103,7 +103,7 @@ void Hero::LiftingState::update() {
   const bool lift_finished = !lifted_item->is_being_lifted() || hero.is_animation_finished();
   if (!is_suspended() && lift_finished) {
 
-    std::shared_ptr<CarriedObject> carried_object = lifted_item;
+    IntrusivePtr<CarriedObject> carried_object = lifted_item;
     lifted_item = nullptr; // we do not take care of the carried object from this state anymore
     hero.set_state(new CarryingState(hero, carried_object));
   }
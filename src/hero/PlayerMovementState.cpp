@@ -53,7 +53,7 @@ Hero::PlayerMovementState::~PlayerMovementState() {
  *
  * \return The player movement.
  */
-const std::shared_ptr<PlayerMovement>& Hero::PlayerMovementState::get_player_movement() {
+const IntrusivePtr<PlayerMovement>& Hero::PlayerMovementState::get_player_movement() {
   return player_movement;
 }
 
@@ -65,7 +65,7 @@ const std::shared_ptr<PlayerMovement>& Hero::PlayerMovementState::get_player_mov
  *
  * \return The player movement.
  */
-std::shared_ptr<const PlayerMovement> Hero::PlayerMovementState::get_player_movement() const {
+IntrusivePtr<const PlayerMovement> Hero::PlayerMovementState::get_player_movement() const {
   return player_movement;
 }
 
@@ -82,7 +82,7 @@ void Hero::PlayerMovementState::start(const State* previous_state) {
 
   HeroState::start(previous_state);
 
-  player_movement = std::make_shared<PlayerMovement>(
+  player_movement = make_intrusive<PlayerMovement>(
       hero.get_walking_speed()
   );
   hero.set_movement(player_movement);
@@ -310,7 +310,7 @@ void Hero::PlayerMovementState::notify_jumper_activated(Jumper& jumper) {
   }
 
   // Add a small delay before jumping.
-  current_jumper = std::static_pointer_cast<Jumper>(jumper.shared_from_this());
+  current_jumper = IntrusivePtr<Jumper>(&jumper);
   jumper_start_date = System::now() + 200;
 }
 
@@ -101,7 +101,7 @@ void Hero::PullingState::update() {
           std::string path = "  ";
           path[0] = path[1] = '0' + opposite_direction8;
 
-          pulling_movement = std::make_shared<PathMovement>(
+          pulling_movement = make_intrusive<PathMovement>(
               path, 40, false, false, false
           );
           hero.set_movement(pulling_movement);
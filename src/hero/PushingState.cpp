@@ -104,7 +104,7 @@ void Hero::PushingState::update() {
           std::string path = "  ";
           path[0] = path[1] = '0' + pushing_direction4 * 2;
 
-          pushing_movement = std::make_shared<PathMovement>(
+          pushing_movement = make_intrusive<PathMovement>(
               path, 40, false, false, false
           );
           hero.set_movement(pushing_movement);
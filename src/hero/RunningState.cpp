@@ -29,7 +29,6 @@
 #include "solarus/GameCommands.h"
 #include "solarus/Map.h"
 #include "solarus/Equipment.h"
-#include <memory>
 
 namespace Solarus {
 
@@ -100,8 +99,8 @@ void Hero::RunningState::update() {
     if (now >= next_phase_date) {
 
       double angle = Geometry::degrees_to_radians(get_sprites().get_animation_direction() * 90);
-      std::shared_ptr<StraightMovement> movement =
-          std::make_shared<StraightMovement>(false, true);
+      IntrusivePtr<StraightMovement> movement =
+          make_intrusive<StraightMovement>(false, true);
       movement->set_max_distance(3000);
       movement->set_speed(300);
       movement->set_angle(angle);
@@ -176,7 +175,7 @@ void Hero::RunningState::notify_obstacle_reached() {
 
   if (phase == 1) {
     int opposite_direction = (get_sprites().get_animation_direction8() + 4) % 8;
-    get_entity().set_movement(std::make_shared<JumpMovement>(
+    get_entity().set_movement(make_intrusive<JumpMovement>(
         opposite_direction, 32, 64, false
     ));
     get_sprites().set_animation_hurt();
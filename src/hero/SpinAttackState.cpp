@@ -25,7 +25,6 @@
 #include "solarus/movements/StraightMovement.h"
 #include "solarus/Equipment.h"
 #include "solarus/Game.h"
-#include <memory>
 #include <sstream>
 #include <string>
 
@@ -56,8 +55,8 @@ void Hero::SpinAttackState::start(const State* previous_state) {
   Hero& hero = get_entity();
   if (get_equipment().has_ability(Ability::SWORD_KNOWLEDGE)) {
     get_sprites().set_animation_super_spin_attack();
-    std::shared_ptr<CircleMovement> movement =
-        std::make_shared<CircleMovement>(false);
+    IntrusivePtr<CircleMovement> movement =
+        make_intrusive<CircleMovement>(false);
     movement->set_center(hero.get_xy());
     movement->set_radius_speed(128);
     movement->set_radius(24);
@@ -262,8 +261,8 @@ void Hero::SpinAttackState::notify_attacked_enemy(
 
       being_pushed = true;
       double angle = victim.get_angle(hero, victim_sprite, nullptr);
-      std::shared_ptr<StraightMovement> movement =
-          std::make_shared<StraightMovement>(false, true);
+      IntrusivePtr<StraightMovement> movement =
+          make_intrusive<StraightMovement>(false, true);
       movement->set_max_distance(24);
       movement->set_speed(120);
       movement->set_angle(angle);
@@ -40,7 +40,7 @@ namespace Solarus {
  */
 Hero::StairsState::StairsState(
     Hero& hero,
-    const std::shared_ptr<const Stairs>& stairs,
+    const IntrusivePtr<const Stairs>& stairs,
     Stairs::Way way
 ):
   HeroState(hero, "stairs"),
@@ -81,7 +81,7 @@ void Hero::StairsState::start(const State* previous_state) {
   // movement
   int speed = stairs->is_inside_floor() ? 40 : 24;
   std::string path = stairs->get_path(way);
-  std::shared_ptr<PathMovement> movement = std::make_shared<PathMovement>(
+  IntrusivePtr<PathMovement> movement = make_intrusive<PathMovement>(
       path, speed, false, true, false
   );
 
@@ -212,7 +212,7 @@ void Hero::StairsState::update() {
         // we are on the old floor:
         // there must be a teletransporter associated with these stairs,
         // otherwise the hero would get stuck into the walls
-        std::shared_ptr<Teletransporter> teletransporter = hero.get_delayed_teletransporter();
+        IntrusivePtr<Teletransporter> teletransporter = hero.get_delayed_teletransporter();
         if (teletransporter == nullptr) {
           Logger::error("Teletransporter expected with the stairs");
         }
@@ -329,7 +329,7 @@ int Hero::StairsState::get_wanted_movement_direction8() const {
  * \brief Returns the item currently carried by the hero in this state, if any.
  * \return the item carried by the hero, or nullptr
  */
-std::shared_ptr<CarriedObject> Hero::StairsState::get_carried_object() const {
+IntrusivePtr<CarriedObject> Hero::StairsState::get_carried_object() const {
   return carried_object;
 }
 
@@ -23,7 +23,6 @@
 #include "solarus/Equipment.h"
 #include "solarus/Game.h"
 #include "solarus/GameCommands.h"
-#include <memory>
 
 namespace Solarus {
 
@@ -234,8 +233,8 @@ void Hero::SwordSwingingState::notify_attacked_enemy(
 
       Hero& hero = get_entity();
       double angle = victim.get_angle(hero, victim_sprite, nullptr);
-      std::shared_ptr<StraightMovement> movement =
-          std::make_shared<StraightMovement>(false, true);
+      IntrusivePtr<StraightMovement> movement =
+          make_intrusive<StraightMovement>(false, true);
       movement->set_max_distance(24);
       movement->set_speed(120);
       movement->set_angle(angle);
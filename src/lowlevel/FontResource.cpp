@@ -19,7 +19,9 @@
 #include "solarus/lowlevel/FontResource.h"
 #include "solarus/lowlevel/Surface.h"
 #include "solarus/CurrentQuest.h"
+#include <set>
 #include <utility>
+#include <vector>
 
 namespace Solarus {
 
@@ -45,72 +47,107 @@ void FontResource::quit() {
 }
 
 /**
- * \brief Loads the fonts declared in the quest resource list.
+ * \brief Finds the files of the fonts declared in the quest resource list.
+ *
+ * Font files are only read the first time each font is actually used.
  */
 void FontResource::load_fonts() {
 
+  // Supported extensions, by order of preference.
+  static const std::vector<std::pair<std::string, bool>> extensions = {
+      { ".png", true },
+      { ".PNG", true },
+      { ".ttf", false },
+      { ".TTF", false },
+      { ".ttc", false },
+      { ".TTC", false },
+      { ".fon", false },
+      { ".FON", false },
+  };
+
   // Get the list of available fonts.
   const std::map<std::string, std::string>& font_resource =
       CurrentQuest::get_resources(ResourceType::FONT);
 
+  // List each fonts directory only once rather than probing every extension.
+  std::map<std::string, std::set<std::string>> directories;
+
   for (const auto& kvp: font_resource) {
 
     const std::string& font_id = kvp.first;
-
-    FontFile font;
-
-    // Load the font.
-
-    bool bitmap_font = false;
     const std::string file_name_start = std::string("fonts/") + font_id;
-    if (QuestFiles::data_file_exists(file_name_start + ".png")) {
-      font.file_name = file_name_start + ".png";
-      bitmap_font = true;
+    const size_t slash_index = file_name_start.rfind('/');
+    const std::string& dir_name = file_name_start.substr(0, slash_index);
+    const std::string& base_name = file_name_start.substr(slash_index + 1);
+
+    auto it = directories.find(dir_name);
+    if (it == directories.end()) {
+      const std::vector<std::string>& files = QuestFiles::data_files_enumerate(dir_name);
+      it = directories.emplace(dir_name, std::set<std::string>(files.begin(), files.end())).first;
     }
-    else if (QuestFiles::data_file_exists(file_name_start + ".PNG")) {
-      font.file_name = file_name_start + ".PNG";
-      bitmap_font = true;
-    }
-    else if (QuestFiles::data_file_exists(file_name_start + ".ttf")) {
-      font.file_name = file_name_start + ".ttf";
-    }
-    else if (QuestFiles::data_file_exists(file_name_start + ".TTF")) {
-      font.file_name = file_name_start + ".TTF";
-    }
-    else if (QuestFiles::data_file_exists(file_name_start + ".ttc")) {
-      font.file_name = file_name_start + ".ttc";
-    }
-    else if (QuestFiles::data_file_exists(file_name_start + ".TTC")) {
-      font.file_name = file_name_start + ".TTC";
-    }
-    else if (QuestFiles::data_file_exists(file_name_start + ".fon")) {
-      font.file_name = file_name_start + ".fon";
+    const std::set<std::string>& files = it->second;
+
+    FontFile font;
+    font.is_bitmap = false;
+    font.loaded = false;
+    for (const auto& extension: extensions) {
+      if (files.find(base_name + extension.first) != files.end()) {
+        font.file_name = file_name_start + extension.first;
+        font.is_bitmap = extension.second;
+        break;
+      }
     }
-    else if (QuestFiles::data_file_exists(file_name_start + ".FON")) {
-      font.file_name = file_name_start + ".FON";
+
+    if (font.file_name.empty()) {
+      // Not listed (symbolic link?): probe each extension.
+      for (const auto& extension: extensions) {
+        if (QuestFiles::data_file_exists(file_name_start + extension.first)) {
+          font.file_name = file_name_start + extension.first;
+          font.is_bitmap = extension.second;
+          break;
+        }
+      }
     }
-    else {
+
+    if (font.file_name.empty()) {
       Debug::error(std::string("Cannot find font file 'fonts/")
           + font_id + "' (tried with extensions .png, .ttf, .ttc and .fon)"
       );
       continue;
     }
 
-    if (bitmap_font) {
-      // It's a bitmap font.
+    fonts.emplace(font_id, std::move(font));
+  }
+
+  fonts_loaded = true;
+}
+
+/**
+ * \brief Returns a font, loading the content of its file if necessary.
+ * \param font_id Id of the font to get. It must exist.
+ * \return The font.
+ */
+FontResource::FontFile& FontResource::get_font_file(const std::string& font_id) {
+
+  if (!fonts_loaded) {
+    load_fonts();
+  }
+
+  const auto& kvp = fonts.find(font_id);
+  Debug::check_assertion(kvp != fonts.end(), std::string("No such font: '") + font_id + "'");
+  FontFile& font = kvp->second;
+
+  if (!font.loaded) {
+    if (font.is_bitmap) {
       font.bitmap_font = Surface::create(font.file_name, Surface::DIR_DATA);
     }
-
     else {
-      // It's an outline font.
       font.buffer = QuestFiles::data_file_read(font.file_name);
       font.bitmap_font = nullptr;
     }
-
-    fonts.emplace(font_id, std::move(font));
+    font.loaded = true;
   }
-
-  fonts_loaded = true;
+  return font;
 }
 
 /**
@@ -159,7 +196,7 @@ bool FontResource::is_bitmap_font(const std::string& font_id) {
 
   const auto& kvp = fonts.find(font_id);
   Debug::check_assertion(kvp != fonts.end(), std::string("No such font: '") + font_id + "'");
-  return kvp->second.bitmap_font != nullptr;
+  return kvp->second.is_bitmap;
 }
 
 /**
@@ -169,14 +206,9 @@ bool FontResource::is_bitmap_font(const std::string& font_id) {
  */
 SurfacePtr FontResource::get_bitmap_font(const std::string& font_id) {
 
-  if (!fonts_loaded) {
-    load_fonts();
-  }
-
-  const auto& kvp = fonts.find(font_id);
-  Debug::check_assertion(kvp != fonts.end(), std::string("No such font: '") + font_id + "'");
-  Debug::check_assertion(kvp->second.bitmap_font != nullptr, std::string("This is not a bitmap font: '") + font_id + "'");
-  return kvp->second.bitmap_font;
+  FontFile& font = get_font_file(font_id);
+  Debug::check_assertion(font.is_bitmap, std::string("This is not a bitmap font: '") + font_id + "'");
+  return font.bitmap_font;
 }
 
 /**
@@ -187,16 +219,10 @@ SurfacePtr FontResource::get_bitmap_font(const std::string& font_id) {
  */
 TTF_Font& FontResource::get_outline_font(const std::string& font_id, int size) {
 
-  if (!fonts_loaded) {
-    load_fonts();
-  }
-
-  const auto& kvp = fonts.find(font_id);
-  Debug::check_assertion(kvp != fonts.end(), std::string("No such font: '") + font_id + "'");
-  FontFile& font = kvp->second;
-  Debug::check_assertion(font.bitmap_font == nullptr, std::string("This is not an outline font: '") + font_id + "'");
+  FontFile& font = get_font_file(font_id);
+  Debug::check_assertion(!font.is_bitmap, std::string("This is not an outline font: '") + font_id + "'");
 
-  std::map<int, OutlineFontReader>& outline_fonts = kvp->second.outline_fonts;
+  std::map<int, OutlineFontReader>& outline_fonts = font.outline_fonts;
 
   const auto& kvp2 = outline_fonts.find(size);
   if (kvp2 != outline_fonts.end()) {
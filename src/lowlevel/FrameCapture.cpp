@@ -0,0 +1,348 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/FrameCapture.h"
+#include "solarus/lowlevel/Logger.h"
+#include "solarus/lowlevel/Size.h"
+#include "solarus/lowlevel/String.h"
+#include "solarus/lowlevel/Surface.h"
+#include "solarus/lowlevel/Video.h"
+#include "solarus/Arguments.h"
+#include <SDL.h>
+#include <SDL_image.h>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Solarus {
+
+namespace {
+
+/**
+ * \brief Number of frames that can wait to be written at the same time.
+ */
+constexpr int num_buffers = 8;
+
+/**
+ * \brief A captured frame waiting to be written.
+ */
+struct Frame {
+  std::vector<uint32_t> pixels;           /**< Pixels in the video pixel format. */
+  int width = 0;                          /**< Width in pixels. */
+  int height = 0;                         /**< Height in pixels. */
+  int number = 0;                         /**< Index of the frame since the capture started. */
+};
+
+std::mutex mutex;                         /**< Protects the state below. */
+std::condition_variable frame_captured;   /**< Signals the writer that a frame is ready. */
+std::condition_variable frame_written;    /**< Signals that the writer finished a frame. */
+std::thread writer;                       /**< Thread that writes frames to disk. */
+bool stopping = false;                    /**< Whether the writer should exit. */
+
+bool capturing = false;                   /**< Whether frames are being captured. */
+std::string directory;                    /**< Where to write frames. */
+FrameCapture::Format format = FrameCapture::Format::PNG;  /**< File format of frames. */
+const SDL_PixelFormat* pixel_format = nullptr;  /**< Format of captured pixels. */
+int num_frames = 0;                       /**< Frames captured or dropped since the start. */
+int num_dropped = 0;                      /**< Frames dropped since the start. */
+bool write_error = false;                 /**< Whether writing a frame failed since the start. */
+
+Frame frames[num_buffers];                /**< Ring of frame buffers. */
+int first_pending = 0;                    /**< Index of the oldest frame not written yet. */
+int num_pending = 0;                      /**< Number of frames not written yet. */
+
+/**
+ * \brief Returns the file name of a frame.
+ * \param directory Directory of the capture.
+ * \param number Index of the frame.
+ * \param format File format.
+ * \return The file name.
+ */
+std::string get_frame_file_name(
+    const std::string& directory,
+    int number,
+    FrameCapture::Format format
+) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%06d.%s", number,
+      format == FrameCapture::Format::PNG ? "png" : "rgba");
+  return directory + "/" + name;
+}
+
+/**
+ * \brief Writes a frame to a PNG file.
+ * \param frame The frame to write.
+ * \param file_name Name of the file to create.
+ * \return \c true in case of success.
+ */
+bool write_png(Frame& frame, const std::string& file_name) {
+
+  SDL_Surface* surface = SDL_CreateRGBSurfaceFrom(
+      frame.pixels.data(),
+      frame.width,
+      frame.height,
+      32,
+      frame.width * 4,
+      pixel_format->Rmask,
+      pixel_format->Gmask,
+      pixel_format->Bmask,
+      pixel_format->Amask
+  );
+  if (surface == nullptr) {
+    return false;
+  }
+  const bool success = IMG_SavePNG(surface, file_name.c_str()) == 0;
+  SDL_FreeSurface(surface);
+  return success;
+}
+
+/**
+ * \brief Writes a frame to a raw file of RGBA bytes.
+ * \param frame The frame to write.
+ * \param file_name Name of the file to create.
+ * \return \c true in case of success.
+ */
+bool write_raw(const Frame& frame, const std::string& file_name) {
+
+  const int num_pixels = frame.width * frame.height;
+  std::vector<uint8_t> bytes(num_pixels * 4);
+  for (int i = 0; i < num_pixels; ++i) {
+    SDL_GetRGBA(frame.pixels[i], pixel_format,
+        &bytes[i * 4], &bytes[i * 4 + 1], &bytes[i * 4 + 2], &bytes[i * 4 + 3]);
+  }
+
+  std::ofstream out(file_name, std::ios::binary);
+  out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  return static_cast<bool>(out);
+}
+
+/**
+ * \brief Main function of the writer thread.
+ *
+ * Writes pending frames in order until quit() is called.
+ */
+void writer_main() {
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    frame_captured.wait(lock, []() {
+      return stopping || num_pending > 0;
+    });
+    if (num_pending == 0) {
+      // Stopping and nothing left to write.
+      return;
+    }
+
+    Frame& frame = frames[first_pending];
+    const std::string& file_name = get_frame_file_name(directory, frame.number, format);
+    const FrameCapture::Format frame_format = format;
+
+    // The main thread does not touch pending frames.
+    lock.unlock();
+    const bool success = frame_format == FrameCapture::Format::PNG ?
+        write_png(frame, file_name) :
+        write_raw(frame, file_name);
+    lock.lock();
+
+    if (!success && !write_error) {
+      // Only report the first failure of a capture.
+      write_error = true;
+      Logger::error("Failed to write captured frame '" + file_name + "'");
+    }
+    first_pending = (first_pending + 1) % num_buffers;
+    --num_pending;
+    frame_written.notify_all();
+  }
+}
+
+}
+
+/**
+ * \brief Starts capturing frames if the -capture option is set.
+ *
+ * Supported options:
+ *   -capture=DIRECTORY
+ *   -capture-format=png|raw
+ *
+ * \param args Command-line arguments.
+ */
+void FrameCapture::initialize(const Arguments& args) {
+
+  const std::string& capture_directory = args.get_argument_value("-capture");
+  if (capture_directory.empty()) {
+    return;
+  }
+
+  const std::string& format_name = args.get_argument_value("-capture-format");
+  Format capture_format = Format::PNG;
+  if (format_name == "raw") {
+    capture_format = Format::RAW;
+  }
+  else if (!format_name.empty() && format_name != "png") {
+    Debug::error("Invalid capture format: '" + format_name + "'");
+  }
+
+  start(capture_directory, capture_format);
+}
+
+/**
+ * \brief Stops capturing and waits for pending frames to be written.
+ */
+void FrameCapture::quit() {
+
+  stop();
+
+  if (writer.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    frame_captured.notify_one();
+    writer.join();
+    stopping = false;
+  }
+}
+
+/**
+ * \brief Returns whether frames are being captured.
+ * \return \c true if capture() records frames.
+ */
+bool FrameCapture::is_capturing() {
+  return capturing;
+}
+
+/**
+ * \brief Starts capturing frames.
+ *
+ * If a capture was already running, it is stopped first.
+ * Frames are named after their index since the start, so dropped frames
+ * leave gaps in the numbering.
+ *
+ * \param capture_directory Existing directory where to write frames.
+ * \param capture_format File format of frames.
+ * \return \c true in case of success.
+ */
+bool FrameCapture::start(const std::string& capture_directory, Format capture_format) {
+
+  stop();
+
+  if (capture_directory.empty()) {
+    Debug::error("Missing capture directory");
+    return false;
+  }
+
+  // Preallocate buffers for the quest size.
+  const Size& quest_size = Video::get_quest_size();
+  for (Frame& frame : frames) {
+    frame.pixels.resize(quest_size.width * quest_size.height);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    directory = capture_directory;
+    format = capture_format;
+    pixel_format = Video::get_pixel_format();
+    num_frames = 0;
+    num_dropped = 0;
+    write_error = false;
+  }
+
+  if (!writer.joinable()) {
+    writer = std::thread(writer_main);
+  }
+
+  capturing = true;
+  Logger::info("Capturing frames to '" + capture_directory + "'");
+  return true;
+}
+
+/**
+ * \brief Stops capturing frames.
+ *
+ * Waits until frames already captured are written.
+ * Does nothing if no capture is running.
+ */
+void FrameCapture::stop() {
+
+  if (!capturing) {
+    return;
+  }
+  capturing = false;
+
+  std::unique_lock<std::mutex> lock(mutex);
+  frame_written.wait(lock, []() {
+    return num_pending == 0;
+  });
+
+  std::string message = "Captured " + String::to_string(num_frames - num_dropped) +
+      " frames to '" + directory + "'";
+  if (num_dropped > 0) {
+    message += " (" + String::to_string(num_dropped) + " dropped)";
+  }
+  Logger::info(message);
+}
+
+/**
+ * \brief Captures a frame if a capture is running.
+ *
+ * The pixels are copied and written later by another thread.
+ * Call this function each time the quest surface is drawn.
+ *
+ * \param surface The surface to capture. Its pixels must be in RAM.
+ */
+void FrameCapture::capture(const Surface& surface) {
+
+  if (!capturing) {
+    return;
+  }
+
+  int slot = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++num_frames;
+    if (num_pending == num_buffers) {
+      // The writer is late: don't wait for it.
+      ++num_dropped;
+      return;
+    }
+    slot = (first_pending + num_pending) % num_buffers;
+  }
+
+  // This frame is not pending yet: the writer does not access it.
+  Frame& frame = frames[slot];
+  frame.width = surface.get_width();
+  frame.height = surface.get_height();
+  frame.number = num_frames - 1;
+  frame.pixels.resize(frame.width * frame.height);
+  if (!surface.read_pixels(frame.pixels.data())) {
+    Debug::error("Cannot capture a surface that is only in GPU memory");
+    stop();
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++num_pending;
+  }
+  frame_captured.notify_one();
+}
+
+}
@@ -22,10 +22,12 @@
 namespace Solarus {
 
 /**
- * \brief Creates an Impulse Tracker decoder.
+ * \brief Sets the global settings of the Impulse Tracker library.
+ *
+ * These settings are shared by all decoders, so they are set once
+ * when the music system starts rather than by each decoder.
  */
-ItDecoder::ItDecoder():
-  modplug_file(nullptr) {
+void ItDecoder::initialize() {
 
   ModPlug_Settings settings;
   ModPlug_GetSettings(&settings);
@@ -35,6 +37,16 @@ ItDecoder::ItDecoder():
   ModPlug_SetSettings(&settings);
 }
 
+/**
+ * \brief Creates an Impulse Tracker decoder.
+ *
+ * initialize() must have been called before.
+ */
+ItDecoder::ItDecoder():
+  modplug_file(nullptr) {
+
+}
+
 /**
  * \brief Loads an IT file from memory.
  * \param sound_buffer The memory area to read
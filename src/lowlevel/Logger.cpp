@@ -18,6 +18,7 @@
 #include "solarus/lowlevel/System.h"
 #include <fstream>
 #include <iostream>
+#include <mutex>
 
 namespace Solarus {
 
@@ -27,6 +28,7 @@ namespace {
 
   const std::string error_log_file_name = "error.txt";
   std::ofstream error_log_file;
+  std::mutex mutex;  // Messages may come from initialization threads.
 
   /**
    * \brief Returns the error log file.
@@ -35,6 +37,7 @@ namespace {
    */
   std::ofstream& get_error_log_file() {
 
+    std::lock_guard<std::mutex> lock(mutex);
     if (!error_log_file.is_open()) {
       error_log_file.open(error_log_file_name.c_str());
     }
@@ -54,6 +57,7 @@ namespace {
 SOLARUS_API void print(const std::string& message, std::ostream& out) {
 
   uint32_t simulated_time = System::now();
+  std::lock_guard<std::mutex> lock(mutex);
   out << "[Solarus] [" << simulated_time << "] " << message << std::endl;
 }
 
@@ -22,6 +22,7 @@
 #include "solarus/lowlevel/Music.h"
 #include "solarus/lowlevel/SpcDecoder.h"
 #include "solarus/lowlevel/String.h"
+#include "solarus/lowlevel/System.h"
 #include "solarus/lua/LuaContext.h"
 #include <lua.hpp>
 #include <algorithm>
@@ -30,11 +31,22 @@
 namespace Solarus {
 
 constexpr int Music::nb_buffers;
-std::unique_ptr<SpcDecoder> Music::spc_decoder = nullptr;
-std::unique_ptr<ItDecoder> Music::it_decoder = nullptr;
-std::unique_ptr<OggDecoder> Music::ogg_decoder = nullptr;
+bool Music::initialized = false;
 float Music::volume = 1.0;
+uint32_t Music::crossfade_duration = 0;
 std::unique_ptr<Music> Music::current_music = nullptr;
+std::unique_ptr<Music> Music::fading_out_music = nullptr;
+std::unique_ptr<Music> Music::preloaded_music = nullptr;
+std::future<bool> Music::preloaded_music_ready;
+
+namespace {
+
+/**
+ * \brief Number of samples decoded in each streaming buffer.
+ */
+constexpr ALsizei buffer_nb_samples = 16384;
+
+}
 
 const std::string Music::none = "none";
 const std::string Music::unchanged = "same";
@@ -57,7 +69,10 @@ Music::Music():
   format(NO_FORMAT),
   loop(false),
   callback_ref(),
-  source(AL_NONE) {
+  source(AL_NONE),
+  fade_start_date(0),
+  fade_duration(0),
+  fading_in(false) {
 
   for (int i = 0; i < nb_buffers; i++) {
     buffers[i] = AL_NONE;
@@ -80,7 +95,10 @@ Music::Music(
   format(OGG),
   loop(loop),
   callback_ref(callback_ref),
-  source(AL_NONE) {
+  source(AL_NONE),
+  fade_start_date(0),
+  fade_duration(0),
+  fading_in(false) {
 
   Debug::check_assertion(!loop || callback_ref.is_empty(),
       "Attempt to set both a loop and a callback to music"
@@ -96,11 +114,8 @@ Music::Music(
  */
 void Music::initialize() {
 
-  // initialize the decoding features
-  spc_decoder = std::unique_ptr<SpcDecoder>(new SpcDecoder());
-  it_decoder = std::unique_ptr<ItDecoder>(new ItDecoder());
-  ogg_decoder = std::unique_ptr<OggDecoder>(new OggDecoder());
-
+  ItDecoder::initialize();
+  initialized = true;
   set_volume(100);
 }
 
@@ -110,10 +125,18 @@ void Music::initialize() {
 void Music::quit() {
 
   if (is_initialized()) {
-    current_music = nullptr;
-    spc_decoder = nullptr;
-    it_decoder = nullptr;
+    cancel_preload();
+    if (fading_out_music != nullptr) {
+      fading_out_music->stop();
+      fading_out_music = nullptr;
+    }
+    if (current_music != nullptr) {
+      current_music->stop();
+      current_music = nullptr;
+    }
     volume = 1.0;
+    crossfade_duration = 0;
+    initialized = false;
   }
 }
 
@@ -122,7 +145,7 @@ void Music::quit() {
  * \return \c true if the music system is initialized.
  */
 bool Music::is_initialized() {
-  return spc_decoder != nullptr;
+  return initialized;
 }
 
 /**
@@ -157,7 +180,10 @@ void Music::set_volume(int volume) {
   Music::volume = volume / 100.0;
 
   if (current_music != nullptr) {
-    alSourcef(current_music->source, AL_GAIN, Music::volume);
+    current_music->update_gain();
+  }
+  if (fading_out_music != nullptr) {
+    fading_out_music->update_gain();
   }
 
   Logger::info(std::string("Music volume: ") + String::to_string(get_volume()));
@@ -175,7 +201,7 @@ int Music::get_num_channels() {
   Debug::check_assertion(get_format() == IT,
       "This function is only supported for .it musics");
 
-  return it_decoder->get_num_channels();
+  return current_music->it_decoder->get_num_channels();
 }
 
 /**
@@ -191,7 +217,7 @@ int Music::get_channel_volume(int channel) {
   Debug::check_assertion(get_format() == IT,
       "This function is only supported for .it musics");
 
-  return it_decoder->get_channel_volume(channel);
+  return current_music->it_decoder->get_channel_volume(channel);
 }
 
 /**
@@ -207,7 +233,7 @@ void Music::set_channel_volume(int channel, int volume) {
   Debug::check_assertion(get_format() == IT,
       "This function is only supported for .it musics");
 
-  it_decoder->set_channel_volume(channel, volume);
+  current_music->it_decoder->set_channel_volume(channel, volume);
 }
 
 /**
@@ -222,7 +248,7 @@ int Music::get_tempo() {
   Debug::check_assertion(get_format() == IT,
       "This function is only supported for .it musics");
 
-  return it_decoder->get_tempo();
+  return current_music->it_decoder->get_tempo();
 }
 
 /**
@@ -237,7 +263,7 @@ void Music::set_tempo(int tempo) {
   Debug::check_assertion(get_format() == IT,
       "This function is only supported for .it musics");
 
-  it_decoder->set_tempo(tempo);
+  current_music->it_decoder->set_tempo(tempo);
 }
 
 /**
@@ -329,17 +355,58 @@ void Music::play(
   if (music_id != unchanged && music_id != get_current_music_id()) {
     // The music is changed.
 
+    std::unique_ptr<Music> music;
+    bool prepared = false;
+    if (music_id != none && is_initialized()) {
+      if (preloaded_music != nullptr &&
+          preloaded_music->id == music_id &&
+          preloaded_music->loop == loop) {
+        // The music was prepared in advance: it is usually ready already.
+        prepared = preloaded_music_ready.get();
+        music = std::move(preloaded_music);
+        music->set_callback(callback_ref);
+      }
+      else {
+        music = std::unique_ptr<Music>(
+            new Music(music_id, loop, callback_ref)
+        );
+        prepared = music->prepare();
+      }
+
+      if (!music->error_message.empty()) {
+        Debug::error(music->error_message);
+      }
+      if (!prepared) {
+        // Could not load the music.
+        music = nullptr;
+      }
+    }
+
+    if (fading_out_music != nullptr) {
+      // A previous crossfade is not finished: interrupt it.
+      fading_out_music->stop();
+      fading_out_music = nullptr;
+    }
+
     if (current_music != nullptr) {
-      // Stop the music that was played.
-      current_music->stop();
+      if (crossfade_duration > 0 && music != nullptr) {
+        // Let the music that was played fade out while the new one starts.
+        current_music->start_fade(false);
+        fading_out_music = std::move(current_music);
+      }
+      else {
+        // Stop the music that was played.
+        current_music->stop();
+      }
       current_music = nullptr;
     }
 
-    if (music_id != none) {
+    if (music != nullptr) {
       // Play another music.
-      current_music = std::unique_ptr<Music>(
-          new Music(music_id, loop, callback_ref)
-      );
+      if (fading_out_music != nullptr) {
+        music->start_fade(true);
+      }
+      current_music = std::move(music);
       if (!current_music->start()) {
         // Could not play the music.
         current_music = nullptr;
@@ -348,6 +415,100 @@ void Music::play(
   }
 }
 
+/**
+ * \brief Starts preparing a music in the background.
+ *
+ * The music file is found, read and its first buffers are decoded on
+ * another thread, so that a later call to play() with the same music
+ * can start it immediately.
+ * Impulse Tracker musics are prepared right now on the calling thread
+ * because their decoder is not thread-safe.
+ * A music that was previously being preloaded and not played yet
+ * is discarded.
+ *
+ * \param music_id Id of the music to prepare (file name without extension).
+ * Music::none, Music::unchanged and the current music are ignored.
+ */
+void Music::preload(const std::string& music_id) {
+
+  if (!is_initialized() ||
+      music_id == none ||
+      music_id == unchanged ||
+      music_id == get_current_music_id()) {
+    return;
+  }
+
+  if (preloaded_music != nullptr && preloaded_music->id == music_id) {
+    // Already preloaded.
+    return;
+  }
+
+  cancel_preload();
+
+  // Musics started by the engine loop, so prepare the loop version.
+  preloaded_music = std::unique_ptr<Music>(
+      new Music(music_id, true, ScopedLuaRef())
+  );
+  Music* music = preloaded_music.get();
+
+  find_music_file(music_id, music->file_name, music->format);
+  if (music->format == IT) {
+    // The IT library mixes with global state shared by all modules,
+    // including the one currently playing: prepare it on this thread.
+    std::promise<bool> result;
+    result.set_value(music->prepare());
+    preloaded_music_ready = result.get_future();
+    return;
+  }
+
+  preloaded_music_ready = std::async(std::launch::async, [music]() {
+    return music->prepare();
+  });
+}
+
+/**
+ * \brief Returns the id of the music preloaded and not played yet.
+ * \return The id of the preloaded music, or Music::none.
+ */
+const std::string& Music::get_preloaded_music_id() {
+  return preloaded_music != nullptr ? preloaded_music->id : none;
+}
+
+/**
+ * \brief Discards the music being preloaded if any.
+ *
+ * Waits for the background preparation to finish first.
+ */
+void Music::cancel_preload() {
+
+  if (preloaded_music_ready.valid()) {
+    preloaded_music_ready.wait();
+    preloaded_music_ready = std::future<bool>();
+  }
+  preloaded_music = nullptr;
+}
+
+/**
+ * \brief Returns the duration of crossfades between musics.
+ * \return The crossfade duration in milliseconds. 0 means no crossfade.
+ */
+uint32_t Music::get_crossfade_duration() {
+  return crossfade_duration;
+}
+
+/**
+ * \brief Sets the duration of crossfades between musics.
+ *
+ * When a music is started while another one is playing, the previous one
+ * fades out during this delay while the new one fades in.
+ *
+ * \param crossfade_duration The crossfade duration in milliseconds.
+ * 0 means no crossfade.
+ */
+void Music::set_crossfade_duration(uint32_t crossfade_duration) {
+  Music::crossfade_duration = crossfade_duration;
+}
+
 /**
  * \brief Stops playing any music.
  *
@@ -369,7 +530,17 @@ void Music::update() {
     return;
   }
 
+  if (fading_out_music != nullptr) {
+    if (!fading_out_music->update_fade() ||
+        !fading_out_music->update_playing()) {
+      // The previous music is now silent.
+      fading_out_music->stop();
+      fading_out_music = nullptr;
+    }
+  }
+
   if (current_music != nullptr) {
+    current_music->update_fade();
     bool playing = current_music->update_playing();
     if (!playing) {
       // Music is finished.
@@ -400,24 +571,10 @@ bool Music::update_playing() {
     alSourceUnqueueBuffers(source, 1, &buffer);  // Unqueue the buffer.
 
     // Fill it by decoding more data.
-    switch (format) {
-
-      case SPC:
-        decode_spc(buffer, 16384);
-        break;
-
-      case IT:
-        decode_it(buffer, 16384);
-        break;
-
-      case OGG:
-        decode_ogg(buffer, 16384);
-        break;
-
-      case NO_FORMAT:
-        Debug::die("Invalid music format");
-        break;
+    if (!decode(streaming_chunk, buffer_nb_samples)) {
+      Debug::error(error_message);
     }
+    fill_buffer(buffer, streaming_chunk);
 
     alSourceQueueBuffers(source, 1, &buffer);  // Queue it again.
   }
@@ -435,147 +592,199 @@ bool Music::update_playing() {
 }
 
 /**
- * \brief Decodes a chunk of SPC data into PCM data for the current music.
- * \param destination_buffer the destination buffer to write
- * \param nb_samples number of samples to write
+ * \brief Decodes a chunk of this music into PCM data.
+ *
+ * This function does not call OpenAL and does not log anything,
+ * so it can be called from a worker thread.
+ *
+ * \param[out] chunk The chunk to write.
+ * \param nb_samples Number of samples to decode.
+ * \return \c false in case of error. The error is stored in error_message.
  */
-void Music::decode_spc(ALuint destination_buffer, ALsizei nb_samples) {
+bool Music::decode(DecodedChunk& chunk, ALsizei nb_samples) {
 
-  // decode the SPC data
-  std::vector<ALushort> raw_data(nb_samples);
-  spc_decoder->decode((int16_t*) raw_data.data(), nb_samples);
+  switch (format) {
 
-  // put this decoded data into the buffer
-  alBufferData(destination_buffer, AL_FORMAT_STEREO16, raw_data.data(), nb_samples * 2, 32000);
+    case SPC:
+      decode_spc(chunk, nb_samples);
+      return true;
 
-  int error = alGetError();
-  if (error != AL_NO_ERROR) {
-    std::ostringstream oss;
-    oss << "Failed to fill the audio buffer with decoded SPC data for music file '"
-      << file_name << ": error " << error;
-    Debug::error(oss.str());
+    case IT:
+      decode_it(chunk, nb_samples);
+      return true;
+
+    case OGG:
+      return decode_ogg(chunk, nb_samples);
+
+    case NO_FORMAT:
+      break;
   }
+
+  error_message = "Invalid music format";
+  return false;
+}
+
+/**
+ * \brief Decodes a chunk of SPC data into PCM data for this music.
+ * \param[out] chunk The chunk to write.
+ * \param nb_samples number of samples to write
+ */
+void Music::decode_spc(DecodedChunk& chunk, ALsizei nb_samples) {
+
+  // decode the SPC data
+  chunk.samples.resize(nb_samples);
+  spc_decoder->decode((int16_t*) chunk.samples.data(), nb_samples);
+  chunk.al_format = AL_FORMAT_STEREO16;
+  chunk.sample_rate = 32000;
 }
 
 /**
- * \brief Decodes a chunk of IT data into PCM data for the current music.
- * \param destination_buffer the destination buffer to write
+ * \brief Decodes a chunk of IT data into PCM data for this music.
+ * \param[out] chunk The chunk to write.
  * \param nb_samples number of samples to write
  */
-void Music::decode_it(ALuint destination_buffer, ALsizei nb_samples) {
+void Music::decode_it(DecodedChunk& chunk, ALsizei nb_samples) {
 
   // Decode the IT data.
-  std::vector<ALushort> raw_data(nb_samples);
-  int bytes_read = it_decoder->decode(raw_data.data(), nb_samples);
+  chunk.samples.resize(nb_samples);
+  int bytes_read = it_decoder->decode(chunk.samples.data(), nb_samples);
 
   if (bytes_read == 0) {
     // End of file.
-    alBufferData(destination_buffer, AL_FORMAT_STEREO16, raw_data.data(), 0, 44100);
+    chunk.samples.clear();
   }
   else {
-    // Put this decoded data into the buffer.
-    alBufferData(destination_buffer, AL_FORMAT_STEREO16, raw_data.data(), nb_samples, 44100);
-  }
-  int error = alGetError();
-  if (error != AL_NO_ERROR) {
-    std::ostringstream oss;
-    oss << "Failed to fill the audio buffer with decoded IT data for music file '"
-        << file_name << ": error " << error;
-    Debug::error(oss.str());
+    // The decoder fills nb_samples bytes.
+    chunk.samples.resize(nb_samples / 2);
   }
+  chunk.al_format = AL_FORMAT_STEREO16;
+  chunk.sample_rate = 44100;
 }
 
 /**
- * \brief Decodes a chunk of OGG data into PCM data for the current music.
- * \param destination_buffer The destination buffer to write.
+ * \brief Decodes a chunk of OGG data into PCM data for this music.
+ * \param[out] chunk The chunk to write.
  * \param nb_samples Number of samples to write.
+ * \return \c false in case of error. The error is stored in error_message.
  */
-void Music::decode_ogg(ALuint destination_buffer, ALsizei nb_samples) {
+bool Music::decode_ogg(DecodedChunk& chunk, ALsizei nb_samples) {
 
-  ogg_decoder->decode(destination_buffer, nb_samples);
+  chunk.al_format = ogg_decoder->get_al_format();
+  chunk.sample_rate = ogg_decoder->get_sample_rate();
+  return ogg_decoder->decode(chunk.samples, nb_samples, error_message);
 }
 
 /**
- * \brief Loads the file and starts playing this music.
- *
- * No other music should be playing.
- *
- * \return true if the music was loaded successfully
+ * \brief Puts a chunk of decoded data into an OpenAL buffer.
+ * \param destination_buffer The buffer to fill.
+ * \param chunk The decoded data.
  */
-bool Music::start() {
+void Music::fill_buffer(ALuint destination_buffer, const DecodedChunk& chunk) {
+
+  alBufferData(
+      destination_buffer,
+      chunk.al_format,
+      chunk.samples.data(),
+      ALsizei(chunk.samples.size() * sizeof(ALshort)),
+      chunk.sample_rate
+  );
 
-  if (!is_initialized()) {
-    return false;
+  int error = alGetError();
+  if (error != AL_NO_ERROR) {
+    std::ostringstream oss;
+    oss << "Failed to fill the audio buffer with decoded data for music file '"
+        << file_name << "': error " << error;
+    Debug::error(oss.str());
   }
+}
+
+/**
+ * \brief Loads the file of this music and decodes its first buffers.
+ *
+ * This function does not call OpenAL, Lua or the logger,
+ * so it can be called from a worker thread, except for IT musics
+ * which must be prepared on the main thread.
+ * Problems are stored in error_message.
+ *
+ * \return \c true if the music was loaded successfully.
+ */
+bool Music::prepare() {
 
   // First time: find the file.
   if (file_name.empty()) {
     find_music_file(id, file_name, format);
 
     if (file_name.empty()) {
-      Debug::error(std::string("Cannot find music file 'musics/")
-          + id + "' (tried with extensions .ogg, .it and .spc)"
-      );
+      error_message = std::string("Cannot find music file 'musics/")
+          + id + "' (tried with extensions .ogg, .it and .spc)";
       return false;
     }
   }
 
-  bool success = true;
-
-  // create the buffers and the source
-  alGenBuffers(nb_buffers, buffers);
-  alGenSources(1, &source);
-  alSourcef(source, AL_GAIN, volume);
-
   // load the music into memory
-  std::string sound_buffer;
+  std::string sound_buffer = QuestFiles::data_file_read(file_name);
   switch (format) {
 
     case SPC:
-
-      sound_buffer = QuestFiles::data_file_read(file_name);
-
       // Give the SPC data into the SPC decoder.
+      spc_decoder = std::unique_ptr<SpcDecoder>(new SpcDecoder());
       spc_decoder->load((int16_t*) sound_buffer.data(), sound_buffer.size());
-
-      for (int i = 0; i < nb_buffers; i++) {
-        decode_spc(buffers[i], 16384);
-      }
       break;
 
     case IT:
-
-      sound_buffer = QuestFiles::data_file_read(file_name);
-
       // Give the IT data to the IT decoder
+      it_decoder = std::unique_ptr<ItDecoder>(new ItDecoder());
       it_decoder->load(sound_buffer);
-
-      for (int i = 0; i < nb_buffers; i++) {
-        decode_it(buffers[i], 16384);
-      }
       break;
 
     case OGG:
-
-      sound_buffer = QuestFiles::data_file_read(file_name);
-
       // Give the OGG data to the OGG decoder.
-      success = ogg_decoder->load(std::move(sound_buffer), this->loop);
-      if (success) {
-        for (int i = 0; i < nb_buffers; i++) {
-          decode_ogg(buffers[i], 16384);
-        }
+      ogg_decoder = std::unique_ptr<OggDecoder>(new OggDecoder());
+      if (!ogg_decoder->load(std::move(sound_buffer), this->loop)) {
+        error_message = "Cannot load music file '" + file_name + "'";
+        return false;
       }
       break;
 
     case NO_FORMAT:
-      Debug::die("Invalid music format");
-      break;
+      error_message = "Invalid music format";
+      return false;
+  }
+
+  // Decode the initial buffers.
+  prepared_chunks.resize(nb_buffers);
+  for (DecodedChunk& chunk : prepared_chunks) {
+    decode(chunk, buffer_nb_samples);
+  }
+
+  return true;
+}
+
+/**
+ * \brief Starts playing this music.
+ *
+ * The music must have been prepared with prepare(),
+ * so this only hands the decoded data to OpenAL.
+ *
+ * \return true if the music was started successfully
+ */
+bool Music::start() {
+
+  if (!is_initialized()) {
+    return false;
   }
 
-  if (!success) {
-    Debug::error("Cannot load music file '" + file_name + "'");
+  bool success = true;
+
+  // create the buffers and the source
+  alGenBuffers(nb_buffers, buffers);
+  alGenSources(1, &source);
+  update_gain();
+
+  for (int i = 0; i < nb_buffers; i++) {
+    fill_buffer(buffers[i], prepared_chunks[i]);
   }
+  prepared_chunks.clear();
 
   // start the streaming
   alSourceQueueBuffers(source, nb_buffers, buffers);
@@ -595,6 +804,62 @@ bool Music::start() {
   return success;
 }
 
+/**
+ * \brief Starts fading this music in or out.
+ *
+ * The fade lasts the current crossfade duration.
+ *
+ * \param fade_in \c true to fade in, \c false to fade out.
+ */
+void Music::start_fade(bool fade_in) {
+
+  fading_in = fade_in;
+  fade_start_date = System::now();
+  fade_duration = crossfade_duration;
+  update_gain();
+}
+
+/**
+ * \brief Updates the gain of this music during a fade.
+ * \return \c false if this music has finished fading out.
+ */
+bool Music::update_fade() {
+
+  if (fade_duration == 0) {
+    return true;
+  }
+
+  bool finished = System::now() - fade_start_date >= fade_duration;
+  bool faded_out = finished && !fading_in;
+  if (finished) {
+    fade_duration = 0;
+  }
+  update_gain();
+  return !faded_out;
+}
+
+/**
+ * \brief Applies the music volume and the current fade to the source.
+ */
+void Music::update_gain() {
+
+  if (source == AL_NONE) {
+    return;
+  }
+
+  float gain = volume;
+  if (fade_duration != 0) {
+    uint32_t elapsed = std::min(System::now() - fade_start_date, fade_duration);
+    float progress = float(elapsed) / fade_duration;
+    gain *= fading_in ? progress : 1.0f - progress;
+  }
+  else if (!fading_in && fade_start_date != 0) {
+    // Finished fading out.
+    gain = 0.0f;
+  }
+  alSourcef(source, AL_GAIN, gain);
+}
+
 /**
  * \brief Stops playing the music.
  *
@@ -625,24 +890,11 @@ void Music::stop() {
 
   // delete the buffers
   alDeleteBuffers(nb_buffers, buffers);
+  source = AL_NONE;
 
-  switch (format) {
-
-    case SPC:
-      break;
-
-    case IT:
-      it_decoder->unload();
-      break;
-
-    case OGG:
-      ogg_decoder->unload();
-      break;
-
-    case NO_FORMAT:
-      Debug::die("Invalid music format");
-      break;
-  }
+  spc_decoder = nullptr;
+  it_decoder = nullptr;
+  ogg_decoder = nullptr;
 }
 
 /**
@@ -14,7 +14,6 @@
  * You should have received a copy of the GNU General Public License along
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
-#include "solarus/lowlevel/Debug.h"
 #include "solarus/lowlevel/OggDecoder.h"
 #include "solarus/lowlevel/QuestFiles.h"
 #include <al.h>
@@ -110,36 +109,73 @@ void OggDecoder::unload() {
 }
 
 /**
- * \brief Decodes a chunk of the previously loaded OGG data into PCM data
- * and plays it.
- * \param decoded_data Pointer to where you want the decoded data to be written.
- * \param nb_samples Number of samples to write.
+ * \brief Returns the OpenAL format of the decoded PCM data.
+ * \return The OpenAL format, or AL_NONE if no music is loaded or if the
+ * number of channels is not supported.
  */
-void OggDecoder::decode(ALuint destination_buffer, ALsizei nb_samples) {
+ALenum OggDecoder::get_al_format() const {
 
   if (ogg_info == nullptr) {
-    return;
+    return AL_NONE;
   }
 
-  // Read the encoded music properties.
-  const int num_channels = ogg_info->channels;
-  ALsizei sample_rate = ALsizei(ogg_info->rate);
-  ALenum al_format = AL_NONE;
-  if (num_channels == 1) {
-    al_format = AL_FORMAT_MONO16;
+  if (ogg_info->channels == 1) {
+    return AL_FORMAT_MONO16;
+  }
+  if (ogg_info->channels == 2) {
+    return AL_FORMAT_STEREO16;
+  }
+  return AL_NONE;
+}
+
+/**
+ * \brief Returns the sample rate of the decoded PCM data.
+ * \return The sample rate in Hz, or 0 if no music is loaded.
+ */
+ALsizei OggDecoder::get_sample_rate() const {
+
+  if (ogg_info == nullptr) {
+    return 0;
   }
-  else if (num_channels == 2) {
-    al_format = AL_FORMAT_STEREO16;
+
+  return ALsizei(ogg_info->rate);
+}
+
+/**
+ * \brief Decodes a chunk of the previously loaded OGG data into PCM data.
+ *
+ * This function does not call OpenAL and does not log anything,
+ * so it can be called from a worker thread.
+ *
+ * \param[out] samples The decoded PCM data. It is resized to the number of
+ * 16-bit values actually decoded, which is less than requested at the end
+ * of a music that does not loop.
+ * \param nb_samples Number of samples to decode.
+ * \param[out] error_message Description of the problem in case of error.
+ * \return \c false in case of error.
+ */
+bool OggDecoder::decode(
+    std::vector<ALshort>& samples,
+    ALsizei nb_samples,
+    std::string& error_message
+) {
+  samples.clear();
+
+  if (ogg_info == nullptr) {
+    return true;
   }
 
+  // Read the encoded music properties.
+  const int num_channels = ogg_info->channels;
   const ogg_int64_t loop_end_byte = loop_end_pcm * num_channels * sizeof(ALshort);
 
   // Decode the OGG data.
-  std::vector<ALshort> raw_data(nb_samples * num_channels);
+  samples.resize(nb_samples * num_channels);
   int bitstream = 0;
   long bytes_read = 0;
   long total_bytes_read = 0;
   long remaining_bytes = nb_samples * num_channels * sizeof(ALshort);
+  bool success = true;
 
   do {
     long max_bytes_to_read = remaining_bytes;
@@ -154,7 +190,7 @@ void OggDecoder::decode(ALuint destination_buffer, ALsizei nb_samples) {
 
     bytes_read = ov_read(
         ogg_file.get(),
-        ((char*) raw_data.data()) + total_bytes_read,
+        ((char*) samples.data()) + total_bytes_read,
         max_bytes_to_read,
         0,
         2,
@@ -166,8 +202,9 @@ void OggDecoder::decode(ALuint destination_buffer, ALsizei nb_samples) {
       if (bytes_read != OV_HOLE) { // OV_HOLE is normal when the music loops
         std::ostringstream oss;
         oss << "Error while decoding ogg chunk: " << bytes_read;
-        Debug::error(oss.str());
-        return;
+        error_message = oss.str();
+        samples.clear();
+        return false;
       }
     }
     else {
@@ -184,23 +221,16 @@ void OggDecoder::decode(ALuint destination_buffer, ALsizei nb_samples) {
         if (error != 0) {
           std::ostringstream oss;
           oss << "Failed to loop in OGG file: error " << error;
-          Debug::error(oss.str());
+          error_message = oss.str();
+          success = false;
         }
       }
     }
   }
   while (remaining_bytes > 0 && bytes_read > 0);
 
-  // Put this decoded data into the buffer.
-  alBufferData(destination_buffer, al_format, raw_data.data(), ALsizei(total_bytes_read), sample_rate);
-
-  int error = alGetError();
-  if (error != AL_NO_ERROR) {
-    std::ostringstream oss;
-    oss << "Failed to fill the audio buffer with decoded OGG data: error " << error;
-    Debug::error(oss.str());
-  }
+  samples.resize(total_bytes_read / sizeof(ALshort));
+  return success;
 }
 
 }
-
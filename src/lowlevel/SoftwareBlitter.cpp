@@ -0,0 +1,798 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Color.h"
+#include "solarus/lowlevel/Point.h"
+#include "solarus/lowlevel/Rectangle.h"
+#include "solarus/lowlevel/SoftwareBlitter.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define SOLARUS_BLITTER_SSE2
+#    include <emmintrin.h>
+#  elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    define SOLARUS_BLITTER_NEON
+#    include <arm_neon.h>
+#  endif
+#endif
+
+namespace Solarus {
+
+namespace {
+
+/**
+ * \brief Divides by 255 with rounding.
+ * \param x A value between 0 and 255 * 255.
+ * \return x / 255 rounded to the nearest integer.
+ */
+inline uint32_t div255(uint32_t x) {
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+/**
+ * \brief Parameters of a row operation.
+ */
+struct RowContext {
+  int alpha_shift;              /**< Bit position of the alpha channel in a pixel. */
+  uint32_t opacity;             /**< Opacity applied to the source (0 to 255). */
+};
+
+/**
+ * \brief Alpha-blends a row of pixels, one pixel at a time.
+ *
+ * For each channel, dst = src * alpha + dst * (1 - alpha),
+ * where the alpha channel itself is treated like a color of the source
+ * that is always fully premultiplied.
+ *
+ * \param src Source pixels.
+ * \param dst Destination pixels.
+ * \param count Number of pixels.
+ * \param context Parameters of the operation.
+ */
+void blend_row_scalar(const uint32_t* src, uint32_t* dst, int count, const RowContext& context) {
+
+  const int alpha_shift = context.alpha_shift;
+  const uint32_t opacity = context.opacity;
+  for (int i = 0; i < count; ++i) {
+    const uint32_t s = src[i];
+    uint32_t alpha = (s >> alpha_shift) & 0xFF;
+    if (opacity != 255) {
+      alpha = div255(alpha * opacity);
+    }
+    if (alpha == 0) {
+      continue;
+    }
+    if (alpha == 255) {
+      dst[i] = s;
+      continue;
+    }
+
+    const uint32_t d = dst[i];
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+      const uint32_t factor = (shift == alpha_shift) ? opacity : alpha;
+      const uint32_t sc = div255(((s >> shift) & 0xFF) * factor);
+      const uint32_t dc = div255(((d >> shift) & 0xFF) * (255 - alpha));
+      result |= (sc + dc) << shift;
+    }
+    dst[i] = result;
+  }
+}
+
+/**
+ * \brief Adds a row of pixels weighted by their alpha, one pixel at a time.
+ *
+ * The alpha channel of the destination is preserved.
+ *
+ * \param src Source pixels.
+ * \param dst Destination pixels.
+ * \param count Number of pixels.
+ * \param context Parameters of the operation.
+ */
+void add_row_scalar(const uint32_t* src, uint32_t* dst, int count, const RowContext& context) {
+
+  const int alpha_shift = context.alpha_shift;
+  const uint32_t opacity = context.opacity;
+  for (int i = 0; i < count; ++i) {
+    const uint32_t s = src[i];
+    uint32_t alpha = (s >> alpha_shift) & 0xFF;
+    if (opacity != 255) {
+      alpha = div255(alpha * opacity);
+    }
+    if (alpha == 0) {
+      continue;
+    }
+
+    const uint32_t d = dst[i];
+    uint32_t result = d & (0xFFu << alpha_shift);
+    for (int shift = 0; shift < 32; shift += 8) {
+      if (shift == alpha_shift) {
+        continue;
+      }
+      const uint32_t sc = div255(((s >> shift) & 0xFF) * alpha);
+      const uint32_t dc = (d >> shift) & 0xFF;
+      result |= std::min(sc + dc, 255u) << shift;
+    }
+    dst[i] = result;
+  }
+}
+
+/**
+ * \brief Multiplies a row of pixels, one pixel at a time.
+ *
+ * The alpha channel of the destination is preserved and the alpha of the
+ * source is ignored.
+ *
+ * \param src Source pixels.
+ * \param dst Destination pixels.
+ * \param count Number of pixels.
+ * \param context Parameters of the operation.
+ */
+void multiply_row_scalar(const uint32_t* src, uint32_t* dst, int count, const RowContext& context) {
+
+  const int alpha_shift = context.alpha_shift;
+  for (int i = 0; i < count; ++i) {
+    const uint32_t s = src[i];
+    const uint32_t d = dst[i];
+    uint32_t result = d & (0xFFu << alpha_shift);
+    for (int shift = 0; shift < 32; shift += 8) {
+      if (shift == alpha_shift) {
+        continue;
+      }
+      result |= div255(((s >> shift) & 0xFF) * ((d >> shift) & 0xFF)) << shift;
+    }
+    dst[i] = result;
+  }
+}
+
+#if defined(SOLARUS_BLITTER_SSE2)
+
+// Four pixels at a time, as 16-bit channels. The alpha channel is byte 3
+// of each pixel.
+
+/**
+ * \brief Divides 16-bit lanes by 255 with rounding.
+ */
+inline __m128i div255_epi16(__m128i x) {
+  x = _mm_add_epi16(x, _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+/**
+ * \brief Returns the alpha of each pixel repeated in its four channels.
+ */
+inline __m128i broadcast_alpha_epi16(__m128i pixels) {
+  return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+/**
+ * \brief Alpha-blends two pixels stored as 16-bit channels.
+ */
+inline __m128i blend_epi16(__m128i s, __m128i d, __m128i opacity, __m128i alpha_lanes) {
+
+  __m128i alpha = broadcast_alpha_epi16(s);
+  alpha = div255_epi16(_mm_mullo_epi16(alpha, opacity));
+  // Colors are multiplied by alpha, the alpha channel by the opacity.
+  const __m128i factor = _mm_or_si128(
+      _mm_andnot_si128(alpha_lanes, alpha),
+      _mm_and_si128(alpha_lanes, opacity)
+  );
+  const __m128i sc = div255_epi16(_mm_mullo_epi16(s, factor));
+  const __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+  const __m128i dc = div255_epi16(_mm_mullo_epi16(d, inverse));
+  return _mm_add_epi16(sc, dc);
+}
+
+void blend_row(const uint32_t* src, uint32_t* dst, int count, const RowContext& context) {
+
+  if (context.alpha_shift != 24) {
+    blend_row_scalar(src, dst, count, context);
+    return;
+  }
+
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i alpha_mask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+  const __m128i opacity = _mm_set1_epi16(static_cast<short>(context.opacity));
+  const __m128i alpha_lanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const int alpha_bits = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(s, alpha_mask), zero));
+    if (alpha_bits == 0xFFFF) {
+      // Fully transparent source.
+      continue;
+    }
+    if (context.opacity == 255 &&
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(s, alpha_mask), alpha_mask)) == 0xFFFF) {
+      // Fully opaque source.
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+      continue;
+    }
+
+    const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    const __m128i low = blend_epi16(
+        _mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), opacity, alpha_lanes);
+    const __m128i high = blend_epi16(
+        _mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), opacity, alpha_lanes);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(low, high));
+  }
+  blend_row_scalar(src + i, dst + i, count - i, context);
+}
+
+/**
+ * \brief Additively blends two pixels stored as 16-bit channels.
+ */
+inline __m128i add_epi16(__m128i s, __m128i d, __m128i opacity, __m128i alpha_lanes) {
+
+  __m128i alpha = broadcast_alpha_epi16(s);
+  alpha = div255_epi16(_mm_mullo_epi16(alpha, opacity));
+  alpha = _mm_andnot_si128(alpha_lanes, alpha);  // Keep the destination alpha.
+  const __m128i sc = div255_epi16(_mm_mullo_epi16(s, alpha));
+  return _mm_add_epi16(sc, d);  // Saturated when packing.
+}
+
+void add_row(const uint32_t* src, uint32_t* dst, int count, const RowContext& context) {
+
+  if (context.alpha_shift != 24) {
+    add_row_scalar(src, dst, count, context);
+    return;
+  }
+
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i opacity = _mm_set1_epi16(static_cast<short>(context.opacity));
+  const __m128i alpha_lanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    const __m128i low = add_epi16(
+        _mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), opacity, alpha_lanes);
+    const __m128i high = add_epi16(
+        _mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), opacity, alpha_lanes);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(low, high));
+  }
+  add_row_scalar(src + i, dst + i, count - i, context);
+}
+
+/**
+ * \brief Multiplies two pixels stored as 16-bit channels.
+ */
+inline __m128i multiply_epi16(__m128i s, __m128i d, __m128i alpha_lanes) {
+
+  // Multiply the alpha of the destination by 255 to keep it.
+  s = _mm_or_si128(_mm_andnot_si128(alpha_lanes, s), _mm_and_si128(alpha_lanes, _mm_set1_epi16(255)));
+  return div255_epi16(_mm_mullo_epi16(s, d));
+}
+
+void multiply_row(const uint32_t* src, uint32_t* dst, int count, const RowContext& context) {
+
+  if (context.alpha_shift != 24) {
+    multiply_row_scalar(src, dst, count, context);
+    return;
+  }
+
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i alpha_lanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    const __m128i low = multiply_epi16(
+        _mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), alpha_lanes);
+    const __m128i high = multiply_epi16(
+        _mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), alpha_lanes);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(low, high));
+  }
+  multiply_row_scalar(src + i, dst + i, count - i, context);
+}
+
+#elif defined(SOLARUS_BLITTER_NEON)
+
+// Eight pixels at a time, deinterleaved into one vector per channel.
+// The alpha channel is channel 3.
+
+/**
+ * \brief Multiplies 8-bit lanes and divides by 255 with rounding.
+ */
+inline uint8x8_t mul_div255_u8(uint8x8_t a, uint8x8_t b) {
+  const uint16x8_t x = vmull_u8(a, b);
+  return vrshrn_n_u16(vrsraq_n_u16(x, x, 8), 8);
+}
+
+void blend_row(const uint32_t* src, uint32_t* dst, int count, const RowContext& context) {
+
+  if (context.alpha_shift != 24) {
+    blend_row_scalar(src, dst, count, context);
+    return;
+  }
+
+  const uint8x8_t opacity = vdup_n_u8(static_cast<uint8_t>(context.opacity));
+
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const uint8x8x4_t s = vld4_u8(reinterpret_cast<const uint8_t*>(src + i));
+    uint8x8x4_t d = vld4_u8(reinterpret_cast<const uint8_t*>(dst + i));
+    const uint8x8_t alpha = mul_div255_u8(s.val[3], opacity);
+    const uint8x8_t inverse = vmvn_u8(alpha);
+    for (int c = 0; c < 3; ++c) {
+      d.val[c] = vadd_u8(mul_div255_u8(s.val[c], alpha), mul_div255_u8(d.val[c], inverse));
+    }
+    d.val[3] = vadd_u8(alpha, mul_div255_u8(d.val[3], inverse));
+    vst4_u8(reinterpret_cast<uint8_t*>(dst + i), d);
+  }
+  blend_row_scalar(src + i, dst + i, count - i, context);
+}
+
+void add_row(const uint32_t* src, uint32_t* dst, int count, const RowContext& context) {
+
+  if (context.alpha_shift != 24) {
+    add_row_scalar(src, dst, count, context);
+    return;
+  }
+
+  const uint8x8_t opacity = vdup_n_u8(static_cast<uint8_t>(context.opacity));
+
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const uint8x8x4_t s = vld4_u8(reinterpret_cast<const uint8_t*>(src + i));
+    uint8x8x4_t d = vld4_u8(reinterpret_cast<const uint8_t*>(dst + i));
+    const uint8x8_t alpha = mul_div255_u8(s.val[3], opacity);
+    for (int c = 0; c < 3; ++c) {
+      d.val[c] = vqadd_u8(d.val[c], mul_div255_u8(s.val[c], alpha));
+    }
+    vst4_u8(reinterpret_cast<uint8_t*>(dst + i), d);
+  }
+  add_row_scalar(src + i, dst + i, count - i, context);
+}
+
+void multiply_row(const uint32_t* src, uint32_t* dst, int count, const RowContext& context) {
+
+  if (context.alpha_shift != 24) {
+    multiply_row_scalar(src, dst, count, context);
+    return;
+  }
+
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const uint8x8x4_t s = vld4_u8(reinterpret_cast<const uint8_t*>(src + i));
+    uint8x8x4_t d = vld4_u8(reinterpret_cast<const uint8_t*>(dst + i));
+    for (int c = 0; c < 3; ++c) {
+      d.val[c] = mul_div255_u8(s.val[c], d.val[c]);
+    }
+    vst4_u8(reinterpret_cast<uint8_t*>(dst + i), d);
+  }
+  multiply_row_scalar(src + i, dst + i, count - i, context);
+}
+
+#else
+
+void blend_row(const uint32_t* src, uint32_t* dst, int count, const RowContext& context) {
+  blend_row_scalar(src, dst, count, context);
+}
+
+void add_row(const uint32_t* src, uint32_t* dst, int count, const RowContext& context) {
+  add_row_scalar(src, dst, count, context);
+}
+
+void multiply_row(const uint32_t* src, uint32_t* dst, int count, const RowContext& context) {
+  multiply_row_scalar(src, dst, count, context);
+}
+
+#endif
+
+/**
+ * \brief Copies a row of pixels.
+ * \param src Source pixels.
+ * \param dst Destination pixels.
+ * \param count Number of pixels.
+ */
+void copy_row(const uint32_t* src, uint32_t* dst, int count, const RowContext& /* context */) {
+  std::memcpy(dst, src, count * sizeof(uint32_t));
+}
+
+using RowFunction = void (*)(const uint32_t*, uint32_t*, int, const RowContext&);
+
+/**
+ * \brief Converts a row of 8-bit palette indexes to pixels.
+ * \param src Source palette indexes.
+ * \param palette Pixel value of each of the 256 palette entries.
+ * \param dst Destination pixels.
+ * \param count Number of pixels.
+ */
+void expand_row(const uint8_t* src, const uint32_t* palette, uint32_t* dst, int count) {
+
+  for (int i = 0; i < count; ++i) {
+    dst[i] = palette[src[i]];
+  }
+}
+
+/**
+ * \brief Returns whether the software blitter supports a pixel format.
+ * \param format The format to test.
+ * \return \c true if this is a 32-bit format with 8-bit channels
+ * including alpha.
+ */
+bool is_format_supported(const SDL_PixelFormat& format) {
+
+  return format.BytesPerPixel == 4 &&
+      format.Amask != 0 &&
+      format.Rloss == 0 && format.Gloss == 0 && format.Bloss == 0 && format.Aloss == 0 &&
+      format.Ashift % 8 == 0;
+}
+
+/**
+ * \brief Returns whether the software blitter supports a surface.
+ * \param surface The surface to test.
+ * \return \c true if pixels of this surface can be accessed directly.
+ */
+bool is_surface_supported(SDL_Surface& surface) {
+
+  return surface.format != nullptr &&
+      is_format_supported(*surface.format) &&
+      !SDL_MUSTLOCK(&surface);
+}
+
+/**
+ * \brief Returns the row function to use for a blend mode.
+ * \param blend_mode A blend mode.
+ * \param opacity Opacity of the source.
+ * \return The row function, or nullptr if this case is not supported.
+ */
+RowFunction get_row_function(BlendMode blend_mode, uint8_t opacity) {
+
+  switch (blend_mode) {
+
+  case BlendMode::NONE:
+    // SDL applies the opacity even without blending.
+    return opacity == 255 ? copy_row : nullptr;
+
+  case BlendMode::BLEND:
+    return blend_row;
+
+  case BlendMode::ADD:
+    return add_row;
+
+  case BlendMode::MULTIPLY:
+    return multiply_row;
+  }
+
+  return nullptr;
+}
+
+/**
+ * \brief Clips a destination rectangle to the clip rectangle of a surface.
+ * \param[in] dst_surface The destination surface.
+ * \param[in,out] dst_rect The rectangle to clip.
+ * \param[out] src_offset How much the top-left corner of the rectangle moved.
+ * \return \c false if nothing is left to draw.
+ */
+bool clip_to_destination(
+    const SDL_Surface& dst_surface,
+    SDL_Rect& dst_rect,
+    SDL_Point& src_offset
+) {
+  const SDL_Rect& clip = dst_surface.clip_rect;
+  const int x1 = std::max(dst_rect.x, clip.x);
+  const int y1 = std::max(dst_rect.y, clip.y);
+  const int x2 = std::min(dst_rect.x + dst_rect.w, clip.x + clip.w);
+  const int y2 = std::min(dst_rect.y + dst_rect.h, clip.y + clip.h);
+  src_offset.x = x1 - dst_rect.x;
+  src_offset.y = y1 - dst_rect.y;
+  dst_rect = { x1, y1, x2 - x1, y2 - y1 };
+  return dst_rect.w > 0 && dst_rect.h > 0;
+}
+
+/**
+ * \brief Returns a row of pixels of a surface.
+ * \param surface A surface.
+ * \param x X coordinate of the first pixel.
+ * \param y Row to get.
+ * \return The pixel at (x, y).
+ */
+uint32_t* get_row(SDL_Surface& surface, int x, int y) {
+  return reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(surface.pixels) + y * surface.pitch) + x;
+}
+
+/**
+ * \brief Returns a row of palette indexes of an 8-bit surface.
+ * \param surface An 8-bit surface.
+ * \param x X coordinate of the first pixel.
+ * \param y Row to get.
+ * \return The palette index at (x, y).
+ */
+const uint8_t* get_indexed_row(SDL_Surface& surface, int x, int y) {
+  return static_cast<const uint8_t*>(surface.pixels) + y * surface.pitch + x;
+}
+
+}
+
+/**
+ * \brief Draws a region of a surface onto another one.
+ *
+ * Works like SDL_BlitSurface(), taking the alpha modulation of the source
+ * and the clip rectangle of the destination into account.
+ *
+ * \param src_surface The surface to draw.
+ * \param region The subrectangle to draw in the source surface.
+ * \param dst_surface The destination surface.
+ * \param dst_position Coordinates on the destination surface.
+ * \param blend_mode How to draw.
+ * \param palette For 8-bit indexed source surfaces, the pixel value of each
+ * of the 256 palette entries in the format of the destination.
+ * nullptr for 32-bit source surfaces.
+ * \return \c false if these surfaces are not supported. Nothing is drawn
+ * in this case.
+ */
+bool SoftwareBlitter::blit(
+    SDL_Surface& src_surface,
+    const Rectangle& region,
+    SDL_Surface& dst_surface,
+    const Point& dst_position,
+    BlendMode blend_mode,
+    const uint32_t* palette
+) {
+  if (!is_surface_supported(dst_surface)) {
+    return false;
+  }
+
+  if (palette != nullptr) {
+    // The palette already makes the color key transparent.
+    if (src_surface.format->BytesPerPixel != 1 || SDL_MUSTLOCK(&src_surface)) {
+      return false;
+    }
+  }
+  else {
+    if (!is_surface_supported(src_surface) ||
+        src_surface.format->format != dst_surface.format->format) {
+      return false;
+    }
+
+    uint32_t color_key;
+    if (SDL_GetColorKey(&src_surface, &color_key) == 0) {
+      // Color keys are left to SDL.
+      return false;
+    }
+  }
+
+  uint8_t opacity = 255;
+  SDL_GetSurfaceAlphaMod(&src_surface, &opacity);
+  const RowFunction row_function = get_row_function(blend_mode, opacity);
+  if (row_function == nullptr) {
+    return false;
+  }
+
+  // Clip to the source surface.
+  const int src_x = std::max(region.get_x(), 0);
+  const int src_y = std::max(region.get_y(), 0);
+  const int src_x2 = std::min(region.get_x() + region.get_width(), src_surface.w);
+  const int src_y2 = std::min(region.get_y() + region.get_height(), src_surface.h);
+  if (src_x2 <= src_x || src_y2 <= src_y) {
+    return true;
+  }
+
+  // Clip to the destination surface.
+  SDL_Rect dst_rect = {
+      dst_position.x + src_x - region.get_x(),
+      dst_position.y + src_y - region.get_y(),
+      src_x2 - src_x,
+      src_y2 - src_y
+  };
+  SDL_Point src_offset;
+  if (!clip_to_destination(dst_surface, dst_rect, src_offset)) {
+    return true;
+  }
+
+  const RowContext context = { dst_surface.format->Ashift, opacity };
+
+  if (palette != nullptr) {
+    // Expand palette indexes by small chunks that stay in the cache.
+    constexpr int chunk_size = 256;
+    uint32_t chunk[chunk_size];
+    for (int j = 0; j < dst_rect.h; ++j) {
+      const uint8_t* src = get_indexed_row(src_surface, src_x + src_offset.x, src_y + src_offset.y + j);
+      uint32_t* dst = get_row(dst_surface, dst_rect.x, dst_rect.y + j);
+      for (int i = 0; i < dst_rect.w; i += chunk_size) {
+        const int count = std::min(chunk_size, dst_rect.w - i);
+        if (row_function == copy_row) {
+          expand_row(src + i, palette, dst + i, count);
+        }
+        else {
+          expand_row(src + i, palette, chunk, count);
+          row_function(chunk, dst + i, count, context);
+        }
+      }
+    }
+    return true;
+  }
+
+  for (int j = 0; j < dst_rect.h; ++j) {
+    row_function(
+        get_row(src_surface, src_x + src_offset.x, src_y + src_offset.y + j),
+        get_row(dst_surface, dst_rect.x, dst_rect.y + j),
+        dst_rect.w,
+        context
+    );
+  }
+  return true;
+}
+
+/**
+ * \brief Draws a surface enlarged by an integer factor onto another one.
+ *
+ * Each source pixel becomes a square of scale x scale pixels.
+ * Each source row is enlarged once into a small buffer and then combined
+ * with the destination rows it covers, so the cost is close to a normal
+ * blit of the enlarged size.
+ *
+ * \param src_surface The surface to draw. It must be a 32-bit surface with
+ * the format of the destination.
+ * \param scale The enlarging factor (1 or more).
+ * \param region The subrectangle to draw, in enlarged coordinates.
+ * \param dst_surface The destination surface.
+ * \param dst_position Coordinates on the destination surface.
+ * \param blend_mode How to draw.
+ * \return \c false if these surfaces are not supported. Nothing is drawn
+ * in this case.
+ */
+bool SoftwareBlitter::blit_scaled(
+    SDL_Surface& src_surface,
+    int scale,
+    const Rectangle& region,
+    SDL_Surface& dst_surface,
+    const Point& dst_position,
+    BlendMode blend_mode
+) {
+  if (scale < 1 ||
+      !is_surface_supported(dst_surface) ||
+      !is_surface_supported(src_surface) ||
+      src_surface.format->format != dst_surface.format->format) {
+    return false;
+  }
+
+  uint8_t opacity = 255;
+  SDL_GetSurfaceAlphaMod(&src_surface, &opacity);
+  const RowFunction row_function = get_row_function(blend_mode, opacity);
+  if (row_function == nullptr) {
+    return false;
+  }
+
+  // Clip to the enlarged source surface.
+  const int src_x = std::max(region.get_x(), 0);
+  const int src_y = std::max(region.get_y(), 0);
+  const int src_x2 = std::min(region.get_x() + region.get_width(), src_surface.w * scale);
+  const int src_y2 = std::min(region.get_y() + region.get_height(), src_surface.h * scale);
+  if (src_x2 <= src_x || src_y2 <= src_y) {
+    return true;
+  }
+
+  // Clip to the destination surface.
+  SDL_Rect dst_rect = {
+      dst_position.x + src_x - region.get_x(),
+      dst_position.y + src_y - region.get_y(),
+      src_x2 - src_x,
+      src_y2 - src_y
+  };
+  SDL_Point src_offset;
+  if (!clip_to_destination(dst_surface, dst_rect, src_offset)) {
+    return true;
+  }
+
+  const RowContext context = { dst_surface.format->Ashift, opacity };
+  const int first_x = src_x + src_offset.x;
+  const int first_y = src_y + src_offset.y;
+  std::vector<uint32_t> enlarged_row(dst_rect.w);
+  int enlarged_src_row = -1;
+  for (int j = 0; j < dst_rect.h; ++j) {
+    const int src_row = (first_y + j) / scale;
+    if (src_row != enlarged_src_row) {
+      const uint32_t* src = get_row(src_surface, 0, src_row);
+      for (int i = 0; i < dst_rect.w; ++i) {
+        enlarged_row[i] = src[(first_x + i) / scale];
+      }
+      enlarged_src_row = src_row;
+    }
+    row_function(
+        enlarged_row.data(),
+        get_row(dst_surface, dst_rect.x, dst_rect.y + j),
+        dst_rect.w,
+        context
+    );
+  }
+  return true;
+}
+
+/**
+ * \brief Fills a rectangle of a surface with a color.
+ * \param dst_surface The destination surface.
+ * \param where The rectangle to fill.
+ * \param color The color to draw.
+ * \param blend_mode How to draw the color.
+ * \return \c false if this surface is not supported. Nothing is drawn
+ * in this case.
+ */
+bool SoftwareBlitter::fill(
+    SDL_Surface& dst_surface,
+    const Rectangle& where,
+    const Color& color,
+    BlendMode blend_mode
+) {
+  if (!is_surface_supported(dst_surface)) {
+    return false;
+  }
+
+  const RowFunction row_function = get_row_function(blend_mode, 255);
+  if (row_function == nullptr) {
+    return false;
+  }
+
+  SDL_Rect dst_rect = { where.get_x(), where.get_y(), where.get_width(), where.get_height() };
+  SDL_Point src_offset;
+  if (!clip_to_destination(dst_surface, dst_rect, src_offset)) {
+    return true;
+  }
+
+  uint8_t r, g, b, a;
+  color.get_components(r, g, b, a);
+  const uint32_t pixel = SDL_MapRGBA(dst_surface.format, r, g, b, a);
+
+  if (row_function == copy_row ||
+      (row_function == blend_row && a == 255)) {
+    SDL_FillRect(&dst_surface, &dst_rect, pixel);
+    return true;
+  }
+
+  const std::vector<uint32_t> src_row(dst_rect.w, pixel);
+  const RowContext context = { dst_surface.format->Ashift, 255 };
+  for (int j = 0; j < dst_rect.h; ++j) {
+    row_function(src_row.data(), get_row(dst_surface, dst_rect.x, dst_rect.y + j), dst_rect.w, context);
+  }
+  return true;
+}
+
+/**
+ * \brief Converts a rectangle of an 8-bit indexed surface to 32-bit pixels.
+ * \param src_surface An 8-bit indexed surface.
+ * \param palette The pixel value of each of the 256 palette entries.
+ * \param region The rectangle to convert. It must be inside the surface.
+ * \param dst Where to write the pixels.
+ * \param dst_pitch Number of bytes between two rows of dst.
+ */
+void SoftwareBlitter::expand_indexed(
+    SDL_Surface& src_surface,
+    const uint32_t* palette,
+    const Rectangle& region,
+    uint32_t* dst,
+    int dst_pitch
+) {
+  for (int j = 0; j < region.get_height(); ++j) {
+    expand_row(
+        get_indexed_row(src_surface, region.get_x(), region.get_y() + j),
+        palette,
+        reinterpret_cast<uint32_t*>(reinterpret_cast<uint8_t*>(dst) + j * dst_pitch),
+        region.get_width()
+    );
+  }
+}
+
+}
@@ -23,6 +23,7 @@
 #include "solarus/lowlevel/Music.h"
 #include "solarus/lowlevel/Sound.h"
 #include "solarus/lowlevel/String.h"
+#include "solarus/lowlevel/WorkerPool.h"
 #include "solarus/Arguments.h"
 #include "solarus/CurrentQuest.h"
 #include <cstdio>
@@ -34,11 +35,27 @@ ALCcontext* Sound::context = nullptr;
 bool Sound::initialized = false;
 bool Sound::sounds_preloaded = false;
 float Sound::volume = 1.0;
+int Sound::max_voices_total = 32;
+int Sound::default_max_voices_per_sound = 4;
+bool Sound::coalescing_louder = false;
+uint32_t Sound::current_tick = 0;
+uint32_t Sound::last_voice_serial = 0;
 std::list<Sound*> Sound::current_sounds;
-std::map<std::string, Sound> Sound::all_sounds;
+std::unordered_map<Symbol, Sound> Sound::all_sounds;
 
 namespace {
 
+/**
+ * \brief Gain added for each extra request of a sound in the same tick
+ * when coalesced sounds are louder.
+ */
+constexpr float coalesced_gain_step = 0.25f;
+
+/**
+ * \brief Maximum gain factor of a coalesced sound.
+ */
+constexpr float max_coalesced_gain = 2.0f;
+
 /**
  * \brief Loads an encoded sound from memory.
  *
@@ -147,7 +164,12 @@ Sound::Sound():
  */
 Sound::Sound(const std::string& sound_id):
   id(sound_id),
-  buffer(AL_NONE) {
+  buffer(AL_NONE),
+  sources(),
+  max_voices(-1),
+  priority(0),
+  last_start_tick(0),
+  num_coalesced(0) {
 
 }
 
@@ -159,7 +181,8 @@ Sound::~Sound() {
   if (is_initialized() && buffer != AL_NONE) {
 
     // stop the sources where this buffer is attached
-    for (ALuint source: sources) {
+    for (const Voice& voice: sources) {
+      ALuint source = voice.source;
       alSourceStop(source);
       alSourcei(source, AL_BUFFER, 0);
       alDeleteSources(1, &source);
@@ -255,6 +278,9 @@ bool Sound::is_initialized() {
 
 /**
  * \brief Loads and decodes all sounds listed in the game database.
+ *
+ * Sound files are decoded in parallel. Only the creation of audio buffers
+ * happens in the calling thread.
  */
 void Sound::load_all() {
 
@@ -262,11 +288,32 @@ void Sound::load_all() {
 
     const std::map<std::string, std::string>& sound_elements =
         CurrentQuest::get_resources(ResourceType::SOUND);
+
+    std::vector<Sound*> sounds;
     for (const auto& kvp: sound_elements) {
       const std::string& sound_id = kvp.first;
 
-      all_sounds[sound_id] = Sound(sound_id);
-      all_sounds[sound_id].load();
+      Sound& sound = all_sounds[sound_id];
+      if (sound.id.empty()) {
+        sound = Sound(sound_id);
+      }
+      if (sound.buffer == AL_NONE) {
+        sounds.push_back(&sound);
+      }
+    }
+
+    std::vector<DecodedSamples> decoded(sounds.size());
+    WorkerPool::parallel_for(
+        static_cast<int>(sounds.size()),
+        1,
+        [&sounds, &decoded](int begin, int end) {
+      for (int i = begin; i < end; ++i) {
+        decoded[i] = decode_samples(sounds[i]->get_file_name());
+      }
+    });
+
+    for (size_t i = 0; i < sounds.size(); ++i) {
+      sounds[i]->buffer = create_buffer(sounds[i]->get_file_name(), decoded[i]);
     }
 
     sounds_preloaded = true;
@@ -289,13 +336,23 @@ bool Sound::exists(const std::string& sound_id) {
  * \brief Starts playing the specified sound.
  * \param sound_id id of the sound to play
  */
-void Sound::play(const std::string& sound_id) {
+void Sound::play(const Symbol& sound_id) {
 
-  if (all_sounds.find(sound_id) == all_sounds.end()) {
-    all_sounds[sound_id] = Sound(sound_id);
-  }
+  get_sound(sound_id).start();
+}
 
-  all_sounds[sound_id].start();
+/**
+ * \brief Returns the sound with the specified id, creating it if necessary.
+ * \param sound_id Id of a sound.
+ * \return The corresponding sound, not necessarily loaded.
+ */
+Sound& Sound::get_sound(const Symbol& sound_id) {
+
+  Sound& sound = all_sounds[sound_id];
+  if (sound.id.empty()) {
+    sound = Sound(sound_id.str());
+  }
+  return sound;
 }
 
 /**
@@ -318,6 +375,227 @@ void Sound::set_volume(int volume) {
   Logger::info(std::string("Sound volume: ") + String::to_string(get_volume()));
 }
 
+/**
+ * \brief Returns the maximum number of sound sources playing at the same time.
+ * \return The maximum number of voices, or 0 if there is no limit.
+ */
+int Sound::get_max_voices() {
+  return max_voices_total;
+}
+
+/**
+ * \brief Sets the maximum number of sound sources playing at the same time.
+ *
+ * When a sound starts and there are already too many voices, the oldest
+ * voice of the sounds with the lowest priority is stopped.
+ *
+ * \param max_voices The maximum number of voices, or 0 for no limit.
+ */
+void Sound::set_max_voices(int max_voices) {
+
+  Debug::check_assertion(max_voices >= 0, "Invalid maximum number of voices");
+  max_voices_total = max_voices;
+}
+
+/**
+ * \brief Returns the maximum number of sources playing the same sound,
+ * for sounds that do not override it.
+ * \return The maximum number of voices of a sound, or 0 if there is no limit.
+ */
+int Sound::get_default_max_voices_per_sound() {
+  return default_max_voices_per_sound;
+}
+
+/**
+ * \brief Sets the maximum number of sources playing the same sound,
+ * for sounds that do not override it.
+ * \param max_voices The maximum number of voices of a sound,
+ * or 0 for no limit.
+ */
+void Sound::set_default_max_voices_per_sound(int max_voices) {
+
+  Debug::check_assertion(max_voices >= 0, "Invalid maximum number of voices");
+  default_max_voices_per_sound = max_voices;
+}
+
+/**
+ * \brief Returns whether a sound played several times in the same tick
+ * becomes louder.
+ * \return \c true if coalesced sounds are louder, \c false if extra
+ * requests are ignored.
+ */
+bool Sound::is_coalescing_louder() {
+  return coalescing_louder;
+}
+
+/**
+ * \brief Sets whether a sound played several times in the same tick
+ * becomes louder.
+ *
+ * In all cases, only one source is started.
+ *
+ * \param louder \c true to make coalesced sounds louder, \c false to
+ * ignore extra requests.
+ */
+void Sound::set_coalescing_louder(bool louder) {
+  coalescing_louder = louder;
+}
+
+/**
+ * \brief Returns the maximum number of sources playing a sound.
+ * \param sound_id Id of a sound.
+ * \return The maximum number of voices of this sound, or 0 if there is no limit.
+ */
+int Sound::get_sound_max_voices(const Symbol& sound_id) {
+
+  const auto& it = all_sounds.find(sound_id);
+  if (it == all_sounds.end() || it->second.max_voices == -1) {
+    return default_max_voices_per_sound;
+  }
+  return it->second.max_voices;
+}
+
+/**
+ * \brief Sets the maximum number of sources playing a sound.
+ *
+ * When the sound starts again with this number of voices playing,
+ * its oldest voice is stopped.
+ *
+ * \param sound_id Id of a sound.
+ * \param max_voices The maximum number of voices of this sound,
+ * 0 for no limit or -1 to use the default value.
+ */
+void Sound::set_sound_max_voices(const Symbol& sound_id, int max_voices) {
+
+  Debug::check_assertion(max_voices >= -1, "Invalid maximum number of voices");
+  get_sound(sound_id).max_voices = max_voices;
+}
+
+/**
+ * \brief Returns the priority of a sound.
+ * \param sound_id Id of a sound.
+ * \return The priority (0 by default).
+ */
+int Sound::get_sound_priority(const Symbol& sound_id) {
+
+  const auto& it = all_sounds.find(sound_id);
+  if (it == all_sounds.end()) {
+    return 0;
+  }
+  return it->second.priority;
+}
+
+/**
+ * \brief Sets the priority of a sound.
+ *
+ * When there are too many voices, voices of sounds with a lower priority
+ * are stopped first, and a sound cannot stop voices of sounds with a
+ * higher priority.
+ *
+ * \param sound_id Id of a sound.
+ * \param priority The priority.
+ */
+void Sound::set_sound_priority(const Symbol& sound_id, int priority) {
+
+  get_sound(sound_id).priority = priority;
+}
+
+/**
+ * \brief Returns the number of sources currently playing sounds.
+ * \return The number of voices.
+ */
+int Sound::get_num_voices() {
+
+  int num_voices = 0;
+  for (const Sound* sound: current_sounds) {
+    num_voices += sound->sources.size();
+  }
+  return num_voices;
+}
+
+/**
+ * \brief Returns the number of sources currently playing a sound.
+ * \param sound_id Id of a sound.
+ * \return The number of voices of this sound.
+ */
+int Sound::get_num_voices(const Symbol& sound_id) {
+
+  const auto& it = all_sounds.find(sound_id);
+  if (it == all_sounds.end()) {
+    return 0;
+  }
+  return it->second.sources.size();
+}
+
+/**
+ * \brief Stops voices if necessary so that this sound can start a new one.
+ *
+ * The oldest voice of this sound is stopped first if it reached its own
+ * limit.
+ * Then, while there are too many voices in total, the oldest voice of
+ * the sounds with the lowest priority is stopped.
+ *
+ * \return \c false if this sound should not start because all voices
+ * belong to sounds with a higher priority.
+ */
+bool Sound::make_room() {
+
+  const int sound_max_voices = max_voices == -1 ?
+      default_max_voices_per_sound : max_voices;
+  if (sound_max_voices > 0) {
+    while (static_cast<int>(sources.size()) >= sound_max_voices) {
+      stop_oldest_voice();
+    }
+  }
+
+  if (max_voices_total <= 0) {
+    return true;
+  }
+
+  int num_voices = get_num_voices();
+  while (num_voices >= max_voices_total) {
+
+    Sound* victim = nullptr;
+    for (Sound* other: current_sounds) {
+      if (other->sources.empty()) {
+        continue;
+      }
+      if (victim == nullptr ||
+          other->priority < victim->priority ||
+          (other->priority == victim->priority &&
+           other->sources.front().serial < victim->sources.front().serial)) {
+        victim = other;
+      }
+    }
+
+    if (victim == nullptr) {
+      break;
+    }
+    if (victim->priority > priority) {
+      return false;
+    }
+    victim->stop_oldest_voice();
+    --num_voices;
+  }
+  return true;
+}
+
+/**
+ * \brief Stops the oldest source playing this sound.
+ */
+void Sound::stop_oldest_voice() {
+
+  if (sources.empty()) {
+    return;
+  }
+
+  ALuint source = sources.front().source;
+  sources.pop_front();
+  alSourceStop(source);
+  alSourcei(source, AL_BUFFER, 0);
+  alDeleteSources(1, &source);
+}
+
 /**
  * \brief Updates the audio (music and sound) system.
  *
@@ -325,6 +603,8 @@ void Sound::set_volume(int volume) {
  */
 void Sound::update() {
 
+  ++current_tick;
+
   // update the playing sounds
   std::list<Sound*> sounds_to_remove;
   for (Sound* sound: current_sounds) {
@@ -347,24 +627,38 @@ void Sound::update() {
  */
 bool Sound::update_playing() {
 
-  // See if this sound is still playing.
-  if (sources.empty()) {
-    return false;
-  }
-
-  ALuint source = *sources.begin();
-  ALint status;
-  alGetSourcei(source, AL_SOURCE_STATE, &status);
+  // Remove the sources that are finished.
+  for (auto it = sources.begin(); it != sources.end(); ) {
+    ALuint source = it->source;
+    ALint status;
+    alGetSourcei(source, AL_SOURCE_STATE, &status);
 
-  if (status != AL_PLAYING) {
-    sources.pop_front();
-    alSourcei(source, AL_BUFFER, 0);
-    alDeleteSources(1, &source);
+    if (status != AL_PLAYING) {
+      it = sources.erase(it);
+      alSourcei(source, AL_BUFFER, 0);
+      alDeleteSources(1, &source);
+    }
+    else {
+      ++it;
+    }
   }
 
   return !sources.empty();
 }
 
+/**
+ * \brief Returns the name of the sound file.
+ * \return The file name, relative to the data directory.
+ */
+std::string Sound::get_file_name() const {
+
+  std::string file_name = std::string("sounds/" + id);
+  if (id.find(".") == std::string::npos) {
+    file_name += ".ogg";
+  }
+  return file_name;
+}
+
 /**
  * \brief Loads and decodes the sound into memory.
  */
@@ -374,13 +668,8 @@ void Sound::load() {
     Debug::error("Previous audio error not cleaned");
   }
 
-  std::string file_name = std::string("sounds/" + id);
-  if (id.find(".") == std::string::npos) {
-    file_name += ".ogg";
-  }
-
   // Create an OpenAL buffer with the sound decoded by the library.
-  buffer = decode_file(file_name);
+  buffer = decode_file(get_file_name());
 
   // buffer is now AL_NONE if there was an error.
 }
@@ -401,6 +690,25 @@ bool Sound::start() {
 
     if (buffer != AL_NONE) {
 
+      if (last_start_tick == current_tick && !sources.empty()) {
+        // Already started during this tick: don't start the same sound again.
+        ++num_coalesced;
+        if (coalescing_louder) {
+          const float gain = std::min(
+              1.0f + coalesced_gain_step * num_coalesced,
+              max_coalesced_gain
+          );
+          alSourcef(sources.back().source, AL_MAX_GAIN, max_coalesced_gain);
+          alSourcef(sources.back().source, AL_GAIN, volume * gain);
+        }
+        return true;
+      }
+
+      if (!make_room()) {
+        // Too many voices of sounds with a higher priority.
+        return false;
+      }
+
       // create a source
       ALuint source;
       alGenSources(1, &source);
@@ -417,7 +725,9 @@ bool Sound::start() {
         alDeleteSources(1, &source);
       }
       else {
-        sources.push_back(source);
+        sources.push_back({ source, ++last_voice_serial });
+        last_start_tick = current_tick;
+        num_coalesced = 0;
         current_sounds.remove(this); // to avoid duplicates
         current_sounds.push_back(this);
         alSourcePlay(source);
@@ -443,11 +753,26 @@ bool Sound::start() {
  */
 ALuint Sound::decode_file(const std::string& file_name) {
 
-  ALuint buffer = AL_NONE;
+  return create_buffer(file_name, decode_samples(file_name));
+}
+
+/**
+ * \brief Loads the specified sound file and decodes its content.
+ *
+ * This function does not use OpenAL and does not log anything,
+ * so it can be called from worker threads.
+ *
+ * \param file_name name of the file to open
+ * \return The decoded samples and an error message if there was a problem.
+ */
+Sound::DecodedSamples Sound::decode_samples(const std::string& file_name) {
+
+  DecodedSamples decoded;
+  decoded.sample_rate = 0;
 
   if (!QuestFiles::data_file_exists(file_name)) {
-    Debug::error(std::string("Cannot find sound file '") + file_name + "'");
-    return AL_NONE;
+    decoded.error = std::string("Cannot find sound file '") + file_name + "'";
+    return decoded;
   }
 
   // load the sound file
@@ -463,32 +788,24 @@ ALuint Sound::decode_file(const std::string& file_name) {
     std::ostringstream oss;
     oss << "Cannot load sound file '" << file_name
         << "' from memory: error " << error;
-    Debug::error(oss.str());
+    decoded.error = oss.str();
   }
   else {
 
     // read the encoded sound properties
     vorbis_info* info = ov_info(&file, -1);
-    ALsizei sample_rate = ALsizei(info->rate);
-
-    ALenum format = AL_NONE;
-    if (info->channels == 1) {
-      format = AL_FORMAT_MONO16;
-    }
-    else if (info->channels == 2) {
-      format = AL_FORMAT_STEREO16;
-    }
+    decoded.sample_rate = ALsizei(info->rate);
 
-    if (format == AL_NONE) {
-      Debug::error(std::string("Invalid audio format for sound file '")
-          + file_name + "'");
+    const int channels = info->channels;
+    if (channels != 1 && channels != 2) {
+      decoded.error = std::string("Invalid audio format for sound file '")
+          + file_name + "'";
     }
     else {
       // decode the sound with vorbisfile
-      std::vector<char> samples;
+      std::vector<char>& samples = decoded.samples;
       int bitstream;
       long bytes_read;
-      long total_bytes_read = 0;
       const int buffer_size = 16384;
       char samples_buffer[buffer_size];
       do {
@@ -497,11 +814,10 @@ ALuint Sound::decode_file(const std::string& file_name) {
           std::ostringstream oss;
           oss << "Error while decoding ogg chunk in sound file '"
               << file_name << "': " << bytes_read;
-          Debug::error(oss.str());
+          decoded.error = oss.str();
         }
         else {
-          total_bytes_read += bytes_read;
-          if (format == AL_FORMAT_STEREO16) {
+          if (channels == 2) {
             samples.insert(samples.end(), samples_buffer, samples_buffer + bytes_read);
           }
           else {
@@ -512,39 +828,57 @@ ALuint Sound::decode_file(const std::string& file_name) {
               samples.insert(samples.end(), samples_buffer + i, samples_buffer + i + 2);
               samples.insert(samples.end(), samples_buffer + i, samples_buffer + i + 2);
             }
-            total_bytes_read += bytes_read;
           }
         }
       }
       while (bytes_read > 0);
-
-      // copy the samples into an OpenAL buffer
-      alGenBuffers(1, &buffer);
-      if (alGetError() != AL_NO_ERROR) {
-          Debug::error("Failed to generate audio buffer");
-      }
-      alBufferData(buffer,
-          AL_FORMAT_STEREO16,
-          reinterpret_cast<ALshort*>(samples.data()),
-          ALsizei(total_bytes_read),
-          sample_rate);
-      ALenum error = alGetError();
-      if (error != AL_NO_ERROR) {
-        std::ostringstream oss;
-        oss << "Cannot copy the sound samples of '"
-            << file_name << "' into buffer " << buffer
-            << ": error " << error;
-        Debug::error(oss.str());
-        buffer = AL_NONE;
-      }
     }
     ov_clear(&file);
   }
 
   mem.data.clear();
 
-  return buffer;
+  return decoded;
 }
 
+/**
+ * \brief Copies decoded samples into a new OpenAL buffer.
+ * \param file_name Name of the sound file, for error messages.
+ * \param decoded The decoded samples.
+ * \return the buffer created, or AL_NONE if there was an error.
+ */
+ALuint Sound::create_buffer(const std::string& file_name, const DecodedSamples& decoded) {
+
+  if (!decoded.error.empty()) {
+    Debug::error(decoded.error);
+    if (decoded.samples.empty()) {
+      return AL_NONE;
+    }
+    // Keep what could be decoded before the error.
+  }
+
+  // copy the samples into an OpenAL buffer
+  ALuint buffer = AL_NONE;
+  alGenBuffers(1, &buffer);
+  if (alGetError() != AL_NO_ERROR) {
+      Debug::error("Failed to generate audio buffer");
+  }
+  alBufferData(buffer,
+      AL_FORMAT_STEREO16,
+      reinterpret_cast<const ALshort*>(decoded.samples.data()),
+      ALsizei(decoded.samples.size()),
+      decoded.sample_rate);
+  ALenum error = alGetError();
+  if (error != AL_NO_ERROR) {
+    std::ostringstream oss;
+    oss << "Cannot copy the sound samples of '"
+        << file_name << "' into buffer " << buffer
+        << ": error " << error;
+    Debug::error(oss.str());
+    buffer = AL_NONE;
+  }
+
+  return buffer;
 }
 
+}
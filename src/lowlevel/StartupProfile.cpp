@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Logger.h"
+#include "solarus/lowlevel/StartupProfile.h"
+#include "solarus/Arguments.h"
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace Solarus {
+
+namespace {
+
+/**
+ * \brief A phase that has finished.
+ */
+struct PhaseRecord {
+  std::string name;             /**< Name of the phase. */
+  double start;                 /**< Start date in milliseconds since the launch. */
+  double duration;              /**< Duration in milliseconds. */
+  bool main_thread;             /**< Whether it ran in the main thread. */
+};
+
+bool enabled = false;                       /**< Whether the startup is profiled. */
+bool finished = false;                      /**< Whether the report was already logged. */
+std::chrono::steady_clock::time_point
+    launch_date;                            /**< Start of the measures. */
+std::thread::id main_thread_id;             /**< Thread that initialized the profile. */
+std::mutex mutex;                           /**< Protects the records. */
+std::vector<PhaseRecord> records;           /**< Phases finished so far. */
+
+/**
+ * \brief Returns the number of milliseconds between two dates.
+ * \param from The first date.
+ * \param to The second date.
+ * \return The duration in milliseconds.
+ */
+double milliseconds(
+    const std::chrono::steady_clock::time_point& from,
+    const std::chrono::steady_clock::time_point& to
+) {
+  return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+}
+
+/**
+ * \brief Starts measuring a phase if the startup is profiled.
+ * \param name Name of the phase.
+ */
+StartupProfile::Phase::Phase(const std::string& name):
+  name(),
+  start() {
+
+  if (enabled && !finished) {
+    this->name = name;
+    start = std::chrono::steady_clock::now();
+  }
+}
+
+/**
+ * \brief Stops measuring the phase and records it.
+ */
+StartupProfile::Phase::~Phase() {
+
+  if (name.empty()) {
+    return;
+  }
+
+  const std::chrono::steady_clock::time_point& end = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(mutex);
+  records.push_back({
+      name,
+      milliseconds(launch_date, start),
+      milliseconds(start, end),
+      std::this_thread::get_id() == main_thread_id
+  });
+}
+
+/**
+ * \brief Starts profiling the startup if the -startup-profile option is set.
+ *
+ * This should be called as early as possible.
+ *
+ * \param args Command-line arguments.
+ */
+void StartupProfile::initialize(const Arguments& args) {
+
+  enabled = args.has_argument("-startup-profile");
+  finished = false;
+  launch_date = std::chrono::steady_clock::now();
+  main_thread_id = std::this_thread::get_id();
+  records.clear();
+}
+
+/**
+ * \brief Returns whether the startup is being profiled.
+ * \return \c true if phases are measured.
+ */
+bool StartupProfile::is_enabled() {
+  return enabled && !finished;
+}
+
+/**
+ * \brief Stops profiling and logs the report.
+ *
+ * Call this function when the first frame is drawn.
+ * Only the first call has an effect.
+ */
+void StartupProfile::notify_first_frame() {
+
+  if (!is_enabled()) {
+    return;
+  }
+
+  const double total = milliseconds(launch_date, std::chrono::steady_clock::now());
+  finished = true;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(1);
+  oss << "Startup profile (milliseconds since launch):";
+  for (const PhaseRecord& record: records) {
+    oss << "\n  " << std::left << std::setw(24) << record.name
+        << std::right << " start " << std::setw(8) << record.start
+        << "  duration " << std::setw(8) << record.duration
+        << (record.main_thread ? "" : "  (parallel)");
+  }
+  oss << "\n  " << std::left << std::setw(24) << "First frame"
+      << std::right << " at    " << std::setw(8) << total;
+  Logger::info(oss.str());
+
+  records.clear();
+}
+
+}
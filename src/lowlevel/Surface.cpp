@@ -20,11 +20,13 @@
 #include "solarus/lowlevel/Rectangle.h"
 #include "solarus/lowlevel/QuestFiles.h"
 #include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/SoftwareBlitter.h"
 #include "solarus/lowlevel/Video.h"
 #include "solarus/lowlevel/PixelFilter.h"
 #include "solarus/lua/LuaContext.h"
 #include "solarus/Transition.h"
 #include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
@@ -108,6 +110,8 @@ Surface::Surface(int width, int height):
   internal_texture(nullptr),
   internal_color(nullptr),
   is_rendered(false),
+  dirty_regions(),
+  palette_pixels(),
   opacity(255),
   width(width),
   height(height) {
@@ -132,11 +136,20 @@ Surface::Surface(SDL_Surface* internal_surface):
   internal_texture(nullptr),
   internal_color(nullptr),
   is_rendered(false),
+  dirty_regions(),
+  palette_pixels(),
   opacity(255) {
 
   width = internal_surface->w;
   height = internal_surface->h;
 
+  if (internal_surface->format->BytesPerPixel == 1 &&
+      internal_surface->format->palette != nullptr) {
+    // Keep palette images in 8 bits: they are expanded when drawn.
+    update_palette_pixels();
+    return;
+  }
+
   // Convert to the preferred pixel format.
   SDL_PixelFormat* pixel_format = Video::get_pixel_format();
   if (internal_surface->format->format != pixel_format->format) {
@@ -162,7 +175,7 @@ Surface::Surface(SDL_Surface* internal_surface):
  * \return The created surface.
  */
 SurfacePtr Surface::create(int width, int height) {
-  SurfacePtr surface = std::make_shared<Surface>(width, height);
+  SurfacePtr surface = make_intrusive<Surface>(width, height);
   return surface;
 }
 
@@ -172,7 +185,7 @@ SurfacePtr Surface::create(int width, int height) {
  * \return The created surface.
  */
 SurfacePtr Surface::create(const Size& size) {
-  SurfacePtr surface = std::make_shared<Surface>(size.width, size.height);
+  SurfacePtr surface = make_intrusive<Surface>(size.width, size.height);
   return surface;
 }
 
@@ -195,7 +208,7 @@ SurfacePtr Surface::create(const std::string& file_name,
     return nullptr;
   }
 
-  SurfacePtr surface = std::make_shared<Surface>(sdl_surface);
+  SurfacePtr surface = make_intrusive<Surface>(sdl_surface);
   return surface;
 }
 
@@ -244,6 +257,12 @@ SDL_Surface* Surface::get_surface_from_file(
     return software_surface;
   }
 
+  if (software_surface->format->BytesPerPixel == 1 &&
+      software_surface->format->palette != nullptr) {
+    // Palette image: keep it indexed to save memory and bandwidth.
+    return software_surface;
+  }
+
   // Convert to the preferred pixel format.
   uint8_t opacity;
   SDL_GetSurfaceAlphaMod(software_surface, &opacity);
@@ -288,9 +307,127 @@ void Surface::create_texture_from_surface() {
     SDL_SetTextureBlendMode(internal_texture.get(), get_sdl_blend_mode());
 
     // Copy the pixels of the software surface to the GPU texture.
-    SDL_UpdateTexture(internal_texture.get(), nullptr, internal_surface->pixels, internal_surface->pitch);
+    if (is_indexed()) {
+      const Rectangle region(get_size());
+      std::vector<uint32_t> pixels(width * height);
+      SoftwareBlitter::expand_indexed(*internal_surface, palette_pixels.data(), region, pixels.data(), width * 4);
+      SDL_UpdateTexture(internal_texture.get(), nullptr, pixels.data(), width * 4);
+    }
+    else {
+      SDL_UpdateTexture(internal_texture.get(), nullptr, internal_surface->pixels, internal_surface->pitch);
+    }
     SDL_GetSurfaceAlphaMod(internal_surface.get(), &opacity);
+    dirty_regions.clear();
+  }
+}
+
+/**
+ * \brief Copies the modified regions of the software surface to the
+ * hardware texture.
+ */
+void Surface::update_texture() {
+
+  if (is_indexed()) {
+    std::vector<uint32_t> pixels;
+    for (const Rectangle& region : dirty_regions) {
+      pixels.resize(region.get_width() * region.get_height());
+      SoftwareBlitter::expand_indexed(
+          *internal_surface, palette_pixels.data(), region, pixels.data(), region.get_width() * 4);
+      SDL_UpdateTexture(
+          internal_texture.get(),
+          region.get_internal_rect(),
+          pixels.data(),
+          region.get_width() * 4
+      );
+    }
+    dirty_regions.clear();
+    return;
+  }
+
+  const int bytes_per_pixel = internal_surface->format->BytesPerPixel;
+  const uint8_t* pixels = static_cast<const uint8_t*>(internal_surface->pixels);
+  for (const Rectangle& region : dirty_regions) {
+    const uint8_t* region_pixels = pixels
+        + region.get_y() * internal_surface->pitch
+        + region.get_x() * bytes_per_pixel;
+    SDL_UpdateTexture(
+        internal_texture.get(),
+        region.get_internal_rect(),
+        region_pixels,
+        internal_surface->pitch
+    );
   }
+  dirty_regions.clear();
+}
+
+/**
+ * \brief Records that a rectangle of this surface was modified.
+ *
+ * Only the modified regions are uploaded to the texture at the next
+ * rendering.
+ * Close regions are merged, and everything is uploaded at once when the
+ * modified area gets large.
+ *
+ * \param where The modified rectangle. It may exceed the surface.
+ */
+void Surface::mark_dirty(const Rectangle& where) {
+
+  is_rendered = false;
+
+  const Rectangle surface_box(get_size());
+  if (!where.overlaps(surface_box)) {
+    return;
+  }
+  Rectangle region = where.get_intersection(surface_box);
+
+  if (dirty_regions.size() == 1 && dirty_regions.front() == surface_box) {
+    // Already fully modified.
+    return;
+  }
+
+  // Merge with the overlapping regions.
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (auto it = dirty_regions.begin(); it != dirty_regions.end(); ++it) {
+      if (it->overlaps(region)) {
+        region |= *it;
+        dirty_regions.erase(it);
+        merged = true;
+        break;
+      }
+    }
+  }
+  dirty_regions.push_back(region);
+
+  // Too many small uploads cost more than a big one.
+  constexpr size_t max_dirty_regions = 8;
+  if (dirty_regions.size() > max_dirty_regions) {
+    Rectangle bounding_box = dirty_regions.front();
+    for (const Rectangle& dirty_region : dirty_regions) {
+      bounding_box |= dirty_region;
+    }
+    dirty_regions.clear();
+    dirty_regions.push_back(bounding_box);
+  }
+
+  int dirty_area = 0;
+  for (const Rectangle& dirty_region : dirty_regions) {
+    dirty_area += dirty_region.get_width() * dirty_region.get_height();
+  }
+  if (dirty_area * 2 > width * height) {
+    mark_all_dirty();
+  }
+}
+
+/**
+ * \brief Records that the whole surface was modified.
+ */
+void Surface::mark_all_dirty() {
+
+  is_rendered = false;
+  dirty_regions.clear();
+  dirty_regions.push_back(Rectangle(get_size()));
 }
 
 /**
@@ -388,6 +525,25 @@ std::string Surface::get_pixels() const {
     return oss.str();
   }
 
+  if (is_indexed()) {
+    // Expand the palette.
+    const SDL_PixelFormat* format = Video::get_pixel_format();
+    std::string pixels;
+    pixels.reserve(num_pixels * 4);
+    for (int y = 0; y < height; ++y) {
+      const uint8_t* row = static_cast<const uint8_t*>(internal_surface->pixels) + y * internal_surface->pitch;
+      for (int x = 0; x < width; ++x) {
+        uint8_t r, g, b, a;
+        SDL_GetRGBA(palette_pixels[row[x]], format, &r, &g, &b, &a);
+        pixels += r;
+        pixels += g;
+        pixels += b;
+        pixels += a;
+      }
+    }
+    return pixels;
+  }
+
   if (internal_surface->format->format == SDL_PIXELFORMAT_ABGR8888) {
     // No conversion needed.
     const char* buffer = static_cast<const char*>(internal_surface->pixels);
@@ -408,6 +564,229 @@ std::string Surface::get_pixels() const {
   return std::string(buffer, num_pixels * 4);
 }
 
+/**
+ * \brief Copies the pixels of this surface into a buffer.
+ *
+ * Pixels are written row by row without padding, in the video pixel format.
+ * Unlike get_pixels(), this does not allocate anything.
+ *
+ * \param pixels Destination buffer of get_width() * get_height() pixels.
+ * \return \c false if the pixels are not available in RAM.
+ */
+bool Surface::read_pixels(uint32_t* pixels) const {
+
+  if (!software_destination &&
+      Video::is_acceleration_enabled()) {
+    // The surface is in GPU.
+    return false;
+  }
+
+  if (internal_surface == nullptr) {
+    // No surface: this may be a color.
+    const Color& color = internal_color != nullptr ? *internal_color : Color::transparent;
+    std::fill(pixels, pixels + width * height, get_color_value(color));
+    return true;
+  }
+
+  if (is_indexed()) {
+    SoftwareBlitter::expand_indexed(
+        *internal_surface, palette_pixels.data(), Rectangle(get_size()), pixels, width * 4);
+    return true;
+  }
+
+  if (internal_surface->format->format != Video::get_pixel_format()->format) {
+    return false;
+  }
+
+  const uint8_t* src = static_cast<const uint8_t*>(internal_surface->pixels);
+  for (int y = 0; y < height; ++y) {
+    std::memcpy(pixels + y * width, src + y * internal_surface->pitch, width * 4);
+  }
+  return true;
+}
+
+/**
+ * \brief Returns whether all pixels of a rectangle of this surface are
+ * fully opaque.
+ *
+ * Drawing such a region with the normal blend mode completely hides
+ * what was below it.
+ * Only software surfaces can be inspected: other surfaces are considered
+ * non-opaque.
+ *
+ * \param region The rectangle to check, in surface coordinates.
+ * \return \c true if the region is inside the surface and fully opaque.
+ */
+bool Surface::is_region_opaque(const Rectangle& region) const {
+
+  if (internal_surface == nullptr ||
+      opacity != 255 ||
+      (get_blend_mode() != BlendMode::BLEND && get_blend_mode() != BlendMode::NONE)) {
+    return false;
+  }
+
+  if (region.is_flat() ||
+      region.get_x() < 0 ||
+      region.get_y() < 0 ||
+      region.get_x() + region.get_width() > width ||
+      region.get_y() + region.get_height() > height) {
+    return false;
+  }
+
+  // Palette colors are already in the video format, with the color key
+  // made transparent.
+  const SDL_PixelFormat* format = is_indexed() ? Video::get_pixel_format() : internal_surface->format;
+  uint32_t colorkey;
+  const bool with_colorkey = !is_indexed() &&
+      SDL_GetColorKey(internal_surface.get(), &colorkey) == 0;
+  for (int y = region.get_y(); y < region.get_y() + region.get_height(); ++y) {
+    for (int x = region.get_x(); x < region.get_x() + region.get_width(); ++x) {
+      const uint32_t pixel = get_pixel(y * width + x);
+      if (with_colorkey && pixel == colorkey) {
+        return false;
+      }
+      if (format->Amask != 0 && (pixel & format->Amask) != format->Amask) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * \brief Returns whether this surface stores 8-bit palette indexes.
+ *
+ * Images with a palette are kept in this format until something is drawn
+ * on them.
+ *
+ * \return \c true if this is an indexed surface.
+ */
+bool Surface::is_indexed() const {
+  return !palette_pixels.empty();
+}
+
+/**
+ * \brief Returns the palette of an indexed surface.
+ *
+ * The color key of the image, if any, is returned as a transparent color.
+ *
+ * \return The colors of the palette, or an empty list if this surface is not
+ * indexed.
+ */
+std::vector<Color> Surface::get_palette() const {
+
+  std::vector<Color> colors;
+  if (!is_indexed()) {
+    return colors;
+  }
+
+  const SDL_Palette* palette = internal_surface->format->palette;
+  const SDL_PixelFormat* format = Video::get_pixel_format();
+  for (int i = 0; i < palette->ncolors; ++i) {
+    uint8_t r, g, b, a;
+    SDL_GetRGBA(palette_pixels[i], format, &r, &g, &b, &a);
+    colors.emplace_back(r, g, b, a);
+  }
+  return colors;
+}
+
+/**
+ * \brief Changes colors of the palette of an indexed surface.
+ *
+ * Pixels are not touched: only the palette changes.
+ * The color key of the image, if any, stays transparent.
+ *
+ * \param colors The new colors, starting from the first palette entry.
+ * Extra colors are ignored.
+ * \return \c false if this surface is not indexed.
+ */
+bool Surface::set_palette(const std::vector<Color>& colors) {
+
+  if (!is_indexed()) {
+    return false;
+  }
+
+  SDL_Palette* palette = internal_surface->format->palette;
+  std::vector<SDL_Color> sdl_colors;
+  for (const Color& color : colors) {
+    if (static_cast<int>(sdl_colors.size()) >= palette->ncolors) {
+      break;
+    }
+    SDL_Color sdl_color;
+    color.get_components(sdl_color.r, sdl_color.g, sdl_color.b, sdl_color.a);
+    sdl_colors.push_back(sdl_color);
+  }
+
+  SDL_SetPaletteColors(palette, sdl_colors.data(), 0, static_cast<int>(sdl_colors.size()));
+  update_palette_pixels();
+  mark_all_dirty();  // The texture has to be updated if any.
+  return true;
+}
+
+/**
+ * \brief Updates the palette entries of an indexed surface in the video
+ * pixel format.
+ */
+void Surface::update_palette_pixels() {
+
+  const SDL_Palette* palette = internal_surface->format->palette;
+  const SDL_PixelFormat* format = Video::get_pixel_format();
+  uint32_t colorkey;
+  const bool with_colorkey = SDL_GetColorKey(internal_surface.get(), &colorkey) == 0;
+
+  palette_pixels.assign(256, SDL_MapRGBA(format, 0, 0, 0, 0));
+  for (int i = 0; i < palette->ncolors && i < 256; ++i) {
+    const SDL_Color& color = palette->colors[i];
+    const uint8_t alpha = (with_colorkey && colorkey == static_cast<uint32_t>(i)) ? 0 : color.a;
+    palette_pixels[i] = SDL_MapRGBA(format, color.r, color.g, color.b, alpha);
+  }
+}
+
+/**
+ * \brief Converts an indexed software surface to the video pixel format.
+ *
+ * This is necessary before drawing on it.
+ */
+void Surface::convert_software_surface() {
+
+  if (!is_indexed()) {
+    return;
+  }
+
+  SDL_PixelFormat* format = Video::get_pixel_format();
+  SDL_Surface_UniquePtr converted_surface(
+      SDL_CreateRGBSurface(
+          0,
+          width,
+          height,
+          32,
+          format->Rmask,
+          format->Gmask,
+          format->Bmask,
+          format->Amask
+      )
+  );
+  Debug::check_assertion(converted_surface != nullptr,
+      std::string("Failed to convert software surface: ") + SDL_GetError());
+
+  SoftwareBlitter::expand_indexed(
+      *internal_surface,
+      palette_pixels.data(),
+      Rectangle(get_size()),
+      static_cast<uint32_t*>(converted_surface->pixels),
+      converted_surface->pitch
+  );
+
+  uint8_t alpha_mod;
+  SDL_GetSurfaceAlphaMod(internal_surface.get(), &alpha_mod);
+  SDL_SetSurfaceAlphaMod(converted_surface.get(), alpha_mod);
+  SDL_SetSurfaceBlendMode(converted_surface.get(), get_sdl_blend_mode());
+
+  internal_surface = std::move(converted_surface);
+  palette_pixels.clear();
+  // The pixels did not change: the texture if any is still valid.
+}
+
 /**
  * When this surface is used as the destination of a drawing operation,
  * returns whether the drawing operation is performed in RAM or by the GPU.
@@ -481,7 +860,7 @@ void Surface::create_software_surface() {
       std::string("Failed to create software surface: ") + SDL_GetError());
 
   SDL_SetSurfaceBlendMode(internal_surface.get(), get_sdl_blend_mode());
-  is_rendered = false;
+  mark_all_dirty();
 }
 
 /**
@@ -502,11 +881,13 @@ void Surface::clear() {
 
   if (internal_surface != nullptr) {
     if (software_destination) {
+      convert_software_surface();
       SDL_FillRect(
           internal_surface.get(),
           nullptr,
           get_color_value(Color::transparent)
       );
+      mark_all_dirty();
     }
     else {
       internal_surface = nullptr;
@@ -532,12 +913,13 @@ void Surface::clear(const Rectangle& where) {
     return;
   }
 
+  convert_software_surface();
   SDL_FillRect(
       internal_surface.get(),
       where.get_internal_rect(),
       get_color_value(Color::transparent)
   );
-  is_rendered = false;  // The surface has changed.
+  mark_dirty(where);  // The surface has changed.
 }
 
 /**
@@ -634,6 +1016,9 @@ void Surface::raw_draw_region(
     if (dst_surface.internal_surface == nullptr) {
       dst_surface.create_software_surface();
     }
+    else {
+      dst_surface.convert_software_surface();
+    }
 
     // First, draw subsurfaces if any.
     // They can exist if the video mode recently switched from an accelerated
@@ -666,16 +1051,27 @@ void Surface::raw_draw_region(
     if (this->internal_surface != nullptr) {
       // The source surface is not empty: draw it onto the destination.
 
-      SDL_SetSurfaceBlendMode(
-            this->internal_surface.get(),
-            get_sdl_blend_mode()
-      );
-      SDL_BlitSurface(
-          this->internal_surface.get(),
-          region.get_internal_rect(),
-          dst_surface.internal_surface.get(),
-          Rectangle(dst_position).get_internal_rect()
+      const bool done = SoftwareBlitter::blit(
+          *this->internal_surface,
+          region,
+          *dst_surface.internal_surface,
+          dst_position,
+          get_blend_mode(),
+          is_indexed() ? palette_pixels.data() : nullptr
       );
+      if (!done) {
+        // Unusual pixel format: let SDL do it.
+        SDL_SetSurfaceBlendMode(
+              this->internal_surface.get(),
+              get_sdl_blend_mode()
+        );
+        SDL_BlitSurface(
+            this->internal_surface.get(),
+            region.get_internal_rect(),
+            dst_surface.internal_surface.get(),
+            Rectangle(dst_position).get_internal_rect()
+        );
+      }
     }
     else if (internal_color != nullptr) { // No internal surface to draw: this may be a color.
 
@@ -691,7 +1087,12 @@ void Surface::raw_draw_region(
             get_color_value(*internal_color)
         );
       }
-      else {
+      else if (!SoftwareBlitter::fill(
+          *dst_surface.internal_surface,
+          Rectangle(dst_position, region.get_size()),
+          *internal_color,
+          get_blend_mode()
+      )) {
         // Fill with semi-transparent pixels: perform alpha-blending.
         create_software_surface();
         SDL_FillRect(
@@ -707,17 +1108,18 @@ void Surface::raw_draw_region(
         );
       }
     }
+
+    dst_surface.mark_dirty(Rectangle(dst_position, region.get_size()));
   }
   else {
     // The destination is a GPU surface (a texture).
     // Do not draw anything, just store the operation in the tree instead.
     // The actual drawing will be done at rendering time in GPU.
 
-    SurfacePtr src_surface = std::static_pointer_cast<Surface>(shared_from_this());
+    SurfacePtr src_surface(this);
     dst_surface.add_subsurface(src_surface, region, dst_position);
+    dst_surface.is_rendered = false;
   }
-
-  dst_surface.is_rendered = false;
 }
 
 /**
@@ -752,6 +1154,9 @@ void Surface::apply_pixel_filter(
     return;
   }
 
+  convert_software_surface();
+  src_internal_surface = this->internal_surface.get();
+
   Debug::check_assertion(dst_internal_surface != nullptr,
       "Missing software destination surface for pixel filter");
 
@@ -767,7 +1172,7 @@ void Surface::apply_pixel_filter(
   SDL_UnlockSurface(src_internal_surface);
 
   // The destination surface has changed.
-  dst_surface.is_rendered = false;
+  dst_surface.mark_all_dirty();
 }
 
 /**
@@ -816,12 +1221,7 @@ void Surface::render(
     else if (
         (software_destination || !Video::is_acceleration_enabled())
          && !is_rendered) {
-      SDL_UpdateTexture(
-          internal_texture.get(),
-          nullptr,
-          internal_surface->pixels,
-          internal_surface->pitch
-      );
+      update_texture();
       SDL_GetSurfaceAlphaMod(internal_surface.get(), &this->opacity);
     }
   }
@@ -897,6 +1297,8 @@ Surface& Surface::get_transition_surface() {
  *
  * The pixel format is preserved: if it is lower than 32 bpp, then the unused
  * upper bits of the value are is padded with zeros.
+ * For indexed surfaces, the palette color is returned in the video pixel
+ * format.
  *
  * \param index Index of the pixel to get.
  * \return The value of this pixel.
@@ -913,8 +1315,10 @@ uint32_t Surface::get_pixel(int index) const {
 
     case 1:
       {
+        // Rows of 8-bit surfaces are padded.
         uint8_t* pixels = static_cast<uint8_t*>(internal_surface->pixels);
-        return pixels[index];
+        const uint8_t pixel = pixels[(index / width) * internal_surface->pitch + index % width];
+        return is_indexed() ? palette_pixels[pixel] : pixel;
       }
 
     case 4:
@@ -954,6 +1358,11 @@ uint32_t Surface::get_pixel(int index) const {
 bool Surface::is_pixel_transparent(int index) const {
 
   uint32_t pixel = get_pixel(index);
+  if (is_indexed()) {
+    // The palette already makes the color key transparent.
+    return (pixel & Video::get_pixel_format()->Amask) == 0;
+  }
+
   uint32_t colorkey;
   bool with_colorkey = SDL_GetColorKey(internal_surface.get(), &colorkey) == 0;
 
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Symbol.h"
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+
+namespace Solarus {
+
+/**
+ * \brief Global table of interned strings.
+ */
+struct Symbol::Table {
+  std::mutex mutex;           /**< Protects the table. */
+  std::unordered_map<std::string, Entry>
+      entries;                /**< Entry of each interned string. */
+};
+
+const Symbol::Entry Symbol::empty_entry = { "", std::hash<std::string>()("") };
+
+/**
+ * \brief Returns the global table of interned strings.
+ *
+ * The table is created on first use so that symbols can be
+ * initialized statically.
+ *
+ * \return The table.
+ */
+Symbol::Table& Symbol::get_table() {
+
+  static Table table;
+  return table;
+}
+
+/**
+ * \brief Returns the symbol of a string only if it was already interned.
+ *
+ * Unlike the constructor, this never adds the string to the table.
+ * This is useful to look up a key without keeping unknown strings forever.
+ *
+ * \param[in] name The string to look for.
+ * \param[out] symbol The symbol of this string if it exists.
+ * \return \c true if the string was already interned.
+ */
+bool Symbol::find(const std::string& name, Symbol& symbol) {
+
+  if (name.empty()) {
+    symbol = Symbol();
+    return true;
+  }
+
+  Table& table = get_table();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  const auto& it = table.entries.find(name);
+  if (it == table.entries.end()) {
+    return false;
+  }
+  symbol = Symbol(&it->second);
+  return true;
+}
+
+/**
+ * \brief Returns the unique entry of a string, creating it if necessary.
+ * \param name The string.
+ * \return The entry of this string.
+ */
+const Symbol::Entry* Symbol::intern(const std::string& name) {
+
+  if (name.empty()) {
+    return &empty_entry;
+  }
+
+  Table& table = get_table();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  const auto& it = table.entries.find(name);
+  if (it != table.entries.end()) {
+    return &it->second;
+  }
+
+  // Elements of an unordered map never move: the entry can be shared.
+  const Entry entry = { name, std::hash<std::string>()(name) };
+  return &table.entries.emplace(name, entry).first->second;
+}
+
+/**
+ * \brief Writes the string of a symbol to an output stream.
+ * \param stream The stream.
+ * \param symbol A symbol.
+ * \return The stream.
+ */
+std::ostream& operator<<(std::ostream& stream, const Symbol& symbol) {
+
+  stream << symbol.str();
+  return stream;
+}
+
+}
@@ -20,10 +20,13 @@
 #include "solarus/lowlevel/InputEvent.h"
 #include "solarus/lowlevel/Random.h"
 #include "solarus/lowlevel/Sound.h"
+#include "solarus/lowlevel/StartupProfile.h"
 #include "solarus/lowlevel/System.h"
 #include "solarus/lowlevel/Video.h"
+#include "solarus/lowlevel/WorkerPool.h"
 #include "solarus/Sprite.h"
 #include <SDL.h>
+#include <future>
 #ifdef SOLARUS_USE_APPLE_POOL
 #  include "lowlevel/apple/AppleInterface.h"
 #endif
@@ -38,29 +41,48 @@ uint32_t System::ticks = 0;
  *
  * Initializes the audio system, the video system,
  * the data file system, etc.
+ * The audio system does not depend on the others and is initialized in
+ * a separate thread meanwhile.
  *
  * \param args Command-line arguments.
  */
 void System::initialize(const Arguments& args) {
 
   // initialize SDL
-  SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK);
+  {
+    StartupProfile::Phase phase("SDL");
+    SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK);
+  }
   initial_time = get_real_time();
   ticks = 0;
 
   // audio
-  Sound::initialize(args);
+  std::future<void> audio = std::async(std::launch::async, [&args]() {
+    StartupProfile::Phase phase("Audio");
+    Sound::initialize(args);
+  });
 
   // input
-  InputEvent::initialize();
+  {
+    StartupProfile::Phase phase("Input");
+    InputEvent::initialize();
+  }
 
   // random number generator
   Random::initialize();
 
+  // worker threads
+  WorkerPool::initialize();
+
   // video
-  Video::initialize(args);
+  {
+    StartupProfile::Phase phase("Video");
+    Video::initialize(args);
+  }
   FontResource::initialize();
   Sprite::initialize();
+
+  audio.get();
 }
 
 /**
@@ -70,6 +92,7 @@ void System::initialize(const Arguments& args) {
  */
 void System::quit() {
 
+  WorkerPool::quit();
   Random::quit();
   InputEvent::quit();
   Sound::quit();
@@ -27,7 +27,6 @@
 #include "solarus/lua/LuaTools.h"
 #include "solarus/Transition.h"
 #include <lua.hpp>
-#include <memory>
 
 namespace Solarus {
 
@@ -524,7 +523,7 @@ void TextSurface::rebuild_ttf() {
       + SDL_GetError()
   );
 
-  surface = std::make_shared<Surface>(internal_surface);
+  surface = make_intrusive<Surface>(internal_surface);
 }
 
 /**
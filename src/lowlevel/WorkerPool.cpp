@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/WorkerPool.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Solarus {
+
+namespace {
+
+/**
+ * \brief Maximum number of worker threads created in addition to the main one.
+ */
+constexpr int max_workers = 7;
+
+std::vector<std::thread> workers;         /**< The worker threads. */
+std::mutex mutex;                         /**< Protects the job state below. */
+std::condition_variable job_posted;       /**< Signals workers that a job is available. */
+std::condition_variable job_finished;     /**< Signals the caller that all workers are done. */
+uint64_t job_generation = 0;              /**< Incremented each time a job is posted. */
+int num_workers_done = 0;                 /**< Workers that finished the current job. */
+bool stopping = false;                    /**< Whether workers should exit. */
+
+const WorkerPool::RangeFunction*
+    job_function = nullptr;               /**< Function of the current job. */
+int job_count = 0;                        /**< Number of items of the current job. */
+int job_chunk_size = 1;                   /**< Number of items taken at once by a thread. */
+std::atomic<int> job_next_index(0);       /**< Next item not yet taken by a thread. */
+
+/**
+ * \brief Processes chunks of the current job until there is nothing left.
+ * \param function The function to call on each chunk.
+ * \param count Number of items of the job.
+ * \param chunk_size Number of items in a chunk.
+ */
+void run_chunks(const WorkerPool::RangeFunction& function, int count, int chunk_size) {
+
+  while (true) {
+    const int begin = job_next_index.fetch_add(chunk_size);
+    if (begin >= count) {
+      return;
+    }
+    function(begin, std::min(begin + chunk_size, count));
+  }
+}
+
+/**
+ * \brief Main function of each worker thread.
+ */
+void worker_main() {
+
+  uint64_t last_generation = 0;
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    job_posted.wait(lock, [&last_generation]() {
+      return stopping || job_generation != last_generation;
+    });
+    if (stopping) {
+      return;
+    }
+    last_generation = job_generation;
+    const WorkerPool::RangeFunction& function = *job_function;
+    const int count = job_count;
+    const int chunk_size = job_chunk_size;
+
+    lock.unlock();
+    run_chunks(function, count, chunk_size);
+    lock.lock();
+
+    ++num_workers_done;
+    if (num_workers_done == static_cast<int>(workers.size())) {
+      job_finished.notify_one();
+    }
+  }
+}
+
+}
+
+/**
+ * \brief Starts the worker threads.
+ *
+ * One thread is created for each additional hardware thread available,
+ * up to a small maximum.
+ */
+void WorkerPool::initialize() {
+
+  const int hardware_threads = static_cast<int>(std::thread::hardware_concurrency());
+  const int num_workers = std::min(std::max(hardware_threads - 1, 0), max_workers);
+
+  stopping = false;
+  job_generation = 0;
+  for (int i = 0; i < num_workers; ++i) {
+    workers.emplace_back(worker_main);
+  }
+}
+
+/**
+ * \brief Stops and joins the worker threads.
+ */
+void WorkerPool::quit() {
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  job_posted.notify_all();
+  for (std::thread& worker: workers) {
+    worker.join();
+  }
+  workers.clear();
+}
+
+/**
+ * \brief Returns the number of worker threads, not counting the main one.
+ * \return The number of worker threads.
+ */
+int WorkerPool::get_num_workers() {
+  return static_cast<int>(workers.size());
+}
+
+/**
+ * \brief Calls a function on all items of a range, possibly in parallel.
+ *
+ * The range [0, count[ is split into chunks processed by the worker threads
+ * and by the calling thread.
+ * If the range is too small to be worth it, or if there is no worker
+ * thread, everything is done in the calling thread.
+ *
+ * \param count Number of items to process.
+ * \param min_chunk_size Minimum number of items given to a thread at once.
+ * \param function The function to call on chunks of items.
+ * It must not throw exceptions.
+ */
+void WorkerPool::parallel_for(
+    int count,
+    int min_chunk_size,
+    const RangeFunction& function
+) {
+  if (count <= 0) {
+    return;
+  }
+
+  min_chunk_size = std::max(min_chunk_size, 1);
+  const int num_threads = get_num_workers() + 1;
+  if (num_threads == 1 || count < 2 * min_chunk_size) {
+    // Not worth waking up the workers.
+    function(0, count);
+    return;
+  }
+
+  // Split the work so that each thread gets several chunks for balancing.
+  const int chunk_size = std::max(min_chunk_size, count / (num_threads * 4));
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    job_function = &function;
+    job_count = count;
+    job_chunk_size = chunk_size;
+    job_next_index = 0;
+    num_workers_done = 0;
+    ++job_generation;
+  }
+  job_posted.notify_all();
+
+  run_chunks(function, count, chunk_size);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  job_finished.wait(lock, []() {
+    return num_workers_done == static_cast<int>(workers.size());
+  });
+  job_function = nullptr;
+}
+
+}
+
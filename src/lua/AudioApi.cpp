@@ -38,6 +38,16 @@ void LuaContext::register_audio_module() {
       { "set_sound_volume", audio_api_set_sound_volume },
       { "play_sound", audio_api_play_sound },
       { "preload_sounds", audio_api_preload_sounds },
+      { "get_max_sound_voices", audio_api_get_max_sound_voices },
+      { "set_max_sound_voices", audio_api_set_max_sound_voices },
+      { "get_max_voices_per_sound", audio_api_get_max_voices_per_sound },
+      { "set_max_voices_per_sound", audio_api_set_max_voices_per_sound },
+      { "get_sound_max_voices", audio_api_get_sound_max_voices },
+      { "set_sound_max_voices", audio_api_set_sound_max_voices },
+      { "get_sound_priority", audio_api_get_sound_priority },
+      { "set_sound_priority", audio_api_set_sound_priority },
+      { "is_sound_coalescing_louder", audio_api_is_sound_coalescing_louder },
+      { "set_sound_coalescing_louder", audio_api_set_sound_coalescing_louder },
       { "get_music_volume", audio_api_get_music_volume },
       { "set_music_volume", audio_api_set_music_volume },
       { "play_music", audio_api_play_music },
@@ -49,6 +59,9 @@ void LuaContext::register_audio_module() {
       { "set_music_channel_volume", audio_api_set_music_channel_volume },
       { "get_music_tempo", audio_api_get_music_tempo },
       { "set_music_tempo", audio_api_set_music_tempo },
+      { "preload_music", audio_api_preload_music },
+      { "get_music_crossfade_duration", audio_api_get_music_crossfade_duration },
+      { "set_music_crossfade_duration", audio_api_set_music_crossfade_duration },
       { nullptr, nullptr }
   };
   register_functions(audio_module_name, functions);
@@ -90,9 +103,9 @@ int LuaContext::audio_api_set_sound_volume(lua_State* l) {
 int LuaContext::audio_api_play_sound(lua_State* l) {
 
   return LuaTools::exception_boundary_handle(l, [&] {
-    const std::string& sound_id = LuaTools::check_string(l, 1);
+    const Symbol& sound_id = LuaTools::check_symbol(l, 1);
 
-    if (!Sound::exists(sound_id)) {
+    if (!Sound::exists(sound_id.str())) {
       LuaTools::error(l, std::string("No such sound: '") + sound_id + "'");
     }
     Sound::play(sound_id);
@@ -114,6 +127,175 @@ int LuaContext::audio_api_preload_sounds(lua_State* l) {
   });
 }
 
+/**
+ * \brief Implementation of sol.audio.get_max_sound_voices().
+ * \param l the Lua context that is calling this function
+ * \return number of values to return to Lua
+ */
+int LuaContext::audio_api_get_max_sound_voices(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    lua_pushinteger(l, Sound::get_max_voices());
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of sol.audio.set_max_sound_voices().
+ * \param l the Lua context that is calling this function
+ * \return number of values to return to Lua
+ */
+int LuaContext::audio_api_set_max_sound_voices(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    int max_voices = LuaTools::check_int(l, 1);
+
+    if (max_voices < 0) {
+      LuaTools::arg_error(l, 1, "Invalid number of voices: must be positive or 0");
+    }
+    Sound::set_max_voices(max_voices);
+
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of sol.audio.get_max_voices_per_sound().
+ * \param l the Lua context that is calling this function
+ * \return number of values to return to Lua
+ */
+int LuaContext::audio_api_get_max_voices_per_sound(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    lua_pushinteger(l, Sound::get_default_max_voices_per_sound());
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of sol.audio.set_max_voices_per_sound().
+ * \param l the Lua context that is calling this function
+ * \return number of values to return to Lua
+ */
+int LuaContext::audio_api_set_max_voices_per_sound(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    int max_voices = LuaTools::check_int(l, 1);
+
+    if (max_voices < 0) {
+      LuaTools::arg_error(l, 1, "Invalid number of voices: must be positive or 0");
+    }
+    Sound::set_default_max_voices_per_sound(max_voices);
+
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of sol.audio.get_sound_max_voices().
+ * \param l the Lua context that is calling this function
+ * \return number of values to return to Lua
+ */
+int LuaContext::audio_api_get_sound_max_voices(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const std::string& sound_id = LuaTools::check_string(l, 1);
+
+    lua_pushinteger(l, Sound::get_sound_max_voices(sound_id));
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of sol.audio.set_sound_max_voices().
+ * \param l the Lua context that is calling this function
+ * \return number of values to return to Lua
+ */
+int LuaContext::audio_api_set_sound_max_voices(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const std::string& sound_id = LuaTools::check_string(l, 1);
+    int max_voices = -1;  // Use the default value.
+    if (!lua_isnil(l, 2)) {
+      max_voices = LuaTools::check_int(l, 2);
+      if (max_voices < 0) {
+        LuaTools::arg_error(l, 2, "Invalid number of voices: must be positive or 0");
+      }
+    }
+
+    if (!Sound::exists(sound_id)) {
+      LuaTools::error(l, std::string("No such sound: '") + sound_id + "'");
+    }
+    Sound::set_sound_max_voices(sound_id, max_voices);
+
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of sol.audio.get_sound_priority().
+ * \param l the Lua context that is calling this function
+ * \return number of values to return to Lua
+ */
+int LuaContext::audio_api_get_sound_priority(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const std::string& sound_id = LuaTools::check_string(l, 1);
+
+    lua_pushinteger(l, Sound::get_sound_priority(sound_id));
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of sol.audio.set_sound_priority().
+ * \param l the Lua context that is calling this function
+ * \return number of values to return to Lua
+ */
+int LuaContext::audio_api_set_sound_priority(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const std::string& sound_id = LuaTools::check_string(l, 1);
+    int priority = LuaTools::check_int(l, 2);
+
+    if (!Sound::exists(sound_id)) {
+      LuaTools::error(l, std::string("No such sound: '") + sound_id + "'");
+    }
+    Sound::set_sound_priority(sound_id, priority);
+
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of sol.audio.is_sound_coalescing_louder().
+ * \param l the Lua context that is calling this function
+ * \return number of values to return to Lua
+ */
+int LuaContext::audio_api_is_sound_coalescing_louder(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    lua_pushboolean(l, Sound::is_coalescing_louder());
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of sol.audio.set_sound_coalescing_louder().
+ * \param l the Lua context that is calling this function
+ * \return number of values to return to Lua
+ */
+int LuaContext::audio_api_set_sound_coalescing_louder(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    bool louder = LuaTools::opt_boolean(l, 1, true);
+
+    Sound::set_coalescing_louder(louder);
+
+    return 0;
+  });
+}
+
 /**
  * \brief Implementation of sol.audio.get_music_volume().
  * \param l the Lua context that is calling this function
@@ -347,5 +529,59 @@ int LuaContext::audio_api_set_music_tempo(lua_State* l) {
   });
 }
 
+
+/**
+ * \brief Implementation of sol.audio.preload_music().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::audio_api_preload_music(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const std::string& music_id = LuaTools::check_string(l, 1);
+
+    if (!Music::exists(music_id)) {
+      LuaTools::arg_error(l, 1, std::string("No such music: '") + music_id + "'");
+    }
+
+    Music::preload(music_id);
+
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of sol.audio.get_music_crossfade_duration().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::audio_api_get_music_crossfade_duration(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    lua_pushinteger(l, Music::get_crossfade_duration());
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of sol.audio.set_music_crossfade_duration().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::audio_api_set_music_crossfade_duration(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    int duration = LuaTools::check_int(l, 1);
+
+    if (duration < 0) {
+      LuaTools::arg_error(l, 1, "Invalid crossfade duration: must be positive or 0");
+    }
+
+    Music::set_crossfade_duration(uint32_t(duration));
+
+    return 0;
+  });
+}
+
 }
 
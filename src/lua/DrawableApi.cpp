@@ -39,7 +39,9 @@ namespace Solarus {
 bool LuaContext::is_drawable(lua_State* l, int index) {
   return is_surface(l, index)
       || is_text_surface(l, index)
-      || is_sprite(l, index);
+      || is_sprite(l, index)
+      || is_particle_emitter(l, index)
+      || is_light_map(l, index);
 }
 
 /**
@@ -55,7 +57,7 @@ DrawablePtr LuaContext::check_drawable(lua_State* l, int index) {
     const ExportableToLuaPtr& userdata = *(static_cast<ExportableToLuaPtr*>(
       lua_touserdata(l, index)
     ));
-    return std::static_pointer_cast<Drawable>(userdata);
+    return static_pointer_cast<Drawable>(userdata);
   }
   else {
     LuaTools::type_error(l, index, "drawable");
@@ -325,7 +327,7 @@ int LuaContext::drawable_api_get_movement(lua_State* l) {
 
   return LuaTools::exception_boundary_handle(l, [&] {
     Drawable& drawable = *check_drawable(l, 1);
-    std::shared_ptr<Movement> movement = drawable.get_movement();
+    IntrusivePtr<Movement> movement = drawable.get_movement();
     if (movement == nullptr) {
       lua_pushnil(l);
     }
@@ -505,6 +505,7 @@ void LuaContext::register_entity_module() {
       { "set_drawn_in_y_order", custom_entity_api_set_drawn_in_y_order },
       { "set_traversable_by", custom_entity_api_set_traversable_by },
       { "set_can_traverse", custom_entity_api_set_can_traverse },
+      { "clear_traversable_cache", custom_entity_api_clear_traversable_cache },
       { "can_traverse_ground", custom_entity_api_can_traverse_ground },
       { "set_can_traverse_ground", custom_entity_api_set_can_traverse_ground },
       { "add_collision_test", custom_entity_api_add_collision_test },
@@ -598,7 +599,7 @@ EntityPtr LuaContext::check_entity(lua_State* l, int index) {
     const ExportableToLuaPtr& userdata = *(static_cast<ExportableToLuaPtr*>(
       lua_touserdata(l, index)
     ));
-    return std::static_pointer_cast<Entity>(userdata);
+    return static_pointer_cast<Entity>(userdata);
   }
   else {
     LuaTools::type_error(l, index, "entity");
@@ -1507,7 +1508,7 @@ int LuaContext::entity_api_get_movement(lua_State* l) {
   return LuaTools::exception_boundary_handle(l, [&] {
     Entity& entity = *check_entity(l, 1);
 
-    const std::shared_ptr<Movement>& movement = entity.get_movement();
+    const IntrusivePtr<Movement>& movement = entity.get_movement();
     if (movement == nullptr) {
       lua_pushnil(l);
     }
@@ -1682,8 +1683,8 @@ bool LuaContext::is_hero(lua_State* l, int index) {
  * \param index An index in the stack.
  * \return The hero.
  */
-std::shared_ptr<Hero> LuaContext::check_hero(lua_State* l, int index) {
-  return std::static_pointer_cast<Hero>(check_userdata(
+IntrusivePtr<Hero> LuaContext::check_hero(lua_State* l, int index) {
+  return static_pointer_cast<Hero>(check_userdata(
       l, index, get_entity_internal_type_name(EntityType::HERO)
   ));
 }
@@ -1905,9 +1906,9 @@ int LuaContext::hero_api_get_animation(lua_State* l) {
   return LuaTools::exception_boundary_handle(l, [&] {
     Hero& hero = *check_hero(l, 1);
 
-    const std::string& animation = hero.get_hero_sprites().get_tunic_animation();
+    const Symbol& animation = hero.get_hero_sprites().get_tunic_animation();
 
-    push_string(l, animation);
+    LuaTools::push_symbol(l, animation);
     return 1;
   });
 }
@@ -1921,7 +1922,7 @@ int LuaContext::hero_api_set_animation(lua_State* l) {
 
   return LuaTools::exception_boundary_handle(l, [&] {
     Hero& hero = *check_hero(l, 1);
-    const std::string& animation = LuaTools::check_string(l, 2);
+    const Symbol& animation = LuaTools::check_symbol(l, 2);
     const ScopedLuaRef& callback_ref = LuaTools::opt_function(l, 3);
 
     HeroSprites& sprites = hero.get_hero_sprites();
@@ -1947,9 +1948,9 @@ int LuaContext::hero_api_get_tunic_sprite_id(lua_State* l) {
   return LuaTools::exception_boundary_handle(l, [&] {
     Hero& hero = *check_hero(l, 1);
 
-    const std::string& sprite_id = hero.get_hero_sprites().get_tunic_sprite_id();
+    const Symbol& sprite_id = hero.get_hero_sprites().get_tunic_sprite_id();
 
-    push_string(l, sprite_id);
+    LuaTools::push_symbol(l, sprite_id);
     return 1;
   });
 }
@@ -1983,9 +1984,9 @@ int LuaContext::hero_api_get_sword_sprite_id(lua_State* l) {
   return LuaTools::exception_boundary_handle(l, [&] {
     Hero& hero = *check_hero(l, 1);
 
-    const std::string& sprite_id = hero.get_hero_sprites().get_sword_sprite_id();
+    const Symbol& sprite_id = hero.get_hero_sprites().get_sword_sprite_id();
 
-    push_string(l, sprite_id);
+    LuaTools::push_symbol(l, sprite_id);
     return 1;
   });
 }
@@ -2051,9 +2052,9 @@ int LuaContext::hero_api_get_shield_sprite_id(lua_State* l) {
   return LuaTools::exception_boundary_handle(l, [&] {
     Hero& hero = *check_hero(l, 1);
 
-    const std::string& sprite_id = hero.get_hero_sprites().get_shield_sprite_id();
+    const Symbol& sprite_id = hero.get_hero_sprites().get_shield_sprite_id();
 
-    push_string(l, sprite_id);
+    LuaTools::push_symbol(l, sprite_id);
     return 1;
   });
 }
@@ -2528,8 +2529,8 @@ bool LuaContext::is_camera(lua_State* l, int index) {
  * \param index An index in the stack.
  * \return The camera.
  */
-std::shared_ptr<Camera> LuaContext::check_camera(lua_State* l, int index) {
-  return std::static_pointer_cast<Camera>(check_userdata(
+IntrusivePtr<Camera> LuaContext::check_camera(lua_State* l, int index) {
+  return static_pointer_cast<Camera>(check_userdata(
       l, index, get_entity_internal_type_name(EntityType::CAMERA)
   ));
 }
@@ -2682,8 +2683,8 @@ bool LuaContext::is_destination(lua_State* l, int index) {
  * \param index An index in the stack.
  * \return The destination.
  */
-std::shared_ptr<Destination> LuaContext::check_destination(lua_State* l, int index) {
-  return std::static_pointer_cast<Destination>(check_userdata(
+IntrusivePtr<Destination> LuaContext::check_destination(lua_State* l, int index) {
+  return static_pointer_cast<Destination>(check_userdata(
       l, index, get_entity_internal_type_name(EntityType::DESTINATION)
   ));
 }
@@ -2754,8 +2755,8 @@ bool LuaContext::is_teletransporter(lua_State* l, int index) {
  * \param index An index in the stack.
  * \return The teletransporter.
  */
-std::shared_ptr<Teletransporter> LuaContext::check_teletransporter(lua_State* l, int index) {
-  return std::static_pointer_cast<Teletransporter>(check_userdata(
+IntrusivePtr<Teletransporter> LuaContext::check_teletransporter(lua_State* l, int index) {
+  return static_pointer_cast<Teletransporter>(check_userdata(
       l, index, get_entity_internal_type_name(EntityType::TELETRANSPORTER)
   ));
 }
@@ -2930,8 +2931,8 @@ bool LuaContext::is_npc(lua_State* l, int index) {
  * \param index An index in the stack.
  * \return The NPC.
  */
-std::shared_ptr<Npc> LuaContext::check_npc(lua_State* l, int index) {
-  return std::static_pointer_cast<Npc>(check_userdata(
+IntrusivePtr<Npc> LuaContext::check_npc(lua_State* l, int index) {
+  return static_pointer_cast<Npc>(check_userdata(
       l, index, get_entity_internal_type_name(EntityType::NPC))
   );
 }
@@ -2995,8 +2996,8 @@ bool LuaContext::is_chest(lua_State* l, int index) {
  * \param index An index in the stack.
  * \return The chest.
  */
-std::shared_ptr<Chest> LuaContext::check_chest(lua_State* l, int index) {
-  return std::static_pointer_cast<Chest>(check_userdata(
+IntrusivePtr<Chest> LuaContext::check_chest(lua_State* l, int index) {
+  return static_pointer_cast<Chest>(check_userdata(
       l, index, get_entity_internal_type_name(EntityType::CHEST)
   ));
 }
@@ -3126,8 +3127,8 @@ bool LuaContext::is_block(lua_State* l, int index) {
  * \param index An index in the stack.
  * \return The block.
  */
-std::shared_ptr<Block> LuaContext::check_block(lua_State* l, int index) {
-  return std::static_pointer_cast<Block>(check_userdata(
+IntrusivePtr<Block> LuaContext::check_block(lua_State* l, int index) {
+  return static_pointer_cast<Block>(check_userdata(
       l, index, get_entity_internal_type_name(EntityType::BLOCK)
   ));
 }
@@ -3290,8 +3291,8 @@ bool LuaContext::is_switch(lua_State* l, int index) {
  * \param index An index in the stack.
  * \return The switch.
  */
-std::shared_ptr<Switch> LuaContext::check_switch(lua_State* l, int index) {
-  return std::static_pointer_cast<Switch>(check_userdata(
+IntrusivePtr<Switch> LuaContext::check_switch(lua_State* l, int index) {
+  return static_pointer_cast<Switch>(check_userdata(
       l, index, get_entity_internal_type_name(EntityType::SWITCH)
   ));
 }
@@ -3401,8 +3402,8 @@ bool LuaContext::is_stream(lua_State* l, int index) {
  * \param index An index in the stack.
  * \return The stream.
  */
-std::shared_ptr<Stream> LuaContext::check_stream(lua_State* l, int index) {
-  return std::static_pointer_cast<Stream>(check_userdata(
+IntrusivePtr<Stream> LuaContext::check_stream(lua_State* l, int index) {
+  return static_pointer_cast<Stream>(check_userdata(
       l, index, get_entity_internal_type_name(EntityType::STREAM)
   ));
 }
@@ -3597,8 +3598,8 @@ bool LuaContext::is_door(lua_State* l, int index) {
  * \param index An index in the stack.
  * \return The door.
  */
-std::shared_ptr<Door> LuaContext::check_door(lua_State* l, int index) {
-  return std::static_pointer_cast<Door>(check_userdata(
+IntrusivePtr<Door> LuaContext::check_door(lua_State* l, int index) {
+  return static_pointer_cast<Door>(check_userdata(
       l, index, get_entity_internal_type_name(EntityType::DOOR))
   );
 }
@@ -3689,8 +3690,8 @@ bool LuaContext::is_shop_treasure(lua_State* l, int index) {
  * \param index An index in the stack.
  * \return The shop treasure.
  */
-std::shared_ptr<ShopTreasure> LuaContext::check_shop_treasure(lua_State* l, int index) {
-  return std::static_pointer_cast<ShopTreasure>(check_userdata(
+IntrusivePtr<ShopTreasure> LuaContext::check_shop_treasure(lua_State* l, int index) {
+  return static_pointer_cast<ShopTreasure>(check_userdata(
       l, index, get_entity_internal_type_name(EntityType::SHOP_TREASURE)
   ));
 }
@@ -3840,8 +3841,8 @@ bool LuaContext::is_pickable(lua_State* l, int index) {
  * \param index An index in the stack.
  * \return The pickable.
  */
-std::shared_ptr<Pickable> LuaContext::check_pickable(lua_State* l, int index) {
-  return std::static_pointer_cast<Pickable>(check_userdata(
+IntrusivePtr<Pickable> LuaContext::check_pickable(lua_State* l, int index) {
+  return static_pointer_cast<Pickable>(check_userdata(
       l, index, get_entity_internal_type_name(EntityType::PICKABLE)
   ));
 }
@@ -3932,8 +3933,8 @@ bool LuaContext::is_destructible(lua_State* l, int index) {
  * \param index An index in the stack.
  * \return The destructible object.
  */
-std::shared_ptr<Destructible> LuaContext::check_destructible(lua_State* l, int index) {
-  return std::static_pointer_cast<Destructible>(check_userdata(
+IntrusivePtr<Destructible> LuaContext::check_destructible(lua_State* l, int index) {
+  return static_pointer_cast<Destructible>(check_userdata(
       l, index, get_entity_internal_type_name(EntityType::DESTRUCTIBLE)
   ));
 }
@@ -4257,8 +4258,8 @@ bool LuaContext::is_dynamic_tile(lua_State* l, int index) {
  * \param index An index in the stack.
  * \return The dynamic tile.
  */
-std::shared_ptr<DynamicTile> LuaContext::check_dynamic_tile(lua_State* l, int index) {
-  return std::static_pointer_cast<DynamicTile>(check_userdata(
+IntrusivePtr<DynamicTile> LuaContext::check_dynamic_tile(lua_State* l, int index) {
+  return static_pointer_cast<DynamicTile>(check_userdata(
       l, index, get_entity_internal_type_name(EntityType::DYNAMIC_TILE)
   ));
 }
@@ -4323,8 +4324,8 @@ bool LuaContext::is_enemy(lua_State* l, int index) {
  * \param index An index in the stack.
  * \return The enemy.
  */
-std::shared_ptr<Enemy> LuaContext::check_enemy(lua_State* l, int index) {
-  return std::static_pointer_cast<Enemy>(check_userdata(
+IntrusivePtr<Enemy> LuaContext::check_enemy(lua_State* l, int index) {
+  return static_pointer_cast<Enemy>(check_userdata(
       l, index, get_entity_internal_type_name(EntityType::ENEMY)
   ));
 }
@@ -5109,8 +5110,8 @@ bool LuaContext::is_custom_entity(lua_State* l, int index) {
  * \param index An index in the stack.
  * \return The custom entity.
  */
-std::shared_ptr<CustomEntity> LuaContext::check_custom_entity(lua_State* l, int index) {
-  return std::static_pointer_cast<CustomEntity>(check_userdata(
+IntrusivePtr<CustomEntity> LuaContext::check_custom_entity(lua_State* l, int index) {
+  return static_pointer_cast<CustomEntity>(check_userdata(
       l, index, get_entity_internal_type_name(EntityType::CUSTOM)
   ));
 }
@@ -5372,11 +5373,12 @@ int LuaContext::custom_entity_api_set_traversable_by(lua_State* l) {
       // Custom boolean function.
 
       const ScopedLuaRef& traversable_test_ref = LuaTools::check_function(l, index);
+      bool stable = LuaTools::opt_boolean(l, index + 1, false);
       if (!type_specific) {
-        entity.set_traversable_by_entities(traversable_test_ref);
+        entity.set_traversable_by_entities(traversable_test_ref, stable);
       }
       else {
-        entity.set_traversable_by_entities(type, traversable_test_ref);
+        entity.set_traversable_by_entities(type, traversable_test_ref, stable);
       }
     }
     else {
@@ -5431,11 +5433,12 @@ int LuaContext::custom_entity_api_set_can_traverse(lua_State* l) {
       // Custom boolean function.
 
       const ScopedLuaRef& traversable_test_ref = LuaTools::check_function(l, index);
+      bool stable = LuaTools::opt_boolean(l, index + 1, false);
       if (!type_specific) {
-        entity.set_can_traverse_entities(traversable_test_ref);
+        entity.set_can_traverse_entities(traversable_test_ref, stable);
       }
       else {
-        entity.set_can_traverse_entities(type, traversable_test_ref);
+        entity.set_can_traverse_entities(type, traversable_test_ref, stable);
       }
     }
     else {
@@ -5446,6 +5449,22 @@ int LuaContext::custom_entity_api_set_can_traverse(lua_State* l) {
   });
 }
 
+/**
+ * \brief Implementation of custom_entity:clear_traversable_cache().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::custom_entity_api_clear_traversable_cache(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    CustomEntity& entity = *check_custom_entity(l, 1);
+
+    entity.notify_state_changed();
+
+    return 0;
+  });
+}
+
 /**
  * \brief Implementation of custom_entity:can_traverse_ground().
  * \param l The Lua context that is calling this function.
@@ -24,22 +24,100 @@ namespace Solarus {
  * \brief Creates an object exportable to Lua.
  */
 ExportableToLua::ExportableToLua():
+  reference_count(0),
+  weak_link(nullptr),
   lua_context(nullptr),
   known_to_lua(false),
   with_lua_table(false) {
 
 }
 
+/**
+ * \brief Copy constructor.
+ *
+ * References are not copied: the new object has no handle yet.
+ *
+ * \param other The object to copy.
+ */
+ExportableToLua::ExportableToLua(const ExportableToLua& other):
+  reference_count(0),
+  weak_link(nullptr),
+  lua_context(other.lua_context),
+  known_to_lua(other.known_to_lua),
+  with_lua_table(other.with_lua_table) {
+
+}
+
 /**
  * \brief Destroys this exportable object.
  */
 ExportableToLua::~ExportableToLua() {
 
+  if (weak_link != nullptr) {
+    weak_link->alive = false;
+    if (--weak_link->count == 0) {
+      delete weak_link;
+    }
+  }
+
   if (lua_context != nullptr) {
     lua_context->notify_userdata_destroyed(*this);
   }
 }
 
+/**
+ * \brief Assignment operator.
+ *
+ * References are not copied: each object keeps its own handles.
+ *
+ * \param other The object to copy.
+ * \return This object.
+ */
+ExportableToLua& ExportableToLua::operator=(const ExportableToLua& other) {
+
+  lua_context = other.lua_context;
+  known_to_lua = other.known_to_lua;
+  with_lua_table = other.with_lua_table;
+  return *this;
+}
+
+/**
+ * \brief Returns the number of IntrusivePtr to this object.
+ * \return The reference counter.
+ */
+int ExportableToLua::get_reference_count() const {
+  return reference_count;
+}
+
+/**
+ * \brief Returns the link between this object and its weak handles.
+ *
+ * The link is created the first time.
+ *
+ * \return The weak link.
+ */
+IntrusiveWeakLink* ExportableToLua::get_weak_link() const {
+
+  if (weak_link == nullptr) {
+    weak_link = new IntrusiveWeakLink{ true, 1 };
+  }
+  return weak_link;
+}
+
+/**
+ * \brief Destroys this object after its last reference was removed.
+ *
+ * Weak handles see the object as expired from now on, including
+ * during its destructor.
+ */
+void ExportableToLua::destroy() const {
+
+  if (weak_link != nullptr) {
+    weak_link->alive = false;
+  }
+  delete this;
+}
+
 /**
  * \brief Returns the Solarus Lua API.
  * \return The Lua context, or nullptr if Lua is not enabled for this object.
@@ -106,6 +106,10 @@ void LuaContext::register_game_module() {
       { "capture_command_binding", game_api_capture_command_binding },
       { "simulate_command_pressed", game_api_simulate_command_pressed },
       { "simulate_command_released", game_api_simulate_command_released },
+      { "has_checkpoint", game_api_has_checkpoint },
+      { "save_checkpoint", game_api_save_checkpoint },
+      { "restore_checkpoint", game_api_restore_checkpoint },
+      { "remove_checkpoint", game_api_remove_checkpoint },
       { nullptr, nullptr }
   };
 
@@ -136,8 +140,8 @@ bool LuaContext::is_game(lua_State* l, int index) {
  * \param index an index in the stack
  * \return the game
  */
-std::shared_ptr<Savegame> LuaContext::check_game(lua_State* l, int index) {
-  return std::static_pointer_cast<Savegame>(check_userdata(
+IntrusivePtr<Savegame> LuaContext::check_game(lua_State* l, int index) {
+  return static_pointer_cast<Savegame>(check_userdata(
       l, index, game_module_name
   ));
 }
@@ -206,7 +210,7 @@ int LuaContext::game_api_load(lua_State* l) {
       LuaTools::error(l, "Cannot load savegame: no write directory was specified in quest.dat");
     }
 
-    std::shared_ptr<Savegame> savegame = std::make_shared<Savegame>(
+    IntrusivePtr<Savegame> savegame = make_intrusive<Savegame>(
         get_lua_context(l).get_main_loop(), file_name
     );
     savegame->initialize();
@@ -244,7 +248,7 @@ int LuaContext::game_api_save(lua_State* l) {
 int LuaContext::game_api_start(lua_State* l) {
 
   return LuaTools::exception_boundary_handle(l, [&] {
-    std::shared_ptr<Savegame> savegame = check_game(l, 1);
+    IntrusivePtr<Savegame> savegame = check_game(l, 1);
 
     if (CurrentQuest::get_resources(ResourceType::MAP).empty()) {
       LuaTools::error(l, "Cannot start game: there is no map in this quest");
@@ -614,9 +618,9 @@ int LuaContext::game_api_get_value(lua_State* l) {
 
   return LuaTools::exception_boundary_handle(l, [&] {
     Savegame& savegame = *check_game(l, 1);
-    const std::string& key = LuaTools::check_string(l, 2);
+    const Symbol& key = LuaTools::check_symbol(l, 2);
 
-    if (!LuaTools::is_valid_lua_identifier(key)) {
+    if (!LuaTools::is_valid_lua_identifier(key.str())) {
       LuaTools::arg_error(l, 3,
           std::string("Invalid savegame variable '") + key
           + "': the name should only contain alphanumeric characters or '_'"
@@ -649,15 +653,15 @@ int LuaContext::game_api_set_value(lua_State* l) {
 
   return LuaTools::exception_boundary_handle(l, [&] {
     Savegame& savegame = *check_game(l, 1);
-    const std::string& key = LuaTools::check_string(l, 2);
+    const Symbol& key = LuaTools::check_symbol(l, 2);
 
-    if (key[0] == '_') {
+    if (key.str()[0] == '_') {
       LuaTools::arg_error(l, 3,
           std::string("Invalid savegame variable '") + key
           + "': names prefixed by '_' are reserved for built-in variables");
     }
 
-    if (!LuaTools::is_valid_lua_identifier(key)) {
+    if (!LuaTools::is_valid_lua_identifier(key.str())) {
       LuaTools::arg_error(l, 3,
           std::string("Invalid savegame variable '") + key
           + "': the name should only contain alphanumeric characters or '_'"
@@ -1553,6 +1557,91 @@ int LuaContext::game_api_simulate_command_released(lua_State* l) {
   });
 }
 
+/**
+ * \brief Implementation of game:has_checkpoint().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::game_api_has_checkpoint(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    Savegame& savegame = *check_game(l, 1);
+    const std::string& name = LuaTools::check_string(l, 2);
+
+    Game* game = savegame.get_game();
+    lua_pushboolean(l, game != nullptr && game->has_checkpoint(name));
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of game:save_checkpoint().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::game_api_save_checkpoint(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    Savegame& savegame = *check_game(l, 1);
+    const std::string& name = LuaTools::check_string(l, 2);
+
+    Game* game = savegame.get_game();
+    if (game == nullptr || !game->has_current_map()) {
+      LuaTools::error(l, "Cannot save checkpoint: this game is not running");
+    }
+
+    game->save_checkpoint(name);
+
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of game:restore_checkpoint().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::game_api_restore_checkpoint(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    Savegame& savegame = *check_game(l, 1);
+    const std::string& name = LuaTools::check_string(l, 2);
+
+    Game* game = savegame.get_game();
+    if (game == nullptr) {
+      LuaTools::error(l, "Cannot restore checkpoint: this game is not running");
+    }
+    if (!game->has_checkpoint(name)) {
+      LuaTools::arg_error(l, 2, std::string("No such checkpoint: '") + name + "'");
+    }
+
+    bool success = game->restore_checkpoint(name);
+
+    lua_pushboolean(l, success);
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of game:remove_checkpoint().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::game_api_remove_checkpoint(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    Savegame& savegame = *check_game(l, 1);
+    const std::string& name = LuaTools::check_string(l, 2);
+
+    Game* game = savegame.get_game();
+    if (game != nullptr) {
+      game->remove_checkpoint(name);
+    }
+
+    return 0;
+  });
+}
+
 /**
  * \brief Calls the on_started() method of a Lua game.
  *
@@ -1838,4 +1927,45 @@ bool LuaContext::game_on_command_released(Game& game, GameCommand command) {
   return handled;
 }
 
+/**
+ * \brief Calls the on_checkpoint_saving() method of a Lua game.
+ *
+ * Does nothing if the method is not defined.
+ *
+ * \param game A game.
+ * \return A ref to the value returned by the method, to be stored in the
+ * checkpoint, or an empty ref.
+ */
+ScopedLuaRef LuaContext::game_on_checkpoint_saving(Game& game) {
+
+  if (!userdata_has_field(game.get_savegame(), "on_checkpoint_saving")) {
+    return ScopedLuaRef();
+  }
+
+  push_game(l, game.get_savegame());
+  ScopedLuaRef data_ref = on_checkpoint_saving();
+  lua_pop(l, 1);
+  return data_ref;
+}
+
+/**
+ * \brief Calls the on_checkpoint_restored() method of a Lua game.
+ *
+ * Does nothing if the method is not defined.
+ *
+ * \param game A game.
+ * \param data_ref Ref to the value returned by game:on_checkpoint_saving()
+ * when the checkpoint was created, or an empty ref.
+ */
+void LuaContext::game_on_checkpoint_restored(Game& game, const ScopedLuaRef& data_ref) {
+
+  if (!userdata_has_field(game.get_savegame(), "on_checkpoint_restored")) {
+    return;
+  }
+
+  push_game(l, game.get_savegame());
+  on_checkpoint_restored(data_ref);
+  lua_pop(l, 1);
+}
+
 }
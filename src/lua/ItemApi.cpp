@@ -103,8 +103,8 @@ bool LuaContext::is_item(lua_State* l, int index) {
  * \param index An index in the stack.
  * \return The equipment item.
  */
-std::shared_ptr<EquipmentItem> LuaContext::check_item(lua_State* l, int index) {
-  return std::static_pointer_cast<EquipmentItem>(check_userdata(
+IntrusivePtr<EquipmentItem> LuaContext::check_item(lua_State* l, int index) {
+  return static_pointer_cast<EquipmentItem>(check_userdata(
       l, index, item_module_name
   ));
 }
@@ -0,0 +1,349 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/entities/Entity.h"
+#include "solarus/lowlevel/String.h"
+#include "solarus/lua/LuaContext.h"
+#include "solarus/lua/LuaTools.h"
+#include "solarus/LightMap.h"
+#include <lua.hpp>
+
+namespace Solarus {
+
+/**
+ * Name of the Lua table representing the light map module.
+ */
+const std::string LuaContext::light_map_module_name = "sol.light_map";
+
+/**
+ * \brief Initializes the light map features provided to Lua.
+ */
+void LuaContext::register_light_map_module() {
+
+  // Functions of sol.light_map.
+  static const luaL_Reg functions[] = {
+      { "create", light_map_api_create },
+      { nullptr, nullptr }
+  };
+
+  // Methods of the light_map type.
+  static const luaL_Reg methods[] = {
+      { "get_scale", light_map_api_get_scale },
+      { "get_ambient_color", light_map_api_get_ambient_color },
+      { "set_ambient_color", light_map_api_set_ambient_color },
+      { "get_view_position", light_map_api_get_view_position },
+      { "set_view_position", light_map_api_set_view_position },
+      { "add_light", light_map_api_add_light },
+      { "set_light_position", light_map_api_set_light_position },
+      { "remove_light", light_map_api_remove_light },
+      { "has_light", light_map_api_has_light },
+      { "clear_lights", light_map_api_clear_lights },
+      { "get_num_lights", light_map_api_get_num_lights },
+      { "draw", drawable_api_draw },
+      { "draw_region", drawable_api_draw_region },
+      { "fade_in", drawable_api_fade_in },
+      { "fade_out", drawable_api_fade_out },
+      { "get_xy", drawable_api_get_xy },
+      { "set_xy", drawable_api_set_xy },
+      { "get_movement", drawable_api_get_movement },
+      { "stop_movement", drawable_api_stop_movement },
+      { nullptr, nullptr }
+  };
+
+  static const luaL_Reg metamethods[] = {
+      { "__gc", drawable_meta_gc },
+      { nullptr, nullptr }
+  };
+
+  register_type(light_map_module_name, functions, methods, metamethods);
+}
+
+/**
+ * \brief Returns whether a value is a userdata of type light map.
+ * \param l A Lua context.
+ * \param index An index in the stack.
+ * \return \c true if the value at this index is a light map.
+ */
+bool LuaContext::is_light_map(lua_State* l, int index) {
+  return is_userdata(l, index, light_map_module_name);
+}
+
+/**
+ * \brief Checks that the userdata at the specified index of the stack is a
+ * light map and returns it.
+ * \param l A Lua context.
+ * \param index An index in the stack.
+ * \return The light map.
+ */
+IntrusivePtr<LightMap> LuaContext::check_light_map(lua_State* l, int index) {
+  return static_pointer_cast<LightMap>(check_userdata(
+      l, index, light_map_module_name
+  ));
+}
+
+/**
+ * \brief Pushes a light map userdata onto the stack.
+ * \param l A Lua context.
+ * \param light_map A light map.
+ */
+void LuaContext::push_light_map(lua_State* l, LightMap& light_map) {
+  push_userdata(l, light_map);
+}
+
+/**
+ * \brief Implementation of sol.light_map.create().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::light_map_api_create(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const Size size(
+        LuaTools::check_int(l, 1),
+        LuaTools::check_int(l, 2)
+    );
+    const int scale = LuaTools::opt_int(l, 3, 4);
+
+    if (size.width <= 0 || size.height <= 0) {
+      LuaTools::error(l, "Invalid light map size");
+    }
+    if (scale < 1 || scale > LightMap::max_scale) {
+      LuaTools::arg_error(l, 3, "Invalid scale: must be between 1 and " +
+          String::to_string(LightMap::max_scale));
+    }
+
+    IntrusivePtr<LightMap> light_map = make_intrusive<LightMap>(size, scale);
+
+    get_lua_context(l).add_drawable(light_map);
+    push_light_map(l, *light_map);
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of light_map:get_scale().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::light_map_api_get_scale(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const LightMap& light_map = *check_light_map(l, 1);
+
+    lua_pushinteger(l, light_map.get_scale());
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of light_map:get_ambient_color().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::light_map_api_get_ambient_color(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const LightMap& light_map = *check_light_map(l, 1);
+
+    push_color(l, light_map.get_ambient_color());
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of light_map:set_ambient_color().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::light_map_api_set_ambient_color(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    LightMap& light_map = *check_light_map(l, 1);
+    const Color& color = LuaTools::check_color(l, 2);
+
+    light_map.set_ambient_color(color);
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of light_map:get_view_position().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::light_map_api_get_view_position(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const LightMap& light_map = *check_light_map(l, 1);
+
+    const Point& view_position = light_map.get_view_position();
+    lua_pushinteger(l, view_position.x);
+    lua_pushinteger(l, view_position.y);
+    return 2;
+  });
+}
+
+/**
+ * \brief Implementation of light_map:set_view_position().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::light_map_api_set_view_position(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    LightMap& light_map = *check_light_map(l, 1);
+    const Point view_position(
+        LuaTools::check_int(l, 2),
+        LuaTools::check_int(l, 3)
+    );
+
+    light_map.set_view_position(view_position);
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of light_map:add_light().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::light_map_api_add_light(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    LightMap& light_map = *check_light_map(l, 1);
+    LuaTools::check_type(l, 2, LUA_TTABLE);
+
+    const int radius = LuaTools::check_int_field(l, 2, "radius");
+    const Color& color = LuaTools::opt_color_field(l, 2, "color", Color(255, 255, 255));
+    const double falloff = LuaTools::opt_number_field(l, 2, "falloff", 1.0);
+    if (radius <= 0) {
+      LuaTools::error(l, "Bad field 'radius' (positive number expected)");
+    }
+    if (falloff <= 0.0) {
+      LuaTools::error(l, "Bad field 'falloff' (positive number expected)");
+    }
+
+    int light_id = 0;
+    lua_getfield(l, 2, "entity");
+    if (!lua_isnil(l, -1)) {
+      if (!is_entity(l, -1)) {
+        LuaTools::error(l, "Bad field 'entity' (entity expected)");
+      }
+      const EntityPtr& entity = check_entity(l, -1);
+      light_id = light_map.add_light(entity, radius, color, falloff);
+      light_map.set_light_position(light_id, Point(
+          LuaTools::opt_int_field(l, 2, "x", 0),
+          LuaTools::opt_int_field(l, 2, "y", 0)
+      ));
+    }
+    else {
+      light_id = light_map.add_light(Point(
+          LuaTools::check_int_field(l, 2, "x"),
+          LuaTools::check_int_field(l, 2, "y")
+      ), radius, color, falloff);
+    }
+    lua_pop(l, 1);
+
+    lua_pushinteger(l, light_id);
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of light_map:set_light_position().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::light_map_api_set_light_position(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    LightMap& light_map = *check_light_map(l, 1);
+    const int light_id = LuaTools::check_int(l, 2);
+    const Point xy(
+        LuaTools::check_int(l, 3),
+        LuaTools::check_int(l, 4)
+    );
+
+    if (!light_map.set_light_position(light_id, xy)) {
+      LuaTools::arg_error(l, 2, "No such light: " + String::to_string(light_id));
+    }
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of light_map:remove_light().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::light_map_api_remove_light(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    LightMap& light_map = *check_light_map(l, 1);
+    const int light_id = LuaTools::check_int(l, 2);
+
+    lua_pushboolean(l, light_map.remove_light(light_id));
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of light_map:has_light().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::light_map_api_has_light(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const LightMap& light_map = *check_light_map(l, 1);
+    const int light_id = LuaTools::check_int(l, 2);
+
+    lua_pushboolean(l, light_map.has_light(light_id));
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of light_map:clear_lights().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::light_map_api_clear_lights(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    LightMap& light_map = *check_light_map(l, 1);
+
+    light_map.clear_lights();
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of light_map:get_num_lights().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::light_map_api_get_num_lights(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const LightMap& light_map = *check_light_map(l, 1);
+
+    lua_pushinteger(l, light_map.get_num_lights());
+    return 1;
+  });
+}
+
+}
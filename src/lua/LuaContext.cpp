@@ -32,6 +32,7 @@
 #include "solarus/lowlevel/QuestFiles.h"
 #include "solarus/lua/ExportableToLuaPtr.h"
 #include "solarus/lua/LuaContext.h"
+#include "solarus/lua/LuaProfiler.h"
 #include "solarus/lua/LuaTools.h"
 #include "solarus/AbilityInfo.h"
 #include "solarus/Equipment.h"
@@ -103,6 +104,7 @@ void LuaContext::initialize() {
   l = luaL_newstate();
   lua_atpanic(l, l_panic);
   luaL_openlibs(l);
+  LuaProfiler::set_lua_state(l);
 
   print_lua_version();
 
@@ -185,6 +187,7 @@ void LuaContext::exit() {
     userdata_close_lua();
 
     // Finalize Lua.
+    LuaProfiler::set_lua_state(nullptr);
     lua_close(l);
     lua_contexts.erase(l);
     l = nullptr;
@@ -936,6 +939,8 @@ void LuaContext::register_modules() {
   register_surface_module();
   register_text_surface_module();
   register_sprite_module();
+  register_particle_emitter_module();
+  register_light_map_module();
   register_movement_module();
   register_item_module();
   register_input_module();
@@ -943,6 +948,7 @@ void LuaContext::register_modules() {
   register_file_module();
   register_menu_module();
   register_language_module();
+  register_ffi_accessors();
 
   Debug::check_assertion(lua_gettop(l) == 0,
       "Lua stack is not empty after modules initialization");
@@ -980,8 +986,8 @@ void LuaContext::push_color(lua_State* l, const Color& color) {
 /**
  * \brief Pushes the Lua equivalent of a C++ object onto the stack.
  * \param l A Lua context.
- * \param userdata A userdata. It must live as a std::shared_ptr somewhere:
- * typically, it should have been stored in a std::shared_ptr at creation time.
+ * \param userdata A userdata. It must live as an IntrusivePtr somewhere:
+ * typically, it should have been stored in an IntrusivePtr at creation time.
  */
 void LuaContext::push_userdata(lua_State* l, ExportableToLua& userdata) {
 
@@ -1013,24 +1019,19 @@ void LuaContext::push_userdata(lua_State* l, ExportableToLua& userdata) {
     lua_pushlightuserdata(l, &userdata);
                                   // ... all_udata lightudata
 
-    // Find the existing shared_ptr from the raw pointer.
-    ExportableToLuaPtr shared_userdata;
-    try {
-      shared_userdata = userdata.shared_from_this();
-    }
-    catch (const std::bad_weak_ptr& ex) {
-      // No existing shared_ptr. This is probably because you forgot to
-      // store your object in a shared_ptr at creation time.
+    if (userdata.get_reference_count() == 0) {
+      // No existing IntrusivePtr. This is probably because you forgot to
+      // store your object in an IntrusivePtr at creation time.
       Debug::die(
-          std::string("No living shared_ptr for ") + userdata.get_lua_type_name()
+          std::string("No living IntrusivePtr for ") + userdata.get_lua_type_name()
       );
     }
 
     ExportableToLuaPtr* block_address = static_cast<ExportableToLuaPtr*>(
           lua_newuserdata(l, sizeof(ExportableToLuaPtr))
     );
-    // Manually construct a shared_ptr in the block allocated by Lua.
-    new (block_address) ExportableToLuaPtr(shared_userdata);
+    // Manually construct an IntrusivePtr in the block allocated by Lua.
+    new (block_address) ExportableToLuaPtr(&userdata);
                                   // ... all_udata lightudata udata
     luaL_getmetatable(l, userdata.get_lua_type_name().c_str());
                                   // ... all_udata lightudata udata mt
@@ -1177,8 +1178,8 @@ int LuaContext::userdata_meta_gc(lua_State* l) {
   // because it is already done: that table is weak on its values and the
   // value was the full userdata.
 
-  // Manually destroy the shared_ptr allocated for Lua.
-  userdata->~shared_ptr<ExportableToLua>();
+  // Manually destroy the IntrusivePtr allocated for Lua.
+  userdata->~IntrusivePtr<ExportableToLua>();
 
   return 0;
 }
@@ -1928,10 +1929,10 @@ bool LuaContext::on_command_released(GameCommand command) {
  * \brief Calls the on_animation_finished() method of the object on top of the stack.
  * \param animation Name of the animation finished.
  */
-void LuaContext::on_animation_finished(const std::string& animation) {
+void LuaContext::on_animation_finished(const Symbol& animation) {
 
   if (find_method("on_animation_finished")) {
-    push_string(l, animation);
+    LuaTools::push_symbol(l, animation);
     call_function(2, 0, "on_animation_finished");
   }
 }
@@ -1940,10 +1941,10 @@ void LuaContext::on_animation_finished(const std::string& animation) {
  * \brief Calls the on_animation_changed() method of the object on top of the stack.
  * \param animation Name of the new animation.
  */
-void LuaContext::on_animation_changed(const std::string& animation) {
+void LuaContext::on_animation_changed(const Symbol& animation) {
 
   if (find_method("on_animation_changed")) {
-    push_string(l, animation);
+    LuaTools::push_symbol(l, animation);
     call_function(2, 0, "on_animation_changed");
   }
 }
@@ -1954,10 +1955,10 @@ void LuaContext::on_animation_changed(const std::string& animation) {
  * \param frame The new frame.
  */
 void LuaContext::on_direction_changed(
-    const std::string& animation, int direction) {
+    const Symbol& animation, int direction) {
 
   if (find_method("on_direction_changed")) {
-    push_string(l, animation);
+    LuaTools::push_symbol(l, animation);
     lua_pushinteger(l, direction);
     call_function(3, 0, "on_direction_changed");
   }
@@ -1968,10 +1969,10 @@ void LuaContext::on_direction_changed(
  * \param animation Name of the sprite animation.
  * \param frame The new frame.
  */
-void LuaContext::on_frame_changed(const std::string& animation, int frame) {
+void LuaContext::on_frame_changed(const Symbol& animation, int frame) {
 
   if (find_method("on_frame_changed")) {
-    push_string(l, animation);
+    LuaTools::push_symbol(l, animation);
     lua_pushinteger(l, frame);
     call_function(3, 0, "on_frame_changed");
   }
@@ -2403,6 +2404,40 @@ void LuaContext::on_map_changed(Map& map) {
   }
 }
 
+/**
+ * \brief Calls the on_checkpoint_saving() method of the object on top of the stack.
+ * \return A ref to the value returned by the method, or an empty ref.
+ */
+ScopedLuaRef LuaContext::on_checkpoint_saving() {
+
+  ScopedLuaRef data_ref;
+  if (find_method("on_checkpoint_saving")) {
+    bool success = call_function(1, 1, "on_checkpoint_saving");
+    if (success) {
+      if (!lua_isnil(l, -1)) {
+        data_ref = create_ref();  // Pops the value.
+      }
+      else {
+        lua_pop(l, 1);
+      }
+    }
+  }
+  return data_ref;
+}
+
+/**
+ * \brief Calls the on_checkpoint_restored() method of the object on top of the stack.
+ * \param data_ref Ref to the value returned by on_checkpoint_saving() or an
+ * empty ref.
+ */
+void LuaContext::on_checkpoint_restored(const ScopedLuaRef& data_ref) {
+
+  if (find_method("on_checkpoint_restored")) {
+    push_ref(l, data_ref);
+    call_function(2, 0, "on_checkpoint_restored");
+  }
+}
+
 /**
  * \brief Calls the on_pickable_created() method of the object on top of the stack.
  * \param pickable A pickable treasure.
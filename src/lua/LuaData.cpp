@@ -19,12 +19,721 @@
 #include "solarus/lua/LuaData.h"
 #include <lua.hpp>
 #include <cstdio>
+#include <cctype>
 #include <fstream>
+#include <locale>
 #include <ostream>
+#include <set>
 #include <sstream>
 
 namespace Solarus {
 
+namespace {
+
+/**
+ * \brief Native parser for the subset of Lua used by data files.
+ *
+ * Data files are sequences of calls like <tt>tile{ x = 16, y = 8 }</tt>
+ * whose only argument is a table literal of strings, numbers, booleans
+ * and nested tables.
+ * Reading them directly is much faster than compiling them with Lua.
+ *
+ * check() first validates the whole buffer without any Lua state.
+ * If the buffer is outside of the subset, the file should be loaded by Lua
+ * as usual.
+ * Otherwise, run() calls the functions registered by the data file class
+ * with the same tables that the Lua code would have built.
+ */
+class DataFileParser {
+
+  public:
+
+    DataFileParser(const std::string& buffer, const std::string& file_name);
+
+    bool check();
+    bool run(lua_State* l);
+
+  private:
+
+    bool parse_chunk();
+    bool parse_call();
+    bool parse_table(int depth);
+    bool parse_value(int depth);
+    bool skip_spaces_and_comments();
+    bool read_name(std::string& name);
+    bool read_quoted_string(std::string& value);
+    bool read_long_string(int level, std::string& value);
+    int read_long_bracket_level();
+    bool read_number(lua_Number& value);
+    bool is_at_end() const;
+    char current() const;
+    char next() const;
+
+    static bool is_name_start(char c);
+    static bool is_name_char(char c);
+    static bool is_reserved_word(const std::string& word);
+
+    static constexpr int max_depth = 64;  /**< Maximum nesting of tables. */
+
+    const std::string& buffer;            /**< Content of the data file. */
+    const std::string& file_name;         /**< File name for error messages. */
+    size_t pos;                           /**< Current position in the buffer. */
+    int line;                             /**< Current line number. */
+    lua_State* l;                         /**< Lua state to push values to,
+                                           * or nullptr when only checking. */
+};
+
+/**
+ * \brief Creates a parser.
+ * \param buffer Content of the data file.
+ * \param file_name Name of the file to use in error messages.
+ */
+DataFileParser::DataFileParser(
+    const std::string& buffer,
+    const std::string& file_name
+):
+  buffer(buffer),
+  file_name(file_name),
+  pos(0),
+  line(1),
+  l(nullptr) {
+
+}
+
+/**
+ * \brief Returns whether the whole buffer can be handled by this parser.
+ * \return \c true if the buffer is in the supported subset of Lua.
+ */
+bool DataFileParser::check() {
+
+  pos = 0;
+  line = 1;
+  l = nullptr;
+  return parse_chunk();
+}
+
+/**
+ * \brief Calls the Lua functions of the data file.
+ *
+ * check() must have succeeded before.
+ *
+ * \param l The Lua state where the data file functions are registered.
+ * \return \c true in case of success, \c false if one of the calls failed.
+ * In this case, the error message is on top of the stack.
+ */
+bool DataFileParser::run(lua_State* l) {
+
+  pos = 0;
+  line = 1;
+  this->l = l;
+  return parse_chunk();
+}
+
+/**
+ * \brief Parses all calls of the buffer.
+ * \return \c false if the buffer is not in the supported subset,
+ * or if a call failed while running.
+ */
+bool DataFileParser::parse_chunk() {
+
+  while (true) {
+    if (!skip_spaces_and_comments()) {
+      return false;
+    }
+    if (is_at_end()) {
+      return true;
+    }
+    if (!parse_call()) {
+      return false;
+    }
+  }
+}
+
+/**
+ * \brief Parses a call like <tt>name{ ... }</tt> and runs it if needed.
+ * \return \c false if the call is not in the supported subset,
+ * or if it failed while running.
+ */
+bool DataFileParser::parse_call() {
+
+  const int call_line = line;
+  std::string name;
+  if (!read_name(name) || is_reserved_word(name)) {
+    return false;
+  }
+
+  if (!skip_spaces_and_comments() || is_at_end() || current() != '{') {
+    return false;
+  }
+
+  if (l != nullptr) {
+    lua_getglobal(l, name.c_str());
+    if (!lua_isfunction(l, -1)) {
+      const char* type_name = luaL_typename(l, -1);
+      lua_pop(l, 1);
+      lua_pushfstring(l, "[string \"%s\"]:%d: attempt to call global '%s' (a %s value)",
+          file_name.c_str(), call_line, name.c_str(), type_name);
+      return false;
+    }
+  }
+
+  if (!parse_table(0)) {
+    return false;
+  }
+
+  if (l != nullptr) {
+    if (lua_pcall(l, 1, 0, 0) != 0) {
+      if (lua_isstring(l, -1)) {
+        // Tell where the failing entry is.
+        lua_pushfstring(l, "[string \"%s\"]:%d: %s",
+            file_name.c_str(), call_line, lua_tostring(l, -1));
+        lua_remove(l, -2);
+      }
+      return false;
+    }
+  }
+
+  // Lua would chain a call or an index here.
+  if (!skip_spaces_and_comments()) {
+    return false;
+  }
+  if (!is_at_end()) {
+    const char c = current();
+    if (c == '{' || c == '(' || c == '"' || c == '\'' ||
+        c == '[' || c == '.' || c == ':') {
+      return false;
+    }
+    if (c == ';') {
+      // Optional separator after a statement.
+      // Other semicolons are syntax errors that Lua will report.
+      ++pos;
+    }
+  }
+  return true;
+}
+
+/**
+ * \brief Parses a table literal and pushes it when running.
+ * \param depth Number of tables enclosing this one.
+ * \return \c false if the table is not in the supported subset.
+ */
+bool DataFileParser::parse_table(int depth) {
+
+  if (depth >= max_depth) {
+    return false;
+  }
+
+  ++pos;  // Skip '{'.
+  if (l != nullptr) {
+    if (!lua_checkstack(l, 3)) {
+      return false;
+    }
+    lua_newtable(l);
+  }
+
+  int num_items = 0;
+  while (true) {
+    if (!skip_spaces_and_comments() || is_at_end()) {
+      return false;
+    }
+
+    if (current() == '}') {
+      ++pos;
+      return true;
+    }
+
+    if (is_name_start(current())) {
+      // Either "key = value" or a positional true, false or nil.
+      const size_t name_pos = pos;
+      const int name_line = line;
+      std::string key;
+      read_name(key);
+      if (!skip_spaces_and_comments() || is_at_end()) {
+        return false;
+      }
+      if (current() == '=' && next() != '=') {
+        if (is_reserved_word(key)) {
+          return false;
+        }
+        ++pos;
+        if (!skip_spaces_and_comments() || is_at_end()) {
+          return false;
+        }
+        if (!parse_value(depth)) {
+          return false;
+        }
+        if (l != nullptr) {
+          lua_setfield(l, -2, key.c_str());
+        }
+      }
+      else {
+        pos = name_pos;
+        line = name_line;
+        if (!parse_value(depth)) {
+          return false;
+        }
+        ++num_items;
+        if (l != nullptr) {
+          lua_rawseti(l, -2, num_items);
+        }
+      }
+    }
+    else {
+      if (!parse_value(depth)) {
+        return false;
+      }
+      ++num_items;
+      if (l != nullptr) {
+        lua_rawseti(l, -2, num_items);
+      }
+    }
+
+    if (!skip_spaces_and_comments() || is_at_end()) {
+      return false;
+    }
+    if (current() == ',' || current() == ';') {
+      ++pos;
+    }
+    else if (current() != '}') {
+      return false;
+    }
+  }
+}
+
+/**
+ * \brief Parses a constant value and pushes it when running.
+ * \param depth Number of tables enclosing this value.
+ * \return \c false if the value is not in the supported subset.
+ */
+bool DataFileParser::parse_value(int depth) {
+
+  const char c = current();
+  if (c == '{') {
+    return parse_table(depth + 1);
+  }
+
+  if (c == '"' || c == '\'') {
+    std::string value;
+    if (!read_quoted_string(value)) {
+      return false;
+    }
+    if (l != nullptr) {
+      lua_pushlstring(l, value.data(), value.size());
+    }
+    return true;
+  }
+
+  if (c == '[') {
+    const int level = read_long_bracket_level();
+    std::string value;
+    if (level < 0 || !read_long_string(level, value)) {
+      return false;
+    }
+    if (l != nullptr) {
+      lua_pushlstring(l, value.data(), value.size());
+    }
+    return true;
+  }
+
+  if (c == '-') {
+    ++pos;
+    if (is_at_end() || current() == '-') {
+      // A comment where a value is expected.
+      return false;
+    }
+    if (!skip_spaces_and_comments() || is_at_end()) {
+      return false;
+    }
+    lua_Number value = 0;
+    if (!read_number(value)) {
+      return false;
+    }
+    if (l != nullptr) {
+      lua_pushnumber(l, -value);
+    }
+    return true;
+  }
+
+  if (std::isdigit(static_cast<unsigned char>(c)) ||
+      (c == '.' && std::isdigit(static_cast<unsigned char>(next())))) {
+    lua_Number value = 0;
+    if (!read_number(value)) {
+      return false;
+    }
+    if (l != nullptr) {
+      lua_pushnumber(l, value);
+    }
+    return true;
+  }
+
+  std::string name;
+  if (!read_name(name)) {
+    return false;
+  }
+  if (name == "true" || name == "false") {
+    if (l != nullptr) {
+      lua_pushboolean(l, name == "true");
+    }
+    return true;
+  }
+  if (name == "nil") {
+    if (l != nullptr) {
+      lua_pushnil(l);
+    }
+    return true;
+  }
+
+  // A variable or an expression.
+  return false;
+}
+
+/**
+ * \brief Skips spaces, line comments and block comments.
+ * \return \c false if a block comment is not terminated.
+ */
+bool DataFileParser::skip_spaces_and_comments() {
+
+  while (!is_at_end()) {
+    const char c = current();
+    if (c == '\n') {
+      ++line;
+      ++pos;
+    }
+    else if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v') {
+      ++pos;
+    }
+    else if (c == '-' && next() == '-') {
+      pos += 2;
+      if (!is_at_end() && current() == '[') {
+        const size_t bracket_pos = pos;
+        const int level = read_long_bracket_level();
+        if (level >= 0) {
+          std::string comment;
+          if (!read_long_string(level, comment)) {
+            return false;
+          }
+          continue;
+        }
+        pos = bracket_pos;
+      }
+      while (!is_at_end() && current() != '\n') {
+        ++pos;
+      }
+    }
+    else {
+      break;
+    }
+  }
+  return true;
+}
+
+/**
+ * \brief Reads an identifier.
+ * \param[out] name The identifier read.
+ * \return \c false if there is no identifier at the current position.
+ */
+bool DataFileParser::read_name(std::string& name) {
+
+  if (is_at_end() || !is_name_start(current())) {
+    return false;
+  }
+
+  const size_t start = pos;
+  while (!is_at_end() && is_name_char(current())) {
+    ++pos;
+  }
+  name = buffer.substr(start, pos - start);
+  return true;
+}
+
+/**
+ * \brief Reads a string enclosed in double or single quotes.
+ * \param[out] value The string with escape sequences replaced.
+ * \return \c false if the string is invalid or uses unsupported escape
+ * sequences.
+ */
+bool DataFileParser::read_quoted_string(std::string& value) {
+
+  const char delimiter = current();
+  ++pos;
+  while (!is_at_end()) {
+    const char c = current();
+    if (c == delimiter) {
+      ++pos;
+      return true;
+    }
+
+    if (c == '\n' || c == '\r') {
+      // Unfinished string.
+      return false;
+    }
+
+    if (c != '\\') {
+      value += c;
+      ++pos;
+      continue;
+    }
+
+    ++pos;
+    if (is_at_end()) {
+      return false;
+    }
+    const char escaped = current();
+    switch (escaped) {
+      case 'a': value += '\a'; ++pos; break;
+      case 'b': value += '\b'; ++pos; break;
+      case 'f': value += '\f'; ++pos; break;
+      case 'n': value += '\n'; ++pos; break;
+      case 'r': value += '\r'; ++pos; break;
+      case 't': value += '\t'; ++pos; break;
+      case 'v': value += '\v'; ++pos; break;
+      case '\\': value += '\\'; ++pos; break;
+      case '"': value += '"'; ++pos; break;
+      case '\'': value += '\''; ++pos; break;
+
+      case '\n':
+      case '\r':
+        value += '\n';
+        ++line;
+        ++pos;
+        if (!is_at_end() &&
+            (current() == '\n' || current() == '\r') &&
+            current() != escaped) {
+          ++pos;
+        }
+        break;
+
+      default:
+        {
+          if (!std::isdigit(static_cast<unsigned char>(escaped))) {
+            // Let Lua decide what to do with other escape sequences.
+            return false;
+          }
+          int code = 0;
+          for (int i = 0; i < 3 && !is_at_end() &&
+              std::isdigit(static_cast<unsigned char>(current())); ++i) {
+            code = code * 10 + (current() - '0');
+            ++pos;
+          }
+          if (code > 255) {
+            return false;
+          }
+          value += static_cast<char>(code);
+        }
+        break;
+    }
+  }
+
+  // Unfinished string.
+  return false;
+}
+
+/**
+ * \brief Reads the opening long bracket of a long string or comment.
+ * \return The level of the bracket (number of '=' signs),
+ * or -1 if there is no valid long bracket at the current position.
+ */
+int DataFileParser::read_long_bracket_level() {
+
+  const size_t start = pos;
+  ++pos;  // Skip '['.
+  int level = 0;
+  while (!is_at_end() && current() == '=') {
+    ++level;
+    ++pos;
+  }
+  if (is_at_end() || current() != '[') {
+    pos = start;
+    return -1;
+  }
+  ++pos;
+  return level;
+}
+
+/**
+ * \brief Reads the content of a long string after its opening bracket.
+ * \param level Level of the opening bracket.
+ * \param[out] value The content of the string.
+ * \return \c false if the string is not terminated or contains a nested
+ * bracket of the same level.
+ */
+bool DataFileParser::read_long_string(int level, std::string& value) {
+
+  // Like Lua, skip a first newline and normalize newlines.
+  bool first = true;
+  while (!is_at_end()) {
+    const char c = current();
+    if (c == '\n' || c == '\r') {
+      ++line;
+      ++pos;
+      if (!is_at_end() &&
+          (current() == '\n' || current() == '\r') &&
+          current() != c) {
+        ++pos;
+      }
+      if (!first) {
+        value += '\n';
+      }
+    }
+    else if (c == ']' || c == '[') {
+      size_t i = pos + 1;
+      int num_equals = 0;
+      while (i < buffer.size() && buffer[i] == '=') {
+        ++num_equals;
+        ++i;
+      }
+      if (num_equals == level && i < buffer.size() && buffer[i] == c) {
+        if (c == '[') {
+          // Nested brackets are an error in some Lua versions.
+          return false;
+        }
+        pos = i + 1;
+        return true;
+      }
+      value += c;
+      ++pos;
+    }
+    else {
+      value += c;
+      ++pos;
+    }
+    first = false;
+  }
+
+  // Unfinished long string.
+  return false;
+}
+
+/**
+ * \brief Reads a decimal number.
+ *
+ * The decimal point is always '.', whatever the current locale.
+ *
+ * \param[out] value The number read.
+ * \return \c false if the number is malformed or not decimal.
+ */
+bool DataFileParser::read_number(lua_Number& value) {
+
+  if (is_at_end()) {
+    return false;
+  }
+
+  // Same scanning rules as the Lua lexer.
+  const size_t start = pos;
+  while (!is_at_end() &&
+      (std::isdigit(static_cast<unsigned char>(current())) || current() == '.')) {
+    ++pos;
+  }
+  if (!is_at_end() && (current() == 'e' || current() == 'E')) {
+    ++pos;
+    if (!is_at_end() && (current() == '+' || current() == '-')) {
+      ++pos;
+    }
+  }
+  while (!is_at_end() && is_name_char(current())) {
+    ++pos;
+  }
+
+  const std::string text = buffer.substr(start, pos - start);
+  if (text.empty() || text.find_first_of("xX") != std::string::npos) {
+    return false;
+  }
+
+  if (text.size() <= 15 && text.find_first_not_of("0123456789") == std::string::npos) {
+    // Most numbers of data files are small integers: exact in a double.
+    value = 0;
+    for (char digit : text) {
+      value = value * 10 + (digit - '0');
+    }
+    return true;
+  }
+
+  std::istringstream iss(text);
+  iss.imbue(std::locale::classic());
+  iss >> value;
+  return !iss.fail() && iss.peek() == std::istringstream::traits_type::eof();
+}
+
+/**
+ * \brief Returns whether the whole buffer was parsed.
+ * \return \c true if there is no more character.
+ */
+bool DataFileParser::is_at_end() const {
+  return pos >= buffer.size();
+}
+
+/**
+ * \brief Returns the character at the current position.
+ * \return The current character. The position must be valid.
+ */
+char DataFileParser::current() const {
+  return buffer[pos];
+}
+
+/**
+ * \brief Returns the character after the current position.
+ * \return The next character, or '\0' if there is none.
+ */
+char DataFileParser::next() const {
+  return pos + 1 < buffer.size() ? buffer[pos + 1] : '\0';
+}
+
+/**
+ * \brief Returns whether a character can start an identifier.
+ * \param c A character.
+ * \return \c true if it can start an identifier.
+ */
+bool DataFileParser::is_name_start(char c) {
+  return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+}
+
+/**
+ * \brief Returns whether a character can be part of an identifier.
+ * \param c A character.
+ * \return \c true if it can be part of an identifier.
+ */
+bool DataFileParser::is_name_char(char c) {
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+/**
+ * \brief Returns whether a word is reserved by Lua.
+ * \param word A word.
+ * \return \c true if it cannot be used as an identifier.
+ */
+bool DataFileParser::is_reserved_word(const std::string& word) {
+
+  static const std::set<std::string> reserved_words = {
+      "and", "break", "do", "else", "elseif", "end", "false", "for",
+      "function", "goto", "if", "in", "local", "nil", "not", "or",
+      "repeat", "return", "then", "true", "until", "while"
+  };
+  return reserved_words.find(word) != reserved_words.end();
+}
+
+bool native_parser_enabled = true;  /**< Whether DataFileParser may be used. */
+
+/**
+ * \brief Lua chunk that runs a data file already checked by a DataFileParser.
+ *
+ * The parser is the first upvalue.
+ *
+ * \param l The Lua state.
+ * \return Number of values to return to Lua.
+ */
+int l_run_parsed_data_file(lua_State* l) {
+
+  DataFileParser* parser = static_cast<DataFileParser*>(
+      lua_touserdata(l, lua_upvalueindex(1))
+  );
+  if (!parser->run(l)) {
+    return lua_error(l);
+  }
+  return 0;
+}
+
+}
+
 /**
  * \brief Imports a Lua data file from memory to this object.
  * \param[in] buffer A memory area with the content of a data file
@@ -38,7 +747,13 @@ bool LuaData::import_from_buffer(
 ) {
   // Read the file.
   lua_State* l = luaL_newstate();
-  if (luaL_loadbuffer(l, buffer.data(), buffer.size(), file_name.c_str()) != 0) {
+  DataFileParser parser(buffer, file_name);
+  if (native_parser_enabled && parser.check()) {
+    // Usual data file syntax: no need to compile it.
+    lua_pushlightuserdata(l, &parser);
+    lua_pushcclosure(l, l_run_parsed_data_file, 1);
+  }
+  else if (luaL_loadbuffer(l, buffer.data(), buffer.size(), file_name.c_str()) != 0) {
     Debug::error(std::string("Failed to load data file: ") + lua_tostring(l, -1));
     lua_pop(l, 1);
     return false;
@@ -49,6 +764,28 @@ bool LuaData::import_from_buffer(
   return success;
 }
 
+/**
+ * \brief Returns whether import_from_buffer() can read usual data files
+ * without compiling them with Lua.
+ * \return \c true if the native parser is enabled.
+ */
+bool LuaData::is_native_parser_enabled() {
+  return native_parser_enabled;
+}
+
+/**
+ * \brief Sets whether import_from_buffer() can read usual data files
+ * without compiling them with Lua.
+ *
+ * The native parser is enabled by default.
+ * Disabling it is only useful to compare its results with Lua.
+ *
+ * \param enabled \c true to enable the native parser.
+ */
+void LuaData::set_native_parser_enabled(bool enabled) {
+  native_parser_enabled = enabled;
+}
+
 /**
  * \brief Imports a Lua data file from the filesystem to this object.
  *
@@ -0,0 +1,411 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/entities/Entity.h"
+#include "solarus/entities/EntityTypeInfo.h"
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lua/ExportableToLuaPtr.h"
+#include "solarus/lua/LuaContext.h"
+#include "solarus/lua/LuaFfi.h"
+#include "solarus/movements/StraightMovement.h"
+#include "solarus/Sprite.h"
+#include <lua.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Solarus {
+
+namespace {
+
+/**
+ * \brief Returns the object of a Solarus userdata block.
+ * \param handle Address of the userdata block.
+ * \return The object, statically casted to the expected type.
+ */
+template<typename T>
+T& get_object(const void* handle) {
+  const ExportableToLuaPtr& userdata = *static_cast<const ExportableToLuaPtr*>(handle);
+  return static_cast<T&>(*userdata);
+}
+
+/**
+ * \brief Lua code that replaces hot methods by wrappers of the C accessors.
+ *
+ * Arguments: the table of C function pointers, then sets of the metatables
+ * of entities, sprites, movements and straight movements.
+ * Does nothing if the FFI is not available.
+ * Wrappers are shared by all metatables of a family, so scripts can store
+ * one in a local variable and use it with any entity of any type.
+ * Calls with unexpected arguments are forwarded to the classic
+ * implementation, which raises the usual errors.
+ */
+const char* ffi_accessors_code =
+"local c, entity_mts, sprite_mts, movement_mts, straight_movement_mts = ...\n"
+"local ok, ffi = pcall(require, 'ffi')\n"
+"if not ok then\n"
+"  return\n"
+"end\n"
+"local getmetatable, type = getmetatable, type\n"
+"local values = ffi.new('int[4]')\n"
+"local function install(metatables, name, c_name, signature, make_wrapper)\n"
+"  if c[c_name] == nil then\n"
+"    return  -- No C function: keep the classic binding.\n"
+"  end\n"
+"  local classic\n"
+"  for mt in pairs(metatables) do\n"
+"    classic = classic or mt[name]\n"
+"  end\n"
+"  local wrapper = make_wrapper(ffi.cast(signature, c[c_name]), classic)\n"
+"  for mt in pairs(metatables) do\n"
+"    mt[name] = wrapper\n"
+"  end\n"
+"end\n"
+"local function install_getter(metatables, name, c_name, signature, num_values)\n"
+"  install(metatables, name, c_name, signature, function(f, classic)\n"
+"    if num_values == 2 then\n"
+"      return function(object)\n"
+"        if not metatables[getmetatable(object)] then return classic(object) end\n"
+"        f(object, values)\n"
+"        return values[0], values[1]\n"
+"      end\n"
+"    elseif num_values == 3 then\n"
+"      return function(object)\n"
+"        if not metatables[getmetatable(object)] then return classic(object) end\n"
+"        f(object, values)\n"
+"        return values[0], values[1], values[2]\n"
+"      end\n"
+"    elseif num_values == 4 then\n"
+"      return function(object)\n"
+"        if not metatables[getmetatable(object)] then return classic(object) end\n"
+"        f(object, values)\n"
+"        return values[0], values[1], values[2], values[3]\n"
+"      end\n"
+"    end\n"
+"    return function(object)\n"
+"      if not metatables[getmetatable(object)] then return classic(object) end\n"
+"      return f(object)\n"
+"    end\n"
+"  end)\n"
+"end\n"
+"local function install_boolean_getter(metatables, name, c_name, signature)\n"
+"  install(metatables, name, c_name, signature, function(f, classic)\n"
+"    return function(object)\n"
+"      if not metatables[getmetatable(object)] then return classic(object) end\n"
+"      return f(object) ~= 0\n"
+"    end\n"
+"  end)\n"
+"end\n"
+"\n"
+"install_getter(entity_mts, 'get_position', 'entity_get_position', 'void (*)(const void*, int*)', 3)\n"
+"install_getter(entity_mts, 'get_center_position', 'entity_get_center_position', 'void (*)(const void*, int*)', 3)\n"
+"install_getter(entity_mts, 'get_bounding_box', 'entity_get_bounding_box', 'void (*)(const void*, int*)', 4)\n"
+"install_getter(entity_mts, 'get_size', 'entity_get_size', 'void (*)(const void*, int*)', 2)\n"
+"install_getter(entity_mts, 'get_origin', 'entity_get_origin', 'void (*)(const void*, int*)', 2)\n"
+"install_boolean_getter(entity_mts, 'is_enabled', 'entity_is_enabled', 'int (*)(const void*)')\n"
+"install_boolean_getter(entity_mts, 'is_visible', 'entity_is_visible', 'int (*)(const void*)')\n"
+"install(entity_mts, 'set_visible', 'entity_set_visible', 'void (*)(void*, int)', function(f, classic)\n"
+"  return function(entity, visible)\n"
+"    if visible == nil then visible = true end\n"
+"    if not entity_mts[getmetatable(entity)] or type(visible) ~= 'boolean' then\n"
+"      return classic(entity, visible)\n"
+"    end\n"
+"    f(entity, visible and 1 or 0)\n"
+"  end\n"
+"end)\n"
+"\n"
+"install_getter(sprite_mts, 'get_direction', 'sprite_get_direction', 'int (*)(const void*)', 1)\n"
+"install_getter(sprite_mts, 'get_frame', 'sprite_get_frame', 'int (*)(const void*)', 1)\n"
+"install_boolean_getter(sprite_mts, 'is_paused', 'sprite_is_paused', 'int (*)(const void*)')\n"
+"install_getter(sprite_mts, 'get_xy', 'sprite_get_xy', 'void (*)(const void*, int*)', 2)\n"
+"install(sprite_mts, 'set_xy', 'sprite_set_xy', 'void (*)(void*, int, int)', function(f, classic)\n"
+"  return function(sprite, x, y)\n"
+"    if not sprite_mts[getmetatable(sprite)] or type(x) ~= 'number' or type(y) ~= 'number' then\n"
+"      return classic(sprite, x, y)\n"
+"    end\n"
+"    f(sprite, x, y)\n"
+"  end\n"
+"end)\n"
+"\n"
+"install_getter(movement_mts, 'get_xy', 'movement_get_xy', 'void (*)(const void*, int*)', 2)\n"
+"install_getter(straight_movement_mts, 'get_speed', 'straight_movement_get_speed', 'int (*)(const void*)', 1)\n"
+"install_getter(straight_movement_mts, 'get_angle', 'straight_movement_get_angle', 'double (*)(const void*)', 1)\n";
+
+/**
+ * \brief Pushes a table whose keys are the metatables of some types.
+ * \param l A Lua state.
+ * \param module_names Names of the types.
+ */
+void push_metatable_set(lua_State* l, const std::vector<std::string>& module_names) {
+
+  lua_newtable(l);
+                                  // set
+  for (const std::string& module_name : module_names) {
+    luaL_getmetatable(l, module_name.c_str());
+                                  // set mt
+    Debug::check_assertion(!lua_isnil(l, -1),
+        std::string("Missing metatable ") + module_name);
+    lua_pushboolean(l, true);
+                                  // set mt true
+    lua_rawset(l, -3);
+                                  // set
+  }
+}
+
+}
+
+/**
+ * \brief Replaces the hot getters and setters of entities, sprites and
+ * movements by FFI wrappers if LuaJIT is used.
+ *
+ * Must be called after the modules of these types are registered.
+ * With the standard Lua, the classic bindings are kept.
+ */
+void LuaContext::register_ffi_accessors() {
+
+  int result = luaL_loadstring(l, ffi_accessors_code);
+  if (result != 0) {
+    Debug::error(std::string("Failed to initialize FFI accessors: ") + lua_tostring(l, -1));
+    lua_pop(l, 1);
+    return;
+  }
+                                  // code
+
+  // Addresses of the C functions.
+  const std::vector<std::pair<const char*, void*>> functions = {
+      { "entity_get_position", reinterpret_cast<void*>(&solarus_entity_get_position) },
+      { "entity_get_center_position", reinterpret_cast<void*>(&solarus_entity_get_center_position) },
+      { "entity_get_bounding_box", reinterpret_cast<void*>(&solarus_entity_get_bounding_box) },
+      { "entity_get_size", reinterpret_cast<void*>(&solarus_entity_get_size) },
+      { "entity_get_origin", reinterpret_cast<void*>(&solarus_entity_get_origin) },
+      { "entity_is_enabled", reinterpret_cast<void*>(&solarus_entity_is_enabled) },
+      { "entity_is_visible", reinterpret_cast<void*>(&solarus_entity_is_visible) },
+      { "entity_set_visible", reinterpret_cast<void*>(&solarus_entity_set_visible) },
+      { "sprite_get_direction", reinterpret_cast<void*>(&solarus_sprite_get_direction) },
+      { "sprite_get_frame", reinterpret_cast<void*>(&solarus_sprite_get_frame) },
+      { "sprite_is_paused", reinterpret_cast<void*>(&solarus_sprite_is_paused) },
+      { "sprite_get_xy", reinterpret_cast<void*>(&solarus_sprite_get_xy) },
+      { "sprite_set_xy", reinterpret_cast<void*>(&solarus_sprite_set_xy) },
+      { "movement_get_xy", reinterpret_cast<void*>(&solarus_movement_get_xy) },
+      { "straight_movement_get_speed", reinterpret_cast<void*>(&solarus_straight_movement_get_speed) },
+      { "straight_movement_get_angle", reinterpret_cast<void*>(&solarus_straight_movement_get_angle) },
+  };
+  lua_newtable(l);
+                                  // code c
+  for (const auto& function : functions) {
+    lua_pushlightuserdata(l, function.second);
+    lua_setfield(l, -2, function.first);
+  }
+
+  std::vector<std::string> entity_module_names;
+  for (const auto& kvp : EnumInfoTraits<EntityType>::names) {
+    entity_module_names.push_back(get_entity_internal_type_name(kvp.first));
+  }
+  push_metatable_set(l, entity_module_names);
+  push_metatable_set(l, { sprite_module_name });
+  push_metatable_set(l, {
+      movement_module_name,
+      movement_straight_module_name,
+      movement_target_module_name,
+      movement_random_module_name,
+      movement_path_module_name,
+      movement_random_path_module_name,
+      movement_path_finding_module_name,
+      movement_circle_module_name,
+      movement_jump_module_name,
+      movement_pixel_module_name
+  });
+  push_metatable_set(l, { movement_straight_module_name });
+                                  // code c entity_mts sprite_mts movement_mts straight_mts
+
+  call_function(5, 0, "FFI accessors");
+                                  // --
+}
+
+}
+
+extern "C" {
+
+using namespace Solarus;
+
+/**
+ * \brief Gets the position of an entity like entity:get_position().
+ * \param entity An entity handle.
+ * \param x_y_layer Array of 3 values to fill.
+ */
+void solarus_entity_get_position(const void* entity, int* x_y_layer) {
+  const Entity& e = get_object<const Entity>(entity);
+  x_y_layer[0] = e.get_x();
+  x_y_layer[1] = e.get_y();
+  x_y_layer[2] = e.get_layer();
+}
+
+/**
+ * \brief Gets the center point of an entity like
+ * entity:get_center_position().
+ * \param entity An entity handle.
+ * \param x_y_layer Array of 3 values to fill.
+ */
+void solarus_entity_get_center_position(const void* entity, int* x_y_layer) {
+  const Entity& e = get_object<const Entity>(entity);
+  const Point& center_point = e.get_center_point();
+  x_y_layer[0] = center_point.x;
+  x_y_layer[1] = center_point.y;
+  x_y_layer[2] = e.get_layer();
+}
+
+/**
+ * \brief Gets the bounding box of an entity like entity:get_bounding_box().
+ * \param entity An entity handle.
+ * \param x_y_width_height Array of 4 values to fill.
+ */
+void solarus_entity_get_bounding_box(const void* entity, int* x_y_width_height) {
+  const Rectangle& bounding_box = get_object<const Entity>(entity).get_bounding_box();
+  x_y_width_height[0] = bounding_box.get_x();
+  x_y_width_height[1] = bounding_box.get_y();
+  x_y_width_height[2] = bounding_box.get_width();
+  x_y_width_height[3] = bounding_box.get_height();
+}
+
+/**
+ * \brief Gets the size of an entity like entity:get_size().
+ * \param entity An entity handle.
+ * \param width_height Array of 2 values to fill.
+ */
+void solarus_entity_get_size(const void* entity, int* width_height) {
+  const Entity& e = get_object<const Entity>(entity);
+  width_height[0] = e.get_width();
+  width_height[1] = e.get_height();
+}
+
+/**
+ * \brief Gets the origin of an entity like entity:get_origin().
+ * \param entity An entity handle.
+ * \param x_y Array of 2 values to fill.
+ */
+void solarus_entity_get_origin(const void* entity, int* x_y) {
+  const Point& origin = get_object<const Entity>(entity).get_origin();
+  x_y[0] = origin.x;
+  x_y[1] = origin.y;
+}
+
+/**
+ * \brief Returns whether an entity is enabled like entity:is_enabled().
+ * \param entity An entity handle.
+ * \return 1 if the entity is enabled, 0 otherwise.
+ */
+int solarus_entity_is_enabled(const void* entity) {
+  return get_object<const Entity>(entity).is_enabled() ? 1 : 0;
+}
+
+/**
+ * \brief Returns whether an entity is visible like entity:is_visible().
+ * \param entity An entity handle.
+ * \return 1 if the entity is visible, 0 otherwise.
+ */
+int solarus_entity_is_visible(const void* entity) {
+  return get_object<const Entity>(entity).is_visible() ? 1 : 0;
+}
+
+/**
+ * \brief Shows or hides an entity like entity:set_visible().
+ * \param entity An entity handle.
+ * \param visible 0 to hide the entity.
+ */
+void solarus_entity_set_visible(void* entity, int visible) {
+  get_object<Entity>(entity).set_visible(visible != 0);
+}
+
+/**
+ * \brief Returns the direction of a sprite like sprite:get_direction().
+ * \param sprite A sprite handle.
+ * \return The current direction.
+ */
+int solarus_sprite_get_direction(const void* sprite) {
+  return get_object<const Sprite>(sprite).get_current_direction();
+}
+
+/**
+ * \brief Returns the frame of a sprite like sprite:get_frame().
+ * \param sprite A sprite handle.
+ * \return The current frame.
+ */
+int solarus_sprite_get_frame(const void* sprite) {
+  return get_object<const Sprite>(sprite).get_current_frame();
+}
+
+/**
+ * \brief Returns whether a sprite is paused like sprite:is_paused().
+ * \param sprite A sprite handle.
+ * \return 1 if the sprite is paused, 0 otherwise.
+ */
+int solarus_sprite_is_paused(const void* sprite) {
+  return get_object<const Sprite>(sprite).is_paused() ? 1 : 0;
+}
+
+/**
+ * \brief Gets the offset of a sprite like sprite:get_xy().
+ * \param sprite A sprite handle.
+ * \param x_y Array of 2 values to fill.
+ */
+void solarus_sprite_get_xy(const void* sprite, int* x_y) {
+  const Point& xy = get_object<const Sprite>(sprite).get_xy();
+  x_y[0] = xy.x;
+  x_y[1] = xy.y;
+}
+
+/**
+ * \brief Sets the offset of a sprite like sprite:set_xy().
+ * \param sprite A sprite handle.
+ * \param x The new x offset.
+ * \param y The new y offset.
+ */
+void solarus_sprite_set_xy(void* sprite, int x, int y) {
+  get_object<Sprite>(sprite).set_xy(Point(x, y));
+}
+
+/**
+ * \brief Gets the coordinates of a movement like movement:get_xy().
+ * \param movement A movement handle of any type.
+ * \param x_y Array of 2 values to fill.
+ */
+void solarus_movement_get_xy(const void* movement, int* x_y) {
+  const Point& xy = get_object<const Movement>(movement).get_xy();
+  x_y[0] = xy.x;
+  x_y[1] = xy.y;
+}
+
+/**
+ * \brief Returns the speed of a straight movement like
+ * straight_movement:get_speed().
+ * \param movement A straight movement handle.
+ * \return The speed in pixels per second, truncated.
+ */
+int solarus_straight_movement_get_speed(const void* movement) {
+  return static_cast<int>(get_object<const StraightMovement>(movement).get_speed());
+}
+
+/**
+ * \brief Returns the angle of a straight movement like
+ * straight_movement:get_angle().
+ * \param movement A straight movement handle.
+ * \return The angle in radians.
+ */
+double solarus_straight_movement_get_angle(const void* movement) {
+  return get_object<const StraightMovement>(movement).get_angle();
+}
+
+}
@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Logger.h"
+#include "solarus/lowlevel/String.h"
+#include "solarus/lua/LuaProfiler.h"
+#include "solarus/Arguments.h"
+#include <lua.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Solarus {
+
+namespace {
+
+constexpr int max_stack_depth = 64;       /**< Frames beyond this depth are ignored. */
+
+bool running = false;                     /**< Whether samples are being recorded. */
+lua_State* main_state = nullptr;          /**< The Lua state to profile. */
+std::string output_file;                  /**< File where to write the result. */
+int sampling_period = LuaProfiler::default_period;
+                                          /**< Instructions between two samples. */
+std::unordered_map<std::string, uint64_t>
+    samples;                              /**< Number of samples of each collapsed stack. */
+std::vector<std::string> frames;          /**< Frames of the current sample, reused. */
+std::string stack;                        /**< Collapsed stack of the current sample, reused. */
+
+/**
+ * \brief Returns a flame graph frame name for a Lua function being executed.
+ * \param frame Debug information with at least "Sln".
+ * \return The frame name, without semicolons.
+ */
+std::string get_frame_name(const lua_Debug& frame) {
+
+  std::ostringstream oss;
+  if (frame.name != nullptr) {
+    oss << frame.name;
+  }
+  else if (frame.what != nullptr && std::string(frame.what) == "main") {
+    oss << "main chunk";
+  }
+  else {
+    oss << "?";
+  }
+
+  // Solarus loads scripts with their file name as chunk name.
+  std::string source = frame.source != nullptr ? frame.source : "";
+  if (!source.empty() && (source[0] == '@' || source[0] == '=')) {
+    source = source.substr(1);
+  }
+  else if (source.empty() || source.size() > 128 || source.find('\n') != std::string::npos) {
+    // Code given as a string.
+    source = frame.short_src;
+  }
+
+  oss << " (" << source;
+  if (frame.currentline > 0) {
+    oss << ':' << frame.currentline;
+  }
+  oss << ')';
+
+  std::string name = oss.str();
+  std::replace(name.begin(), name.end(), ';', ',');
+  return name;
+}
+
+/**
+ * \brief Lua hook that records the current call stack.
+ * \param l The Lua thread being executed.
+ * \param ar Information about the hook event.
+ */
+void sample_hook(lua_State* l, lua_Debug* /* ar */) {
+
+  if (!running) {
+    // A coroutine created while profiling still has the hook.
+    lua_sethook(l, nullptr, 0, 0);
+    return;
+  }
+
+  frames.clear();
+  lua_Debug frame;
+  for (int level = 0;
+      level < max_stack_depth && lua_getstack(l, level, &frame);
+      ++level) {
+    lua_getinfo(l, "Sln", &frame);
+    frames.push_back(get_frame_name(frame));
+  }
+
+  // Outermost frame first.
+  stack.clear();
+  for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+    if (!stack.empty()) {
+      stack += ';';
+    }
+    stack += *it;
+  }
+  ++samples[stack];
+}
+
+/**
+ * \brief Installs or removes the profiling hook on the Lua state.
+ */
+void update_hook() {
+
+  if (main_state == nullptr) {
+    return;
+  }
+
+  if (running) {
+    lua_sethook(main_state, sample_hook, LUA_MASKCOUNT, sampling_period);
+  }
+  else {
+    lua_sethook(main_state, nullptr, 0, 0);
+  }
+}
+
+}
+
+/**
+ * \brief Starts profiling Lua if the -lua-profile option is set.
+ *
+ * Supported options:
+ *   -lua-profile=FILE
+ *   -lua-profile-period=INSTRUCTIONS
+ *
+ * Profiling actually begins when the Lua state is created.
+ *
+ * \param args Command-line arguments.
+ */
+void LuaProfiler::initialize(const Arguments& args) {
+
+  const std::string& file_name = args.get_argument_value("-lua-profile");
+  if (file_name.empty()) {
+    return;
+  }
+
+  int period = default_period;
+  const std::string& period_arg = args.get_argument_value("-lua-profile-period");
+  if (!period_arg.empty()) {
+    std::istringstream iss(period_arg);
+    if (!(iss >> period) || period <= 0) {
+      Debug::error("Invalid Lua profile period: '" + period_arg + "'");
+      period = default_period;
+    }
+  }
+
+  start(file_name, period);
+}
+
+/**
+ * \brief Stops profiling and writes the result if the profiler is running.
+ */
+void LuaProfiler::quit() {
+
+  stop();
+  main_state = nullptr;
+}
+
+/**
+ * \brief Sets the Lua state to profile.
+ *
+ * Call this function when the Lua state is created and with nullptr before
+ * it is closed.
+ * Samples are kept when the Lua state is replaced.
+ *
+ * \param l The Lua state or nullptr.
+ */
+void LuaProfiler::set_lua_state(lua_State* l) {
+
+  if (main_state != nullptr && running) {
+    lua_sethook(main_state, nullptr, 0, 0);
+  }
+  main_state = l;
+  update_hook();
+}
+
+/**
+ * \brief Returns whether Lua is being profiled.
+ * \return \c true if samples are being recorded.
+ */
+bool LuaProfiler::is_running() {
+  return running;
+}
+
+/**
+ * \brief Starts profiling Lua.
+ *
+ * If the profiler was already running, it is stopped first
+ * and its result is written.
+ *
+ * \param output_file_name File to write when the profiler stops.
+ * \param period Number of Lua instructions between two samples.
+ * \return \c true in case of success.
+ */
+bool LuaProfiler::start(const std::string& output_file_name, int period) {
+
+  stop();
+
+  if (output_file_name.empty()) {
+    Debug::error("Missing Lua profile file name");
+    return false;
+  }
+
+  output_file = output_file_name;
+  sampling_period = std::max(1, period);
+  samples.clear();
+  running = true;
+  update_hook();
+
+  Logger::info("Lua profiler: started, writing to '" + output_file + "'");
+  return true;
+}
+
+/**
+ * \brief Stops profiling Lua and writes the collapsed stacks.
+ *
+ * Does nothing if the profiler is not running.
+ *
+ * \return The number of samples recorded.
+ */
+int LuaProfiler::stop() {
+
+  if (!running) {
+    return 0;
+  }
+
+  running = false;
+  update_hook();
+
+  // Sort stacks to get a stable output.
+  std::vector<std::pair<std::string, uint64_t>> sorted_samples(
+      samples.begin(), samples.end()
+  );
+  std::sort(sorted_samples.begin(), sorted_samples.end());
+  samples.clear();
+
+  uint64_t num_samples = 0;
+  std::ofstream out(output_file);
+  for (const std::pair<std::string, uint64_t>& sample : sorted_samples) {
+    out << sample.first << ' ' << sample.second << '\n';
+    num_samples += sample.second;
+  }
+  out.close();
+
+  if (!out) {
+    Debug::error("Cannot write Lua profile file '" + output_file + "'");
+  }
+  else {
+    Logger::info("Lua profiler: " + String::to_string(num_samples) +
+        " samples written to '" + output_file + "'");
+  }
+
+  return int(num_samples);
+}
+
+}
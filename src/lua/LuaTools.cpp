@@ -25,6 +25,70 @@
 namespace Solarus {
 namespace LuaTools {
 
+namespace {
+
+/**
+ * \brief Address used as the key of the symbol cache in the Lua registry.
+ */
+char symbol_cache_key;
+
+/**
+ * \brief Pushes onto the stack the symbol cache of a Lua state.
+ *
+ * This table maps Lua strings to symbol handles (light userdata) and
+ * symbol handles back to Lua strings.
+ * Lua strings are already interned: looking up a string key only
+ * compares pointers, so symbols are converted in both directions without
+ * hashing or copying the characters again.
+ * The table is created the first time.
+ *
+ * \param l A Lua state.
+ */
+void push_symbol_cache(lua_State* l) {
+
+  lua_pushlightuserdata(l, &symbol_cache_key);
+                                  // ... key
+  lua_rawget(l, LUA_REGISTRYINDEX);
+                                  // ... cache/nil
+  if (lua_isnil(l, -1)) {
+    lua_pop(l, 1);
+                                  // ...
+    lua_newtable(l);
+                                  // ... cache
+    lua_pushlightuserdata(l, &symbol_cache_key);
+                                  // ... cache key
+    lua_pushvalue(l, -2);
+                                  // ... cache key cache
+    lua_rawset(l, LUA_REGISTRYINDEX);
+                                  // ... cache
+  }
+}
+
+/**
+ * \brief Stores in the symbol cache the Lua string of a symbol.
+ * \param l A Lua state with the cache at index -2 and the string at -1.
+ * \param symbol The symbol of this string.
+ */
+void add_to_symbol_cache(lua_State* l, const Symbol& symbol) {
+
+  void* handle = const_cast<void*>(symbol.get_handle());
+                                  // ... cache string
+  lua_pushvalue(l, -1);
+                                  // ... cache string string
+  lua_pushlightuserdata(l, handle);
+                                  // ... cache string string handle
+  lua_rawset(l, -4);
+                                  // ... cache string
+  lua_pushlightuserdata(l, handle);
+                                  // ... cache string handle
+  lua_pushvalue(l, -2);
+                                  // ... cache string handle string
+  lua_rawset(l, -4);
+                                  // ... cache string
+}
+
+}  // Anonymous namespace.
+
 /**
  * \brief For an index in the Lua stack, returns an equivalent positive index.
  *
@@ -574,6 +638,102 @@ std::string opt_string_field(
   return value;
 }
 
+/**
+ * \brief Checks that the value at the given index is a string and returns
+ * it as a symbol.
+ *
+ * Strings already converted once in this Lua state are found without
+ * hashing them or allocating memory.
+ *
+ * \param l A Lua state.
+ * \param index An index in the stack.
+ * \return The string as a symbol.
+ */
+Symbol check_symbol(
+    lua_State* l,
+    int index
+) {
+  if (lua_type(l, index) != LUA_TSTRING) {
+    // Numbers are accepted too but they are not cached.
+    return Symbol(check_string(l, index));
+  }
+
+  index = get_positive_index(l, index);
+  push_symbol_cache(l);
+                                  // ... cache
+  lua_pushvalue(l, index);
+                                  // ... cache string
+  lua_rawget(l, -2);
+                                  // ... cache handle/nil
+  if (lua_islightuserdata(l, -1)) {
+    Symbol symbol = Symbol::from_handle(lua_touserdata(l, -1));
+    lua_pop(l, 2);
+                                  // ...
+    return symbol;
+  }
+  lua_pop(l, 1);
+                                  // ... cache
+
+  size_t size = 0;
+  const char* name = lua_tolstring(l, index, &size);
+  Symbol symbol(std::string(name, size));
+  lua_pushvalue(l, index);
+                                  // ... cache string
+  add_to_symbol_cache(l, symbol);
+  lua_pop(l, 2);
+                                  // ...
+  return symbol;
+}
+
+/**
+ * \brief Like LuaTools::check_symbol() but the value is optional.
+ * \param l A Lua state.
+ * \param index An index in the stack.
+ * \param default_value The default value to return if the value is \c nil.
+ * \return The string as a symbol.
+ */
+Symbol opt_symbol(
+    lua_State* l,
+    int index,
+    const Symbol& default_value
+) {
+  if (lua_isnoneornil(l, index)) {
+    return default_value;
+  }
+  return check_symbol(l, index);
+}
+
+/**
+ * \brief Pushes the string of a symbol onto the stack.
+ *
+ * Symbols already pushed once in this Lua state reuse the same Lua string
+ * without hashing it again.
+ *
+ * \param l A Lua state.
+ * \param symbol The symbol to push.
+ */
+void push_symbol(
+    lua_State* l,
+    const Symbol& symbol
+) {
+  push_symbol_cache(l);
+                                  // ... cache
+  lua_pushlightuserdata(l, const_cast<void*>(symbol.get_handle()));
+                                  // ... cache handle
+  lua_rawget(l, -2);
+                                  // ... cache string/nil
+  if (lua_isnil(l, -1)) {
+    lua_pop(l, 1);
+                                  // ... cache
+    const std::string& name = symbol.str();
+    lua_pushlstring(l, name.c_str(), name.size());
+                                  // ... cache string
+    add_to_symbol_cache(l, symbol);
+  }
+  lua_remove(l, -2);
+                                  // ... string
+}
+
 /**
  * \brief Checks that a value is a boolean and returns it.
  *
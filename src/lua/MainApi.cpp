@@ -15,6 +15,7 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "solarus/lua/LuaContext.h"
+#include "solarus/lua/LuaProfiler.h"
 #include "solarus/lua/LuaTools.h"
 #include "solarus/lowlevel/Geometry.h"
 #include "solarus/lowlevel/QuestFiles.h"
@@ -54,6 +55,9 @@ void LuaContext::register_main_module() {
       { "get_type", main_api_get_type },
       { "get_metatable", main_api_get_metatable },
       { "get_os", main_api_get_os },
+      { "start_profiler", main_api_start_profiler },
+      { "stop_profiler", main_api_stop_profiler },
+      { "is_profiling", main_api_is_profiling },
       { nullptr, nullptr }
   };
 
@@ -374,6 +378,62 @@ int LuaContext::main_api_get_os(lua_State* l) {
   return 1;
 }
 
+/**
+ * \brief Implementation of sol.main.start_profiler().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::main_api_start_profiler(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const std::string& file_name = LuaTools::check_string(l, 1);
+    int period = LuaTools::opt_int(l, 2, LuaProfiler::default_period);
+
+    if (period <= 0) {
+      LuaTools::arg_error(l, 2, "Invalid sampling period: must be positive");
+    }
+
+    if (QuestFiles::get_quest_write_dir().empty()) {
+      LuaTools::error(l, "Cannot start the profiler: no write directory was specified in quest.dat");
+    }
+
+    // The file is relative to the quest write directory.
+    const std::string& output_file = QuestFiles::get_full_quest_write_dir() + "/" + file_name;
+
+    LuaProfiler::start(output_file, period);
+
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of sol.main.stop_profiler().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::main_api_stop_profiler(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    int num_samples = LuaProfiler::stop();
+
+    lua_pushinteger(l, num_samples);
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of sol.main.is_profiling().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::main_api_is_profiling(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    lua_pushboolean(l, LuaProfiler::is_running());
+    return 1;
+  });
+}
+
 /**
  * \brief Calls sol.main.on_started() if it exists.
  *
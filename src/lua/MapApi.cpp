@@ -59,6 +59,8 @@
 #include "solarus/Timer.h"
 #include "solarus/Treasure.h"
 #include <lua.hpp>
+#include <algorithm>
+#include <cstdlib>
 #include <sstream>
 
 namespace Solarus {
@@ -149,6 +151,8 @@ void LuaContext::register_map_module() {
       { "get_entities_by_type", map_api_get_entities_by_type },
       { "get_entities_in_rectangle", map_api_get_entities_in_rectangle },
       { "get_entities_in_region", map_api_get_entities_in_region },
+      { "get_entities_on_segment", map_api_get_entities_on_segment },
+      { "raycast", map_api_raycast },
       { "get_hero", map_api_get_hero },
       { "set_entities_enabled", map_api_set_entities_enabled },
       { "remove_entities", map_api_remove_entities },
@@ -207,9 +211,9 @@ bool LuaContext::is_map(lua_State* l, int index) {
  * \param index An index in the stack.
  * \return The map.
  */
-std::shared_ptr<Map> LuaContext::check_map(lua_State* l, int index) {
+IntrusivePtr<Map> LuaContext::check_map(lua_State* l, int index) {
 
-  return std::static_pointer_cast<Map>(check_userdata(
+  return static_pointer_cast<Map>(check_userdata(
       l, index, map_module_name
   ));
 }
@@ -462,7 +466,7 @@ int LuaContext::l_create_destination(lua_State* l) {
     Map& map = *check_map(l, 1);
     EntityData& data = *(static_cast<EntityData*>(lua_touserdata(l, 2)));
 
-    std::shared_ptr<Destination> entity = std::make_shared<Destination>(
+    IntrusivePtr<Destination> entity = make_intrusive<Destination>(
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
         data.get_xy(),
@@ -494,7 +498,7 @@ int LuaContext::l_create_teletransporter(lua_State* l) {
     Map& map = *check_map(l, 1);
     EntityData& data = *(static_cast<EntityData*>(lua_touserdata(l, 2)));
 
-    EntityPtr entity = std::make_shared<Teletransporter>(
+    EntityPtr entity = make_intrusive<Teletransporter>(
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
         data.get_xy(),
@@ -535,7 +539,7 @@ int LuaContext::l_create_pickable(lua_State* l) {
       force_persistent = true;
     }
 
-    const std::shared_ptr<Pickable>& entity = Pickable::create(
+    const IntrusivePtr<Pickable>& entity = Pickable::create(
         game,
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
@@ -576,7 +580,7 @@ int LuaContext::l_create_destructible(lua_State* l) {
     Map& map = *check_map(l, 1);
     EntityData& data = *(static_cast<EntityData*>(lua_touserdata(l, 2)));
 
-    std::shared_ptr<Destructible> destructible = std::make_shared<Destructible>(
+    IntrusivePtr<Destructible> destructible = make_intrusive<Destructible>(
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
         data.get_xy(),
@@ -643,7 +647,7 @@ int LuaContext::l_create_chest(lua_State* l) {
       }
     }
 
-    std::shared_ptr<Chest> chest = std::make_shared<Chest>(
+    IntrusivePtr<Chest> chest = make_intrusive<Chest>(
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
         data.get_xy(),
@@ -679,7 +683,7 @@ int LuaContext::l_create_jumper(lua_State* l) {
     Map& map = *check_map(l, 1);
     EntityData& data = *(static_cast<EntityData*>(lua_touserdata(l, 2)));
 
-    EntityPtr entity = std::make_shared<Jumper>(
+    EntityPtr entity = make_intrusive<Jumper>(
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
         data.get_xy(),
@@ -747,7 +751,7 @@ int LuaContext::l_create_npc(lua_State* l) {
     EntityData& data = *(static_cast<EntityData*>(lua_touserdata(l, 2)));
 
     Game& game = map.get_game();
-    EntityPtr entity = std::make_shared<Npc>(
+    EntityPtr entity = make_intrusive<Npc>(
         game,
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
@@ -783,7 +787,7 @@ int LuaContext::l_create_block(lua_State* l) {
       oss << "Invalid maximum_moves: " << maximum_moves;
       LuaTools::arg_error(l, 1, oss.str());
     }
-    std::shared_ptr<Block> entity = std::make_shared<Block>(
+    IntrusivePtr<Block> entity = make_intrusive<Block>(
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
         data.get_xy(),
@@ -813,7 +817,7 @@ int LuaContext::l_create_dynamic_tile(lua_State* l) {
     Map& map = *check_map(l, 1);
     EntityData& data = *(static_cast<EntityData*>(lua_touserdata(l, 2)));
 
-    EntityPtr entity = std::make_shared<DynamicTile>(
+    EntityPtr entity = make_intrusive<DynamicTile>(
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
         data.get_xy(),
@@ -842,7 +846,7 @@ int LuaContext::l_create_switch(lua_State* l) {
     Map& map = *check_map(l, 1);
     EntityData& data = *(static_cast<EntityData*>(lua_touserdata(l, 2)));
 
-    EntityPtr entity = std::make_shared<Switch>(
+    EntityPtr entity = make_intrusive<Switch>(
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
         data.get_xy(),
@@ -872,7 +876,7 @@ int LuaContext::l_create_wall(lua_State* l) {
     Map& map = *check_map(l, 1);
     EntityData& data = *(static_cast<EntityData*>(lua_touserdata(l, 2)));
 
-    EntityPtr entity = std::make_shared<Wall>(
+    EntityPtr entity = make_intrusive<Wall>(
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
         data.get_xy(),
@@ -903,7 +907,7 @@ int LuaContext::l_create_sensor(lua_State* l) {
     Map& map = *check_map(l, 1);
     EntityData& data = *(static_cast<EntityData*>(lua_touserdata(l, 2)));
 
-    EntityPtr entity = std::make_shared<Sensor>(
+    EntityPtr entity = make_intrusive<Sensor>(
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
         data.get_xy(),
@@ -929,7 +933,7 @@ int LuaContext::l_create_crystal(lua_State* l) {
     Map& map = *check_map(l, 1);
     EntityData& data = *(static_cast<EntityData*>(lua_touserdata(l, 2)));
 
-    EntityPtr entity = std::make_shared<Crystal>(
+    EntityPtr entity = make_intrusive<Crystal>(
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
         data.get_xy()
@@ -955,7 +959,7 @@ int LuaContext::l_create_crystal_block(lua_State* l) {
     EntityData& data = *(static_cast<EntityData*>(lua_touserdata(l, 2)));
 
     Game& game = map.get_game();
-    EntityPtr entity = std::make_shared<CrystalBlock>(
+    EntityPtr entity = make_intrusive<CrystalBlock>(
         game,
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
@@ -1024,7 +1028,7 @@ int LuaContext::l_create_stream(lua_State* l) {
     Map& map = *check_map(l, 1);
     EntityData& data = *(static_cast<EntityData*>(lua_touserdata(l, 2)));
 
-    std::shared_ptr<Stream> stream = std::make_shared<Stream>(
+    IntrusivePtr<Stream> stream = make_intrusive<Stream>(
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
         data.get_xy(),
@@ -1083,7 +1087,7 @@ int LuaContext::l_create_door(lua_State* l) {
         );
       }
     }
-    std::shared_ptr<Door> door = std::make_shared<Door>(
+    IntrusivePtr<Door> door = make_intrusive<Door>(
         game,
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
@@ -1116,7 +1120,7 @@ int LuaContext::l_create_stairs(lua_State* l) {
     Map& map = *check_map(l, 1);
     EntityData& data = *(static_cast<EntityData*>(lua_touserdata(l, 2)));
 
-    EntityPtr entity = std::make_shared<Stairs>(
+    EntityPtr entity = make_intrusive<Stairs>(
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
         data.get_xy(),
@@ -1143,7 +1147,7 @@ int LuaContext::l_create_separator(lua_State* l) {
     Map& map = *check_map(l, 1);
     EntityData& data = *(static_cast<EntityData*>(lua_touserdata(l, 2)));
 
-    EntityPtr entity = std::make_shared<Separator>(
+    EntityPtr entity = make_intrusive<Separator>(
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
         data.get_xy(),
@@ -1170,7 +1174,7 @@ int LuaContext::l_create_custom_entity(lua_State* l) {
     EntityData& data = *(static_cast<EntityData*>(lua_touserdata(l, 2)));
 
     Game& game = map.get_game();
-    EntityPtr entity = std::make_shared<CustomEntity>(
+    EntityPtr entity = make_intrusive<CustomEntity>(
         game,
         data.get_name(),
         data.get_integer("direction"),
@@ -1200,7 +1204,7 @@ int LuaContext::l_create_bomb(lua_State* l) {
     Map& map = *check_map(l, 1);
     EntityData& data = *(static_cast<EntityData*>(lua_touserdata(l, 2)));
 
-    EntityPtr entity = std::make_shared<Bomb>(
+    EntityPtr entity = make_intrusive<Bomb>(
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
         data.get_xy()
@@ -1226,7 +1230,7 @@ int LuaContext::l_create_explosion(lua_State* l) {
     EntityData& data = *(static_cast<EntityData*>(lua_touserdata(l, 2)));
 
     const bool with_damage = true;
-    EntityPtr entity = std::make_shared<Explosion>(
+    EntityPtr entity = make_intrusive<Explosion>(
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
         data.get_xy(),
@@ -1252,7 +1256,7 @@ int LuaContext::l_create_fire(lua_State* l) {
     Map& map = *check_map(l, 1);
     EntityData& data = *(static_cast<EntityData*>(lua_touserdata(l, 2)));
 
-    EntityPtr entity = std::make_shared<Fire>(
+    EntityPtr entity = make_intrusive<Fire>(
         data.get_name(),
         entity_creation_check_layer(l, 1, data, map),
         data.get_xy()
@@ -1848,7 +1852,7 @@ int LuaContext::map_api_open_doors(lua_State* l) {
     Entities& entities = map.get_entities();
     const std::vector<EntityPtr>& doors = entities.get_entities_with_prefix(EntityType::DOOR, prefix);
     for (const EntityPtr& entity: doors) {
-      Door& door = *std::static_pointer_cast<Door>(entity);
+      Door& door = *static_pointer_cast<Door>(entity);
       if (!door.is_open() || door.is_closing()) {
         door.open();
         done = true;
@@ -1880,7 +1884,7 @@ int LuaContext::map_api_close_doors(lua_State* l) {
     Entities& entities = map.get_entities();
     const std::vector<EntityPtr>& doors = entities.get_entities_with_prefix(EntityType::DOOR, prefix);
     for (const EntityPtr& entity: doors) {
-      Door& door = *std::static_pointer_cast<Door>(entity);
+      Door& door = *static_pointer_cast<Door>(entity);
       if (door.is_open() || door.is_opening()) {
         door.close();
         done = true;
@@ -1912,7 +1916,7 @@ int LuaContext::map_api_set_doors_open(lua_State* l) {
     Entities& entities = map.get_entities();
     const std::vector<EntityPtr>& doors = entities.get_entities_with_prefix(EntityType::DOOR, prefix);
     for (const EntityPtr& entity: doors) {
-      Door& door = *std::static_pointer_cast<Door>(entity);
+      Door& door = *static_pointer_cast<Door>(entity);
       door.set_open(open);
     }
 
@@ -2048,10 +2052,11 @@ int LuaContext::map_api_get_entities_in_rectangle(lua_State* l) {
     const int width = LuaTools::check_int(l, 4);
     const int height = LuaTools::check_int(l, 5);
 
+    const Rectangle where(x, y, width, height);
+    map.get_entities().instantiate_deferred_entities(where);
+
     EntityVector entities;
-    map.get_entities().get_entities_in_rectangle_sorted(
-        Rectangle(x, y, width, height), entities
-    );
+    map.get_entities().get_entities_in_rectangle_sorted(where, entities);
 
     push_entity_iterator(l, entities);
     return 1;
@@ -2100,6 +2105,81 @@ int LuaContext::map_api_get_entities_in_region(lua_State* l) {
   });
 }
 
+/**
+ * \brief Implementation of map:get_entities_on_segment().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::map_api_get_entities_on_segment(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    Map& map = *check_map(l, 1);
+    const Point source(LuaTools::check_int(l, 2), LuaTools::check_int(l, 3));
+    const Point target(LuaTools::check_int(l, 4), LuaTools::check_int(l, 5));
+
+    const Rectangle where(
+        std::min(source.x, target.x),
+        std::min(source.y, target.y),
+        std::abs(target.x - source.x) + 1,
+        std::abs(target.y - source.y) + 1
+    );
+    map.get_entities().instantiate_deferred_entities(where);
+
+    EntityVector entities;
+    map.get_entities_on_segment(source, target, entities);
+
+    push_entity_iterator(l, entities);
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of map:raycast().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::map_api_raycast(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    Map& map = *check_map(l, 1);
+    const Point source(LuaTools::check_int(l, 2), LuaTools::check_int(l, 3));
+    const Point target(LuaTools::check_int(l, 4), LuaTools::check_int(l, 5));
+    const int layer = LuaTools::check_layer(l, 6, map);
+    EntityPtr entity_to_check;
+    if (lua_isnoneornil(l, 7)) {
+      entity_to_check = map.get_game().get_hero();
+    }
+    else {
+      entity_to_check = check_entity(l, 7);
+    }
+
+    const Rectangle where(
+        std::min(source.x, target.x),
+        std::min(source.y, target.y),
+        std::abs(target.x - source.x) + 1,
+        std::abs(target.y - source.y) + 1
+    );
+    map.get_entities().instantiate_deferred_entities(where);
+
+    Point hit_point = target;
+    EntityPtr hit_entity;
+    const bool hit = map.raycast(
+        layer, source, target, *entity_to_check, hit_point, hit_entity
+    );
+
+    lua_pushboolean(l, hit);
+    lua_pushinteger(l, hit_point.x);
+    lua_pushinteger(l, hit_point.y);
+    if (hit_entity != nullptr) {
+      push_entity(l, *hit_entity);
+    }
+    else {
+      lua_pushnil(l);
+    }
+    return 4;
+  });
+}
+
 /**
  * \brief Implementation of map:get_hero().
  * \param l The Lua context that is calling this function.
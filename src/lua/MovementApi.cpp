@@ -225,6 +225,8 @@ void LuaContext::register_movement_module() {
       { "set_target", path_finding_movement_api_set_target },
       { "get_speed", path_finding_movement_api_get_speed },
       { "set_speed", path_finding_movement_api_set_speed },
+      { "is_hierarchical", path_finding_movement_api_is_hierarchical },
+      { "set_hierarchical", path_finding_movement_api_set_hierarchical },
       { nullptr, nullptr }
   };
   register_type(
@@ -340,13 +342,13 @@ bool LuaContext::is_movement(lua_State* l, int index) {
  * \param index an index in the stack
  * \return the sprite
  */
-std::shared_ptr<Movement> LuaContext::check_movement(lua_State* l, int index) {
+IntrusivePtr<Movement> LuaContext::check_movement(lua_State* l, int index) {
 
   if (is_movement(l, index)) {
     const ExportableToLuaPtr& userdata = *(static_cast<ExportableToLuaPtr*>(
       lua_touserdata(l, index)
     ));
-    return std::static_pointer_cast<Movement>(userdata);
+    return static_pointer_cast<Movement>(userdata);
   }
   else {
     LuaTools::type_error(l, index, "movement");
@@ -374,7 +376,7 @@ void LuaContext::push_movement(lua_State* l, Movement& movement) {
  * \param point_index Index of the x,y table in the Lua stack.
  */
 void LuaContext::start_movement_on_point(
-    const std::shared_ptr<Movement>& movement, int point_index
+    const IntrusivePtr<Movement>& movement, int point_index
 ) {
   int x = 0;
   int y = 0;
@@ -432,7 +434,7 @@ void LuaContext::start_movement_on_point(
  * \brief Stops moving an x,y point.
  * \param movement The movement to stop.
  */
-void LuaContext::stop_movement_on_point(const std::shared_ptr<Movement>& movement) {
+void LuaContext::stop_movement_on_point(const IntrusivePtr<Movement>& movement) {
 
                                   // ...
   lua_getfield(l, LUA_REGISTRYINDEX, "sol.movements_on_points");
@@ -477,41 +479,41 @@ int LuaContext::movement_api_create(lua_State* l) {
     LuaContext& lua_context = get_lua_context(l);
     const std::string& type = LuaTools::check_string(l, 1);
 
-    std::shared_ptr<Movement> movement;
+    IntrusivePtr<Movement> movement;
     if (type == "straight") {
-      std::shared_ptr<StraightMovement> straight_movement =
-          std::make_shared<StraightMovement>(false, true);
+      IntrusivePtr<StraightMovement> straight_movement =
+          make_intrusive<StraightMovement>(false, true);
       straight_movement->set_speed(32);
       movement = straight_movement;
     }
     else if (type == "random") {
-      movement = std::make_shared<RandomMovement>(32);
+      movement = make_intrusive<RandomMovement>(32);
     }
     else if (type == "target") {
       Game* game = lua_context.get_main_loop().get_game();
       if (game != nullptr) {
         // If we are on a map, the default target is the hero.
-        movement = std::make_shared<TargetMovement>(
+        movement = make_intrusive<TargetMovement>(
             game->get_hero(), 0, 0, 96, false
         );
       }
       else {
-        movement = std::make_shared<TargetMovement>(
+        movement = make_intrusive<TargetMovement>(
             nullptr, 0, 0, 32, false
         );
       }
     }
     else if (type == "path") {
-      movement = std::make_shared<PathMovement>(
+      movement = make_intrusive<PathMovement>(
           "", 32, false, false, false
       );
     }
     else if (type == "random_path") {
-      movement = std::make_shared<RandomPathMovement>(32);
+      movement = make_intrusive<RandomPathMovement>(32);
     }
     else if (type == "path_finding") {
-      std::shared_ptr<PathFindingMovement> path_finding_movement =
-          std::make_shared<PathFindingMovement>(32);
+      IntrusivePtr<PathFindingMovement> path_finding_movement =
+          make_intrusive<PathFindingMovement>(32);
       Game* game = lua_context.get_main_loop().get_game();
       if (game != nullptr) {
         // If we are on a map, the default target is the hero.
@@ -520,13 +522,13 @@ int LuaContext::movement_api_create(lua_State* l) {
       movement = path_finding_movement;
     }
     else if (type == "circle") {
-      movement = std::make_shared<CircleMovement>(false);
+      movement = make_intrusive<CircleMovement>(false);
     }
     else if (type == "jump") {
-      movement = std::make_shared<JumpMovement>(0, 0, 0, false);
+      movement = make_intrusive<JumpMovement>(0, 0, 0, false);
     }
     else if (type == "pixel") {
-      movement = std::make_shared<PixelMovement>("", 30, false, false);
+      movement = make_intrusive<PixelMovement>("", 30, false, false);
     }
     else {
       LuaTools::arg_error(l, 1, "should be one of: "
@@ -591,7 +593,7 @@ int LuaContext::movement_api_start(lua_State* l) {
   return LuaTools::exception_boundary_handle(l, [&] {
     LuaContext& lua_context = get_lua_context(l);
 
-    std::shared_ptr<Movement> movement = check_movement(l, 1);
+    IntrusivePtr<Movement> movement = check_movement(l, 1);
     movement_api_stop(l);  // First, stop any previous movement.
 
     ScopedLuaRef callback_ref = LuaTools::opt_function(l, 3);
@@ -627,7 +629,7 @@ int LuaContext::movement_api_stop(lua_State* l) {
   return LuaTools::exception_boundary_handle(l, [&] {
     LuaContext& lua_context = get_lua_context(l);
 
-    std::shared_ptr<Movement> movement = check_movement(l, 1);
+    IntrusivePtr<Movement> movement = check_movement(l, 1);
 
     Entity* entity = movement->get_entity();
     if (entity != nullptr) {
@@ -658,7 +660,7 @@ int LuaContext::movement_api_stop(lua_State* l) {
 int LuaContext::movement_api_get_ignore_obstacles(lua_State* l) {
 
   return LuaTools::exception_boundary_handle(l, [&] {
-    std::shared_ptr<Movement> movement = check_movement(l, 1);
+    IntrusivePtr<Movement> movement = check_movement(l, 1);
 
     lua_pushboolean(l, movement->are_obstacles_ignored());
     return 1;
@@ -673,7 +675,7 @@ int LuaContext::movement_api_get_ignore_obstacles(lua_State* l) {
 int LuaContext::movement_api_set_ignore_obstacles(lua_State* l) {
 
   return LuaTools::exception_boundary_handle(l, [&] {
-    std::shared_ptr<Movement> movement = check_movement(l, 1);
+    IntrusivePtr<Movement> movement = check_movement(l, 1);
     bool ignore_obstacles = LuaTools::opt_boolean(l, 2, true);
 
     movement->set_ignore_obstacles(ignore_obstacles);
@@ -690,7 +692,7 @@ int LuaContext::movement_api_set_ignore_obstacles(lua_State* l) {
 int LuaContext::movement_api_get_direction4(lua_State* l) {
 
   return LuaTools::exception_boundary_handle(l, [&] {
-    std::shared_ptr<Movement> movement = check_movement(l, 1);
+    IntrusivePtr<Movement> movement = check_movement(l, 1);
     lua_pushinteger(l, movement->get_displayed_direction4());
     return 1;
   });
@@ -713,9 +715,9 @@ bool LuaContext::is_straight_movement(lua_State* l, int index) {
  * \param index an index in the stack
  * \return the movement
  */
-std::shared_ptr<StraightMovement> LuaContext::check_straight_movement(lua_State* l, int index) {
+IntrusivePtr<StraightMovement> LuaContext::check_straight_movement(lua_State* l, int index) {
 
-  return std::static_pointer_cast<StraightMovement>(check_userdata(
+  return static_pointer_cast<StraightMovement>(check_userdata(
       l, index, movement_straight_module_name
   ));
 }
@@ -852,8 +854,8 @@ bool LuaContext::is_random_movement(lua_State* l, int index) {
  * \param index an index in the stack
  * \return the movement
  */
-std::shared_ptr<RandomMovement> LuaContext::check_random_movement(lua_State* l, int index) {
-  return std::static_pointer_cast<RandomMovement>(check_userdata(
+IntrusivePtr<RandomMovement> LuaContext::check_random_movement(lua_State* l, int index) {
+  return static_pointer_cast<RandomMovement>(check_userdata(
       l, index, movement_random_module_name
   ));
 }
@@ -977,8 +979,8 @@ bool LuaContext::is_target_movement(lua_State* l, int index) {
  * \param index an index in the stack
  * \return the movement
  */
-std::shared_ptr<TargetMovement> LuaContext::check_target_movement(lua_State* l, int index) {
-  return std::static_pointer_cast<TargetMovement>(check_userdata(
+IntrusivePtr<TargetMovement> LuaContext::check_target_movement(lua_State* l, int index) {
+  return static_pointer_cast<TargetMovement>(check_userdata(
       l, index, movement_target_module_name
   ));
 }
@@ -1105,8 +1107,8 @@ bool LuaContext::is_path_movement(lua_State* l, int index) {
  * \param index an index in the stack
  * \return the movement
  */
-std::shared_ptr<PathMovement> LuaContext::check_path_movement(lua_State* l, int index) {
-  return std::static_pointer_cast<PathMovement>(check_userdata(
+IntrusivePtr<PathMovement> LuaContext::check_path_movement(lua_State* l, int index) {
+  return static_pointer_cast<PathMovement>(check_userdata(
       l, index, movement_path_module_name
   ));
 }
@@ -1258,8 +1260,8 @@ int LuaContext::path_movement_api_set_snap_to_grid(lua_State* l) {
  * \param index an index in the stack
  * \return the movement
  */
-std::shared_ptr<RandomPathMovement> LuaContext::check_random_path_movement(lua_State* l, int index) {
-  return std::static_pointer_cast<RandomPathMovement>(check_userdata(
+IntrusivePtr<RandomPathMovement> LuaContext::check_random_path_movement(lua_State* l, int index) {
+  return static_pointer_cast<RandomPathMovement>(check_userdata(
       l, index, movement_random_path_module_name
   ));
 }
@@ -1320,8 +1322,8 @@ bool LuaContext::is_path_finding_movement(lua_State* l, int index) {
  * \param index an index in the stack
  * \return the movement
  */
-std::shared_ptr<PathFindingMovement> LuaContext::check_path_finding_movement(lua_State* l, int index) {
-  return std::static_pointer_cast<PathFindingMovement>(check_userdata(
+IntrusivePtr<PathFindingMovement> LuaContext::check_path_finding_movement(lua_State* l, int index) {
+  return static_pointer_cast<PathFindingMovement>(check_userdata(
       l, index, movement_path_finding_module_name
   ));
 }
@@ -1372,6 +1374,37 @@ int LuaContext::path_finding_movement_api_set_speed(lua_State* l) {
   });
 }
 
+/**
+ * \brief Implementation of path_finding_movement:is_hierarchical().
+ * \param l the Lua context that is calling this function
+ * \return number of values to return to Lua
+ */
+int LuaContext::path_finding_movement_api_is_hierarchical(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const PathFindingMovement& movement = *check_path_finding_movement(l, 1);
+
+    lua_pushboolean(l, movement.is_hierarchical());
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of path_finding_movement:set_hierarchical().
+ * \param l the Lua context that is calling this function
+ * \return number of values to return to Lua
+ */
+int LuaContext::path_finding_movement_api_set_hierarchical(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    PathFindingMovement& movement = *check_path_finding_movement(l, 1);
+    bool hierarchical = LuaTools::opt_boolean(l, 2, true);
+    movement.set_hierarchical(hierarchical);
+
+    return 0;
+  });
+}
+
 /**
  * \brief Returns whether a value is a userdata of type circle movement.
  * \param l A Lua context.
@@ -1389,8 +1422,8 @@ bool LuaContext::is_circle_movement(lua_State* l, int index) {
  * \param index an index in the stack
  * \return the movement
  */
-std::shared_ptr<CircleMovement> LuaContext::check_circle_movement(lua_State* l, int index) {
-  return std::static_pointer_cast<CircleMovement>(check_userdata(
+IntrusivePtr<CircleMovement> LuaContext::check_circle_movement(lua_State* l, int index) {
+  return static_pointer_cast<CircleMovement>(check_userdata(
       l, index, movement_circle_module_name
   ));
 }
@@ -1674,8 +1707,8 @@ bool LuaContext::is_jump_movement(lua_State* l, int index) {
  * \param index an index in the stack
  * \return the movement
  */
-std::shared_ptr<JumpMovement> LuaContext::check_jump_movement(lua_State* l, int index) {
-  return std::static_pointer_cast<JumpMovement>(check_userdata(
+IntrusivePtr<JumpMovement> LuaContext::check_jump_movement(lua_State* l, int index) {
+  return static_pointer_cast<JumpMovement>(check_userdata(
       l, index, movement_jump_module_name
   ));
 }
@@ -1784,8 +1817,8 @@ bool LuaContext::is_pixel_movement(lua_State* l, int index) {
  * \param index an index in the stack
  * \return the movement
  */
-std::shared_ptr<PixelMovement> LuaContext::check_pixel_movement(lua_State* l, int index) {
-  return std::static_pointer_cast<PixelMovement>(check_userdata(
+IntrusivePtr<PixelMovement> LuaContext::check_pixel_movement(lua_State* l, int index) {
+  return static_pointer_cast<PixelMovement>(check_userdata(
       l, index, movement_pixel_module_name
   ));
 }
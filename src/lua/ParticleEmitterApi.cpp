@@ -0,0 +1,534 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Surface.h"
+#include "solarus/lua/LuaContext.h"
+#include "solarus/lua/LuaTools.h"
+#include "solarus/ParticleEmitter.h"
+#include <lua.hpp>
+
+namespace Solarus {
+
+/**
+ * Name of the Lua table representing the particle emitter module.
+ */
+const std::string LuaContext::particle_emitter_module_name = "sol.particle_emitter";
+
+/**
+ * \brief Initializes the particle emitter features provided to Lua.
+ */
+void LuaContext::register_particle_emitter_module() {
+
+  // Functions of sol.particle_emitter.
+  static const luaL_Reg functions[] = {
+      { "create", particle_emitter_api_create },
+      { nullptr, nullptr }
+  };
+
+  // Methods of the particle_emitter type.
+  static const luaL_Reg methods[] = {
+      { "get_num_particles", particle_emitter_api_get_num_particles },
+      { "get_max_particles", particle_emitter_api_get_max_particles },
+      { "is_emitting", particle_emitter_api_is_emitting },
+      { "set_emitting", particle_emitter_api_set_emitting },
+      { "get_emission_rate", particle_emitter_api_get_emission_rate },
+      { "set_emission_rate", particle_emitter_api_set_emission_rate },
+      { "get_emission_size", particle_emitter_api_get_emission_size },
+      { "set_emission_size", particle_emitter_api_set_emission_size },
+      { "get_lifetime", particle_emitter_api_get_lifetime },
+      { "set_lifetime", particle_emitter_api_set_lifetime },
+      { "get_speed", particle_emitter_api_get_speed },
+      { "set_speed", particle_emitter_api_set_speed },
+      { "get_angle", particle_emitter_api_get_angle },
+      { "set_angle", particle_emitter_api_set_angle },
+      { "get_gravity", particle_emitter_api_get_gravity },
+      { "set_gravity", particle_emitter_api_set_gravity },
+      { "get_frame_delay", particle_emitter_api_get_frame_delay },
+      { "set_frame_delay", particle_emitter_api_set_frame_delay },
+      { "emit", particle_emitter_api_emit },
+      { "clear", particle_emitter_api_clear },
+      { "draw", drawable_api_draw },
+      { "draw_region", drawable_api_draw_region },
+      { "get_blend_mode", drawable_api_get_blend_mode },
+      { "set_blend_mode", drawable_api_set_blend_mode },
+      { "fade_in", drawable_api_fade_in },
+      { "fade_out", drawable_api_fade_out },
+      { "get_xy", drawable_api_get_xy },
+      { "set_xy", drawable_api_set_xy },
+      { "get_movement", drawable_api_get_movement },
+      { "stop_movement", drawable_api_stop_movement },
+      { nullptr, nullptr }
+  };
+
+  static const luaL_Reg metamethods[] = {
+      { "__gc", drawable_meta_gc },
+      { nullptr, nullptr }
+  };
+
+  register_type(particle_emitter_module_name, functions, methods, metamethods);
+}
+
+/**
+ * \brief Returns whether a value is a userdata of type particle emitter.
+ * \param l A Lua context.
+ * \param index An index in the stack.
+ * \return \c true if the value at this index is a particle emitter.
+ */
+bool LuaContext::is_particle_emitter(lua_State* l, int index) {
+  return is_userdata(l, index, particle_emitter_module_name);
+}
+
+/**
+ * \brief Checks that the userdata at the specified index of the stack is a
+ * particle emitter and returns it.
+ * \param l A Lua context.
+ * \param index An index in the stack.
+ * \return The particle emitter.
+ */
+IntrusivePtr<ParticleEmitter> LuaContext::check_particle_emitter(lua_State* l, int index) {
+  return static_pointer_cast<ParticleEmitter>(check_userdata(
+      l, index, particle_emitter_module_name
+  ));
+}
+
+/**
+ * \brief Pushes a particle emitter userdata onto the stack.
+ * \param l A Lua context.
+ * \param emitter A particle emitter.
+ */
+void LuaContext::push_particle_emitter(lua_State* l, ParticleEmitter& emitter) {
+  push_userdata(l, emitter);
+}
+
+/**
+ * \brief Implementation of sol.particle_emitter.create().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_create(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    LuaTools::check_type(l, 1, LUA_TTABLE);
+
+    // The sheet is an image file name or a surface.
+    lua_getfield(l, 1, "sheet");
+    SurfacePtr sheet;
+    if (lua_type(l, -1) == LUA_TSTRING) {
+      const std::string& file_name = lua_tostring(l, -1);
+      sheet = Surface::create(file_name);
+      if (sheet == nullptr) {
+        LuaTools::error(l, "Cannot load particle sheet '" + file_name + "'");
+      }
+    }
+    else if (is_surface(l, -1)) {
+      sheet = check_surface(l, -1);
+    }
+    else {
+      LuaTools::error(l, "Bad field 'sheet' (string or surface expected)");
+    }
+    lua_pop(l, 1);
+
+    const Size frame_size(
+        LuaTools::opt_int_field(l, 1, "frame_width", sheet->get_width()),
+        LuaTools::opt_int_field(l, 1, "frame_height", sheet->get_height())
+    );
+    if (frame_size.width <= 0 || frame_size.height <= 0) {
+      LuaTools::error(l, "Invalid particle frame size");
+    }
+    const int max_particles = LuaTools::opt_int_field(l, 1, "max_particles", 1000);
+    if (max_particles <= 0) {
+      LuaTools::error(l, "Bad field 'max_particles' (positive number expected)");
+    }
+
+    IntrusivePtr<ParticleEmitter> emitter =
+        make_intrusive<ParticleEmitter>(sheet, frame_size, max_particles);
+    emitter->set_frame_delay(LuaTools::opt_int_field(l, 1, "frame_delay", 0));
+    emitter->set_emission_rate(LuaTools::opt_number_field(l, 1, "emission_rate", 0.0));
+    emitter->set_emission_size(Size(
+        LuaTools::opt_int_field(l, 1, "emission_width", 0),
+        LuaTools::opt_int_field(l, 1, "emission_height", 0)
+    ));
+    const int min_lifetime = LuaTools::opt_int_field(l, 1, "min_lifetime", 1000);
+    emitter->set_lifetime(
+        min_lifetime,
+        LuaTools::opt_int_field(l, 1, "max_lifetime", min_lifetime)
+    );
+    const double min_speed = LuaTools::opt_number_field(l, 1, "min_speed", 0.0);
+    emitter->set_speed(
+        min_speed,
+        LuaTools::opt_number_field(l, 1, "max_speed", min_speed)
+    );
+    emitter->set_angle(
+        LuaTools::opt_number_field(l, 1, "angle", 0.0),
+        LuaTools::opt_number_field(l, 1, "spread", 0.0)
+    );
+    emitter->set_gravity(
+        LuaTools::opt_number_field(l, 1, "gravity_x", 0.0),
+        LuaTools::opt_number_field(l, 1, "gravity_y", 0.0)
+    );
+    emitter->set_emitting(LuaTools::opt_boolean_field(l, 1, "emitting", true));
+
+    get_lua_context(l).add_drawable(emitter);
+    push_particle_emitter(l, *emitter);
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:get_num_particles().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_get_num_particles(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+
+    lua_pushinteger(l, emitter.get_num_particles());
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:get_max_particles().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_get_max_particles(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+
+    lua_pushinteger(l, emitter.get_max_particles());
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:is_emitting().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_is_emitting(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+
+    lua_pushboolean(l, emitter.is_emitting());
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:set_emitting().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_set_emitting(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+    bool emitting = LuaTools::opt_boolean(l, 2, true);
+
+    emitter.set_emitting(emitting);
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:get_emission_rate().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_get_emission_rate(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+
+    lua_pushnumber(l, emitter.get_emission_rate());
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:set_emission_rate().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_set_emission_rate(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+    double emission_rate = LuaTools::check_number(l, 2);
+
+    emitter.set_emission_rate(emission_rate);
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:get_emission_size().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_get_emission_size(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+
+    const Size& size = emitter.get_emission_size();
+    lua_pushinteger(l, size.width);
+    lua_pushinteger(l, size.height);
+    return 2;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:set_emission_size().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_set_emission_size(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+    int width = LuaTools::check_int(l, 2);
+    int height = LuaTools::check_int(l, 3);
+
+    if (width < 0 || height < 0) {
+      LuaTools::error(l, "Invalid emission size");
+    }
+    emitter.set_emission_size(Size(width, height));
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:get_lifetime().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_get_lifetime(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+
+    uint32_t min_lifetime = 0;
+    uint32_t max_lifetime = 0;
+    emitter.get_lifetime(min_lifetime, max_lifetime);
+    lua_pushinteger(l, min_lifetime);
+    lua_pushinteger(l, max_lifetime);
+    return 2;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:set_lifetime().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_set_lifetime(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+    int min_lifetime = LuaTools::check_int(l, 2);
+    int max_lifetime = LuaTools::opt_int(l, 3, min_lifetime);
+
+    if (min_lifetime <= 0 || max_lifetime < min_lifetime) {
+      LuaTools::error(l, "Invalid particle lifetime");
+    }
+    emitter.set_lifetime(min_lifetime, max_lifetime);
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:get_speed().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_get_speed(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+
+    double min_speed = 0.0;
+    double max_speed = 0.0;
+    emitter.get_speed(min_speed, max_speed);
+    lua_pushnumber(l, min_speed);
+    lua_pushnumber(l, max_speed);
+    return 2;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:set_speed().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_set_speed(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+    double min_speed = LuaTools::check_number(l, 2);
+    double max_speed = LuaTools::opt_number(l, 3, min_speed);
+
+    if (min_speed < 0.0 || max_speed < min_speed) {
+      LuaTools::error(l, "Invalid particle speed");
+    }
+    emitter.set_speed(min_speed, max_speed);
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:get_angle().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_get_angle(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+
+    double angle = 0.0;
+    double spread = 0.0;
+    emitter.get_angle(angle, spread);
+    lua_pushnumber(l, angle);
+    lua_pushnumber(l, spread);
+    return 2;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:set_angle().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_set_angle(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+    double angle = LuaTools::check_number(l, 2);
+    double spread = LuaTools::opt_number(l, 3, 0.0);
+
+    emitter.set_angle(angle, spread);
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:get_gravity().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_get_gravity(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+
+    double x = 0.0;
+    double y = 0.0;
+    emitter.get_gravity(x, y);
+    lua_pushnumber(l, x);
+    lua_pushnumber(l, y);
+    return 2;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:set_gravity().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_set_gravity(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+    double x = LuaTools::check_number(l, 2);
+    double y = LuaTools::check_number(l, 3);
+
+    emitter.set_gravity(x, y);
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:get_frame_delay().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_get_frame_delay(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+
+    lua_pushinteger(l, emitter.get_frame_delay());
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:set_frame_delay().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_set_frame_delay(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+    int frame_delay = LuaTools::check_int(l, 2);
+
+    if (frame_delay < 0) {
+      LuaTools::arg_error(l, 2, "Frame delay should not be negative");
+    }
+    emitter.set_frame_delay(frame_delay);
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:emit().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_emit(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+    int count = LuaTools::check_int(l, 2);
+
+    emitter.emit(count);
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of particle_emitter:clear().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::particle_emitter_api_clear(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    ParticleEmitter& emitter = *check_particle_emitter(l, 1);
+
+    emitter.clear();
+    return 0;
+  });
+}
+
+}
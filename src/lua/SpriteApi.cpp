@@ -97,7 +97,7 @@ bool LuaContext::is_sprite(lua_State* l, int index) {
  * \return the sprite
  */
 SpritePtr LuaContext::check_sprite(lua_State* l, int index) {
-  return std::static_pointer_cast<Sprite>(check_userdata(
+  return static_pointer_cast<Sprite>(check_userdata(
       l, index, sprite_module_name
   ));
 }
@@ -123,7 +123,7 @@ int LuaContext::sprite_api_create(lua_State* l) {
     const std::string& animation_set_id = LuaTools::check_string(l, 1);
 
     // TODO if the file does not exist, make a Lua error instead of an assertion error.
-    SpritePtr sprite = std::make_shared<Sprite>(animation_set_id);
+    SpritePtr sprite = make_intrusive<Sprite>(animation_set_id);
     get_lua_context(l).add_drawable(sprite);
 
     push_sprite(l, *sprite);
@@ -141,9 +141,9 @@ int LuaContext::sprite_api_get_animation_set(lua_State* l) {
   return LuaTools::exception_boundary_handle(l, [&] {
     const Sprite& sprite = *check_sprite(l, 1);
 
-    const std::string& animation_set_id = sprite.get_animation_set_id();
+    const Symbol& animation_set_id = sprite.get_animation_set_id();
 
-    push_string(l, animation_set_id);
+    LuaTools::push_symbol(l, animation_set_id);
     return 1;
   });
 }
@@ -158,9 +158,9 @@ int LuaContext::sprite_api_get_animation(lua_State* l) {
   return LuaTools::exception_boundary_handle(l, [&] {
     const Sprite& sprite = *check_sprite(l, 1);
 
-    const std::string& animation_name = sprite.get_current_animation();
+    const Symbol& animation_name = sprite.get_current_animation();
 
-    push_string(l, animation_name);
+    LuaTools::push_symbol(l, animation_name);
     return 1;
   });
 }
@@ -174,7 +174,7 @@ int LuaContext::sprite_api_set_animation(lua_State* l) {
 
   return LuaTools::exception_boundary_handle(l, [&] {
     Sprite& sprite = *check_sprite(l, 1);
-    const std::string& animation_name = LuaTools::check_string(l, 2);
+    const Symbol& animation_name = LuaTools::check_symbol(l, 2);
     ScopedLuaRef callback_ref;
     if (lua_gettop(l) >= 3) {
       if (!lua_isfunction(l, 3) && !lua_isstring(l, 3)) {
@@ -207,7 +207,7 @@ int LuaContext::sprite_api_has_animation(lua_State* l) {
 
   return LuaTools::exception_boundary_handle(l, [&] {
     const Sprite& sprite = *check_sprite(l, 1);
-    const std::string& animation_name = LuaTools::check_string(l, 2);
+    const Symbol& animation_name = LuaTools::check_symbol(l, 2);
 
     lua_pushboolean(l, sprite.has_animation(animation_name));
     return 1;
@@ -262,7 +262,7 @@ int LuaContext::sprite_api_get_num_directions(lua_State* l) {
 
   return LuaTools::exception_boundary_handle(l, [&] {
     const Sprite& sprite = *check_sprite(l, 1);
-    const std::string& animation_name = LuaTools::opt_string(l, 2, sprite.get_current_animation());
+    const Symbol& animation_name = LuaTools::opt_symbol(l, 2, sprite.get_current_animation());
     if (!sprite.has_animation(animation_name)) {
       LuaTools::arg_error(l, 2,
           std::string("Animation '") + animation_name
@@ -491,7 +491,7 @@ int LuaContext::sprite_api_synchronize(lua_State *l) {
  * \param animation Name of the animation finished.
  */
 void LuaContext::sprite_on_animation_finished(Sprite& sprite,
-    const std::string& animation) {
+    const Symbol& animation) {
 
   if (!userdata_has_field(sprite, "on_animation_finished")) {
     return;
@@ -511,7 +511,7 @@ void LuaContext::sprite_on_animation_finished(Sprite& sprite,
  * \param animation Name of the new animation.
  */
 void LuaContext::sprite_on_animation_changed(
-    Sprite& sprite, const std::string& animation) {
+    Sprite& sprite, const Symbol& animation) {
 
   if (!userdata_has_field(sprite, "on_animation_changed")) {
     return;
@@ -532,7 +532,7 @@ void LuaContext::sprite_on_animation_changed(
  * \param direction The new direction.
  */
 void LuaContext::sprite_on_direction_changed(Sprite& sprite,
-    const std::string& animation, int direction) {
+    const Symbol& animation, int direction) {
 
   if (!userdata_has_field(sprite, "on_direction_changed")) {
     return;
@@ -553,7 +553,7 @@ void LuaContext::sprite_on_direction_changed(Sprite& sprite,
  * \param frame The new frame.
  */
 void LuaContext::sprite_on_frame_changed(Sprite& sprite,
-    const std::string& animation, int frame) {
+    const Symbol& animation, int frame) {
 
   if (!userdata_has_field(sprite, "on_frame_changed")) {
     return;
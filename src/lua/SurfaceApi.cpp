@@ -48,6 +48,8 @@ void LuaContext::register_surface_module() {
       { "set_opacity", surface_api_set_opacity },
       { "get_pixels", surface_api_get_pixels },
       { "set_pixels", surface_api_set_pixels },
+      { "get_palette", surface_api_get_palette },
+      { "set_palette", surface_api_set_palette },
       { "draw", drawable_api_draw },
       { "draw_region", drawable_api_draw_region },
       { "get_blend_mode", drawable_api_get_blend_mode },
@@ -87,7 +89,7 @@ bool LuaContext::is_surface(lua_State* l, int index) {
  * \return the surface
  */
 SurfacePtr LuaContext::check_surface(lua_State* l, int index) {
-  return std::static_pointer_cast<Surface>(check_userdata(
+  return static_pointer_cast<Surface>(check_userdata(
       l, index, surface_module_name
   ));
 }
@@ -265,5 +267,59 @@ int LuaContext::surface_api_set_pixels(lua_State* l) {
   });
 }
 
+/**
+ * \brief Implementation of surface:get_palette().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::surface_api_get_palette(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const Surface& surface = *check_surface(l, 1);
+
+    if (!surface.is_indexed()) {
+      lua_pushnil(l);
+      return 1;
+    }
+
+    const std::vector<Color>& colors = surface.get_palette();
+    lua_createtable(l, static_cast<int>(colors.size()), 0);
+    int i = 1;
+    for (const Color& color : colors) {
+      push_color(l, color);
+      lua_rawseti(l, -2, i);
+      ++i;
+    }
+    return 1;
+  });
 }
 
+/**
+ * \brief Implementation of surface:set_palette().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::surface_api_set_palette(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    Surface& surface = *check_surface(l, 1);
+    LuaTools::check_type(l, 2, LUA_TTABLE);
+
+    if (!surface.is_indexed()) {
+      LuaTools::error(l, "This surface has no palette");
+    }
+
+    std::vector<Color> colors;
+    const int num_colors = static_cast<int>(lua_objlen(l, 2));
+    for (int i = 1; i <= num_colors; ++i) {
+      lua_rawgeti(l, 2, i);
+      colors.push_back(LuaTools::check_color(l, -1));
+      lua_pop(l, 1);
+    }
+
+    surface.set_palette(colors);
+    return 0;
+  });
+}
+
+}
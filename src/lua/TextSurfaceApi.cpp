@@ -120,8 +120,8 @@ bool LuaContext::is_text_surface(lua_State* l, int index) {
  * \param index an index in the stack
  * \return the text surface
  */
-std::shared_ptr<TextSurface> LuaContext::check_text_surface(lua_State* l, int index) {
-  return std::static_pointer_cast<TextSurface>(check_userdata(
+IntrusivePtr<TextSurface> LuaContext::check_text_surface(lua_State* l, int index) {
+  return static_pointer_cast<TextSurface>(check_userdata(
       l, index, text_surface_module_name
   ));
 }
@@ -143,8 +143,8 @@ void LuaContext::push_text_surface(lua_State* l, TextSurface& text_surface) {
 int LuaContext::text_surface_api_create(lua_State* l) {
 
   return LuaTools::exception_boundary_handle(l, [&] {
-    std::shared_ptr<TextSurface> text_surface =
-        std::make_shared<TextSurface>(0, 0);
+    IntrusivePtr<TextSurface> text_surface =
+        make_intrusive<TextSurface>(0, 0);
 
     if (lua_gettop(l) > 0) {
       LuaTools::check_type(l, 1, LUA_TTABLE);
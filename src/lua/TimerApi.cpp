@@ -86,7 +86,7 @@ bool LuaContext::is_timer(lua_State* l, int index) {
  * \return the timer
  */
 TimerPtr LuaContext::check_timer(lua_State* l, int index) {
-  return std::static_pointer_cast<Timer>(
+  return static_pointer_cast<Timer>(
       check_userdata(l, index, timer_module_name)
   );
 }
@@ -377,7 +377,7 @@ int LuaContext::timer_api_start(lua_State *l) {
     const ScopedLuaRef& callback_ref = LuaTools::check_function(l, 3);
 
     // Create the timer.
-    TimerPtr timer = std::make_shared<Timer>(delay);
+    TimerPtr timer = make_intrusive<Timer>(delay);
     lua_context.add_timer(timer, 1, callback_ref);
 
     if (delay == 0) {
@@ -16,10 +16,13 @@
  */
 #include "solarus/lua/LuaContext.h"
 #include "solarus/lua/LuaTools.h"
+#include "solarus/lowlevel/FrameCapture.h"
+#include "solarus/lowlevel/QuestFiles.h"
 #include "solarus/lowlevel/Video.h"
 #include "solarus/lowlevel/VideoMode.h"
 #include "solarus/lowlevel/Size.h"
 #include <lua.hpp>
+#include <map>
 
 namespace Solarus {
 
@@ -49,6 +52,9 @@ void LuaContext::register_video_module() {
       { "get_window_size", video_api_get_window_size },
       { "set_window_size", video_api_set_window_size },
       { "reset_window_size", video_api_reset_window_size },
+      { "start_capture", video_api_start_capture },
+      { "stop_capture", video_api_stop_capture },
+      { "is_capturing", video_api_is_capturing },
       { nullptr, nullptr }
   };
   register_functions(video_module_name, functions);
@@ -307,5 +313,66 @@ int LuaContext::video_api_reset_window_size(lua_State* l) {
   });
 }
 
+/**
+ * \brief Implementation of sol.video.start_capture().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::video_api_start_capture(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    static const std::map<FrameCapture::Format, std::string> format_names = {
+        { FrameCapture::Format::PNG, "png" },
+        { FrameCapture::Format::RAW, "raw" }
+    };
+
+    const std::string& dir_name = LuaTools::check_string(l, 1);
+    const FrameCapture::Format format = LuaTools::opt_enum<FrameCapture::Format>(
+        l, 2, format_names, FrameCapture::Format::PNG
+    );
+
+    if (QuestFiles::get_quest_write_dir().empty()) {
+      LuaTools::error(l, "Cannot capture frames: no write directory was specified in quest.dat");
+    }
+
+    // The directory is relative to the quest write directory.
+    if (!QuestFiles::data_file_mkdir(dir_name)) {
+      LuaTools::error(l, "Cannot create capture directory '" + dir_name + "'");
+    }
+    const std::string& directory = QuestFiles::get_full_quest_write_dir() + "/" + dir_name;
+
+    FrameCapture::start(directory, format);
+
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of sol.video.stop_capture().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::video_api_stop_capture(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    FrameCapture::stop();
+
+    return 0;
+  });
+}
+
+/**
+ * \brief Implementation of sol.video.is_capturing().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::video_api_is_capturing(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    lua_pushboolean(l, FrameCapture::is_capturing());
+
+    return 1;
+  });
 }
 
+}
@@ -64,6 +64,16 @@ void print_help(const Arguments& args) {
     << "  -turbo=yes|no                 runs as fast as possible rather than simulating real time (default no)"
     << std::endl
     << "  -lag=X                        slows down each frame of X milliseconds to simulate slower systems for debugging (default 0)"
+    << std::endl
+    << "  -startup-profile              logs the time spent in each phase of the startup until the first frame"
+    << std::endl
+    << "  -capture=<directory>          writes each rendered frame as an image file in an existing directory"
+    << std::endl
+    << "  -capture-format=png|raw       file format of captured frames: PNG or raw RGBA bytes (default png)"
+    << std::endl
+    << "  -lua-profile=<file>           samples Lua call stacks and writes them to a file for flame graph tools at exit"
+    << std::endl
+    << "  -lua-profile-period=X         number of Lua instructions between two samples (default 1000)"
     << std::endl;
 }
 
@@ -95,6 +105,15 @@ void print_help(const Arguments& args) {
  *   -turbo=yes|no                     Runs as fast as possible rather than simulating real time (default: no).
  *   -lag=X                            (Advanced) Artificially slows down each frame of X milliseconds
  *                                     to simulate slower systems for debugging (default: 0).
+ *   -startup-profile                  (Advanced) Logs the time spent in each phase of the startup
+ *                                     until the first frame is drawn.
+ *   -capture=DIRECTORY                (Advanced) Writes each rendered frame as an image file
+ *                                     in an existing directory, also with -no-video.
+ *   -capture-format=png|raw           (Advanced) File format of captured frames (default: png).
+ *   -lua-profile=FILE                 (Advanced) Samples Lua call stacks and writes them at exit
+ *                                     in the collapsed format of flame graph tools.
+ *   -lua-profile-period=X             (Advanced) Number of Lua instructions between two samples
+ *                                     (default: 1000).
  *
  * \param argc Number of command-line arguments.
  * \param argv Command-line arguments.
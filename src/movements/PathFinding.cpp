@@ -16,10 +16,14 @@
  */
 #include "solarus/movements/PathFinding.h"
 #include "solarus/entities/Entity.h"
+#include "solarus/entities/GroundInfo.h"
 #include "solarus/lowlevel/Geometry.h"
 #include "solarus/Map.h"
 #include "solarus/lowlevel/Debug.h"
+#include "solarus/movements/PathFindingGraph.h"
+#include <algorithm>
 #include <limits>
+#include <vector>
 
 namespace Solarus {
 
@@ -58,12 +62,34 @@ PathFinding::PathFinding(
     Entity& target_entity):
   map(map),
   source_entity(source_entity),
-  target_entity(target_entity) {
+  target_entity(target_entity),
+  hierarchical(false) {
 
   Debug::check_assertion(source_entity.is_aligned_to_grid(),
       "The source must be aligned on the map grid");
 }
 
+/**
+ * \brief Returns whether far targets are searched with the path finding
+ * graph of the map.
+ * \return \c true if hierarchical path finding is enabled.
+ */
+bool PathFinding::is_hierarchical() const {
+  return hierarchical;
+}
+
+/**
+ * \brief Sets whether far targets are searched with the path finding
+ * graph of the map.
+ *
+ * Otherwise, no path is computed when the target is too far.
+ *
+ * \param hierarchical \c true to enable hierarchical path finding.
+ */
+void PathFinding::set_hierarchical(bool hierarchical) {
+  this->hierarchical = hierarchical;
+}
+
 /**
  * \brief Tries to find a path between the source point and the target point.
  * \return the path found, or an empty string if no path was found
@@ -115,17 +141,41 @@ std::string PathFinding::compute_path(const Point& offset) {
   target.x += -target.x % 8;
   target.y += 4;
   target.y += -target.y % 8;
-  const int target_index = get_square_index(target);
 
   Debug::check_assertion(target.x % 8 == 0 && target.y % 8 == 0,
       "Could not snap the target to the map grid");
 
+  if (target_entity.get_layer() != source_entity.get_layer()) {
+    return "";  // Not on the same layer.
+  }
+
   const int total_mdistance = Geometry::get_manhattan_distance(source, target);
-  if (total_mdistance > 200 || target_entity.get_layer() != source_entity.get_layer()) {
+  if (total_mdistance > 200) {
+    if (hierarchical) {
+      return find_long_path(source, target);
+    }
     //std::cout << "too far, not computing a path\n";
     return ""; // too far to compute a path
   }
 
+  return find_path(source, target, Rectangle(Point(), map.get_size()));
+}
+
+/**
+ * \brief Runs the A* algorithm between two close points.
+ * \param source The starting point, aligned on the map grid.
+ * \param target The target point, aligned on the map grid.
+ * \param area Nodes outside this rectangle are not explored.
+ * \return the path found, or an empty string if no path was found
+ */
+std::string PathFinding::find_path(
+    const Point& source,
+    const Point& target,
+    const Rectangle& area) {
+
+  const int target_index = get_square_index(target);
+  const int total_mdistance = Geometry::get_manhattan_distance(source, target);
+
   std::string path = "";
 
   Node starting_node;
@@ -182,6 +232,7 @@ std::string PathFinding::compute_path(const Point& offset) {
 
         const bool in_closed_list = (closed_list.find(new_node.index) != closed_list.end());
         if (!in_closed_list && Geometry::get_manhattan_distance(new_node.location, target) < 200
+            && area.contains(new_node.location)
             && is_node_transition_valid(*current_node, i)) {
           //std::cout << "  node in direction " << i << " is not in the closed list\n";
           // not in the closed list: look in the open list
@@ -229,6 +280,57 @@ std::string PathFinding::compute_path(const Point& offset) {
   return path;
 }
 
+/**
+ * \brief Finds a path to a far target with the path finding graph of the map.
+ *
+ * The graph gives waypoints that only take the ground into account.
+ * The path between two consecutive waypoints is then computed with A*
+ * restricted to their clusters, which also checks other obstacles.
+ *
+ * \param source The starting point, aligned on the map grid.
+ * \param target The target point, aligned on the map grid.
+ * \return the path found, or an empty string if no path was found
+ */
+std::string PathFinding::find_long_path(const Point& source, const Point& target) {
+
+  uint32_t ground_obstacles = 0;
+  for (const auto& kvp : EnumInfoTraits<Ground>::names) {
+    if (source_entity.is_ground_obstacle(kvp.first)) {
+      ground_obstacles |= 1 << static_cast<int>(kvp.first);
+    }
+  }
+
+  PathFindingGraph& graph = map.get_path_finding_graph(
+      source_entity.get_layer(), ground_obstacles
+  );
+  std::vector<Point> waypoints;
+  if (!graph.find_waypoints(source, target, waypoints)) {
+    return "";
+  }
+
+  std::string path;
+  for (size_t i = 1; i < waypoints.size(); ++i) {
+    const Rectangle& box_1 = graph.get_cluster_box(waypoints[i - 1]);
+    const Rectangle& box_2 = graph.get_cluster_box(waypoints[i]);
+    const int x = std::min(box_1.get_x(), box_2.get_x());
+    const int y = std::min(box_1.get_y(), box_2.get_y());
+    const Rectangle area(
+        x,
+        y,
+        std::max(box_1.get_x() + box_1.get_width(), box_2.get_x() + box_2.get_width()) - x,
+        std::max(box_1.get_y() + box_1.get_height(), box_2.get_y() + box_2.get_height()) - y
+    );
+
+    const std::string& sub_path = find_path(waypoints[i - 1], waypoints[i], area);
+    if (sub_path.empty()) {
+      // Something that is not the ground blocks the way.
+      return "";
+    }
+    path += sub_path;
+  }
+  return path;
+}
+
 /**
  * \brief Returns the index of the 8*8 square in the map
  * corresponding to the specified location.
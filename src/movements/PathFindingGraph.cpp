@@ -0,0 +1,597 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/movements/PathFindingGraph.h"
+#include "solarus/entities/Entities.h"
+#include "solarus/entities/Entity.h"
+#include "solarus/Map.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
+namespace Solarus {
+
+namespace {
+
+/**
+ * \brief Maximum length of a run of crossable squares on a cluster border
+ * that is represented by a single entrance.
+ */
+constexpr int max_single_entrance_length = 6;
+
+/**
+ * \brief Returns an estimation of the cost between two squares.
+ *
+ * This is the exact cost when there is no obstacle, with straight moves
+ * costing 8 and diagonal moves costing 11.
+ *
+ * \param x8_1 X coordinate of the first square.
+ * \param y8_1 Y coordinate of the first square.
+ * \param x8_2 X coordinate of the second square.
+ * \param y8_2 Y coordinate of the second square.
+ * \return The estimated cost.
+ */
+int get_octile_distance(int x8_1, int y8_1, int x8_2, int y8_2) {
+
+  const int dx = std::abs(x8_2 - x8_1);
+  const int dy = std::abs(y8_2 - y8_1);
+  return 8 * std::max(dx, dy) + 3 * std::min(dx, dy);
+}
+
+}
+
+/**
+ * \brief Creates a path finding graph.
+ *
+ * The graph is not computed yet: this is done the first time a path is
+ * requested.
+ *
+ * \param map The map.
+ * \param layer Layer of the map to represent.
+ * \param ground_obstacles Bit field of the grounds that are obstacles
+ * (one bit for each value of Ground).
+ */
+PathFindingGraph::PathFindingGraph(Map& map, int layer, uint32_t ground_obstacles):
+  map(map),
+  layer(layer),
+  ground_obstacles(ground_obstacles),
+  width8(map.get_width8()),
+  height8(map.get_height8()),
+  num_clusters_x((width8 + cluster_size - 1) / cluster_size),
+  num_clusters_y((height8 + cluster_size - 1) / cluster_size),
+  built(false),
+  ground_revision(0),
+  static_blocked(),
+  nodes_free(),
+  clusters() {
+
+}
+
+/**
+ * \brief Finds a sequence of cluster entrances leading from a point
+ * to another one.
+ *
+ * Two consecutive waypoints are always in the same cluster or in adjacent
+ * clusters, so that the path between them can then be refined by a local
+ * search.
+ *
+ * \param source Starting point, aligned on the map grid.
+ * \param target Target point, aligned on the map grid.
+ * \param waypoints Receives the waypoints, including the source and the
+ * target.
+ * \return \c true if a path was found.
+ */
+bool PathFindingGraph::find_waypoints(
+    const Point& source,
+    const Point& target,
+    std::vector<Point>& waypoints
+) {
+  waypoints.clear();
+
+  const Point source8 = source / 8;
+  const Point target8 = target / 8;
+  if (source8.x < 0 || source8.x >= width8 || source8.y < 0 || source8.y >= height8 ||
+      target8.x < 0 || target8.x >= width8 || target8.y < 0 || target8.y >= height8) {
+    return false;
+  }
+
+  update();
+
+  const int source_square = source8.y * width8 + source8.x;
+  const int target_square = target8.y * width8 + target8.x;
+  if (!nodes_free[source_square] || !nodes_free[target_square]) {
+    return false;
+  }
+
+  const int source_cluster = get_cluster_index(source_square);
+  const int target_cluster = get_cluster_index(target_square);
+  std::vector<int> source_costs;
+  std::vector<int> target_costs;
+  get_costs_in_cluster(source_cluster, source_square, source_costs);
+  get_costs_in_cluster(target_cluster, target_square, target_costs);
+
+  // A* on the abstract graph whose nodes are the entrances,
+  // the source and the target.
+  struct NodeInfo {
+    int cost;
+    int parent;
+    bool closed;
+  };
+  std::unordered_map<int, NodeInfo> nodes;
+  using QueueElement = std::pair<int, int>;  // Estimated total cost and square.
+  std::priority_queue<QueueElement, std::vector<QueueElement>, std::greater<QueueElement>> open_list;
+
+  const auto& get_heuristic = [&](int square) {
+    return get_octile_distance(
+        square % width8, square / width8, target8.x, target8.y
+    );
+  };
+
+  const auto& relax = [&](int from, int square, int step_cost) {
+    const int cost = nodes[from].cost + step_cost;
+    const auto& it = nodes.find(square);
+    if (it == nodes.end() || (!it->second.closed && cost < it->second.cost)) {
+      nodes[square] = { cost, from, false };
+      open_list.emplace(cost + get_heuristic(square), square);
+    }
+  };
+
+  nodes[source_square] = { 0, -1, false };
+  open_list.emplace(get_heuristic(source_square), source_square);
+
+  while (!open_list.empty()) {
+
+    const int square = open_list.top().second;
+    open_list.pop();
+    NodeInfo& info = nodes[square];
+    if (info.closed) {
+      continue;
+    }
+    info.closed = true;
+
+    if (square == target_square) {
+      // Rebuild the sequence of waypoints.
+      for (int current = target_square; current != -1; current = nodes[current].parent) {
+        waypoints.emplace_back((current % width8) * 8, (current / width8) * 8);
+      }
+      std::reverse(waypoints.begin(), waypoints.end());
+      return true;
+    }
+
+    const int cluster_index = get_cluster_index(square);
+    const Cluster& cluster = clusters[cluster_index];
+
+    if (square == source_square) {
+      // From the source to the entrances of its cluster.
+      for (int entrance : cluster.entrances) {
+        const int cost = get_cost_in_cluster(cluster_index, source_costs, entrance);
+        if (cost > 0) {
+          relax(square, entrance, cost);
+        }
+      }
+    }
+
+    const auto& it = std::lower_bound(
+        cluster.entrances.begin(), cluster.entrances.end(), square
+    );
+    if (it != cluster.entrances.end() && *it == square) {
+      // From an entrance to the other ones of the same cluster.
+      const int num_entrances = cluster.entrances.size();
+      const int i = it - cluster.entrances.begin();
+      for (int j = 0; j < num_entrances; ++j) {
+        const int cost = cluster.costs[i * num_entrances + j];
+        if (j != i && cost > 0) {
+          relax(square, cluster.entrances[j], cost);
+        }
+      }
+
+      // To the neighbour clusters.
+      for (const std::pair<int, int>& link : cluster.links) {
+        if (link.first == square) {
+          relax(square, link.second, 8);
+        }
+      }
+    }
+
+    if (cluster_index == target_cluster) {
+      // To the target.
+      const int cost = get_cost_in_cluster(target_cluster, target_costs, square);
+      if (cost >= 0) {
+        relax(square, target_square, cost);
+      }
+    }
+  }
+
+  return false;
+}
+
+/**
+ * \brief Returns the rectangle of the cluster containing a point.
+ * \param location A point of the map.
+ * \return The rectangle of the cluster in pixels.
+ */
+Rectangle PathFindingGraph::get_cluster_box(const Point& location) const {
+
+  const int cluster_pixels = cluster_size * 8;
+  return Rectangle(
+      (location.x / cluster_pixels) * cluster_pixels,
+      (location.y / cluster_pixels) * cluster_pixels,
+      cluster_pixels,
+      cluster_pixels
+  );
+}
+
+/**
+ * \brief Builds the graph the first time and updates it if the ground of
+ * the map has changed since the last time.
+ *
+ * Entrances are found again on every border, but the costs inside a
+ * cluster are only recomputed if its squares or its entrances changed.
+ */
+void PathFindingGraph::update() {
+
+  if (built && map.get_ground_revision() == ground_revision) {
+    return;
+  }
+
+  const std::vector<bool> old_nodes_free = nodes_free;
+  compute_squares();
+
+  std::vector<Cluster> new_clusters(num_clusters_x * num_clusters_y);
+  find_entrances(new_clusters);
+
+  for (int cluster_index = 0; cluster_index < static_cast<int>(new_clusters.size()); ++cluster_index) {
+    Cluster& cluster = new_clusters[cluster_index];
+
+    bool changed = !built || cluster.entrances != clusters[cluster_index].entrances;
+    if (!changed) {
+      const int x0 = (cluster_index % num_clusters_x) * cluster_size;
+      const int y0 = (cluster_index / num_clusters_x) * cluster_size;
+      const int x1 = std::min(x0 + cluster_size, width8);
+      const int y1 = std::min(y0 + cluster_size, height8);
+      for (int y8 = y0; y8 < y1 && !changed; ++y8) {
+        for (int x8 = x0; x8 < x1 && !changed; ++x8) {
+          const int square = y8 * width8 + x8;
+          changed = nodes_free[square] != old_nodes_free[square];
+        }
+      }
+    }
+
+    if (changed) {
+      compute_costs(cluster, cluster_index);
+    }
+    else {
+      cluster.costs = std::move(clusters[cluster_index].costs);
+    }
+  }
+
+  clusters = std::move(new_clusters);
+  ground_revision = map.get_ground_revision();
+  built = true;
+}
+
+/**
+ * \brief Determines which squares are obstacles and where a 16x16 box can be.
+ *
+ * The ground of tiles is only read the first time.
+ * Then the ground of dynamic entities is applied on top of it.
+ * Diagonal walls are considered as entirely blocking their square.
+ */
+void PathFindingGraph::compute_squares() {
+
+  const auto& is_obstacle = [&](Ground ground) {
+    return ((ground_obstacles >> static_cast<int>(ground)) & 1) != 0;
+  };
+
+  const int num_squares = width8 * height8;
+  if (static_blocked.empty()) {
+    const Entities& entities = map.get_entities();
+    static_blocked.resize(num_squares);
+    for (int y8 = 0; y8 < height8; ++y8) {
+      for (int x8 = 0; x8 < width8; ++x8) {
+        static_blocked[y8 * width8 + x8] = is_obstacle(
+            entities.get_tile_ground(layer, x8 * 8, y8 * 8)
+        );
+      }
+    }
+  }
+
+  std::vector<bool> blocked = static_blocked;
+
+  // Dynamic entities that modify the ground, from the lowest one to the
+  // highest one.
+  EntityVector entities;
+  map.get_entities().get_entities_in_rectangle_sorted(
+      Rectangle(0, 0, width8 * 8, height8 * 8), entities
+  );
+  for (const EntityPtr& entity : entities) {
+
+    if (entity->get_layer() != layer ||
+        !entity->is_ground_modifier() ||
+        !entity->is_enabled() ||
+        entity->is_being_removed()) {
+      continue;
+    }
+
+    const Rectangle& box = entity->get_bounding_box();
+    const int x8_min = std::max(box.get_x() / 8, 0);
+    const int y8_min = std::max(box.get_y() / 8, 0);
+    const int x8_max = std::min((box.get_x() + box.get_width() - 1) / 8, width8 - 1);
+    const int y8_max = std::min((box.get_y() + box.get_height() - 1) / 8, height8 - 1);
+    for (int y8 = y8_min; y8 <= y8_max; ++y8) {
+      for (int x8 = x8_min; x8 <= x8_max; ++x8) {
+        // Take a point of the square that is inside the entity.
+        const Point xy(std::max(x8 * 8, box.get_x()), std::max(y8 * 8, box.get_y()));
+        const Ground ground = map.get_ground_from_entity(*entity, xy);
+        if (ground != Ground::EMPTY) {
+          blocked[y8 * width8 + x8] = is_obstacle(ground);
+        }
+      }
+    }
+  }
+
+  nodes_free.assign(num_squares, false);
+  for (int y8 = 0; y8 < height8 - 1; ++y8) {
+    for (int x8 = 0; x8 < width8 - 1; ++x8) {
+      const int square = y8 * width8 + x8;
+      nodes_free[square] =
+          !blocked[square] &&
+          !blocked[square + 1] &&
+          !blocked[square + width8] &&
+          !blocked[square + width8 + 1];
+    }
+  }
+}
+
+/**
+ * \brief Returns whether a 16x16 box can be at the given square.
+ * \param x8 X coordinate of the square.
+ * \param y8 Y coordinate of the square.
+ * \return \c true if the four squares covered by the box are not obstacles.
+ */
+bool PathFindingGraph::is_node_free(int x8, int y8) const {
+
+  return nodes_free[y8 * width8 + x8];
+}
+
+/**
+ * \brief Returns the index of the cluster containing a square.
+ * \param square Index of a square of the map.
+ * \return Index of the cluster.
+ */
+int PathFindingGraph::get_cluster_index(int square) const {
+
+  const int x8 = square % width8;
+  const int y8 = square / width8;
+  return (y8 / cluster_size) * num_clusters_x + (x8 / cluster_size);
+}
+
+/**
+ * \brief Adds a pair of entrances on both sides of a cluster border.
+ * \param square_1 Square on the first side of the border.
+ * \param square_2 Adjacent square on the other side.
+ * \param new_clusters The clusters to fill.
+ */
+void PathFindingGraph::add_entrances(
+    int square_1,
+    int square_2,
+    std::vector<Cluster>& new_clusters
+) const {
+
+  const std::pair<int, int> squares[] = {
+      { square_1, square_2 },
+      { square_2, square_1 }
+  };
+  for (const std::pair<int, int>& link : squares) {
+    Cluster& cluster = new_clusters[get_cluster_index(link.first)];
+    std::vector<int>& entrances = cluster.entrances;
+    const auto& it = std::lower_bound(entrances.begin(), entrances.end(), link.first);
+    if (it == entrances.end() || *it != link.first) {
+      entrances.insert(it, link.first);
+    }
+    cluster.links.push_back(link);
+  }
+}
+
+/**
+ * \brief Adds the entrances of a cluster border.
+ *
+ * Each run of squares where the border can be crossed gives one entrance
+ * in its middle, or two entrances at its ends if it is long.
+ *
+ * \param first_square_1 First square of the border on the first side.
+ * \param first_square_2 First square of the border on the other side.
+ * \param step Index difference between two consecutive squares of the border.
+ * \param length Length of the border in squares.
+ * \param new_clusters The clusters to fill.
+ */
+void PathFindingGraph::add_border_entrances(
+    int first_square_1,
+    int first_square_2,
+    int step,
+    int length,
+    std::vector<Cluster>& new_clusters
+) const {
+
+  int run_start = -1;
+  for (int i = 0; i <= length; ++i) {
+    const bool crossable = i < length &&
+        nodes_free[first_square_1 + i * step] &&
+        nodes_free[first_square_2 + i * step];
+
+    if (crossable && run_start == -1) {
+      run_start = i;
+    }
+    else if (!crossable && run_start != -1) {
+      const int run_end = i - 1;
+      if (run_end - run_start + 1 <= max_single_entrance_length) {
+        const int middle = (run_start + run_end) / 2;
+        add_entrances(first_square_1 + middle * step, first_square_2 + middle * step, new_clusters);
+      }
+      else {
+        add_entrances(first_square_1 + run_start * step, first_square_2 + run_start * step, new_clusters);
+        add_entrances(first_square_1 + run_end * step, first_square_2 + run_end * step, new_clusters);
+      }
+      run_start = -1;
+    }
+  }
+}
+
+/**
+ * \brief Finds the entrances of all cluster borders.
+ * \param new_clusters The clusters to fill.
+ */
+void PathFindingGraph::find_entrances(std::vector<Cluster>& new_clusters) const {
+
+  for (int cluster_y = 0; cluster_y < num_clusters_y; ++cluster_y) {
+    for (int cluster_x = 0; cluster_x < num_clusters_x; ++cluster_x) {
+      const int x0 = cluster_x * cluster_size;
+      const int y0 = cluster_y * cluster_size;
+
+      // Right border.
+      if (cluster_x < num_clusters_x - 1) {
+        const int x8 = x0 + cluster_size - 1;
+        const int first_square = y0 * width8 + x8;
+        add_border_entrances(
+            first_square, first_square + 1, width8,
+            std::min(cluster_size, height8 - y0),
+            new_clusters
+        );
+      }
+
+      // Bottom border.
+      if (cluster_y < num_clusters_y - 1) {
+        const int y8 = y0 + cluster_size - 1;
+        const int first_square = y8 * width8 + x0;
+        add_border_entrances(
+            first_square, first_square + width8, 1,
+            std::min(cluster_size, width8 - x0),
+            new_clusters
+        );
+      }
+    }
+  }
+}
+
+/**
+ * \brief Computes the cost between each pair of entrances of a cluster.
+ * \param cluster The cluster, whose entrances are already known.
+ * \param cluster_index Index of the cluster.
+ */
+void PathFindingGraph::compute_costs(Cluster& cluster, int cluster_index) const {
+
+  const int num_entrances = cluster.entrances.size();
+  cluster.costs.assign(num_entrances * num_entrances, -1);
+
+  std::vector<int> costs;
+  for (int i = 0; i < num_entrances; ++i) {
+    get_costs_in_cluster(cluster_index, cluster.entrances[i], costs);
+    for (int j = 0; j < num_entrances; ++j) {
+      cluster.costs[i * num_entrances + j] =
+          get_cost_in_cluster(cluster_index, costs, cluster.entrances[j]);
+    }
+  }
+}
+
+/**
+ * \brief Computes the cost from a square to every square of its cluster
+ * without leaving it.
+ * \param cluster_index Index of the cluster.
+ * \param source Square to start from, in this cluster.
+ * \param costs Receives the cost of each square of the cluster,
+ * or -1 for squares that cannot be reached.
+ */
+void PathFindingGraph::get_costs_in_cluster(
+    int cluster_index,
+    int source,
+    std::vector<int>& costs
+) const {
+
+  const int x0 = (cluster_index % num_clusters_x) * cluster_size;
+  const int y0 = (cluster_index / num_clusters_x) * cluster_size;
+  const int width = std::min(cluster_size, width8 - x0);
+  const int height = std::min(cluster_size, height8 - y0);
+
+  costs.assign(width * height, -1);
+
+  using QueueElement = std::pair<int, int>;  // Cost and local index.
+  std::priority_queue<QueueElement, std::vector<QueueElement>, std::greater<QueueElement>> queue;
+
+  const int source_index = (source / width8 - y0) * width + (source % width8 - x0);
+  costs[source_index] = 0;
+  queue.emplace(0, source_index);
+
+  while (!queue.empty()) {
+
+    const int cost = queue.top().first;
+    const int index = queue.top().second;
+    queue.pop();
+    if (cost > costs[index]) {
+      continue;
+    }
+
+    const int x8 = x0 + index % width;
+    const int y8 = y0 + index / width;
+    for (int dy = -1; dy <= 1; ++dy) {
+      for (int dx = -1; dx <= 1; ++dx) {
+        const int next_x8 = x8 + dx;
+        const int next_y8 = y8 + dy;
+        if ((dx == 0 && dy == 0) ||
+            next_x8 < x0 || next_x8 >= x0 + width ||
+            next_y8 < y0 || next_y8 >= y0 + height ||
+            !is_node_free(next_x8, next_y8)) {
+          continue;
+        }
+
+        const bool diagonal = dx != 0 && dy != 0;
+        if (diagonal && (!is_node_free(next_x8, y8) || !is_node_free(x8, next_y8))) {
+          // Don't cut corners.
+          continue;
+        }
+
+        const int next_cost = cost + (diagonal ? 11 : 8);
+        const int next_index = (next_y8 - y0) * width + (next_x8 - x0);
+        if (costs[next_index] == -1 || next_cost < costs[next_index]) {
+          costs[next_index] = next_cost;
+          queue.emplace(next_cost, next_index);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * \brief Returns the cost of a square computed by get_costs_in_cluster().
+ * \param cluster_index Index of the cluster.
+ * \param costs Costs of the squares of this cluster.
+ * \param square A square of this cluster.
+ * \return The cost, or -1 if the square cannot be reached.
+ */
+int PathFindingGraph::get_cost_in_cluster(
+    int cluster_index,
+    const std::vector<int>& costs,
+    int square
+) const {
+
+  const int x0 = (cluster_index % num_clusters_x) * cluster_size;
+  const int y0 = (cluster_index / num_clusters_x) * cluster_size;
+  const int width = std::min(cluster_size, width8 - x0);
+  return costs[(square / width8 - y0) * width + (square % width8 - x0)];
+}
+
+}
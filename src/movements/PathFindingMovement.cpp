@@ -31,7 +31,8 @@ namespace Solarus {
 PathFindingMovement::PathFindingMovement(int speed):
   PathMovement("", speed, false, false, true),
   target(),
-  next_recomputation_date(0) {
+  next_recomputation_date(0),
+  hierarchical(false) {
 
 }
 
@@ -44,6 +45,28 @@ void PathFindingMovement::set_target(const EntityPtr& target) {
   next_recomputation_date = System::now() + 100;
 }
 
+/**
+ * \brief Returns whether far targets are searched with hierarchical path
+ * finding.
+ * \return \c true if hierarchical path finding is enabled.
+ */
+bool PathFindingMovement::is_hierarchical() const {
+  return hierarchical;
+}
+
+/**
+ * \brief Sets whether far targets are searched with hierarchical path
+ * finding.
+ *
+ * Without it, no path is computed when the target is more than about
+ * 200 pixels away.
+ *
+ * \param hierarchical \c true to enable hierarchical path finding.
+ */
+void PathFindingMovement::set_hierarchical(bool hierarchical) {
+  this->hierarchical = hierarchical;
+}
+
 /**
  * \brief Updates the position.
  */
@@ -81,6 +104,7 @@ void PathFindingMovement::recompute_movement() {
 
   if (target != nullptr) {
     PathFinding path_finding(get_entity()->get_map(), *get_entity(), *target);
+    path_finding.set_hierarchical(hierarchical);
     std::string path = path_finding.compute_path();
 
     uint32_t min_delay;
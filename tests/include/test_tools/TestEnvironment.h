@@ -20,9 +20,10 @@
 #include "solarus/Common.h"
 #include "solarus/Arguments.h"
 #include "solarus/MainLoop.h"
+#include "solarus/lowlevel/IntrusivePtr.h"
 #include "solarus/lowlevel/Point.h"
 #include <cstdint>
-#include <memory>
+#include <vector>
 
 namespace Solarus {
 
@@ -50,6 +51,8 @@ class TestEnvironment {
 
     TestEnvironment(int argc, char** argv);
 
+    static std::vector<char*> with_audio(int argc, char** argv);
+
     // Get important objects.
     const Arguments& get_arguments() const;
     MainLoop& get_main_loop();
@@ -62,7 +65,7 @@ class TestEnvironment {
 
     // Creating entities.
     template<typename T>
-    std::shared_ptr<T> make_entity(
+    IntrusivePtr<T> make_entity(
         const Point& xy = Point(0, 0),
         int layer = 0
     );
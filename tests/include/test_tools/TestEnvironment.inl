@@ -21,7 +21,7 @@ class CustomEntity;
 // Template specializations.
 
 template<>
-std::shared_ptr<CustomEntity> TestEnvironment::make_entity<CustomEntity>(
+IntrusivePtr<CustomEntity> TestEnvironment::make_entity<CustomEntity>(
     const Point& xy,
     int layer
 );
@@ -23,6 +23,8 @@
 #include "solarus/Game.h"
 #include "solarus/Savegame.h"
 #include "test_tools/TestEnvironment.h"
+#include <cstdlib>
+#include <string>
 
 namespace Solarus {
 
@@ -39,6 +41,34 @@ TestEnvironment::TestEnvironment(int argc, char** argv):
   Debug::set_abort_on_die(true);
 }
 
+/**
+ * \brief Prepares the arguments of a test that needs audio.
+ *
+ * Tests are run with -no-audio: this option is removed.
+ * The null output of OpenAL Soft is selected so that no sound card is
+ * needed.
+ *
+ * \param argc Number of command-line arguments of the test.
+ * \param argv Command-line arguments of the test.
+ * \return The arguments to pass to the constructor.
+ */
+std::vector<char*> TestEnvironment::with_audio(int argc, char** argv) {
+
+#ifdef _WIN32
+  _putenv_s("ALSOFT_DRIVERS", "null");
+#else
+  setenv("ALSOFT_DRIVERS", "null", 1);
+#endif
+
+  std::vector<char*> arguments;
+  for (int i = 0; i < argc; ++i) {
+    if (std::string(argv[i]) != "-no-audio") {
+      arguments.push_back(argv[i]);
+    }
+  }
+  return arguments;
+}
+
 /**
  * \brief Returns the runtime arguments that were passed to the test.
  * \return The runtime arguments.
@@ -60,7 +90,7 @@ MainLoop& TestEnvironment::get_main_loop() {
 Game& TestEnvironment::get_game() {
 
   if (main_loop.get_game() == nullptr) {
-    std::shared_ptr<Savegame> savegame = std::make_shared<Savegame>(
+    IntrusivePtr<Savegame> savegame = make_intrusive<Savegame>(
         main_loop, "save_initial.dat"
     );
     savegame->initialize();
@@ -121,12 +151,12 @@ void TestEnvironment::run_map(const std::string& map_id) {
  * \param layer Layer of the entity to create.
  */
 template<>
-std::shared_ptr<CustomEntity> TestEnvironment::make_entity<CustomEntity>(
+IntrusivePtr<CustomEntity> TestEnvironment::make_entity<CustomEntity>(
     const Point& xy,
     int layer
 ) {
 
-  std::shared_ptr<CustomEntity> entity = std::make_shared<CustomEntity>(
+  IntrusivePtr<CustomEntity> entity = make_intrusive<CustomEntity>(
      get_game(),
      "",
      0,
@@ -147,12 +177,12 @@ std::shared_ptr<CustomEntity> TestEnvironment::make_entity<CustomEntity>(
  * \param layer Layer of the entity to create.
  */
 template<>
-std::shared_ptr<Npc> TestEnvironment::make_entity<Npc>(
+IntrusivePtr<Npc> TestEnvironment::make_entity<Npc>(
     const Point& xy,
     int layer
 ) {
 
-  std::shared_ptr<Npc> entity = std::make_shared<Npc>(
+  IntrusivePtr<Npc> entity = make_intrusive<Npc>(
      get_game(),
      "",
      layer,
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/IntrusivePtr.h"
+#include "solarus/lowlevel/String.h"
+#include "solarus/lua/ExportableToLua.h"
+#include "test_tools/TestEnvironment.h"
+#include <set>
+#include <string>
+#include <unordered_set>
+
+using namespace Solarus;
+
+namespace {
+
+int num_objects = 0;  /**< Number of Object instances alive. */
+
+/**
+ * \brief Minimal object managed by IntrusivePtr.
+ */
+class Object: public ExportableToLua {
+
+  public:
+
+    Object() {
+      ++num_objects;
+    }
+
+    ~Object() {
+      --num_objects;
+    }
+
+    const std::string& get_lua_type_name() const override {
+      static const std::string name = "object";
+      return name;
+    }
+
+};
+
+/**
+ * \brief Subclass to test conversions.
+ */
+class DerivedObject: public Object {
+
+};
+
+using ObjectPtr = IntrusivePtr<Object>;
+using DerivedObjectPtr = IntrusivePtr<DerivedObject>;
+
+/**
+ * \brief Checks the number of objects alive.
+ */
+void check_num_objects(int expected) {
+
+  Debug::check_assertion(num_objects == expected,
+      "Wrong number of objects: expected " + String::to_string(expected) +
+      ", got " + String::to_string(num_objects));
+}
+
+/**
+ * \brief Tests copying and destroying handles.
+ */
+void test_copy(TestEnvironment& /* env */) {
+
+  {
+    ObjectPtr object = make_intrusive<Object>();
+    check_num_objects(1);
+    Debug::check_assertion(object->get_reference_count() == 1, "Wrong reference count");
+
+    ObjectPtr copy = object;
+    Debug::check_assertion(object->get_reference_count() == 2, "Wrong reference count");
+    Debug::check_assertion(copy == object, "Copy differs");
+
+    ObjectPtr moved = std::move(copy);
+    Debug::check_assertion(copy == nullptr, "Moved handle not empty");
+    Debug::check_assertion(object->get_reference_count() == 2, "Wrong reference count");
+
+    object.reset();
+    check_num_objects(1);
+    Debug::check_assertion(moved->get_reference_count() == 1, "Wrong reference count");
+  }
+  check_num_objects(0);
+}
+
+/**
+ * \brief Tests creating a new handle from a raw pointer.
+ */
+void test_raw_pointer(TestEnvironment& /* env */) {
+
+  ObjectPtr object = make_intrusive<Object>();
+  Object& raw_object = *object;
+  {
+    ObjectPtr other(&raw_object);
+    Debug::check_assertion(other == object, "Wrong object");
+    Debug::check_assertion(object->get_reference_count() == 2, "Wrong reference count");
+  }
+  Debug::check_assertion(object->get_reference_count() == 1, "Wrong reference count");
+
+  object = nullptr;
+  check_num_objects(0);
+}
+
+/**
+ * \brief Tests conversions between handle types.
+ */
+void test_casts(TestEnvironment& /* env */) {
+
+  DerivedObjectPtr derived = make_intrusive<DerivedObject>();
+  ObjectPtr base = derived;
+  IntrusivePtr<const Object> const_base = base;
+  Debug::check_assertion(base == derived, "Wrong conversion");
+  Debug::check_assertion(const_base == derived, "Wrong const conversion");
+
+  Debug::check_assertion(static_pointer_cast<DerivedObject>(base) == derived, "Wrong static cast");
+  Debug::check_assertion(dynamic_pointer_cast<DerivedObject>(base) == derived, "Wrong dynamic cast");
+  Debug::check_assertion(const_pointer_cast<Object>(const_base) == base, "Wrong const cast");
+
+  ObjectPtr other = make_intrusive<Object>();
+  Debug::check_assertion(dynamic_pointer_cast<DerivedObject>(other) == nullptr, "Wrong dynamic cast");
+
+  std::set<ObjectPtr> set = { base, other, base };
+  Debug::check_assertion(set.size() == 2, "Wrong set size");
+  std::unordered_set<ObjectPtr> unordered_set = { base, other, base };
+  Debug::check_assertion(unordered_set.size() == 2, "Wrong unordered set size");
+  Debug::check_assertion(base->get_reference_count() == 5, "Wrong reference count");
+}
+
+/**
+ * \brief Tests weak handles.
+ */
+void test_weak(TestEnvironment& /* env */) {
+
+  check_num_objects(0);
+  IntrusiveWeakPtr<Object> weak;
+  Debug::check_assertion(weak.expired(), "Empty weak handle not expired");
+  Debug::check_assertion(weak.lock() == nullptr, "Empty weak handle locked");
+
+  {
+    ObjectPtr object = make_intrusive<DerivedObject>();
+    weak = object;
+    IntrusiveWeakPtr<Object> copy = weak;
+    Debug::check_assertion(!weak.expired(), "Weak handle expired too early");
+    Debug::check_assertion(copy.lock() == object, "Wrong locked object");
+    Debug::check_assertion(object->get_reference_count() == 1, "Weak handle took a reference");
+  }
+  check_num_objects(0);
+  Debug::check_assertion(weak.expired(), "Weak handle not expired");
+  Debug::check_assertion(weak.lock() == nullptr, "Expired weak handle locked");
+
+  weak.reset();
+  Debug::check_assertion(weak.expired(), "Reset weak handle not expired");
+}
+
+}
+
+/**
+ * Tests for reference-counted handles.
+ */
+int main(int argc, char** argv) {
+
+  TestEnvironment env(argc, argv);
+
+  test_copy(env);
+  test_raw_pointer(env);
+  test_casts(env);
+  test_weak(env);
+
+  return 0;
+}
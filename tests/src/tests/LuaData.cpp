@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lua/LuaData.h"
+#include "test_tools/TestEnvironment.h"
+#include <lua.hpp>
+#include <algorithm>
+#include <clocale>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Solarus;
+
+namespace {
+
+/**
+ * \brief Data file that records the tables passed to its functions.
+ *
+ * entry{ ... } records its table.
+ * fail{ ... } raises an error.
+ */
+class RecordedData : public LuaData {
+
+  public:
+
+    std::string calls;   /**< Text of the tables received, in order. */
+    std::string error;   /**< Error message of the chunk if any. */
+
+    virtual bool import_from_lua(lua_State* l) override {
+
+      lua_pushlightuserdata(l, this);
+      lua_pushcclosure(l, l_entry, 1);
+      lua_setglobal(l, "entry");
+      lua_pushcfunction(l, l_fail);
+      lua_setglobal(l, "fail");
+
+      if (lua_pcall(l, 0, 0, 0) != 0) {
+        error = lua_tostring(l, -1);
+        lua_pop(l, 1);
+        return false;
+      }
+      return true;
+    }
+
+  private:
+
+    static int l_entry(lua_State* l) {
+
+      RecordedData* data = static_cast<RecordedData*>(
+          lua_touserdata(l, lua_upvalueindex(1))
+      );
+      luaL_checktype(l, 1, LUA_TTABLE);
+      data->calls += to_string(l, 1) + "\n";
+      return 0;
+    }
+
+    static int l_fail(lua_State* l) {
+      return luaL_error(l, "fail was called");
+    }
+
+    /**
+     * \brief Returns a text that identifies a constant Lua value.
+     *
+     * The keys of tables are sorted so that the text does not depend
+     * on the order of construction.
+     */
+    static std::string to_string(lua_State* l, int index) {
+
+      char number[64];
+      switch (lua_type(l, index)) {
+
+        case LUA_TNUMBER:
+          std::snprintf(number, sizeof(number), "%.17g", lua_tonumber(l, index));
+          return number;
+
+        case LUA_TSTRING:
+        {
+          size_t size = 0;
+          const char* value = lua_tolstring(l, index, &size);
+          return "\"" + std::string(value, size) + "\"";
+        }
+
+        case LUA_TBOOLEAN:
+          return lua_toboolean(l, index) ? "true" : "false";
+
+        case LUA_TTABLE:
+        {
+          std::vector<std::pair<std::string, std::string>> fields;
+          lua_pushnil(l);
+          while (lua_next(l, index) != 0) {
+            const int top = lua_gettop(l);
+            fields.emplace_back(to_string(l, top - 1), to_string(l, top));
+            lua_pop(l, 1);
+          }
+          std::sort(fields.begin(), fields.end());
+          std::string text = "{";
+          for (const auto& field : fields) {
+            text += "[" + field.first + "]=" + field.second + ",";
+          }
+          return text + "}";
+        }
+      }
+
+      return luaL_typename(l, index);
+    }
+};
+
+/**
+ * \brief Imports a buffer with and without the native parser.
+ * \param buffer Content of a data file.
+ * \param native Receives the result with the native parser.
+ * \param lua Receives the result with the Lua compiler only.
+ * \return \c true if both imports succeeded.
+ */
+bool import_both(const std::string& buffer, RecordedData& native, RecordedData& lua) {
+
+  LuaData::set_native_parser_enabled(true);
+  const bool native_success = native.import_from_buffer(buffer, "test.dat");
+  LuaData::set_native_parser_enabled(false);
+  const bool lua_success = lua.import_from_buffer(buffer, "test.dat");
+  LuaData::set_native_parser_enabled(true);
+
+  if (native_success != lua_success) {
+    std::cerr << "Buffer:" << std::endl << buffer << std::endl
+        << "*** Native parser error: " << native.error << std::endl
+        << "*** Lua error: " << lua.error << std::endl;
+    Debug::die("The native parser and Lua do not both succeed or fail");
+  }
+  if (native.calls != lua.calls) {
+    std::cerr << "Buffer:" << std::endl << buffer << std::endl
+        << "*** Native parser:" << std::endl << native.calls << std::endl
+        << "*** Lua:" << std::endl << lua.calls << std::endl;
+    Debug::die("The native parser and Lua give different tables");
+  }
+  return native_success;
+}
+
+/**
+ * \brief Checks that a valid buffer gives the same tables with both paths.
+ */
+void check_same_tables(const std::string& buffer) {
+
+  RecordedData native;
+  RecordedData lua;
+  Debug::check_assertion(import_both(buffer, native, lua), "Import failed");
+  Debug::check_assertion(!native.calls.empty(), "No calls were recorded");
+}
+
+/**
+ * \brief Checks that an invalid buffer fails the same way with both paths.
+ * \param same_message Whether error messages must be identical.
+ * Otherwise, the native parser may add the file and the line.
+ */
+void check_same_error(const std::string& buffer, bool same_message) {
+
+  RecordedData native;
+  RecordedData lua;
+  Debug::set_die_on_error(false);
+  const bool success = import_both(buffer, native, lua);
+  Debug::set_die_on_error(true);
+
+  Debug::check_assertion(!success, "Import should have failed");
+  if (same_message) {
+    Debug::check_assertion(native.error == lua.error,
+        "Different error messages: '" + native.error + "' and '" + lua.error + "'");
+  }
+  else {
+    Debug::check_assertion(native.error.find(lua.error) != std::string::npos,
+        "Different error messages: '" + native.error + "' and '" + lua.error + "'");
+  }
+}
+
+/**
+ * \brief Returns a copy of a buffer with Windows line endings.
+ */
+std::string with_crlf(const std::string& buffer) {
+
+  std::string result;
+  for (char c : buffer) {
+    if (c == '\n') {
+      result += '\r';
+    }
+    result += c;
+  }
+  return result;
+}
+
+const std::string numbers_buffer =
+    "entry{ a = 0, b = 42, c = 123456789012345, d = 1234567890123456789 }\n"
+    "entry{ a = 1.5, b = .25, c = 5., d = 0.1, e = 3.14159265358979 }\n"
+    "entry{ a = 1e3, b = 2E-2, c = 1.5e+10, d = 1e308, e = 1e-300 }\n"
+    "entry{ a = -1, b = - 2.5, c = -1e-3, d = { -7, -8 } }\n";
+
+const std::string hex_buffer =
+    "entry{ a = 0x10, b = 0XfF, c = -0x1 }\n";
+
+const std::string strings_buffer =
+    "entry{ \"double\", 'single', \"it's\", 'say \"hi\"', '' }\n"
+    "entry{ \"a\\nb\\tc\\\\d\\\"e\\'f\", '\\a\\b\\f\\r\\v' }\n"
+    "entry{ \"\\65\\066\\0671\\255\", 'line\\\ncontinued' }\n"
+    "entry{ [[long\nstring]], [==[\nwith ]] inside]==], [[]] }\n"
+    "entry{ 'caf\xc3\xa9' }\n";
+
+const std::string tables_buffer =
+    "entry{ { 1, 2, { x = 3, y = { true, false, nil, 4 } } } }\n"
+    "entry{ name = \"n\"; other = 'o', 10, 20; }\n"
+    "entry{\n"
+    "  properties = {\n"
+    "    { key = \"a\", value = \"1\" },\n"
+    "    { key = \"b\", value = \"2\" },\n"
+    "  },\n"
+    "}\n"
+    "entry{}\n"
+    "entry{ x = 1 }; entry{ y = 2 }\n";
+
+const std::string comments_buffer =
+    "-- A line comment.\n"
+    "entry{ a = 1 } -- A trailing comment.\n"
+    "--[[ A block\n"
+    "comment. ]] entry{ --[==[ Inside ]] a table. ]==] b = 2 }\n"
+    "entry{ c = 3, -- Between fields.\n"
+    "  d = --[[ Before a value. ]] 4,\n"
+    "}\n"
+    "--";
+
+}
+
+/**
+ * \brief Tests that the native parser of data files gives the same results
+ * as Lua.
+ */
+int main(int argc, char** argv) {
+
+  TestEnvironment env(argc, argv);
+
+  const std::vector<std::string> valid_buffers = {
+      numbers_buffer,
+      hex_buffer,
+      strings_buffer,
+      tables_buffer,
+      comments_buffer,
+  };
+  for (const std::string& buffer : valid_buffers) {
+    check_same_tables(buffer);
+    check_same_tables(with_crlf(buffer));
+  }
+
+  // Syntax errors: Lua reports them.
+  check_same_error("entry{ a = 1 }\n;\n;\n", true);
+  check_same_error("entry{ a = 1 };;\n", true);
+  check_same_error("; entry{ a = 1 }\n", true);
+  check_same_error("entry{ a = 1\n", true);
+  check_same_error("entry{ a = \"unfinished }\n", true);
+  check_same_error("entry{ a = 1 } }\n", true);
+  check_same_error("entry{ a = 1.2.3 }\n", true);
+  check_same_error("entry{ a = 1e }\n", true);
+  check_same_error("entry{ a = [[unfinished }\n", true);
+
+  // Errors while running.
+  check_same_error("entry{ a = 1 }\n\nunknown{ b = 2 }\n", true);
+  check_same_error(with_crlf("entry{ a = 1 }\n\nunknown{ b = 2 }\n"), true);
+  check_same_error("entry{ a = 1 }\nfail{ b = 2 }\nentry{ c = 3 }\n", false);
+
+  // Numbers do not depend on the decimal point of the locale.
+  const char* const comma_locales[] = {
+      "de_DE.UTF-8", "fr_FR.UTF-8", "de_DE", "fr_FR", "German", "French"
+  };
+  for (const char* locale : comma_locales) {
+    if (std::setlocale(LC_NUMERIC, locale) != nullptr) {
+      check_same_tables(numbers_buffer);
+      std::setlocale(LC_NUMERIC, "C");
+      break;
+    }
+  }
+
+  return 0;
+}
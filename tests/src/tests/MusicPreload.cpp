@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Music.h"
+#include "test_tools/TestEnvironment.h"
+#include <vector>
+
+using namespace Solarus;
+
+namespace {
+
+/**
+ * \brief Tests that playing a preloaded music uses the prepared track.
+ */
+void test_reuse(TestEnvironment& /* env */) {
+
+  Music::preload("short_tune");
+  Debug::check_assertion(Music::get_preloaded_music_id() == "short_tune",
+      "Music not preloaded");
+
+  Music::play("short_tune", true);
+  Debug::check_assertion(Music::get_current_music_id() == "short_tune",
+      "Preloaded music not played");
+  Debug::check_assertion(Music::get_preloaded_music_id() == Music::none,
+      "Preloaded music not reused");
+
+  // Preloading the current music does nothing.
+  Music::preload("short_tune");
+  Debug::check_assertion(Music::get_preloaded_music_id() == Music::none,
+      "Current music preloaded again");
+
+  Music::stop_playing();
+}
+
+/**
+ * \brief Tests that a preloaded music is not reused with other options.
+ */
+void test_no_reuse(TestEnvironment& /* env */) {
+
+  // Preloaded musics loop: playing the music once needs another track.
+  Music::preload("short_tune");
+  Music::play("short_tune", false);
+  Debug::check_assertion(Music::get_current_music_id() == "short_tune",
+      "Music not played");
+  Debug::check_assertion(Music::get_preloaded_music_id() == "short_tune",
+      "Preloaded music reused with a different loop setting");
+
+  Music::stop_playing();
+}
+
+}
+
+/**
+ * \brief Tests for preloading musics.
+ */
+int main(int argc, char** argv) {
+
+  std::vector<char*> arguments = TestEnvironment::with_audio(argc, argv);
+  TestEnvironment env(static_cast<int>(arguments.size()), arguments.data());
+  Debug::check_assertion(Music::is_initialized(), "Audio is not initialized");
+
+  test_reuse(env);
+  test_no_reuse(env);
+
+  return 0;
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/entities/Camera.h"
+#include "solarus/entities/TilePattern.h"
+#include "solarus/entities/Tileset.h"
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Surface.h"
+#include "solarus/Map.h"
+#include "test_tools/TestEnvironment.h"
+#include <string>
+
+using namespace Solarus;
+
+namespace {
+
+/**
+ * \brief Returns the RGBA components of a pixel.
+ */
+std::string get_pixel(const std::string& pixels, int width, int x, int y) {
+  return pixels.substr((y * width + x) * 4, 4);
+}
+
+/**
+ * \brief Checks the parallax ratios read from the tileset.
+ */
+void test_ratios(TestEnvironment& env) {
+
+  const Tileset& tileset = env.get_map().get_tileset();
+  Debug::check_assertion(tileset.get_tile_pattern("87").get_parallax_ratio() == 2,
+      "Wrong default parallax ratio");
+  Debug::check_assertion(tileset.get_tile_pattern("88").get_parallax_ratio() == 4,
+      "Wrong parallax ratio");
+  Debug::check_assertion(tileset.get_tile_pattern("3").get_parallax_ratio() == 0,
+      "Parallax ratio on a normal tile pattern");
+}
+
+/**
+ * \brief Checks that tiles with different ratios scroll differently.
+ *
+ * The map has a tile with ratio 2 at (200,100) and a tile with ratio 4
+ * at (200,140), both filled with the same color on a black background.
+ */
+void test_rendering(TestEnvironment& env) {
+
+  Map& map = env.get_map();
+  map.get_camera()->set_xy(80, 40);
+  map.draw();
+
+  const SurfacePtr& camera_surface = map.get_camera_surface();
+  const int width = camera_surface->get_width();
+  const std::string& pixels = camera_surface->get_pixels();
+
+  const std::string color("\x20\x03\x02\xff", 4);
+  const std::string black("\0\0\0\xff", 4);
+
+  // Ratio 2: moved by (40,20) from its position relative to the camera.
+  // Ratio 4: moved by (20,10).
+  const Point ratio_2_xy(200 - 80 + 40, 100 - 40 + 20);
+  const Point ratio_4_xy(200 - 80 + 20, 140 - 40 + 10);
+  for (int y = 0; y < 16; ++y) {
+    for (int x = 0; x < 16; ++x) {
+      Debug::check_assertion(
+          get_pixel(pixels, width, ratio_2_xy.x + x, ratio_2_xy.y + y) == color,
+          "Wrong pixel for the tile with ratio 2");
+      Debug::check_assertion(
+          get_pixel(pixels, width, ratio_4_xy.x + x, ratio_4_xy.y + y) == color,
+          "Wrong pixel for the tile with ratio 4");
+    }
+  }
+
+  // Where the tiles would be with the other ratio.
+  Debug::check_assertion(
+      get_pixel(pixels, width, 200 - 80 + 20 + 8, 100 - 40 + 10 + 8) == black,
+      "The tile with ratio 2 scrolls with ratio 4");
+  Debug::check_assertion(
+      get_pixel(pixels, width, 200 - 80 + 40 + 8, 140 - 40 + 20 + 8) == black,
+      "The tile with ratio 4 scrolls with ratio 2");
+}
+
+}
+
+/**
+ * \brief Tests for parallax scrolling tiles.
+ */
+int main(int argc, char** argv) {
+
+  TestEnvironment env(argc, argv);
+  env.run_map("parallax_tests");
+
+  test_ratios(env);
+  test_rendering(env);
+
+  return 0;
+}
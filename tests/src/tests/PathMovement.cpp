@@ -30,7 +30,7 @@ void one_step_test(TestEnvironment& env, Entity& entity) {
 
   Point old_xy = entity.get_xy();
 
-  std::shared_ptr<PathMovement> movement = std::make_shared<PathMovement>(
+  IntrusivePtr<PathMovement> movement = make_intrusive<PathMovement>(
       "0", 100, false, false, false // 8 pixels to the right.
   );
   entity.set_movement(movement);
@@ -79,7 +79,7 @@ void one_step_test(TestEnvironment& env, Entity& entity) {
  */
 void direction_test(TestEnvironment& env, Entity& entity) {
 
-  std::shared_ptr<PathMovement> movement = std::make_shared<PathMovement>(
+  IntrusivePtr<PathMovement> movement = make_intrusive<PathMovement>(
       "5", 100, false, false, false  // 8 pixels to the right.
   );
   entity.set_movement(movement);
@@ -103,7 +103,7 @@ void multi_step_test(TestEnvironment& env, Entity& entity) {
 
   Point old_xy = entity.get_xy();
 
-  std::shared_ptr<PathMovement> movement = std::make_shared<PathMovement>(
+  IntrusivePtr<PathMovement> movement = make_intrusive<PathMovement>(
       "66", 100, false, false, false  // 16 pixels downwards.
   );
   entity.set_movement(movement);
@@ -141,7 +141,7 @@ void snap_test(TestEnvironment& env, Entity& entity) {
       "Entity should not be aligned on the grid");
 
   // #1: a path movement that does not require the entity to snap to the grid
-  std::shared_ptr<PathMovement> movement = std::make_shared<PathMovement>(
+  IntrusivePtr<PathMovement> movement = make_intrusive<PathMovement>(
       "56", 100, false, false, false
   );
   entity.set_movement(movement);
@@ -155,7 +155,7 @@ void snap_test(TestEnvironment& env, Entity& entity) {
   entity.clear_movement();
 
   // #2: a path movement that requires the entity to snap to the grid
-  movement = std::make_shared<PathMovement>(
+  movement = make_intrusive<PathMovement>(
       "21", 100, false, false, true
   );
   entity.set_movement(movement);
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Sound.h"
+#include "test_tools/TestEnvironment.h"
+#include <vector>
+
+using namespace Solarus;
+
+namespace {
+
+// Sounds long enough to still be playing during the whole test.
+const Symbol heart_container = "heart_container";
+const Symbol water_fill = "water_fill";
+const Symbol wings = "wings1";
+const Symbol world_warp = "world_warp";
+const Symbol hero_dying = "hero_dying";
+const Symbol treasure = "treasure";
+
+/**
+ * \brief Plays a sound in a new tick.
+ */
+void play_in_new_tick(const Symbol& sound_id) {
+
+  Sound::update();
+  Sound::play(sound_id);
+}
+
+/**
+ * \brief Tests that a sound played several times in a tick has one voice.
+ */
+void test_coalescing(TestEnvironment& /* env */) {
+
+  Sound::update();
+  for (int i = 0; i < 30; ++i) {
+    Sound::play(heart_container);
+  }
+  Debug::check_assertion(Sound::get_num_voices(heart_container) == 1,
+      "Sounds played in the same tick are not coalesced");
+  Debug::check_assertion(Sound::get_num_voices() == 1, "Wrong number of voices");
+}
+
+/**
+ * \brief Tests the maximum number of voices of a sound.
+ */
+void test_sound_limit(TestEnvironment& /* env */) {
+
+  for (int i = 0; i < 5; ++i) {
+    play_in_new_tick(water_fill);
+  }
+  Debug::check_assertion(Sound::get_num_voices(water_fill) == 2,
+      "Default limit of voices per sound not respected");
+
+  Sound::set_sound_max_voices(wings, 3);
+  for (int i = 0; i < 5; ++i) {
+    play_in_new_tick(wings);
+  }
+  Debug::check_assertion(Sound::get_num_voices(wings) == 3,
+      "Limit of voices of a sound not respected");
+  Debug::check_assertion(Sound::get_num_voices() == 6, "Wrong number of voices");
+}
+
+/**
+ * \brief Tests the maximum number of voices of all sounds.
+ */
+void test_total_limit(TestEnvironment& /* env */) {
+
+  Sound::set_max_voices(6);
+  play_in_new_tick(world_warp);
+
+  // The oldest voice was stopped.
+  Debug::check_assertion(Sound::get_num_voices() == 6, "Total limit of voices not respected");
+  Debug::check_assertion(Sound::get_num_voices(heart_container) == 0, "Wrong voice stopped");
+  Debug::check_assertion(Sound::get_num_voices(world_warp) == 1, "Sound not started");
+}
+
+/**
+ * \brief Tests that voices of sounds with a higher priority are kept.
+ */
+void test_priority(TestEnvironment& /* env */) {
+
+  Sound::set_sound_priority(hero_dying, 10);
+  play_in_new_tick(hero_dying);
+  Debug::check_assertion(Sound::get_num_voices(hero_dying) == 1, "Sound not started");
+
+  // Only the voice with a higher priority can remain.
+  Sound::set_max_voices(1);
+  play_in_new_tick(treasure);
+  Debug::check_assertion(Sound::get_num_voices() == 1, "Total limit of voices not respected");
+  Debug::check_assertion(Sound::get_num_voices(hero_dying) == 1,
+      "Voice with a higher priority stopped");
+  Debug::check_assertion(Sound::get_num_voices(treasure) == 0,
+      "Sound with a lower priority started");
+
+  // Same priority: the oldest voice is stopped.
+  Sound::set_sound_priority(treasure, 10);
+  play_in_new_tick(treasure);
+  Debug::check_assertion(Sound::get_num_voices() == 1, "Total limit of voices not respected");
+  Debug::check_assertion(Sound::get_num_voices(hero_dying) == 0, "Oldest voice not stopped");
+  Debug::check_assertion(Sound::get_num_voices(treasure) == 1, "Sound not started");
+}
+
+}
+
+/**
+ * \brief Tests for the limits of sound voices.
+ */
+int main(int argc, char** argv) {
+
+  std::vector<char*> arguments = TestEnvironment::with_audio(argc, argv);
+  TestEnvironment env(static_cast<int>(arguments.size()), arguments.data());
+  Debug::check_assertion(Sound::is_initialized(), "Audio is not initialized");
+
+  Sound::set_coalescing_louder(false);
+  Sound::set_max_voices(0);
+  Sound::set_default_max_voices_per_sound(2);
+
+  test_coalescing(env);
+  test_sound_limit(env);
+  test_total_limit(env);
+  test_priority(env);
+
+  return 0;
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Symbol.h"
+#include "test_tools/TestEnvironment.h"
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+using namespace Solarus;
+
+namespace {
+
+/**
+ * \brief Tests that equal strings give the same symbol.
+ */
+void test_interning(TestEnvironment& /* env */) {
+
+  const Symbol walking("walking");
+  const Symbol walking_again(std::string("walk") + "ing");
+  const Symbol stopped = "stopped";
+
+  Debug::check_assertion(walking == walking_again, "Equal strings give different symbols");
+  Debug::check_assertion(walking.get_handle() == walking_again.get_handle(), "Different handles");
+  Debug::check_assertion(walking.str().c_str() == walking_again.c_str(), "String not shared");
+  Debug::check_assertion(walking != stopped, "Different strings give equal symbols");
+  Debug::check_assertion(walking.get_hash() == std::hash<std::string>()("walking"), "Wrong hash");
+
+  Debug::check_assertion(Symbol::from_handle(stopped.get_handle()) == stopped, "Wrong symbol from handle");
+}
+
+/**
+ * \brief Tests the empty symbol.
+ */
+void test_empty(TestEnvironment& /* env */) {
+
+  const Symbol empty;
+  Debug::check_assertion(empty.empty(), "Default symbol is not empty");
+  Debug::check_assertion(empty.str().empty(), "Default symbol has a string");
+  Debug::check_assertion(empty == Symbol(""), "Empty string gives another symbol");
+  Debug::check_assertion(!Symbol("a").empty(), "Non-empty symbol is empty");
+}
+
+/**
+ * \brief Tests looking up symbols without interning them.
+ */
+void test_find(TestEnvironment& /* env */) {
+
+  Symbol symbol;
+  Debug::check_assertion(!Symbol::find("symbol_test_never_interned", symbol), "Unknown string found");
+
+  const Symbol interned("symbol_test_interned");
+  Debug::check_assertion(Symbol::find("symbol_test_interned", symbol), "Interned string not found");
+  Debug::check_assertion(symbol == interned, "Wrong symbol found");
+
+  Debug::check_assertion(Symbol::find("", symbol), "Empty string not found");
+  Debug::check_assertion(symbol.empty(), "Wrong empty symbol found");
+}
+
+/**
+ * \brief Tests comparisons and conversions with strings.
+ */
+void test_strings(TestEnvironment& /* env */) {
+
+  const Symbol hurt("hurt");
+  const std::string hurt_string = "hurt";
+
+  Debug::check_assertion(hurt == "hurt" && "hurt" == hurt, "Wrong comparison with C string");
+  Debug::check_assertion(hurt == hurt_string && hurt_string == hurt, "Wrong comparison with string");
+  Debug::check_assertion(hurt != "walking" && "walking" != hurt, "Wrong comparison with C string");
+  Debug::check_assertion(hurt + "_1" == "hurt_1", "Wrong concatenation");
+  Debug::check_assertion("enemy_" + hurt == "enemy_hurt", "Wrong concatenation");
+
+  std::ostringstream oss;
+  oss << hurt;
+  Debug::check_assertion(oss.str() == "hurt", "Wrong output");
+}
+
+/**
+ * \brief Tests symbols as keys of containers.
+ */
+void test_containers(TestEnvironment& /* env */) {
+
+  std::unordered_map<Symbol, int> unordered_map;
+  unordered_map[Symbol("b")] = 2;
+  unordered_map["a"] = 1;
+  unordered_map[std::string("b")] = 3;
+  Debug::check_assertion(unordered_map.size() == 2, "Wrong unordered map size");
+  Debug::check_assertion(unordered_map.at("b") == 3, "Wrong unordered map value");
+
+  // Ordered containers are sorted alphabetically.
+  std::map<Symbol, int> map;
+  map["zz"] = 3;
+  map["aa"] = 1;
+  map["mm"] = 2;
+  int i = 1;
+  for (const auto& kvp: map) {
+    Debug::check_assertion(kvp.second == i, "Wrong order");
+    ++i;
+  }
+}
+
+}
+
+/**
+ * Tests for interned symbols.
+ */
+int main(int argc, char** argv) {
+
+  TestEnvironment env(argc, argv);
+
+  test_interning(env);
+  test_empty(env);
+  test_find(env);
+  test_strings(env);
+  test_containers(env);
+
+  return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2006-2016 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/entities/Entities.h"
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Rectangle.h"
+#include "solarus/lowlevel/Surface.h"
+#include "solarus/Map.h"
+#include "test_tools/TestEnvironment.h"
+#include <string>
+
+using namespace Solarus;
+
+namespace {
+
+/**
+ * \brief Returns the RGBA components of a pixel.
+ */
+std::string get_pixel(const std::string& pixels, int width, int x, int y) {
+  return pixels.substr((y * width + x) * 4, 4);
+}
+
+/**
+ * \brief Checks which regions of the map are considered hidden.
+ *
+ * The map has a floor on layer 0 and an opaque 64x64 black square on
+ * layer 1 at (64,64).
+ */
+void test_hidden(TestEnvironment& env) {
+
+  Entities& entities = env.get_entities();
+
+  // The floor below the black square is culled.
+  Debug::check_assertion(entities.is_hidden(Rectangle(64, 64, 64, 64), 0),
+      "Tiles below the opaque square are not hidden");
+  Debug::check_assertion(entities.is_hidden(Rectangle(72, 80, 16, 16), 0),
+      "Tiles below the opaque square are not hidden");
+
+  // Partially covered or uncovered regions are not.
+  Debug::check_assertion(!entities.is_hidden(Rectangle(56, 64, 16, 16), 0),
+      "Partially covered tile is hidden");
+  Debug::check_assertion(!entities.is_hidden(Rectangle(0, 0, 16, 16), 0),
+      "Uncovered tile is hidden");
+
+  // The opaque square itself is visible.
+  Debug::check_assertion(!entities.is_hidden(Rectangle(64, 64, 64, 64), 1),
+      "Opaque tiles are hidden");
+
+  // The whole map is covered by the floor: the background is culled.
+  Debug::check_assertion(entities.is_hidden(Rectangle(0, 0, 320, 240), -1),
+      "Background is not hidden");
+}
+
+/**
+ * \brief Checks that culling does not change the rendered map.
+ */
+void test_rendering(TestEnvironment& env) {
+
+  Map& map = env.get_map();
+  map.draw();
+
+  const SurfacePtr& camera_surface = map.get_camera_surface();
+  const int width = camera_surface->get_width();
+  const std::string& pixels = camera_surface->get_pixels();
+
+  const SurfacePtr& tiles = Surface::create("tilesets/castle.tiles.png", Surface::DIR_DATA);
+  const int tiles_width = tiles->get_width();
+  const std::string& tiles_pixels = tiles->get_pixels();
+
+  const std::string black("\0\0\0\xff", 4);
+  for (int y = 32; y < 160; ++y) {
+    for (int x = 32; x < 160; ++x) {
+      const std::string& pixel = get_pixel(pixels, width, x, y);
+      if (x >= 64 && x < 128 && y >= 64 && y < 128) {
+        // Opaque square.
+        Debug::check_assertion(pixel == black, "Wrong pixel on the opaque square");
+      }
+      else {
+        // Floor: pattern "3" at (96,0) in the tileset image.
+        const std::string& expected = get_pixel(tiles_pixels, tiles_width, 96 + x % 16, y % 16);
+        Debug::check_assertion(pixel == expected, "Wrong pixel on the floor");
+      }
+    }
+  }
+}
+
+}
+
+/**
+ * \brief Tests for skipping tiles hidden by opaque tiles.
+ */
+int main(int argc, char** argv) {
+
+  TestEnvironment env(argc, argv);
+  env.run_map("tile_occlusion_tests");
+
+  test_hidden(env);
+  test_rendering(env);
+
+  return 0;
+}
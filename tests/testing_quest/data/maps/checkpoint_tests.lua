@@ -0,0 +1,81 @@
+local map = ...
+local game = map:get_game()
+
+-- Save a checkpoint, change the state, then restore the checkpoint.
+function map:on_started()
+
+  if game:has_checkpoint("start") then
+    -- Restarted from the checkpoint.
+    return
+  end
+
+  hero:set_position(80, 77, 0)
+  hero:set_direction(2)
+  block:set_position(120, 165, 1)
+  switch:set_enabled(false)
+  pot:remove()
+  game:set_value("checkpoint_integer", 42)
+  game:set_value("checkpoint_string", "before")
+  game.checkpoint_step = 1
+
+  function game:on_checkpoint_saving()
+    return { step = game.checkpoint_step }
+  end
+
+  function game:on_checkpoint_restored(data)
+
+    local map = game:get_map()
+    assert(map:get_id() == "checkpoint_tests")
+
+    -- Savegame values.
+    assert(game:get_value("checkpoint_integer") == 42)
+    assert(game:get_value("checkpoint_string") == "before")
+    assert(game:get_value("checkpoint_boolean") == nil)
+
+    -- Hero.
+    local hero = game:get_hero()
+    local x, y, layer = hero:get_position()
+    assert(x == 80 and y == 77 and layer == 0)
+    assert(hero:get_direction() == 2)
+    assert(hero:get_state() == "free")
+
+    -- Named entities are back to their state at checkpoint time.
+    local block = map:get_entity("block")
+    assert(block ~= nil)
+    x, y, layer = block:get_position()
+    assert(x == 120 and y == 165 and layer == 1)
+    assert(block:is_enabled())
+    local switch = map:get_entity("switch")
+    assert(switch ~= nil)
+    assert(not switch:is_enabled())
+    x, y = switch:get_position()
+    assert(x == 240 and y == 165)
+    assert(map:get_entity("pot") == nil)
+
+    -- Script data.
+    assert(data.step == 1)
+
+    game:remove_checkpoint("start")
+    assert(not game:has_checkpoint("start"))
+    sol.main.exit()
+  end
+
+  game:save_checkpoint("start")
+  assert(game:has_checkpoint("start"))
+
+  -- Change everything.
+  game:set_value("checkpoint_integer", 7)
+  game:set_value("checkpoint_string", "after")
+  game:set_value("checkpoint_boolean", true)
+  game.checkpoint_step = 2
+  hero:set_position(200, 117, 0)
+  hero:set_direction(0)
+  block:set_position(40, 165, 0)
+  block:set_enabled(false)
+  switch:set_enabled(true)
+  switch:set_position(200, 165)
+
+  sol.timer.start(map, 10, function()
+    assert(game:restore_checkpoint("start"))
+  end)
+end
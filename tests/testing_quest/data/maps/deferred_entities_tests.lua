@@ -0,0 +1,47 @@
+local map = ...
+local game = map:get_game()
+
+-- Entities of other separator regions behave as if they were
+-- all created when the map was loaded.
+function map:on_started()
+
+  -- A new entity does not steal the name of an entity of the map file.
+  local far_copy = map:create_custom_entity({
+    name = "far_1",
+    layer = 0,
+    x = 120,
+    y = 77,
+    width = 16,
+    height = 16,
+    direction = 0,
+  })
+  assert(far_copy:get_name() == "far_1_2")
+  local x, y = map:get_entity("far_1"):get_position()
+  assert(x == 40 and y == 365)
+
+  -- Lookups by name, prefix and type see all entities.
+  assert(map:has_entity("far_2"))
+  assert(map:has_entities("far_"))
+  assert(map:get_entities_count("near_") == 2)
+  assert(map:get_entities_count("far_") == 3)
+  local num_npcs = 0
+  for npc in map:get_entities_by_type("npc") do
+    num_npcs = num_npcs + 1
+  end
+  assert(num_npcs == 1)
+
+  -- The Z order follows the map file.
+  local names = {}
+  for entity in map:get_entities_in_rectangle(0, 0, 320, 480) do
+    if entity:get_type() == "custom_entity" then
+      names[#names + 1] = entity:get_name()
+    end
+  end
+  assert(#names == 4)
+  assert(names[1] == "near_1")
+  assert(names[2] == "far_1")
+  assert(names[3] == "near_2")
+  assert(names[4] == "far_1_2")
+
+  sol.main.exit()
+end
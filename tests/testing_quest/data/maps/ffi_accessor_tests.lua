@@ -0,0 +1,70 @@
+local map = ...
+
+-- Hot getters and setters give the same results whether they use the
+-- LuaJIT FFI or the classic bindings.
+function map:on_started()
+
+  local entity = map:create_custom_entity({
+    x = 80,
+    y = 69,
+    layer = 1,
+    direction = 0,
+    width = 16,
+    height = 16,
+    sprite = "entities/explosion",
+  })
+
+  local x, y, layer = entity:get_position()
+  assert_equal(x, 80)
+  assert_equal(y, 69)
+  assert_equal(layer, 1)
+  assert_equal(select("#", entity:get_position()), 3)
+  local width, height = entity:get_size()
+  assert_equal(width, 16)
+  assert_equal(height, 16)
+  x, y, width, height = entity:get_bounding_box()
+  assert_equal(x, 72)
+  assert_equal(y, 56)
+  assert(entity:is_enabled())
+
+  -- A wrapper works with any entity type.
+  local get_position = entity.get_position
+  local hero_x, hero_y = map:get_hero():get_position()
+  x, y = get_position(map:get_hero())
+  assert_equal(x, hero_x)
+  assert_equal(y, hero_y)
+
+  entity:set_visible(false)
+  assert(not entity:is_visible())
+  entity:set_visible()
+  assert(entity:is_visible())
+
+  local sprite = entity:get_sprite()
+  sprite:set_xy(3, -2)
+  x, y = sprite:get_xy()
+  assert_equal(x, 3)
+  assert_equal(y, -2)
+  assert_equal(sprite:get_direction(), 0)
+  assert_equal(sprite:get_frame(), 0)
+  assert(not sprite:is_paused())
+
+  local movement = sol.movement.create("straight")
+  movement:set_speed(48)
+  movement:set_angle(math.pi)
+  assert_equal(movement:get_speed(), 48)
+  assert_equal(movement:get_angle(), math.pi)
+  x, y = movement:get_xy()
+  assert_equal(x, 0)
+  assert_equal(y, 0)
+  movement:set_xy(5, -7)
+  x, y = movement:get_xy()
+  assert_equal(x, 5)
+  assert_equal(y, -7)
+
+  -- Wrong arguments still raise errors.
+  assert(not pcall(get_position, sprite))
+  assert(not pcall(sprite.get_direction, entity))
+  assert(not pcall(entity.set_visible, entity, "yes"))
+
+  sol.main.exit()
+end
@@ -0,0 +1,81 @@
+local map = ...
+
+-- Returns the color of a pixel of a surface.
+local function get_pixel(surface, x, y)
+  local width = surface:get_size()
+  local index = (y * width + x) * 4 + 1
+  return { surface:get_pixels():byte(index, index + 3) }
+end
+
+-- Checks that a color is close to the expected one.
+local function assert_color(actual, expected)
+  for i = 1, 4 do
+    assert(math.abs(actual[i] - expected[i]) <= 1,
+        "Wrong color: expected " .. table.concat(expected, ", ") ..
+        ", got " .. table.concat(actual, ", "))
+  end
+end
+
+function map:on_started()
+
+  local light_map = sol.light_map.create(32, 32, 4)
+  assert_equal(sol.main.get_type(light_map), "light_map")
+  assert_equal(light_map:get_scale(), 4)
+  assert_equal(light_map:get_num_lights(), 0)
+  assert_color(light_map:get_ambient_color(), {0, 0, 0, 255})
+
+  local light_id = light_map:add_light({
+    x = 16,
+    y = 16,
+    radius = 12,
+  })
+  assert_equal(light_map:get_num_lights(), 1)
+  assert(light_map:has_light(light_id))
+  assert(not light_map:has_light(light_id + 1))
+
+  -- Lights follow entities and are removed with them.
+  local hero = map:get_hero()
+  local hero_light_id = light_map:add_light({
+    entity = hero,
+    radius = 24,
+    color = {255, 128, 0},
+    falloff = 2,
+  })
+  assert(hero_light_id ~= light_id)
+  assert_equal(light_map:get_num_lights(), 2)
+  assert(light_map:remove_light(hero_light_id))
+  assert(not light_map:remove_light(hero_light_id))
+  assert(not light_map:has_light(hero_light_id))
+  assert(light_map:has_light(light_id))
+  assert_equal(light_map:get_num_lights(), 1)
+
+  -- Dark where there is no light, unchanged at the center of a light.
+  local surface = sol.surface.create(32, 32)
+  surface:fill_color({200, 100, 50, 255})
+  light_map:draw(surface)
+  assert_color(get_pixel(surface, 0, 0), {0, 0, 0, 255})
+  assert_color(get_pixel(surface, 16, 16), {200, 100, 50, 255})
+
+  -- Moving the view moves the lights.
+  light_map:set_view_position(100, 100)
+  local x, y = light_map:get_view_position()
+  assert_equal(x, 100)
+  assert_equal(y, 100)
+  surface:fill_color({200, 100, 50, 255})
+  light_map:draw(surface)
+  assert_color(get_pixel(surface, 16, 16), {0, 0, 0, 255})
+
+  -- Ambient light.
+  light_map:set_ambient_color({255, 255, 255})
+  surface:fill_color({200, 100, 50, 255})
+  light_map:draw(surface)
+  assert_color(get_pixel(surface, 0, 0), {200, 100, 50, 255})
+
+  light_map:clear_lights()
+  assert_equal(light_map:get_num_lights(), 0)
+  assert(not light_map:has_light(light_id))
+  assert(not pcall(sol.light_map.create, 32, 32, 0))
+  assert(not pcall(light_map.add_light, light_map, { x = 0, y = 0, radius = 0 }))
+
+  sol.main.exit()
+end
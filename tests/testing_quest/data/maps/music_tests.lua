@@ -0,0 +1,24 @@
+local map = ...
+
+function map:on_started()
+
+  assert_equal(sol.audio.get_music_crossfade_duration(), 0)
+  sol.audio.set_music_crossfade_duration(500)
+  assert_equal(sol.audio.get_music_crossfade_duration(), 500)
+
+  -- Preloading an unknown music is an error.
+  assert(not pcall(sol.audio.preload_music, "no_such_music"))
+  assert(not pcall(sol.audio.set_music_crossfade_duration, -1))
+
+  -- Audio is disabled here: reusing the preloaded music is checked by
+  -- the MusicPreload C++ test.
+  sol.audio.preload_music("short_tune")
+
+  -- Switching musics with a crossfade.
+  sol.audio.preload_music("none")
+  sol.audio.play_music(nil)
+  assert_equal(sol.audio.get_music(), nil)
+
+  sol.audio.set_music_crossfade_duration(0)
+  sol.main.exit()
+end
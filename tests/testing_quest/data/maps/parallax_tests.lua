@@ -0,0 +1,6 @@
+local map = ...
+
+-- The checks are made in C++ once the map is started.
+function map:on_started()
+  sol.main.exit()
+end
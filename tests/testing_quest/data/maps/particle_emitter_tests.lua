@@ -0,0 +1,66 @@
+local map = ...
+
+function map:on_opening_transition_finished()
+
+  local emitter = sol.particle_emitter.create({
+    sheet = "things/grass_effect.png",
+    frame_width = 8,
+    frame_height = 8,
+    max_particles = 10,
+    emitting = false,
+    min_lifetime = 50,
+    max_lifetime = 100,
+    min_speed = 10,
+    max_speed = 20,
+    gravity_y = 100,
+  })
+  assert_equal(sol.main.get_type(emitter), "particle_emitter")
+  assert_equal(emitter:get_max_particles(), 10)
+  assert_equal(emitter:get_num_particles(), 0)
+  assert(not emitter:is_emitting())
+  assert_equal(emitter:get_lifetime(), 50)
+
+  -- Emitting more than the maximum is clamped.
+  emitter:emit(20)
+  assert_equal(emitter:get_num_particles(), 10)
+  emitter:clear()
+  assert_equal(emitter:get_num_particles(), 0)
+
+  emitter:emit(5)
+  assert_equal(emitter:get_num_particles(), 5)
+  function map:on_draw(dst_surface)
+    map:draw_visual(emitter, 160, 120)
+  end
+
+  -- Drawing with a blend mode does not change a sheet owned by the script.
+  local sheet = sol.surface.create(8, 8)
+  sheet:fill_color({ 255, 255, 255 })
+  local blended_emitter = sol.particle_emitter.create({
+    sheet = sheet,
+    emitting = false,
+  })
+  blended_emitter:set_blend_mode("add")
+  blended_emitter:emit(3)
+  local dst_surface = sol.surface.create(32, 32)
+  blended_emitter:draw(dst_surface, 16, 16)
+  blended_emitter:draw_region(-8, -8, 16, 16, dst_surface, 16, 16)
+  assert_equal(sheet:get_blend_mode(), "blend")
+  assert_equal(blended_emitter:get_blend_mode(), "add")
+
+  -- Fading the emitter does not change the opacity of the sheet either.
+  blended_emitter:fade_out(100)
+
+  -- All particles are dead after their maximum lifetime.
+  sol.timer.start(map, 200, function()
+    assert_equal(emitter:get_num_particles(), 0)
+    blended_emitter:draw(dst_surface, 16, 16)
+    assert_equal(sheet:get_opacity(), 255)
+
+    emitter:set_emission_rate(1000)
+    emitter:set_emitting(true)
+    sol.timer.start(map, 50, function()
+      assert(emitter:get_num_particles() > 0)
+      sol.main.exit()
+    end)
+  end)
+end
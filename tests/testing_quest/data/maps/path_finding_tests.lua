@@ -0,0 +1,41 @@
+local map = ...
+
+function map:on_started()
+
+  local source = map:create_custom_entity({
+    x = 24,
+    y = 29,
+    layer = 0,
+    direction = 0,
+    width = 16,
+    height = 16,
+  })
+
+  -- Too far for the usual path finding.
+  local target = map:create_custom_entity({
+    x = 296,
+    y = 29,
+    layer = 0,
+    direction = 0,
+    width = 16,
+    height = 16,
+  })
+
+  local movement = sol.movement.create("path_finding")
+  assert(not movement:is_hierarchical())
+  movement:set_hierarchical()
+  assert(movement:is_hierarchical())
+  movement:set_hierarchical(false)
+  assert(not movement:is_hierarchical())
+  movement:set_hierarchical(true)
+
+  movement:set_target(target)
+  movement:set_speed(256)
+  movement:start(source)
+
+  sol.timer.start(map, 3000, function()
+    local distance = source:get_distance(target)
+    assert(distance <= 24, "The target was not reached: distance " .. distance)
+    sol.main.exit()
+  end)
+end
@@ -0,0 +1,48 @@
+local map = ...
+
+local function busy_loop()
+
+  local sum = 0
+  for i = 1, 200000 do
+    sum = sum + i % 7
+  end
+  return sum
+end
+
+if jit ~= nil then
+  -- Hooks are not called from code compiled by LuaJIT.
+  jit.off(busy_loop)
+end
+
+function map:on_started()
+
+  assert(not sol.main.is_profiling())
+  assert_equal(sol.main.stop_profiler(), 0)
+
+  sol.main.start_profiler("profiler_tests.folded", 100)
+  assert(sol.main.is_profiling())
+  busy_loop()
+  local num_samples = sol.main.stop_profiler()
+  assert(not sol.main.is_profiling())
+  assert(num_samples > 0)
+
+  -- Collapsed stacks: frames separated by semicolons, then a count.
+  local file = sol.file.open("profiler_tests.folded")
+  local total = 0
+  local found = false
+  for line in file:lines() do
+    local stack, count = line:match("^(.+) (%d+)$")
+    assert(stack ~= nil)
+    total = total + tonumber(count)
+    if stack:match("busy_loop %(maps/profiler_tests%.lua:%d+%)$") then
+      found = true
+    end
+  end
+  file:close()
+  assert_equal(total, num_samples)
+  assert(found)
+
+  assert(not pcall(sol.main.start_profiler, "profiler_tests.folded", 0))
+
+  sol.main.exit()
+end
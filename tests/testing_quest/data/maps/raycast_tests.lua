@@ -0,0 +1,83 @@
+local map = ...
+
+function map:on_started()
+
+  local probe = map:create_custom_entity({
+    x = 40,
+    y = 45,
+    layer = 0,
+    direction = 0,
+    width = 16,
+    height = 16,
+  })
+
+  -- An obstacle entity.
+  local block = map:create_custom_entity({
+    x = 160,
+    y = 80,
+    layer = 0,
+    direction = 0,
+    width = 16,
+    height = 16,
+  })
+  block:set_traversable_by(false)
+  local block_x, block_y, block_width, block_height = block:get_bounding_box()
+  local ray_y = block_y + 4
+
+  local hit, x, y, entity = map:raycast(100, ray_y, 220, ray_y, 0, probe)
+  assert(hit)
+  assert_equal(x, block_x)
+  assert_equal(y, ray_y)
+  assert_equal(entity, block)
+
+  -- Same ray from the other side.
+  hit, x, y, entity = map:raycast(220, ray_y, 100, ray_y, 0, probe)
+  assert(hit)
+  assert_equal(x, block_x + block_width - 1)
+  assert_equal(entity, block)
+
+  -- Other layer: no obstacle.
+  hit, x, y, entity = map:raycast(100, ray_y, 220, ray_y, 1, probe)
+  assert(not hit)
+  assert_equal(x, 220)
+  assert_equal(y, ray_y)
+  assert_equal(entity, nil)
+
+  -- A ground modifier is hit as the ground.
+  local wall = map:create_custom_entity({
+    x = 80,
+    y = 160,
+    layer = 0,
+    direction = 0,
+    width = 16,
+    height = 16,
+  })
+  wall:set_modified_ground("wall")
+  local wall_x, wall_y = wall:get_bounding_box()
+  hit, x, y, entity = map:raycast(wall_x + 3, 230, wall_x + 3, 100, 0, probe)
+  assert(hit)
+  assert_equal(x, wall_x + 3)
+  assert_equal(y, wall_y + 15)
+  assert_equal(entity, nil)
+
+  -- Diagonal ray.
+  hit, x, y, entity = map:raycast(block_x - 20, block_y - 20, block_x + 8, block_y + 8, 0, probe)
+  assert(hit)
+  assert_equal(x, block_x)
+  assert_equal(y, block_y)
+  assert_equal(entity, block)
+
+  -- Segment query: entities in the order the segment reaches them.
+  local entities = {}
+  for entity in map:get_entities_on_segment(220, ray_y, 0, ray_y) do
+    entities[#entities + 1] = entity
+  end
+  assert_equal(entities[1], block)
+
+  -- Outside the map is an obstacle.
+  hit, x, y = map:raycast(300, 10, 340, 10, 0, probe)
+  assert(hit)
+  assert_equal(x, 320)
+
+  sol.main.exit()
+end
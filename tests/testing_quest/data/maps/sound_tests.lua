@@ -0,0 +1,42 @@
+local map = ...
+
+function map:on_started()
+
+  -- Values from quest.dat.
+  assert_equal(sol.audio.get_max_sound_voices(), 24)
+  assert_equal(sol.audio.get_max_voices_per_sound(), 4)
+  assert(not sol.audio.is_sound_coalescing_louder())
+
+  sol.audio.set_max_sound_voices(8)
+  assert_equal(sol.audio.get_max_sound_voices(), 8)
+  sol.audio.set_max_voices_per_sound(2)
+  assert_equal(sol.audio.get_max_voices_per_sound(), 2)
+  sol.audio.set_sound_coalescing_louder()
+  assert(sol.audio.is_sound_coalescing_louder())
+  sol.audio.set_sound_coalescing_louder(false)
+  assert(not sol.audio.is_sound_coalescing_louder())
+
+  -- Per-sound settings.
+  assert_equal(sol.audio.get_sound_max_voices("bomb"), 2)
+  sol.audio.set_sound_max_voices("bomb", 1)
+  assert_equal(sol.audio.get_sound_max_voices("bomb"), 1)
+  sol.audio.set_sound_max_voices("bomb", nil)
+  assert_equal(sol.audio.get_sound_max_voices("bomb"), 2)
+
+  assert_equal(sol.audio.get_sound_priority("boss_hurt"), 0)
+  sol.audio.set_sound_priority("boss_hurt", 10)
+  assert_equal(sol.audio.get_sound_priority("boss_hurt"), 10)
+
+  -- Many requests in the same tick must not fail.
+  -- Audio is disabled here: the resulting voices are checked by the
+  -- SoundVoices C++ test.
+  for i = 1, 30 do
+    sol.audio.play_sound("bomb")
+    sol.audio.play_sound("boss_hurt")
+  end
+
+  assert(not pcall(sol.audio.set_max_sound_voices, -1))
+  assert(not pcall(sol.audio.set_sound_priority, "no_such_sound", 1))
+
+  sol.main.exit()
+end
@@ -0,0 +1,61 @@
+local map = ...
+
+-- Many animated sprites: frame changes are computed in parallel
+-- but must still be notified in order for each sprite.
+local num_entities = 300
+local frames_by_sprite = {}
+local finished_count = 0
+
+function map:on_started()
+
+  for i = 1, num_entities do
+    local entity = map:create_custom_entity({
+      x = 8 + (i % 20) * 16,
+      y = 13 + math.floor(i / 20) * 16,
+      layer = 0,
+      direction = 0,
+      width = 16,
+      height = 16,
+      sprite = "entities/explosion",
+    })
+    local sprite = entity:get_sprite()
+    local frames = {}
+    frames_by_sprite[i] = frames
+
+    function sprite:on_frame_changed(animation, frame)
+      frames[#frames + 1] = frame
+
+      if i == 1 and frame == 3 and #frames == 3 then
+        -- Modify the sprite while its next frames may be already computed.
+        sprite:set_frame(0)
+      end
+    end
+
+    function sprite:on_animation_finished(animation)
+      finished_count = finished_count + 1
+    end
+  end
+end
+
+function map:on_opening_transition_finished()
+
+  sol.timer.start(map, 2000, function()
+    assert_equal(finished_count, num_entities)
+
+    for i = 1, num_entities do
+      local frames = frames_by_sprite[i]
+      local expected = {}
+      if i == 1 then
+        expected = { 1, 2, 3, 0 }
+      end
+      for frame = 1, 8 do
+        expected[#expected + 1] = frame
+      end
+      for j, frame in ipairs(expected) do
+        assert_equal(frames[j], frame)
+      end
+    end
+
+    sol.main.exit()
+  end)
+end
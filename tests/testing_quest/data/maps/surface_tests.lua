@@ -14,6 +14,89 @@ local function test_get_pixels()
   assert_equal(a, 255)
 end
 
+-- Checks that the first pixel of a surface is close to the expected color.
+local function assert_first_pixel(surface, expected)
+  local pixels = surface:get_pixels()
+  local actual = { pixels:byte(1, 4) }
+  for i = 1, 4 do
+    assert(math.abs(actual[i] - expected[i]) <= 1,
+        "Wrong pixel: expected " .. table.concat(expected, ", ") ..
+        ", got " .. table.concat(actual, ", "))
+  end
+end
+
+-- Test for drawing surfaces with each blend mode.
+local function test_blend_modes()
+
+  -- Semi-transparent color fill.
+  local surface = sol.surface.create(16, 16)
+  surface:fill_color({0, 0, 255, 255})
+  surface:fill_color({255, 0, 0, 128})
+  assert_first_pixel(surface, {128, 0, 127, 255})
+
+  local src = sol.surface.create(16, 16)
+  src:fill_color({200, 100, 50, 128})
+
+  -- Alpha blending.
+  local dst = sol.surface.create(16, 16)
+  dst:fill_color({0, 0, 100, 255})
+  src:draw(dst)
+  assert_first_pixel(dst, {100, 50, 75, 255})
+
+  -- Alpha blending with an opacity.
+  dst:clear()
+  src:set_opacity(128)
+  src:draw(dst)
+  assert_first_pixel(dst, {50, 25, 13, 64})
+  src:set_opacity(255)
+
+  -- Additive blending.
+  dst:fill_color({100, 200, 250, 255})
+  src:set_blend_mode("add")
+  src:draw(dst)
+  assert_first_pixel(dst, {200, 250, 255, 255})
+
+  -- Multiplicative blending.
+  dst:fill_color({255, 128, 0, 255})
+  src:set_blend_mode("multiply")
+  src:draw(dst)
+  assert_first_pixel(dst, {200, 50, 0, 255})
+
+  -- No blending.
+  dst:fill_color({1, 2, 3, 255})
+  src:set_blend_mode("none")
+  src:draw(dst)
+  assert_first_pixel(dst, {200, 100, 50, 128})
+end
+
+-- Test for palette images.
+local function test_palette()
+
+  assert_equal(sol.surface.create(16, 16):get_palette(), nil)
+
+  local surface = sol.surface.create("citizens/witch.png")
+  local palette = surface:get_palette()
+  assert(palette ~= nil)
+  assert_equal(#palette, 26)
+  assert_equal(palette[1][4], 0)
+  assert_equal(palette[2][1], 6)
+  assert_equal(palette[2][4], 255)
+
+  palette[2] = {1, 2, 3, 255}
+  surface:set_palette(palette)
+  palette = surface:get_palette()
+  assert_equal(palette[2][1], 1)
+  assert_equal(palette[2][2], 2)
+  assert_equal(palette[2][3], 3)
+
+  -- Drawing on the surface converts it to 32-bit colors.
+  surface:fill_color({10, 20, 30, 255})
+  assert_equal(surface:get_palette(), nil)
+  assert_first_pixel(surface, {10, 20, 30, 255})
+end
+
 test_get_pixels()
+test_blend_modes()
+test_palette()
 
 sol.main.exit()
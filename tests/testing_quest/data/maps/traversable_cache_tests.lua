@@ -0,0 +1,71 @@
+local map = ...
+
+function map:on_started()
+
+  local wall = map:create_custom_entity({
+    x = 88,
+    y = 93,
+    layer = 0,
+    direction = 0,
+    width = 16,
+    height = 16,
+  })
+
+  local walker = map:create_custom_entity({
+    x = 72,
+    y = 93,
+    layer = 0,
+    direction = 0,
+    width = 16,
+    height = 16,
+  })
+
+  local num_calls = 0
+  local function traversable_test(entity, other)
+    num_calls = num_calls + 1
+    return false
+  end
+
+  -- Stable rule: called once as long as nothing changes.
+  wall:set_traversable_by(traversable_test, true)
+  for i = 1, 10 do
+    assert(walker:test_obstacles(8, 0))
+  end
+  assert_equal(num_calls, 1)
+
+  -- Invalidated by the script.
+  wall:clear_traversable_cache()
+  assert(walker:test_obstacles(8, 0))
+  assert(walker:test_obstacles(8, 0))
+  assert_equal(num_calls, 2)
+
+  -- Invalidated by a state change of the other entity.
+  walker:set_enabled(false)
+  walker:set_enabled(true)
+  assert(walker:test_obstacles(8, 0))
+  assert_equal(num_calls, 3)
+
+  -- Type-specific stable rule.
+  num_calls = 0
+  wall:set_traversable_by("custom_entity", traversable_test, true)
+  for i = 1, 10 do
+    assert(walker:test_obstacles(8, 0))
+  end
+  assert_equal(num_calls, 1)
+  wall:set_traversable_by("custom_entity", nil)
+
+  -- Rules not declared stable are called every time.
+  num_calls = 0
+  wall:set_traversable_by(traversable_test)
+  for i = 1, 10 do
+    assert(walker:test_obstacles(8, 0))
+  end
+  assert_equal(num_calls, 10)
+
+  -- No collision: the rule is not called.
+  num_calls = 0
+  assert(not walker:test_obstacles(-8, 0))
+  assert_equal(num_calls, 0)
+
+  sol.main.exit()
+end
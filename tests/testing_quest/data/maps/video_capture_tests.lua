@@ -0,0 +1,43 @@
+local map = ...
+
+-- Removes frames left by a previous run.
+local function remove_frames(extension)
+  for i = 0, 1 do
+    local file_name = string.format("video_capture_tests/%06d.%s", i, extension)
+    if sol.file.exists(file_name) then
+      assert(sol.file.remove(file_name))
+    end
+  end
+end
+
+-- Capture a few frames and check that they are written.
+function map:on_opening_transition_finished()
+
+  remove_frames("png")
+  remove_frames("rgba")
+
+  assert(not sol.video.is_capturing())
+  sol.video.start_capture("video_capture_tests")
+  assert(sol.video.is_capturing())
+
+  sol.timer.start(map, 100, function()
+    sol.video.stop_capture()
+    assert(not sol.video.is_capturing())
+    assert(sol.file.exists("video_capture_tests/000000.png"))
+    assert(sol.file.exists("video_capture_tests/000001.png"))
+
+    sol.video.start_capture("video_capture_tests", "raw")
+    sol.timer.start(map, 100, function()
+      sol.video.stop_capture()
+      assert(sol.file.exists("video_capture_tests/000000.rgba"))
+      assert(sol.file.exists("video_capture_tests/000001.rgba"))
+
+      -- A raw frame is made of RGBA pixels of the quest size.
+      local width, height = sol.video.get_quest_size()
+      local file = sol.file.open("video_capture_tests/000000.rgba", "rb")
+      assert_equal(file:seek("end"), width * height * 4)
+      file:close()
+      sol.main.exit()
+    end)
+  end)
+end